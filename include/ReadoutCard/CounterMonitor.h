@@ -0,0 +1,94 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CounterMonitor.h
+/// \brief Definition of the CounterMonitor class.
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_COUNTERMONITOR_H_
+#define ALICEO2_INCLUDE_READOUTCARD_COUNTERMONITOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "ReadoutCard/BarInterface.h"
+#include "ReadoutCard/ExtendedCounter.h"
+#include "ReadoutCard/Parameters.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Samples the card's wrapping 32-bit packet counters and extends them to monotonic 64-bit values with rates.
+/// Sampling is either done explicitly through sample(), or periodically by a background thread through start().
+/// The sampling interval has to be shorter than the wrap period of the fastest counter.
+class CounterMonitor
+{
+ public:
+  /// Packet counters of a single link
+  struct LinkCounters {
+    ExtendedCounter accepted;
+    ExtendedCounter rejected;
+    ExtendedCounter forced;
+  };
+
+  /// Packet counters of a single datapath wrapper
+  struct WrapperCounters {
+    ExtendedCounter dropped;
+  };
+
+  /// Extended counters as of the last sample
+  struct Snapshot {
+    std::map<int, LinkCounters> links;
+    std::map<int, WrapperCounters> wrappers;
+    uint64_t samples = 0;
+    std::chrono::steady_clock::time_point time;
+  };
+
+  static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{ 1000 };
+
+  CounterMonitor(Parameters::CardIdType cardId);
+  CounterMonitor(std::shared_ptr<BarInterface> bar2);
+  ~CounterMonitor();
+
+  /// Reads all counters once and updates their extended values
+  void sample();
+
+  /// Starts sampling periodically in a background thread
+  void start(std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+
+  /// Stops the background thread, if any
+  void stop();
+
+  /// Returns a copy of the extended counters
+  Snapshot getSnapshot();
+
+ private:
+  void sampleLocked();
+
+  std::shared_ptr<BarInterface> mBar2;
+  std::mutex mMutex;
+  Snapshot mSnapshot;
+  bool mRefreshLinks = true;
+
+  std::thread mThread;
+  std::atomic<bool> mRunning{ false };
+  std::mutex mWaitMutex;
+  std::condition_variable mWaitCondition;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_COUNTERMONITOR_H_
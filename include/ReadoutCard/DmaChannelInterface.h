@@ -140,6 +140,40 @@ class DmaChannelInterface
   /// Gets card unique ID, such as an FPGA chip ID in the case of the CRU
   /// \return A string containing the unique ID
   virtual boost::optional<std::string> getCardId() = 0;
+
+  /// Dumps the flight recorder, the recent history of queue depths, push/pop rates, poll intervals and drop counter.
+  /// The recorder also dumps itself automatically when the firmware drops packets.
+  /// Currently, only the CRU backend supports this
+  /// \return The path of the dump file if available, else an empty optional
+  virtual boost::optional<std::string> dumpFlightRecorder() = 0;
+
+  /// Dumps the superpage lifecycle trace in the Chrome trace event format, which can be loaded in chrome://tracing or
+  /// Perfetto, and logs the residence-time statistics per stage and per link.
+  /// Requires the SuperpageTrackingEnabled parameter. Currently, only the CRU backend supports this
+  /// \return The path of the trace file if available, else an empty optional
+  virtual boost::optional<std::string> dumpSuperpageTrace() = 0;
+
+  /// Hands the running DMA over to a successor process, e.g. for a software update without a run interruption.
+  /// Exports the state of the channel (buffer identity, superpages in flight per link, ready superpages and FIFO
+  /// indices) to shared memory, and leaves the DMA running when this object is destroyed. The successor opens the
+  /// channel with the same buffer and the AdoptDmaEnabled parameter, and its startDma() adopts the running DMA
+  /// instead of starting it. After this call, the only valid operation on this object is to destroy it, which
+  /// releases the channel lock for the successor.
+  /// Requires the DMA to be started, and the IOMMU to be disabled, since the card keeps the bus addresses it was
+  /// given. Superpages the consumer had already popped are not handed over, they belong to the old owner.
+  /// \return The path of the state file if supported, else an empty optional
+  virtual boost::optional<std::string> handOverDma() = 0;
+
+  /// Gets a file descriptor that becomes readable when superpages may have arrived, so that a consumer can sleep in
+  /// poll() or epoll instead of polling the channel, which suits low-rate channels. After it becomes readable, the
+  /// consumer calls fillSuperpages(), which acknowledges the notification, and pops the ready superpages. It waits on
+  /// the descriptor again only once a fillSuperpages() moved no superpages to the ready queue, since arrivals held back
+  /// by a full ready queue are not notified again. Notifications may be spurious, and a card whose firmware raises no
+  /// interrupt never notifies, so a consumer should wait with a timeout and call fillSuperpages() after it.
+  /// The descriptor belongs to the channel: the consumer must not read from it or close it.
+  /// Requires the ArrivalNotificationEnabled parameter. Polling stays the default.
+  /// \return The file descriptor if enabled, else an empty optional
+  virtual boost::optional<int> getArrivalNotificationFd() = 0;
 };
 
 } // namespace roc
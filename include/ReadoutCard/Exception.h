@@ -34,6 +34,9 @@ struct PdaException : virtual Exception {
 };
 struct MemoryMapException : virtual Exception {
 };
+/// Not enough hugepages are free for a buffer, counting the ones other processes reserved but did not map yet
+struct HugepageCapacityException : virtual MemoryMapException {
+};
 struct ParameterException : virtual Exception {
 };
 struct ParseException : virtual Exception {
@@ -64,6 +67,9 @@ struct UnsafeWriteAccess : virtual UnsafeAccess {
 };
 struct InvalidLinkId : virtual Exception {
 };
+/// The card does not respond to MMIO: it dropped off the bus, or hit an uncorrectable PCIe error
+struct DeviceLostException : virtual Exception {
+};
 
 // C-RORC exception definitions
 struct CrorcException : virtual Exception {
@@ -0,0 +1,100 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ExtendedCounter.h
+/// \brief Definition of the ExtendedCounter class.
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_EXTENDEDCOUNTER_H_
+#define ALICEO2_INCLUDE_READOUTCARD_EXTENDEDCOUNTER_H_
+
+#include <cstdint>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Extends a wrapping 32-bit firmware counter to a monotonic 64-bit value.
+/// The lower 32 bits of the extended value always mirror the last raw reading, so the increment is the modular
+/// difference between two readings and a wrap shows up as a reading smaller than the previous one.
+/// The counter must be updated at least once per wrap period, otherwise whole wraps are lost.
+/// It is header-only to make it inlineable.
+class ExtendedCounter
+{
+ public:
+  /// Feeds a new raw reading. The first reading only sets the baseline.
+  /// \param raw Raw 32-bit register value
+  /// \param elapsed Seconds since the previous reading, used to compute the rate
+  void update(uint32_t raw, double elapsed)
+  {
+    if (!mValid) {
+      mValue = raw;
+      mInitial = raw;
+      mValid = true;
+      return;
+    }
+
+    uint32_t previous = static_cast<uint32_t>(mValue);
+    uint32_t increment = raw - previous; // Modular arithmetic takes care of the wrap
+    if (raw < previous) {
+      mWraps++;
+    }
+    mValue += increment;
+    mRate = (elapsed > 0.0) ? (increment / elapsed) : 0.0;
+  }
+
+  /// Forgets all readings; the next update sets a new baseline
+  void reset()
+  {
+    *this = ExtendedCounter();
+  }
+
+  /// Has the counter received a reading yet
+  bool isValid() const
+  {
+    return mValid;
+  }
+
+  /// Monotonic 64-bit value of the counter
+  uint64_t getValue() const
+  {
+    return mValue;
+  }
+
+  /// Increment since the first reading
+  uint64_t getDelta() const
+  {
+    return mValue - mInitial;
+  }
+
+  /// Number of times the raw register wrapped since the first reading
+  uint64_t getWraps() const
+  {
+    return mWraps;
+  }
+
+  /// Counts per second between the last two readings
+  double getRate() const
+  {
+    return mRate;
+  }
+
+ private:
+  bool mValid = false;
+  uint64_t mValue = 0;
+  uint64_t mInitial = 0;
+  uint64_t mWraps = 0;
+  double mRate = 0.0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_EXTENDEDCOUNTER_H_
@@ -21,6 +21,7 @@
 #include <chrono>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include "ReadoutCard/TimeSource.h"
 
 #define LOCK_TIMEOUT 5            //5 second timeout in case we wait for the lock (e.g PDA)
 #define UNIX_SOCK_NAME_LENGTH 104 //108 for most UNIXs, 104 for macOS
@@ -51,8 +52,9 @@ class Lock
     mServerAddress.sun_path[0] = 0; //this makes the unix domain socket *abstract*
 
     if (waitOnLock) { //retry until timeout
-      const auto start = std::chrono::steady_clock::now();
-      auto timeExceeded = [&]() { return ((std::chrono::steady_clock::now() - start) > std::chrono::seconds(LOCK_TIMEOUT)); };
+      auto& timeSource = TimeSource::get();
+      const auto start = timeSource.now();
+      auto timeExceeded = [&]() { return ((timeSource.now() - start) > std::chrono::seconds(LOCK_TIMEOUT)); };
 
       while (bind(mSocketFd,
                   (const struct sockaddr*)&mServerAddress,
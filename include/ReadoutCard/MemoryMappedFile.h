@@ -43,6 +43,9 @@ class MemoryMappedFile
 
   std::string getFileName() const;
 
+  /// Changes whether the file is deleted when this object is destroyed, e.g. to keep it for another process
+  void setDeleteFileOnDestruction(bool deleteFileOnDestruction);
+
  private:
   bool map(const std::string& fileName, size_t fileSize);
 
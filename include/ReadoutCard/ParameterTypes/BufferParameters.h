@@ -41,6 +41,12 @@ struct File {
 struct Null {
 };
 
+/// Part of a buffer shared by several channels, which a channel uses as its own buffer
+struct Partition {
+  size_t offset; ///< Offset in bytes of the partition in the shared buffer
+  size_t size;   ///< Size in bytes of the partition
+};
+
 } // namespace buffer_parameters
 } // namespace roc
 } // namespace AliceO2
@@ -121,6 +121,48 @@ class Parameters
   // Type for the Trigger Window Size parameter
   using TriggerWindowSizeType = uint32_t;
 
+  /// Type for the Ordered Delivery enabled parameter
+  using OrderedDeliveryEnabledType = bool;
+
+  /// Type for the Ordered Delivery window parameter
+  using OrderedDeliveryWindowType = size_t;
+
+  /// Type for the Ordered Delivery timeout parameter, in milliseconds
+  using OrderedDeliveryTimeoutType = uint32_t;
+
+  /// Type for the Superpage Tracking enabled parameter
+  using SuperpageTrackingEnabledType = bool;
+
+  /// Type for the Superpage Tracking threshold parameter, in milliseconds
+  using SuperpageTrackingThresholdType = uint32_t;
+
+  /// Type for the Latency Measurement enabled parameter
+  using LatencyMeasurementEnabledType = bool;
+
+  /// Type for the Adopt DMA enabled parameter
+  using AdoptDmaEnabledType = bool;
+
+  /// Type for the Link Liveness enabled parameter
+  using LinkLivenessEnabledType = bool;
+
+  /// Type for the Link Liveness timeout parameter, in milliseconds
+  using LinkLivenessTimeoutType = uint32_t;
+
+  /// Type for the Rate Weighted Distribution enabled parameter
+  using RateWeightedDistributionEnabledType = bool;
+
+  /// Type for the VFIO enabled parameter
+  using VfioEnabledType = bool;
+
+  /// Type for the BufferPartition parameter
+  using BufferPartitionType = buffer_parameters::Partition;
+
+  /// Type for the ConfigurationProgram parameter
+  using ConfigurationProgramType = std::string;
+
+  /// Type for the ArrivalNotificationEnabled parameter
+  using ArrivalNotificationEnabledType = bool;
+
   // Setters
 
   /// Sets the CardId parameter
@@ -321,6 +363,137 @@ class Parameters
   /// \return Reference to this object for chaining calls
   auto setTriggerWindowSize(TriggerWindowSizeType value) -> Parameters&;
 
+  /// Sets the OrderedDeliveryEnabled parameter
+  ///
+  /// If enabled the CRU DMA channel merges the superpages of all links into a single ready queue, ordered by the
+  /// heartbeat orbit of their first RDH.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setOrderedDeliveryEnabled(OrderedDeliveryEnabledType value) -> Parameters&;
+
+  /// Sets the OrderedDeliveryWindow parameter
+  ///
+  /// Maximum amount of superpages held back for reordering. When reached, the oldest superpage is delivered regardless
+  /// of the other links.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setOrderedDeliveryWindow(OrderedDeliveryWindowType value) -> Parameters&;
+
+  /// Sets the OrderedDeliveryTimeout parameter
+  ///
+  /// Time in milliseconds after which a link without data is no longer waited for.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setOrderedDeliveryTimeout(OrderedDeliveryTimeoutType value) -> Parameters&;
+
+  /// Sets the SuperpageTrackingEnabled parameter
+  ///
+  /// If enabled the CRU DMA channel records the lifecycle of every superpage (push, firmware completion, pop and
+  /// re-push), keeps residence-time statistics per stage and per link, and warns about superpages stuck in a stage.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setSuperpageTrackingEnabled(SuperpageTrackingEnabledType value) -> Parameters&;
+
+  /// Sets the SuperpageTrackingThreshold parameter
+  ///
+  /// Time in milliseconds after which a superpage that has not moved to the next stage of its lifecycle is reported,
+  /// e.g. when it is popped and never pushed back.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setSuperpageTrackingThreshold(SuperpageTrackingThresholdType value) -> Parameters&;
+
+  /// Sets the LatencyMeasurementEnabled parameter
+  ///
+  /// If enabled the CRU DMA channel correlates the orbit and bunch crossing in the RDH of every arriving superpage with
+  /// the host clock, and tags the superpage with its card-to-host latency (see Superpage::getLatency()).
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLatencyMeasurementEnabled(LatencyMeasurementEnabledType value) -> Parameters&;
+
+  /// Sets the AdoptDmaEnabled parameter
+  ///
+  /// If enabled the DMA channel adopts the running DMA handed over by its previous owner (see
+  /// DmaChannelInterface::handOverDma()): the channel is not reset, and startDma() restores the handed over state
+  /// instead of starting the DMA.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setAdoptDmaEnabled(AdoptDmaEnabledType value) -> Parameters&;
+
+  /// Sets the LinkLivenessEnabled parameter
+  ///
+  /// If enabled the CRU DMA channel watches the status and the superpage completions of its links, and stops giving
+  /// superpages to links that are down or do not fill the ones they have, so they do not starve the other links.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkLivenessEnabled(LinkLivenessEnabledType value) -> Parameters&;
+
+  /// Sets the LinkLivenessTimeout parameter
+  ///
+  /// Time in milliseconds without a superpage completion after which a link that has superpages is considered idle.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setLinkLivenessTimeout(LinkLivenessTimeoutType value) -> Parameters&;
+
+  /// Sets the RateWeightedDistributionEnabled parameter
+  ///
+  /// If enabled the CRU DMA channel gives the pushed superpages to the links in proportion to the rate at which they
+  /// complete them, with a floor for quiet links, instead of evenly.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setRateWeightedDistributionEnabled(RateWeightedDistributionEnabledType value) -> Parameters&;
+
+  /// Sets the VfioEnabled parameter
+  ///
+  /// If enabled the card is accessed through the kernel's VFIO interface instead of PDA: it must be bound to the
+  /// vfio-pci driver and identified by its PCI address. The BARs are mapped through the VFIO device, and the DMA buffer
+  /// is mapped at a single contiguous IOVA range. Only supported by the CRU.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setVfioEnabled(VfioEnabledType value) -> Parameters&;
+
+  /// Sets the BufferPartition parameter
+  ///
+  /// If set the BufferParameters describe a buffer shared by several channels of the same card, and the channel only
+  /// uses the given partition of it. The channels of a process that share a PCI function (e.g. the C-RORC's channels)
+  /// register the buffer once. The offset and size must be multiples of 2 MiB, and the partitions of the channels must
+  /// not overlap. Not supported with the Null buffer.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setBufferPartition(BufferPartitionType value) -> Parameters&;
+
+  /// Sets the ConfigurationProgram parameter
+  ///
+  /// Path of the compiled configuration program of the card (CRU only). If the file holds a program for the firmware
+  /// and the configuration parameters of the card, configure() replays it instead of running the configuration.
+  /// Otherwise the configuration runs, is recorded, and its program is written to the file.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setConfigurationProgram(ConfigurationProgramType value) -> Parameters&;
+
+  /// Sets the ArrivalNotificationEnabled parameter
+  ///
+  /// If enabled the channel provides a file descriptor that becomes readable when superpages may have arrived, see
+  /// DmaChannelInterface::getArrivalNotificationFd(). With PDA it is the card's UIO device, with VFIO an eventfd the
+  /// card's MSI signals, and with the Dummy card an eventfd signalled in software. The interrupts need a firmware that
+  /// raises them on superpage completion.
+  ///
+  /// \param value The value to set
+  /// \return Reference to this object for chaining calls
+  auto setArrivalNotificationEnabled(ArrivalNotificationEnabledType value) -> Parameters&;
+
   // on-throwing getters
 
   /// Gets the AllowRejection parameter
@@ -402,6 +575,62 @@ class Parameters
   /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
   auto getTriggerWindowSize() const -> boost::optional<TriggerWindowSizeType>;
 
+  /// Gets the OrderedDeliveryEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getOrderedDeliveryEnabled() const -> boost::optional<OrderedDeliveryEnabledType>;
+
+  /// Gets the OrderedDeliveryWindow parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getOrderedDeliveryWindow() const -> boost::optional<OrderedDeliveryWindowType>;
+
+  /// Gets the OrderedDeliveryTimeout parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getOrderedDeliveryTimeout() const -> boost::optional<OrderedDeliveryTimeoutType>;
+
+  /// Gets the SuperpageTrackingEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getSuperpageTrackingEnabled() const -> boost::optional<SuperpageTrackingEnabledType>;
+
+  /// Gets the SuperpageTrackingThreshold parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getSuperpageTrackingThreshold() const -> boost::optional<SuperpageTrackingThresholdType>;
+
+  /// Gets the LatencyMeasurementEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLatencyMeasurementEnabled() const -> boost::optional<LatencyMeasurementEnabledType>;
+
+  /// Gets the AdoptDmaEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getAdoptDmaEnabled() const -> boost::optional<AdoptDmaEnabledType>;
+
+  /// Gets the LinkLivenessEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkLivenessEnabled() const -> boost::optional<LinkLivenessEnabledType>;
+
+  /// Gets the LinkLivenessTimeout parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getLinkLivenessTimeout() const -> boost::optional<LinkLivenessTimeoutType>;
+
+  /// Gets the RateWeightedDistributionEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getRateWeightedDistributionEnabled() const -> boost::optional<RateWeightedDistributionEnabledType>;
+
+  /// Gets the VfioEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getVfioEnabled() const -> boost::optional<VfioEnabledType>;
+
+  /// Gets the BufferPartition parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getBufferPartition() const -> boost::optional<BufferPartitionType>;
+
+  /// Gets the ConfigurationProgram parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getConfigurationProgram() const -> boost::optional<ConfigurationProgramType>;
+
+  /// Gets the ArrivalNotificationEnabled parameter
+  /// \return The value wrapped in an optional if it is present, or an empty optional if it was not
+  auto getArrivalNotificationEnabled() const -> boost::optional<ArrivalNotificationEnabledType>;
+
   // Throwing getters
 
   /// Gets the AllowRejection parameter
@@ -504,6 +733,76 @@ class Parameters
   /// \return The value
   auto getTriggerWindowSizeRequired() const -> TriggerWindowSizeType;
 
+  /// Gets the OrderedDeliveryEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getOrderedDeliveryEnabledRequired() const -> OrderedDeliveryEnabledType;
+
+  /// Gets the OrderedDeliveryWindow parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getOrderedDeliveryWindowRequired() const -> OrderedDeliveryWindowType;
+
+  /// Gets the OrderedDeliveryTimeout parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getOrderedDeliveryTimeoutRequired() const -> OrderedDeliveryTimeoutType;
+
+  /// Gets the SuperpageTrackingEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getSuperpageTrackingEnabledRequired() const -> SuperpageTrackingEnabledType;
+
+  /// Gets the SuperpageTrackingThreshold parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getSuperpageTrackingThresholdRequired() const -> SuperpageTrackingThresholdType;
+
+  /// Gets the LatencyMeasurementEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLatencyMeasurementEnabledRequired() const -> LatencyMeasurementEnabledType;
+
+  /// Gets the AdoptDmaEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getAdoptDmaEnabledRequired() const -> AdoptDmaEnabledType;
+
+  /// Gets the LinkLivenessEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkLivenessEnabledRequired() const -> LinkLivenessEnabledType;
+
+  /// Gets the LinkLivenessTimeout parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getLinkLivenessTimeoutRequired() const -> LinkLivenessTimeoutType;
+
+  /// Gets the RateWeightedDistributionEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getRateWeightedDistributionEnabledRequired() const -> RateWeightedDistributionEnabledType;
+
+  /// Gets the VfioEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getVfioEnabledRequired() const -> VfioEnabledType;
+
+  /// Gets the BufferPartition parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getBufferPartitionRequired() const -> BufferPartitionType;
+
+  /// Gets the ConfigurationProgram parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getConfigurationProgramRequired() const -> ConfigurationProgramType;
+
+  /// Gets the ArrivalNotificationEnabled parameter
+  /// \exception ParameterException The parameter was not present
+  /// \return The value
+  auto getArrivalNotificationEnabledRequired() const -> ArrivalNotificationEnabledType;
+
   // Helper functions
 
   /// Convenience function to make a Parameters object with card ID and channel number, since these are the most
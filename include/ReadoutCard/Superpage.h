@@ -17,6 +17,7 @@
 #ifndef ALICEO2_INCLUDE_READOUTCARD_SUPERPAGE_H_
 #define ALICEO2_INCLUDE_READOUTCARD_SUPERPAGE_H_
 
+#include <chrono>
 #include <cstddef>
 
 namespace AliceO2
@@ -71,6 +72,13 @@ struct Superpage {
     return mUserData;
   }
 
+  /// Time from the card's generation of the first data in the superpage to its arrival on the host, relative to the
+  /// fastest superpage of the channel. Negative if latency measurement is not enabled.
+  std::chrono::nanoseconds getLatency() const
+  {
+    return mLatency;
+  }
+
   /// Set the ready flag
   void setReady(bool ready)
   {
@@ -101,12 +109,19 @@ struct Superpage {
     mUserData = userData;
   }
 
+  /// Set the card-to-host latency
+  void setLatency(std::chrono::nanoseconds latency)
+  {
+    mLatency = latency;
+  }
+
  private:
-  size_t mOffset = 0;        ///< Offset from the start of the DMA buffer to the start of the superpage
-  size_t mSize = 0;          ///< Size of the superpage in bytes
-  void* mUserData = nullptr; ///< Pointer that users can use for whatever, e.g. to associate data with the superpage
-  size_t mReceived = 0;      ///< Size of the received data in bytes
-  bool mReady = false;       ///< Indicates this superpage is ready
+  size_t mOffset = 0;                      ///< Offset from the start of the DMA buffer to the start of the superpage
+  size_t mSize = 0;                        ///< Size of the superpage in bytes
+  void* mUserData = nullptr;               ///< Pointer that users can use for whatever, e.g. to associate data with the superpage
+  size_t mReceived = 0;                    ///< Size of the received data in bytes
+  bool mReady = false;                     ///< Indicates this superpage is ready
+  std::chrono::nanoseconds mLatency{ -1 }; ///< Card-to-host latency, negative if not measured
 };
 
 } // namespace roc
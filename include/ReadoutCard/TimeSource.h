@@ -0,0 +1,185 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TimeSource.h
+/// \brief Definition of the TimeSource classes
+
+#ifndef ALICEO2_INCLUDE_READOUTCARD_TIMESOURCE_H_
+#define ALICEO2_INCLUDE_READOUTCARD_TIMESOURCE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Clock and sleep of the timeouts and waits of the configuration, reset and locking paths, e.g. Cru::waitForBit(), the
+/// I2C and TTC sequences, the C-RORC DDL commands and Interprocess::Lock.
+/// The process uses the SteadyTimeSource unless another one is installed with a ScopedTimeSource, e.g. a
+/// VirtualTimeSource by a test, to run a sequence that waits for seconds in no time. A ScopedThreadTimeSource installs
+/// one for a single thread, over the one of the process.
+/// The DMA hot paths do not use it.
+class TimeSource
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  virtual ~TimeSource() = default;
+
+  virtual TimePoint now() = 0;
+
+  virtual void sleepFor(std::chrono::nanoseconds duration) = 0;
+
+  /// Gets the time source of the process
+  static TimeSource& get();
+
+ private:
+  friend class ScopedTimeSource;
+  friend class ScopedThreadTimeSource;
+
+  static std::atomic<TimeSource*>& getInstalled()
+  {
+    static std::atomic<TimeSource*> installed{ nullptr };
+    return installed;
+  }
+
+  static TimeSource*& getThreadInstalled()
+  {
+    static thread_local TimeSource* installed = nullptr;
+    return installed;
+  }
+};
+
+/// The real time: std::chrono::steady_clock and std::this_thread::sleep_for()
+class SteadyTimeSource : public TimeSource
+{
+ public:
+  virtual TimePoint now() override
+  {
+    return Clock::now();
+  }
+
+  virtual void sleepFor(std::chrono::nanoseconds duration) override
+  {
+    std::this_thread::sleep_for(duration);
+  }
+};
+
+/// A simulated time, which only passes when it is advanced. A sleep advances it by the sleep time, and every read by a
+/// small step, so that loops polling until a timeout (without sleeping) also end.
+class VirtualTimeSource : public TimeSource
+{
+ public:
+  /// \param readStep Time that passes with every read
+  explicit VirtualTimeSource(std::chrono::nanoseconds readStep = std::chrono::microseconds(1))
+    : mReadStep(readStep.count())
+  {
+  }
+
+  virtual TimePoint now() override
+  {
+    return TimePoint(std::chrono::nanoseconds(mTime.fetch_add(mReadStep) + mReadStep));
+  }
+
+  virtual void sleepFor(std::chrono::nanoseconds duration) override
+  {
+    if (duration.count() > 0) {
+      mTime.fetch_add(duration.count());
+      mSlept.fetch_add(duration.count());
+    }
+  }
+
+  void advance(std::chrono::nanoseconds duration)
+  {
+    mTime.fetch_add(duration.count());
+  }
+
+  /// Time passed since the construction, by reads, sleeps and advances
+  std::chrono::nanoseconds getElapsed() const
+  {
+    return std::chrono::nanoseconds(mTime.load());
+  }
+
+  /// Time passed in sleeps
+  std::chrono::nanoseconds getSlept() const
+  {
+    return std::chrono::nanoseconds(mSlept.load());
+  }
+
+ private:
+  const int64_t mReadStep;
+  std::atomic<int64_t> mTime{ 0 };
+  std::atomic<int64_t> mSlept{ 0 };
+};
+
+/// Installs a time source for the process for the lifetime of the object, and restores the previous one after.
+/// Not meant to be used while other threads are in the paths using the time source.
+class ScopedTimeSource
+{
+ public:
+  explicit ScopedTimeSource(TimeSource& timeSource)
+    : mPrevious(TimeSource::getInstalled().exchange(&timeSource))
+  {
+  }
+
+  ~ScopedTimeSource()
+  {
+    TimeSource::getInstalled().store(mPrevious);
+  }
+
+  ScopedTimeSource(const ScopedTimeSource&) = delete;
+  ScopedTimeSource& operator=(const ScopedTimeSource&) = delete;
+
+ private:
+  TimeSource* mPrevious;
+};
+
+/// Installs a time source for the calling thread for the lifetime of the object, and restores the previous one after.
+/// The other threads keep the time source of the process.
+class ScopedThreadTimeSource
+{
+ public:
+  explicit ScopedThreadTimeSource(TimeSource& timeSource)
+    : mPrevious(TimeSource::getThreadInstalled())
+  {
+    TimeSource::getThreadInstalled() = &timeSource;
+  }
+
+  ~ScopedThreadTimeSource()
+  {
+    TimeSource::getThreadInstalled() = mPrevious;
+  }
+
+  ScopedThreadTimeSource(const ScopedThreadTimeSource&) = delete;
+  ScopedThreadTimeSource& operator=(const ScopedThreadTimeSource&) = delete;
+
+ private:
+  TimeSource* mPrevious;
+};
+
+inline TimeSource& TimeSource::get()
+{
+  static SteadyTimeSource steady;
+  if (auto thread = getThreadInstalled()) {
+    return *thread;
+  }
+  auto installed = getInstalled().load();
+  return installed ? *installed : steady;
+}
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_INCLUDE_READOUTCARD_TIMESOURCE_H_
@@ -0,0 +1,124 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ArrivalNotifier.cxx
+/// \brief Implementation of the ArrivalNotifier classes.
+
+#include "ArrivalNotifier.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace bfs = boost::filesystem;
+namespace
+{
+
+std::string errorString(const std::string& message)
+{
+  return message + ": " + std::strerror(errno);
+}
+
+/// Finds the UIO device of a card, e.g. "/dev/uio3", from sysfs
+std::string findUioDevice(const PciAddress& address)
+{
+  auto directory = bfs::path("/sys/bus/pci/devices") / ("0000:" + address.toString()) / "uio";
+  boost::system::error_code error;
+  for (bfs::directory_iterator iter(directory, error), end; !error && iter != end; iter.increment(error)) {
+    return "/dev/" + iter->path().filename().string();
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Card has no UIO device")
+                                    << ErrorInfo::PciAddress(address)
+                                    << ErrorInfo::PossibleCauses({ "Card is not bound to the uio_pci_dma driver",
+                                                                   "Card is accessed through VFIO" }));
+}
+
+} // Anonymous namespace
+
+EventFdNotifier::EventFdNotifier() : mFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+  if (mFd < 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to create eventfd")));
+  }
+}
+
+EventFdNotifier::~EventFdNotifier()
+{
+  close(mFd);
+}
+
+uint64_t EventFdNotifier::acknowledge()
+{
+  // Reading gives the counter and resets it, or fails with EAGAIN if it is zero
+  uint64_t count = 0;
+  if (read(mFd, &count, sizeof(count)) != sizeof(count)) {
+    return 0;
+  }
+  return count;
+}
+
+void EventFdNotifier::signal()
+{
+  uint64_t one = 1;
+  // Only fails if the counter would overflow, in which case the descriptor is readable anyway
+  (void)!write(mFd, &one, sizeof(one));
+}
+
+UioNotifier::UioNotifier(const PciAddress& address)
+{
+  auto device = findUioDevice(address);
+  mFd = open(device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (mFd < 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to open UIO device"))
+                                      << ErrorInfo::FileName(device)
+                                      << ErrorInfo::PciAddress(address));
+  }
+  enableInterrupt();
+}
+
+UioNotifier::~UioNotifier()
+{
+  close(mFd);
+}
+
+uint64_t UioNotifier::acknowledge()
+{
+  // Reading gives the total interrupt count, or fails with EAGAIN if there was no interrupt since the last read
+  uint32_t count = 0;
+  if (read(mFd, &count, sizeof(count)) != sizeof(count)) {
+    return 0;
+  }
+  uint32_t notifications = count - mCount;
+  mCount = count;
+  enableInterrupt();
+  return notifications;
+}
+
+void UioNotifier::enableInterrupt()
+{
+  if (!mIrqControl) {
+    return;
+  }
+  uint32_t one = 1;
+  if (write(mFd, &one, sizeof(one)) != sizeof(one)) {
+    // The driver does not mask the interrupt, so there is nothing to re-enable
+    mIrqControl = false;
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
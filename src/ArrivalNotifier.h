@@ -0,0 +1,97 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ArrivalNotifier.h
+/// \brief Definition of the ArrivalNotifier classes.
+
+#ifndef ALICEO2_READOUTCARD_SRC_ARRIVALNOTIFIER_H_
+#define ALICEO2_READOUTCARD_SRC_ARRIVALNOTIFIER_H_
+
+#include <cstdint>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// A file descriptor that becomes readable when superpages may have arrived, which a consumer waits on with poll() or
+/// epoll instead of polling the channel. See DmaChannelInterface::getArrivalNotificationFd().
+class ArrivalNotifier
+{
+ public:
+  virtual ~ArrivalNotifier() = default;
+
+  /// Gets the file descriptor to wait on. It stays owned by the notifier.
+  virtual int getFd() const = 0;
+
+  /// Clears the pending notifications and rearms the notifier. The channel calls it before it looks for arrivals, so
+  /// that an arrival after the look leaves the descriptor readable.
+  /// \return The number of notifications since the last acknowledgement
+  virtual uint64_t acknowledge() = 0;
+};
+
+/// Notifier on an eventfd, which is signalled by software, like the Dummy channel does, or by the kernel, like VFIO does
+/// for an MSI.
+class EventFdNotifier final : public ArrivalNotifier
+{
+ public:
+  EventFdNotifier();
+  ~EventFdNotifier();
+
+  EventFdNotifier(const EventFdNotifier&) = delete;
+  EventFdNotifier& operator=(const EventFdNotifier&) = delete;
+
+  virtual int getFd() const override
+  {
+    return mFd;
+  }
+
+  virtual uint64_t acknowledge() override;
+
+  /// Makes the descriptor readable
+  void signal();
+
+ private:
+  int mFd;
+};
+
+/// Notifier on the interrupt of a card bound to a UIO driver, like uio_pci_dma. Reading the UIO device gives the total
+/// interrupt count, and writing 1 to it re-enables the interrupt, if the driver masks it on delivery.
+class UioNotifier final : public ArrivalNotifier
+{
+ public:
+  /// \exception Exception The card has no UIO device
+  explicit UioNotifier(const PciAddress& address);
+  ~UioNotifier();
+
+  UioNotifier(const UioNotifier&) = delete;
+  UioNotifier& operator=(const UioNotifier&) = delete;
+
+  virtual int getFd() const override
+  {
+    return mFd;
+  }
+
+  virtual uint64_t acknowledge() override;
+
+ private:
+  /// Re-enables the interrupt, if the driver supports it
+  void enableInterrupt();
+
+  int mFd;
+  uint32_t mCount = 0;
+  bool mIrqControl = true;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_ARRIVALNOTIFIER_H_
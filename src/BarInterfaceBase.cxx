@@ -15,6 +15,7 @@
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
 #include "BarInterfaceBase.h"
+#include "ExceptionInternal.h"
 #include "Utilities/SmartPointer.h"
 
 namespace AliceO2
@@ -26,6 +27,17 @@ BarInterfaceBase::BarInterfaceBase(const Parameters& parameters)
   : mBarIndex(parameters.getChannelNumberRequired())
 {
   auto id = parameters.getCardIdRequired();
+  if (parameters.getVfioEnabled().get_value_or(false)) {
+    auto address = boost::get<PciAddress>(&id);
+    if (!address) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("VFIO requires the card to be identified by its PCI address")
+                                                 << ErrorInfo::CardId(id));
+    }
+    mVfioDevice = Vfio::VfioDevice::get(*address);
+    mPdaBar = std::make_shared<Pda::PdaBar>(mVfioDevice, mBarIndex);
+    return;
+  }
+
   if (auto serial = boost::get<int>(&id)) {
     Utilities::resetSmartPtr(mRocPciDevice, *serial);
   } else if (auto address = boost::get<PciAddress>(&id)) {
@@ -65,7 +77,8 @@ void BarInterfaceBase::modifyRegister(int index, int position, int width, uint32
 void BarInterfaceBase::log(std::string logMessage, InfoLogger::InfoLogger::Severity logLevel)
 {
   mLogger << logLevel;
-  mLogger << "[PCI ID: " << mRocPciDevice->getPciAddress().toString() << " | bar" << getIndex() << "] : " << logMessage << InfoLogger::InfoLogger::endm;
+  auto pciAddress = mVfioDevice ? mVfioDevice->getPciAddress() : mRocPciDevice->getPciAddress();
+  mLogger << "[PCI ID: " << pciAddress.toString() << " | bar" << getIndex() << "] : " << logMessage << InfoLogger::InfoLogger::endm;
 }
 
 } // namespace roc
@@ -24,6 +24,7 @@
 #include "Pda/PdaBar.h"
 #include "ReadoutCard/BarInterface.h"
 #include "ReadoutCard/Parameters.h"
+#include "Vfio/VfioDevice.h"
 
 namespace AliceO2
 {
@@ -135,6 +136,9 @@ class BarInterfaceBase : public BarInterface
   /// PDA device objects
   std::unique_ptr<RocPciDevice> mRocPciDevice;
 
+  /// VFIO device, instead of the PDA device objects if VFIO is enabled
+  std::shared_ptr<Vfio::VfioDevice> mVfioDevice;
+
   /// PDA BAR object ptr
   std::shared_ptr<Pda::PdaBar> mPdaBar;
 
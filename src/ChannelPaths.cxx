@@ -25,6 +25,7 @@ namespace roc
 namespace
 {
 static const char* DIR_SHAREDMEM = "/dev/shm/";
+static const char* DIR_TMP = "/tmp/";
 static const char* FORMAT = "%s/AliceO2_RoC_%s_Channel_%i%s";
 } // namespace
 
@@ -47,6 +48,21 @@ std::string ChannelPaths::fifo() const
   return makePath("_fifo", DIR_SHAREDMEM);
 }
 
+std::string ChannelPaths::flightRecorder(int index) const
+{
+  return makePath(b::str(b::format("_flight_recorder_%i.csv") % index), DIR_TMP);
+}
+
+std::string ChannelPaths::superpageTrace(int index) const
+{
+  return makePath(b::str(b::format("_superpage_trace_%i.json") % index), DIR_TMP);
+}
+
+std::string ChannelPaths::handover() const
+{
+  return makePath("_handover", DIR_SHAREDMEM);
+}
+
 std::string ChannelPaths::namedMutex() const
 {
   return b::str(b::format("AliceO2_RoC_%s_Channel_%i_Mutex") % mPciAddress.toString() % mChannel);
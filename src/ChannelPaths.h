@@ -45,6 +45,20 @@ class ChannelPaths
   /// \return The name
   std::string namedMutex() const;
 
+  /// Generates a path for a dump of the channel's flight recorder
+  /// \param index Index of the dump, to keep several of them
+  /// \return The path
+  std::string flightRecorder(int index) const;
+
+  /// Generates a path for a dump of the channel's superpage lifecycle trace
+  /// \param index Index of the dump, to keep several of them
+  /// \return The path
+  std::string superpageTrace(int index) const;
+
+  /// Generates a path for the state of a running DMA, handed over to a successor process. It will be in shared memory.
+  /// \return The path
+  std::string handover() const;
+
  private:
   std::string makePath(std::string fileName, const char* directory) const;
 
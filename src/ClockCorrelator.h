@@ -0,0 +1,173 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ClockCorrelator.h
+/// \brief Definition of the ClockCorrelator class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_CLOCKCORRELATOR_H_
+#define ALICEO2_READOUTCARD_SRC_CLOCKCORRELATOR_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Relates the card's LHC clock (orbit and bunch crossing, as stamped in the RDH) to the host's monotonic clock, to
+/// measure how long data took from the card to the host.
+/// Every sample pairs the orbit/BC of some data with the host time at which it was seen. The difference of the two
+/// clocks is the clock offset plus the latency of that sample. The lowest difference of an epoch approximates the
+/// offset (plus the minimum latency), and the change of that minimum across epochs gives the drift of the card clock
+/// against the host clock.
+/// The latencies are therefore relative to the fastest sample, which is what queueing delays and stalls show up in.
+/// A jump of the card clock (e.g. an orbit counter reset at the start of a run) restarts the correlation.
+class ClockCorrelator
+{
+ public:
+  /// Bunch crossings per LHC orbit
+  static constexpr int64_t BCS_PER_ORBIT = 3564;
+
+  /// Period of the LHC bunch crossing clock (40.079 MHz)
+  static constexpr double BC_NS = 1e3 / 40.079;
+
+  /// A clock difference changing by more than this is a jump of the card clock, not latency
+  static constexpr std::chrono::seconds RESYNC_THRESHOLD{ 10 };
+
+  /// \param epoch Duration over which the minimum clock difference is collected
+  explicit ClockCorrelator(std::chrono::nanoseconds epoch = std::chrono::seconds(1)) : mEpoch(epoch.count())
+  {
+  }
+
+  /// Forgets the correlation
+  void reset()
+  {
+    mHasSample = false;
+    mHasAnchor = false;
+    mHasDrift = false;
+    mDrift = 0;
+  }
+
+  /// Adds a sample and returns its latency
+  /// \param orbit Orbit counter of the data
+  /// \param bc Bunch crossing of the data
+  /// \param hostNs Host time at which the data was seen, in ns of the monotonic clock
+  std::chrono::nanoseconds addSample(uint32_t orbit, uint32_t bc, int64_t hostNs)
+  {
+    if (!mHasSample) {
+      startCorrelation(orbit, hostNs);
+    }
+
+    // Unwrap the 32-bit orbit counter. Samples may come slightly out of order from different links.
+    mOrbits += static_cast<int32_t>(orbit - mLastOrbit);
+    mLastOrbit = orbit;
+    const double cardNs = (mOrbits * BCS_PER_ORBIT + bc) * BC_NS;
+    const double difference = hostNs - cardNs;
+
+    if (mHasAnchor) {
+      const double latency = difference - predictOffset(cardNs);
+      if (std::abs(latency) > std::chrono::duration<double, std::nano>(RESYNC_THRESHOLD).count()) {
+        mResyncs++;
+        startCorrelation(orbit, hostNs);
+        return addSample(orbit, bc, hostNs);
+      }
+    }
+
+    if ((hostNs - mEpochStart) >= mEpoch) {
+      closeEpoch();
+      mEpochStart = hostNs;
+      mEpochMin = difference;
+      mEpochMinCardNs = cardNs;
+    } else if (difference < mEpochMin) {
+      mEpochMin = difference;
+      mEpochMinCardNs = cardNs;
+    }
+
+    // Use the current epoch's minimum if it is below the prediction, so a latency never goes negative
+    const double epochOffset = mEpochMin + mDrift * (cardNs - mEpochMinCardNs);
+    const double offset = mHasAnchor ? std::min(predictOffset(cardNs), epochOffset) : epochOffset;
+    return std::chrono::nanoseconds(static_cast<int64_t>(std::max(0.0, difference - offset)));
+  }
+
+  /// Is an offset estimate from a completed epoch available
+  bool isSynchronized() const
+  {
+    return mHasAnchor;
+  }
+
+  /// Drift of the card clock against the host clock, in parts per million. Positive if the card clock is slower.
+  double getDriftPpm() const
+  {
+    return mDrift * 1e6;
+  }
+
+  /// Amount of times the card clock jumped and the correlation was restarted
+  uint64_t getResyncCount() const
+  {
+    return mResyncs;
+  }
+
+ private:
+  void startCorrelation(uint32_t orbit, int64_t hostNs)
+  {
+    mHasSample = true;
+    mHasAnchor = false;
+    mHasDrift = false;
+    mDrift = 0;
+    mOrbits = 0;
+    mLastOrbit = orbit;
+    mEpochStart = hostNs;
+    mEpochMin = std::numeric_limits<double>::max();
+    mEpochMinCardNs = 0;
+  }
+
+  void closeEpoch()
+  {
+    if (mHasAnchor && mEpochMinCardNs != mAnchorCardNs) {
+      const double drift = (mEpochMin - mAnchorOffset) / (mEpochMinCardNs - mAnchorCardNs);
+      mDrift = mHasDrift ? (DRIFT_SMOOTHING * drift + (1 - DRIFT_SMOOTHING) * mDrift) : drift;
+      mHasDrift = true;
+    }
+    mAnchorOffset = mEpochMin;
+    mAnchorCardNs = mEpochMinCardNs;
+    mHasAnchor = true;
+  }
+
+  double predictOffset(double cardNs) const
+  {
+    return mAnchorOffset + mDrift * (cardNs - mAnchorCardNs);
+  }
+
+  /// Weight of a new epoch's drift in the drift estimate
+  static constexpr double DRIFT_SMOOTHING = 0.25;
+
+  int64_t mEpoch;
+  bool mHasSample = false;
+  bool mHasAnchor = false;
+  bool mHasDrift = false;
+  uint32_t mLastOrbit = 0;
+  int64_t mOrbits = 0;
+  int64_t mEpochStart = 0;
+  double mEpochMin = 0;
+  double mEpochMinCardNs = 0;
+  double mAnchorOffset = 0;
+  double mAnchorCardNs = 0;
+  double mDrift = 0;
+  uint64_t mResyncs = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_CLOCKCORRELATOR_H_
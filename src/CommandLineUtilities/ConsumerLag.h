@@ -0,0 +1,178 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ConsumerLag.h
+/// \brief Definition of the ConsumerLag class.
+
+#ifndef ALICEO2_READOUTCARD_CONSUMERLAG_H
+#define ALICEO2_READOUTCARD_CONSUMERLAG_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include "ExceptionInternal.h"
+#include "Utilities/PerfCounters.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace CommandLineUtilities
+{
+
+/// This class measures how the cost of processing freshly DMA'd data grows with the time between its completion and
+/// its consumption. With DDIO the card writes into a part of the LLC, from which the data is evicted if the consumer
+/// lags behind, so it has to come from memory instead.
+/// The readout thread holds every superpage back until it is as old as the delay of the current step, then touches all
+/// its data, timing it and counting the LLC misses. The queue of held superpages grows with the delay, so the steps
+/// also give the ready queue depth a consumer can have before the data falls out of the cache.
+/// The class is used by the readout thread only.
+class ConsumerLag
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Measurements of a delay step
+  struct Step {
+    std::chrono::microseconds delay;
+    uint64_t superpages = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;     ///< Time spent touching the data
+    uint64_t llcMisses = 0; ///< LLC misses while touching the data
+    uint64_t depthSum = 0;  ///< Sum of the held superpages at each consumption, for the mean
+    size_t maxDepth = 0;
+  };
+
+  /// Parses a comma separated list of delays in microseconds, e.g. "0,100,1000"
+  static std::vector<std::chrono::microseconds> parseDelays(const std::string& string)
+  {
+    std::vector<std::chrono::microseconds> delays;
+    std::vector<std::string> items;
+    boost::split(items, string, boost::is_any_of(","));
+    for (auto item : items) {
+      boost::trim(item);
+      uint64_t delay;
+      // The conversion takes a negative number for a huge one
+      if (item.find('-') != std::string::npos || !boost::conversion::try_lexical_convert<uint64_t>(item, delay)) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Malformed consumer lag list '" + string + "'"));
+      }
+      delays.emplace_back(delay);
+    }
+    return delays;
+  }
+
+  /// \param delays Delay of every step
+  /// \param superpagesPerStep Superpages to consume in every step
+  ConsumerLag(const std::vector<std::chrono::microseconds>& delays, uint64_t superpagesPerStep)
+    : mSuperpagesPerStep(superpagesPerStep), mCounters(std::make_unique<Utilities::PerfCounters>())
+  {
+    for (auto delay : delays) {
+      Step step;
+      step.delay = delay;
+      mSteps.push_back(step);
+    }
+  }
+
+  /// Holds a superpage that just arrived
+  void hold(size_t bufferOffset, size_t effectiveSize, Clock::time_point arrival)
+  {
+    mHeld.push_back({ bufferOffset, effectiveSize, arrival });
+  }
+
+  /// Takes the oldest held superpage, if it is as old as the delay of the current step
+  /// \return True if a superpage was taken
+  bool take(size_t& bufferOffset, size_t& effectiveSize, Clock::time_point now)
+  {
+    if (isDone() || mHeld.empty() || now - mHeld.front().arrival < mSteps[mStep].delay) {
+      return false;
+    }
+    bufferOffset = mHeld.front().bufferOffset;
+    effectiveSize = mHeld.front().effectiveSize;
+    mDepth = mHeld.size();
+    mHeld.pop_front();
+    return true;
+  }
+
+  /// Touches the data of the superpage just taken, and moves to the next step when the current one is complete
+  void process(uintptr_t address, size_t bytes)
+  {
+    auto& step = mSteps[mStep];
+    auto countsBefore = mCounters->read();
+    auto start = Clock::now();
+    mSink += touch(address, bytes);
+    auto end = Clock::now();
+    auto counts = mCounters->read() - countsBefore;
+
+    step.superpages++;
+    step.bytes += bytes;
+    step.seconds += std::chrono::duration<double>(end - start).count();
+    step.llcMisses += counts[Utilities::PerfEvent::LlcMisses];
+    step.depthSum += mDepth;
+    step.maxDepth = std::max(step.maxDepth, mDepth);
+    if (step.superpages >= mSuperpagesPerStep) {
+      mStep++;
+    }
+  }
+
+  /// All steps are complete
+  bool isDone() const
+  {
+    return mStep >= mSteps.size();
+  }
+
+  bool isLlcMissesAvailable() const
+  {
+    return mCounters->isAvailable(Utilities::PerfEvent::LlcMisses);
+  }
+
+  const std::vector<Step>& getSteps() const
+  {
+    return mSteps;
+  }
+
+ private:
+  struct Held {
+    size_t bufferOffset;
+    size_t effectiveSize;
+    Clock::time_point arrival;
+  };
+
+  /// Reads every word, like the simplest consumer would
+  static uint64_t touch(uintptr_t address, size_t bytes)
+  {
+    auto words = reinterpret_cast<const volatile uint64_t*>(address);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bytes / sizeof(uint64_t); ++i) {
+      sum += words[i];
+    }
+    return sum;
+  }
+
+  uint64_t mSuperpagesPerStep;
+  std::unique_ptr<Utilities::PerfCounters> mCounters;
+  std::vector<Step> mSteps;
+  size_t mStep = 0;
+  std::deque<Held> mHeld;
+  size_t mDepth = 0;
+  uint64_t mSink = 0; ///< Keeps the touch from being optimized away
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_CONSUMERLAG_H
@@ -0,0 +1,121 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DdgCheck.h
+/// \brief Definition of the DdgCheck struct.
+
+#ifndef ALICEO2_READOUTCARD_DDGCHECK_H
+#define ALICEO2_READOUTCARD_DDGCHECK_H
+
+#include <cstdint>
+#include <limits>
+#include "DataFormat.h"
+#include "ErrorRecorder.h"
+#include "Utilities/Util.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace CommandLineUtilities
+{
+
+/// The error check of the pages of the CRU's data generator (DDG): the RDH memory size, the packet counter against the
+/// previous checked page of the link, the time frame alignment and, unless the check is fast, the payload pattern.
+/// roc-bench-dma checks its pages with it, and roc-bench-hotpath runs it as its training workload.
+struct DdgCheck {
+  /// Value of a link's counters to resynchronize them on its next page
+  static constexpr uint32_t COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
+
+  /// Pages of a link from one checked page to the next
+  uint64_t errorCheckFrequency = 1;
+
+  /// The packet counter wraps after this value
+  uint64_t maxPacketCounter = 255;
+
+  /// Skips the payload
+  bool fast = false;
+
+  /// Checks a page
+  /// \param packetCounter Packet counter of the link's previous checked page, updated
+  /// \param dataCounter Data generator counter of the link, updated
+  /// \param eventCounter Pages of the link, recorded with the packet counter errors
+  /// \param record Called as record(ErrorType::type, counter, index, expected, actual, size) for every error and
+  ///   resynchronization, with the fields as described at ErrorRecord
+  /// \return True if the page has an error
+  template <typename Counter, typename Record>
+  bool checkPage(const char* page, size_t pageSize, bool atStartOfSuperpage, Counter& packetCounter,
+                 Counter& dataCounter, uint32_t eventCounter, Record&& record) const
+  {
+    // Memory size [RDH, Payload]
+    const uint32_t memBytes = DataFormat::getMemsize(page);
+    if (memBytes < 0x40 || memBytes > pageSize) {
+      record(ErrorType::RdhSizeRange, 0, 0, pageSize, memBytes, 0);
+      return true;
+    }
+
+    const uint32_t pagePacketCounter = DataFormat::getPacketCounter(page);
+    if (packetCounter == COUNTER_INITIAL_VALUE) {
+      record(ErrorType::ResyncPacket, eventCounter, 0, 0, pagePacketCounter, 0);
+      packetCounter = pagePacketCounter;
+    } else if (((packetCounter + errorCheckFrequency) % (maxPacketCounter + 1)) != pagePacketCounter) {
+      record(ErrorType::PacketCounter, eventCounter, 0, uint32_t(packetCounter), pagePacketCounter, memBytes);
+      return true;
+    } else {
+      packetCounter = pagePacketCounter;
+    }
+
+    // The time frame starts at the beginning of the superpage
+    if (Utilities::getBit(DataFormat::getTriggerType(page), 11) == 0x1 && DataFormat::getPagesCounter(page) == 0x0 &&
+        !atStartOfSuperpage) {
+      record(ErrorType::TfUnaligned, eventCounter, 0, 0, pagePacketCounter, memBytes);
+    }
+
+    if (fast) {
+      return false;
+    }
+
+    const auto payload = reinterpret_cast<const volatile uint32_t*>(page + DataFormat::getHeaderSize());
+    const uint32_t payloadBytes = memBytes - DataFormat::getHeaderSize();
+    const uint32_t pageDataCounter = payload[0];
+    if (dataCounter == COUNTER_INITIAL_VALUE) {
+      record(ErrorType::ResyncData, 0, 0, 0, pageDataCounter, 0);
+      dataCounter = pageDataCounter;
+    }
+
+    bool foundError = false;
+    auto checkValue = [&](uint32_t i, uint32_t expectedValue, uint32_t actualValue) {
+      if (expectedValue != actualValue) {
+        foundError = true;
+        record(ErrorType::DataMismatch, pageDataCounter, i, expectedValue, actualValue, payloadBytes);
+      }
+    };
+
+    // Every 256-bit word is built as follows:
+    // 32 bits counter       + 32 bits counter       + 16 lsb counter       + 32 bit 0
+    // 32 bits (counter + 1) + 32 bits (counter + 1) + 16 lsb (counter + 1) + 32 bit 0
+    uint32_t counter = pageDataCounter;
+    for (uint32_t i = 0; (i * 4) < payloadBytes; i += 4) {
+      checkValue(i + 0, counter, payload[i + 0]);          // 32-bit counter
+      checkValue(i + 1, counter, payload[i + 1]);          // 32-bit counter
+      checkValue(i + 2, counter & 0xffff, payload[i + 2]); // 16-lsb truncated counter
+      checkValue(i + 3, 0x0, payload[i + 3]);              // 32-bit 0-padding word
+      counter++;
+    }
+    dataCounter = counter;
+    return foundError;
+  }
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_DDGCHECK_H
@@ -0,0 +1,342 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ErrorRecorder.h
+/// \brief Definition of the ErrorRecorder class.
+
+#ifndef ALICEO2_READOUTCARD_ERRORRECORDER_H
+#define ALICEO2_READOUTCARD_ERRORRECORDER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace CommandLineUtilities
+{
+
+/// Kinds of data verification errors and events
+struct ErrorType {
+  enum type : uint8_t {
+    DataMismatch,     ///< Payload word differs from the expected pattern
+    RdhSizeRange,     ///< RDH memory size out of range
+    PacketCounter,    ///< Unexpected RDH packet counter
+    TfUnaligned,      ///< TimeFrame not at the start of a superpage
+    ResyncData,       ///< Data generator counter resynchronized (not an error)
+    ResyncPacket,     ///< Packet counter resynchronized (not an error)
+    SuperpageSize,    ///< RDH offsets of a superpage add up to more than its size
+    LinkIdRange,      ///< RDH link ID out of range
+    Count
+  };
+
+  static const char* toString(type errorType)
+  {
+    switch (errorType) {
+      case DataMismatch:
+        return "data-mismatch";
+      case RdhSizeRange:
+        return "rdh-size-range";
+      case PacketCounter:
+        return "packet-counter";
+      case TfUnaligned:
+        return "tf-unaligned";
+      case ResyncData:
+        return "resync-data";
+      case ResyncPacket:
+        return "resync-packet";
+      case SuperpageSize:
+        return "superpage-size";
+      case LinkIdRange:
+        return "link-id-range";
+      case Count:
+        break;
+    }
+    return "unknown";
+  }
+
+  static bool isError(type errorType)
+  {
+    return errorType != ResyncData && errorType != ResyncPacket;
+  }
+};
+
+/// Compact binary record of one error. The meaning of the fields depends on the type:
+///   - DataMismatch: counter = generator counter, index = 32-bit word index, size = payload bytes
+///   - RdhSizeRange: expected = page size, actual = RDH memory size
+///   - PacketCounter: expected = previous packet counter, actual = packet counter, counter = link event counter,
+///     size = RDH memory size
+///   - TfUnaligned: actual = packet counter, counter = link event counter, size = RDH memory size
+///   - ResyncData: actual = new data counter
+///   - ResyncPacket: actual = new packet counter, counter = link event counter
+///   - SuperpageSize: expected = superpage size, actual = sum of the RDH offsets, counter = superpage offset
+///   - LinkIdRange: expected = amount of links, actual = link ID
+struct ErrorRecord {
+  int64_t event = 0;
+  uint16_t link = 0;
+  ErrorType::type type = ErrorType::DataMismatch;
+  uint8_t reserved = 0;
+  uint32_t counter = 0;
+  uint32_t index = 0;
+  uint32_t expected = 0;
+  uint32_t actual = 0;
+  uint32_t size = 0;
+  uint32_t repeats = 0; ///< Amount of further errors of the same type in the same page, folded into this record
+  uint32_t reserved2 = 0;
+};
+
+static_assert(sizeof(ErrorRecord) == 40, "ErrorRecord must stay compact and have a stable binary layout");
+
+/// Records data verification errors without formatting them on the readout path.
+/// Errors are stored as fixed-size binary records in a buffer of fixed capacity, so memory use is bounded. Repeated
+/// errors of the same type in the same page are folded into one record with a repeat count, and the amount of new
+/// records per second is limited, so a broken link cannot flood the output. Every error is still counted per type and
+/// link, including those that were folded or dropped.
+/// Records are decoded to text only on request, or written in binary form to be decoded offline.
+class ErrorRecorder
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Identifies the binary error file format
+  static constexpr char MAGIC[8] = { 'R', 'O', 'C', 'E', 'R', 'R', '0', '1' };
+
+  /// \param capacity Maximum amount of records stored
+  /// \param maxRecordsPerSecond Maximum amount of new records stored per second, 0 for no limit
+  ErrorRecorder(size_t capacity = 10000, size_t maxRecordsPerSecond = 0)
+    : mCapacity(capacity), mMaxRecordsPerSecond(maxRecordsPerSecond)
+  {
+    mRecords.reserve(capacity);
+  }
+
+  void record(const ErrorRecord& record)
+  {
+    this->record(record, Clock::now());
+  }
+
+  void record(const ErrorRecord& record, Clock::time_point now)
+  {
+    mCounts[{ record.type, record.link }]++;
+
+    if (!mRecords.empty()) {
+      auto& last = mRecords.back();
+      if (last.type == record.type && last.link == record.link && last.event == record.event) {
+        last.repeats++;
+        return;
+      }
+    }
+
+    if (mRecords.size() >= mCapacity) {
+      mDropped++;
+      return;
+    }
+
+    if (mMaxRecordsPerSecond != 0) {
+      if ((now - mWindowStart) >= std::chrono::seconds(1)) {
+        mWindowStart = now;
+        mWindowRecords = 0;
+      }
+      if (mWindowRecords >= mMaxRecordsPerSecond) {
+        mRateLimited++;
+        return;
+      }
+      mWindowRecords++;
+    }
+
+    mRecords.push_back(record);
+  }
+
+  const std::vector<ErrorRecord>& getRecords() const
+  {
+    return mRecords;
+  }
+
+  /// Amount of occurrences of the given type on the given link, including those not stored
+  uint64_t getCount(ErrorType::type type, uint16_t link) const
+  {
+    auto iterator = mCounts.find({ type, link });
+    return iterator == mCounts.end() ? 0 : iterator->second;
+  }
+
+  /// Amount of records not stored because the buffer was full
+  uint64_t getDroppedCount() const
+  {
+    return mDropped;
+  }
+
+  /// Amount of records not stored because of the rate limit
+  uint64_t getRateLimitedCount() const
+  {
+    return mRateLimited;
+  }
+
+  bool empty() const
+  {
+    return mCounts.empty();
+  }
+
+  /// Writes the counts per type and link, followed by the records, as text
+  void decode(std::ostream& stream) const
+  {
+    decode(stream, mCounts, mRecords, mDropped, mRateLimited);
+  }
+
+  /// Writes the counts and records in binary form, to be decoded offline with readBinary()
+  void writeBinary(std::ostream& stream) const
+  {
+    FileHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.recordSize = sizeof(ErrorRecord);
+    header.countEntries = mCounts.size();
+    header.records = mRecords.size();
+    header.dropped = mDropped;
+    header.rateLimited = mRateLimited;
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& pair : mCounts) {
+      CountEntry entry;
+      entry.type = pair.first.first;
+      entry.link = pair.first.second;
+      entry.count = pair.second;
+      stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    stream.write(reinterpret_cast<const char*>(mRecords.data()), mRecords.size() * sizeof(ErrorRecord));
+  }
+
+  /// Reads a binary error file and writes it as text
+  static void decodeBinary(std::istream& input, std::ostream& output)
+  {
+    FileHeader header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!input || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.recordSize != sizeof(ErrorRecord)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Not a binary error file, or an incompatible version"));
+    }
+
+    Counts counts;
+    for (uint64_t i = 0; i < header.countEntries; ++i) {
+      CountEntry entry;
+      input.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+      counts[{ ErrorType::type(entry.type), entry.link }] = entry.count;
+    }
+    std::vector<ErrorRecord> records(header.records);
+    input.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ErrorRecord));
+    if (!input) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Binary error file is truncated"));
+    }
+    decode(output, counts, records, header.dropped, header.rateLimited);
+  }
+
+  /// Writes one record as a line of text
+  static void decodeRecord(std::ostream& stream, const ErrorRecord& r)
+  {
+    switch (r.type) {
+      case ErrorType::DataMismatch:
+        stream << boost::format("[ERROR]\tevent:%d link:%d cnt:%x payloadBytes:%d i:%d exp:%x val:%x") % r.event %
+                    r.link % r.counter % r.size % r.index % r.expected % r.actual;
+        break;
+      case ErrorType::RdhSizeRange:
+        stream << boost::format("[RDHERR]\tevent:%d l:%d payloadBytes:%d size:%d words out of range") % r.event %
+                    r.link % r.actual % r.expected;
+        break;
+      case ErrorType::PacketCounter:
+        stream << boost::format("[RDHERR]\tevent:%d l:%d payloadBytes:%d packet_cnt:%d mpacket_cnt:%d levent:%d "
+                                "unexpected packet counter") %
+                    r.event % r.link % r.size % r.actual % r.expected % r.counter;
+        break;
+      case ErrorType::TfUnaligned:
+        stream << boost::format("[RDHERR]\tevent:%d l:%d payloadBytes:%d packet_cnt:%d levent:%d TF unaligned w/ start "
+                                "of superpage") %
+                    r.event % r.link % r.size % r.actual % r.counter;
+        break;
+      case ErrorType::ResyncData:
+        stream << boost::format("resync counter for e:%d l:%d cnt:%x") % r.event % r.link % r.actual;
+        break;
+      case ErrorType::ResyncPacket:
+        stream << boost::format("resync packet counter for e:%d l:%d packet_cnt:%x le:%d") % r.event % r.link %
+                    r.actual % r.counter;
+        break;
+      case ErrorType::SuperpageSize:
+        stream << boost::format("[RDHERR]\tevent:%d offset:%d readoutBytes:%d superpageSize:%d RDH offsets exceed the "
+                                "superpage size") %
+                    r.event % r.counter % r.actual % r.expected;
+        break;
+      case ErrorType::LinkIdRange:
+        stream << boost::format("[RDHERR]\tevent:%d link_id:%d links:%d link ID out of range") % r.event % r.actual %
+                    r.expected;
+        break;
+      default:
+        stream << boost::format("[UNKNOWN]\ttype:%d event:%d l:%d") % int(r.type) % r.event % r.link;
+        break;
+    }
+    if (r.repeats > 0) {
+      stream << " (+" << r.repeats << " more in this page)";
+    }
+    stream << '\n';
+  }
+
+ private:
+  using Counts = std::map<std::pair<ErrorType::type, uint16_t>, uint64_t>;
+
+  struct FileHeader {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t reserved = 0;
+    uint64_t countEntries;
+    uint64_t records;
+    uint64_t dropped;
+    uint64_t rateLimited;
+  };
+
+  struct CountEntry {
+    uint64_t count;
+    uint16_t link;
+    uint8_t type;
+    uint8_t reserved[5] = {};
+  };
+
+  static void decode(std::ostream& stream, const Counts& counts, const std::vector<ErrorRecord>& records,
+                     uint64_t dropped, uint64_t rateLimited)
+  {
+    stream << "# Counts per type and link\n";
+    for (const auto& pair : counts) {
+      stream << boost::format("# %-15s link:%-3d count:%d\n") % ErrorType::toString(pair.first.first) %
+                  pair.first.second % pair.second;
+    }
+    stream << boost::format("# %d records, %d not recorded because the buffer was full, %d because of the rate "
+                            "limit\n") %
+                records.size() % dropped % rateLimited;
+    for (const auto& record : records) {
+      decodeRecord(stream, record);
+    }
+  }
+
+  size_t mCapacity;
+  size_t mMaxRecordsPerSecond;
+  std::vector<ErrorRecord> mRecords;
+  Counts mCounts;
+  uint64_t mDropped = 0;
+  uint64_t mRateLimited = 0;
+  Clock::time_point mWindowStart;
+  size_t mWindowRecords = 0;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_ERRORRECORDER_H
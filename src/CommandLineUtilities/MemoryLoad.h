@@ -0,0 +1,278 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MemoryLoad.h
+/// \brief Definition of the MemoryLoad class.
+
+#ifndef ALICEO2_READOUTCARD_MEMORYLOAD_H
+#define ALICEO2_READOUTCARD_MEMORYLOAD_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace CommandLineUtilities
+{
+
+/// This class generates CPU memory-bandwidth load, to benchmark DMA while competing for the memory controllers.
+/// Every thread is pinned to one core and streams through its own buffer, which should be much larger than the LLC.
+/// Buffers are placed by first touch: on the NUMA node of the worker core, or on a given node by touching them from one
+/// of that node's cores.
+class MemoryLoad
+{
+ public:
+  struct Mode {
+    enum type {
+      Read,
+      Write,
+      Copy
+    };
+  };
+
+  static Mode::type parseMode(const std::string& string)
+  {
+    if (string == "read") {
+      return Mode::Read;
+    } else if (string == "write") {
+      return Mode::Write;
+    } else if (string == "copy") {
+      return Mode::Copy;
+    }
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Invalid memory load mode '" + string + "', must be read, write or copy"));
+  }
+
+  static std::string toString(Mode::type mode)
+  {
+    switch (mode) {
+      case Mode::Read:
+        return "read";
+      case Mode::Write:
+        return "write";
+      case Mode::Copy:
+        return "copy";
+    }
+    return "unknown";
+  }
+
+  /// Parses a Linux CPU list, e.g. "0-3,8,10-11"
+  static std::vector<int> parseCpuList(std::string string)
+  {
+    std::vector<int> cpus;
+    boost::trim(string);
+    if (string.empty()) {
+      return cpus;
+    }
+    std::vector<std::string> ranges;
+    boost::split(ranges, string, boost::is_any_of(","));
+    for (const auto& range : ranges) {
+      std::vector<std::string> bounds;
+      boost::split(bounds, range, boost::is_any_of("-"));
+      int first = 0;
+      int last = 0;
+      if (bounds.empty() || bounds.size() > 2 ||
+          !boost::conversion::try_lexical_convert<int>(bounds.front(), first) ||
+          !boost::conversion::try_lexical_convert<int>(bounds.back(), last) || last < first) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Malformed CPU list '" + string + "'"));
+      }
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+
+  /// Gets the CPUs of a NUMA node from sysfs
+  static std::vector<int> getNodeCpus(int node)
+  {
+    std::ifstream stream((boost::format("/sys/devices/system/node/node%d/cpulist") % node).str());
+    std::string string;
+    if (!std::getline(stream, string)) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Failed to get CPUs of NUMA node") << ErrorInfo::NumaNode(node));
+    }
+    return parseCpuList(string);
+  }
+
+  /// Starts one load thread per core
+  /// \param mode Access pattern
+  /// \param cores Cores to pin the threads to
+  /// \param bufferSize Size of the buffer per thread, at least MIN_BUFFER_SIZE
+  /// \param node NUMA node to place the buffers on, or -1 for the node of each worker core
+  void start(Mode::type mode, const std::vector<int>& cores, size_t bufferSize, int node = -1)
+  {
+    if (bufferSize < MIN_BUFFER_SIZE) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Memory load buffer smaller than a chunk of work"));
+    }
+    mMode = mode;
+    mStop = false;
+    auto nodeCpus = (node >= 0) ? getNodeCpus(node) : std::vector<int>();
+
+    for (int core : cores) {
+      auto worker = std::make_unique<Worker>();
+      worker->thread = std::thread([this, core, bufferSize, nodeCpus, w = worker.get()]() {
+        std::vector<uint8_t> buffer;
+        try {
+          // First touch decides the placement of the pages
+          setAffinity(nodeCpus.empty() ? std::vector<int>{ core } : nodeCpus);
+          buffer.assign(bufferSize, 0x1);
+          setAffinity({ core });
+        } catch (const std::exception&) {
+          mFailed = true;
+          mReady.fetch_add(1);
+          return;
+        }
+        mReady.fetch_add(1);
+        run(buffer, w->bytes);
+      });
+      mWorkers.push_back(std::move(worker));
+    }
+
+    // Wait until all buffers are allocated, so the load is at full strength when the DMA starts
+    while (mReady.load() < mWorkers.size()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    mStart = std::chrono::steady_clock::now();
+
+    if (mFailed) {
+      stop();
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Failed to start memory load; check the cores and NUMA node"));
+    }
+  }
+
+  ~MemoryLoad()
+  {
+    stop();
+  }
+
+  void stop()
+  {
+    mStop = true;
+    for (auto& worker : mWorkers) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+    mEnd = std::chrono::steady_clock::now();
+  }
+
+  /// Total bytes moved by the load threads. A copy counts both the read and the write.
+  double getBytes() const
+  {
+    double bytes = 0;
+    for (const auto& worker : mWorkers) {
+      bytes += worker->bytes.load(std::memory_order_relaxed);
+    }
+    return bytes;
+  }
+
+  double getSeconds() const
+  {
+    return std::chrono::duration<double>(mEnd - mStart).count();
+  }
+
+  size_t getThreads() const
+  {
+    return mWorkers.size();
+  }
+
+  Mode::type getMode() const
+  {
+    return mMode;
+  }
+
+  /// Granularity of the work between checks of the stop flag
+  static constexpr size_t CHUNK_SIZE = 1024 * 1024;
+
+  /// Smallest buffer size per thread, a chunk, so that the copy has two halves of at least half a chunk
+  static constexpr size_t MIN_BUFFER_SIZE = CHUNK_SIZE;
+
+ private:
+  struct Worker {
+    std::thread thread;
+    std::atomic<uint64_t> bytes{ 0 };
+  };
+
+  static void setAffinity(const std::vector<int>& cpus)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Failed to set memory load thread affinity"));
+    }
+  }
+
+  void run(std::vector<uint8_t>& buffer, std::atomic<uint64_t>& bytes)
+  {
+    const size_t chunk = std::min(CHUNK_SIZE, buffer.size() / 2);
+    const size_t chunks = buffer.size() / chunk;
+    uint64_t sum = 0;
+    size_t index = 0;
+
+    while (!mStop.load(std::memory_order_relaxed)) {
+      auto data = buffer.data() + index * chunk;
+      switch (mMode) {
+        case Mode::Read: {
+          auto words = reinterpret_cast<const uint64_t*>(data);
+          for (size_t i = 0; i < chunk / sizeof(uint64_t); ++i) {
+            sum += words[i];
+          }
+          bytes.fetch_add(chunk, std::memory_order_relaxed);
+          break;
+        }
+        case Mode::Write:
+          std::memset(data, int(index), chunk);
+          bytes.fetch_add(chunk, std::memory_order_relaxed);
+          break;
+        case Mode::Copy: {
+          // Copy from the opposite half of the buffer, so source and destination never overlap
+          auto source = buffer.data() + ((index + chunks / 2) % chunks) * chunk;
+          std::memcpy(data, source, chunk);
+          bytes.fetch_add(2 * chunk, std::memory_order_relaxed);
+          break;
+        }
+      }
+      index = (index + 1) % chunks;
+    }
+
+    // Keep the reads from being optimized away
+    mSink.fetch_add(sum, std::memory_order_relaxed);
+  }
+
+  Mode::type mMode = Mode::Read;
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::atomic<bool> mStop{ false };
+  std::atomic<bool> mFailed{ false };
+  std::atomic<size_t> mReady{ 0 };
+  std::atomic<uint64_t> mSink{ 0 };
+  std::chrono::steady_clock::time_point mStart;
+  std::chrono::steady_clock::time_point mEnd;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_MEMORYLOAD_H
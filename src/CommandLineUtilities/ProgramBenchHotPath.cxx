@@ -0,0 +1,304 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProgramBenchHotPath.cxx
+/// \brief Utility that runs a fixed workload over the DMA hot paths, for profile-guided optimization and its report
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "DataFormat.h"
+#include "DdgCheck.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/DmaChannelInterface.h"
+#include "ReadoutCard/Parameters.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+namespace po = boost::program_options;
+
+namespace
+{
+
+constexpr size_t BUFFER_SIZE = 64 * 1024 * 1024;
+constexpr size_t SUPERPAGE_SIZE = 1024 * 1024;
+constexpr size_t DMA_PAGE_SIZE = 8 * 1024;
+constexpr size_t DATA_SIZE = 8 * 1024 * 1024; ///< Of the synthetic CRU data, small enough to stay in the cache
+constexpr uint32_t LINKS = 12;
+
+/// Writes a CRU data page: the RDH, and a payload with the DDG pattern
+/// \return The data generator counter after the page
+uint32_t writePage(char* page, uint32_t linkId, uint32_t packetCounter, uint32_t pagesCounter, uint32_t dataCounter)
+{
+  std::memset(page, 0, DataFormat::getHeaderSize());
+  auto word = [&](int i, uint32_t value) { std::memcpy(&page[sizeof(uint32_t) * i], &value, sizeof(value)); };
+  word(2, (uint32_t(DMA_PAGE_SIZE) << 16) | uint32_t(DMA_PAGE_SIZE));
+  word(3, (packetCounter << 8) | linkId);
+  word(4, pagesCounter);
+  word(5, pagesCounter);
+  word(9, (pagesCounter == 0) ? (1 << 11) : 0); // Time frame start on the first page of the superpage
+  word(13, pagesCounter << 8);
+
+  // Every 256-bit word holds the counter twice, its 16 LSBs and a 0, see DdgCheck
+  auto payload = reinterpret_cast<uint32_t*>(page + DataFormat::getHeaderSize());
+  for (size_t i = 0; i < (DMA_PAGE_SIZE - DataFormat::getHeaderSize()) / sizeof(uint32_t); i += 4) {
+    payload[i + 0] = dataCounter;
+    payload[i + 1] = dataCounter;
+    payload[i + 2] = dataCounter & 0xffff;
+    payload[i + 3] = 0;
+    dataCounter++;
+  }
+  return dataCounter;
+}
+
+} // Anonymous namespace
+
+/// Runs every phase of a fixed, deterministic workload over the paths that dominate a readout: the superpage push and
+/// pop through the DmaChannelInterface, and the DDG page check of roc-bench-dma (DdgCheck), with and without the payload. It needs no card and no
+/// hugepages, using the dummy channel and a heap buffer, so it can run on a build machine to train the profile of a
+/// -DREADOUTCARD_PGO=GENERATE build. Its timings, compared to a baseline with --baseline, are the report of the gains.
+class ProgramBenchHotPath : public Program
+{
+ public:
+  virtual Description getDescription()
+  {
+    return { "Bench Hot Path", "Run a fixed workload over the DMA hot paths",
+             "Times the superpage push and pop of the dummy channel, and the data generator page check of the DMA\n"
+             "benchmark over synthetic CRU data, of the RDHs only (fast check) and of the payload as well. The workload is the same on every run, so it serves as the\n"
+             "training workload of profile-guided builds, and as their report when compared to a baseline.\n"
+             "roc-bench-hotpath --csv-out > baseline.csv\n"
+             "roc-bench-hotpath --baseline baseline.csv" };
+  }
+
+  virtual void addOptions(boost::program_options::options_description& options)
+  {
+    options.add_options()("baseline",
+                          po::value<std::string>(&mOptions.baseline),
+                          "CSV output of an earlier run, e.g. of a build without profile feedback, to compare with");
+    options.add_options()("csv-out",
+                          po::bool_switch(&mOptions.csvOut),
+                          "Toggle csv-formatted output");
+    options.add_options()("repeat",
+                          po::value<int>(&mOptions.repeat)->default_value(200),
+                          "Times to run every phase. The work per phase is fixed, so keep it equal to compare runs");
+  }
+
+  virtual void run(const boost::program_options::variables_map&)
+  {
+    if (mOptions.repeat < 1) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Repeat must be at least 1"));
+    }
+    auto baseline = readBaseline();
+
+    std::vector<Result> results;
+    results.push_back(benchmark("dma-loop", [&] { return runDmaLoop(); }));
+    generateData();
+    results.push_back(benchmark("rdh-check", [&] { return runDdgCheck(true); }));
+    results.push_back(benchmark("ddg-check", [&] { return runDdgCheck(false); }));
+
+    auto formatHeader = "  %-14s %-10s %-10s %-14s %-8s\n";
+    auto formatRow = "  %-14s %-10d %-10.2f %-14s %-8s\n";
+    auto header = (boost::format(formatHeader) % "Phase" % "Ops" % "ns/op" % "Baseline ns/op" % "Speedup").str();
+    auto lineFat = std::string(header.length(), '=') + '\n';
+    auto lineThin = std::string(header.length(), '-') + '\n';
+
+    if (mOptions.csvOut) {
+      std::cout << "Phase,Ops,ns/op\n";
+    } else {
+      std::cout << lineFat << header << lineThin;
+    }
+    for (const auto& result : results) {
+      if (mOptions.csvOut) {
+        std::cout << result.phase << "," << result.ops << "," << result.nanosecondsPerOp << "\n";
+        continue;
+      }
+      auto entry = baseline.find(result.phase);
+      if (entry != baseline.end()) {
+        std::cout << boost::format(formatRow) % result.phase % result.ops % result.nanosecondsPerOp
+                       % (boost::format("%.2f") % entry->second) % (boost::format("%.2fx") % (entry->second / result.nanosecondsPerOp));
+      } else {
+        std::cout << boost::format(formatRow) % result.phase % result.ops % result.nanosecondsPerOp % "n/a" % "n/a";
+      }
+    }
+    if (!mOptions.csvOut) {
+      std::cout << lineFat;
+    }
+  }
+
+ private:
+  struct Result {
+    std::string phase;
+    uint64_t ops = 0;
+    double nanosecondsPerOp = 0;
+  };
+
+  /// Runs a phase, which returns its amount of operations, and takes the fastest of the repetitions
+  Result benchmark(std::string phase, std::function<uint64_t()> function)
+  {
+    Result result;
+    result.phase = phase;
+    for (int i = 0; i < mOptions.repeat && !isSigInt(); ++i) {
+      auto start = std::chrono::steady_clock::now();
+      uint64_t ops = function();
+      double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      if (result.ops == 0 || nanoseconds / ops < result.nanosecondsPerOp) {
+        result.nanosecondsPerOp = nanoseconds / ops;
+      }
+      result.ops = ops;
+    }
+    return result;
+  }
+
+  /// Pushes the superpages of the buffer through the dummy channel, like the push thread of roc-bench-dma
+  uint64_t runDmaLoop()
+  {
+    if (!mChannel) {
+      mBuffer.resize(BUFFER_SIZE);
+      auto params = Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0);
+      params.setBufferParameters(buffer_parameters::Memory{ mBuffer.data(), mBuffer.size() });
+      mChannel = ChannelFactory().getDmaChannel(params);
+      mChannel->startDma();
+    }
+
+    const size_t superpages = 64 * (BUFFER_SIZE / SUPERPAGE_SIZE);
+    size_t pushed = 0;
+    size_t popped = 0;
+    while (popped < superpages) {
+      while (pushed < superpages && mChannel->getTransferQueueAvailable() != 0) {
+        Superpage superpage;
+        superpage.setOffset((pushed % (BUFFER_SIZE / SUPERPAGE_SIZE)) * SUPERPAGE_SIZE);
+        superpage.setSize(SUPERPAGE_SIZE);
+        mChannel->pushSuperpage(superpage);
+        pushed++;
+      }
+      mChannel->fillSuperpages();
+      while (mChannel->getReadyQueueSize() != 0) {
+        auto superpage = mChannel->getSuperpage();
+        if (!superpage.isReady() || superpage.getReceived() != SUPERPAGE_SIZE) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Dummy channel returned an incomplete superpage"));
+        }
+        mChannel->popSuperpage();
+        popped++;
+      }
+    }
+    return popped;
+  }
+
+  /// Fills the data with pages of links in turn, every link a superpage at a time
+  void generateData()
+  {
+    mData.resize(DATA_SIZE);
+    std::vector<uint32_t> packetCounters(LINKS, 0);
+    std::vector<uint32_t> dataCounters(LINKS, 0);
+    const size_t pagesPerSuperpage = SUPERPAGE_SIZE / DMA_PAGE_SIZE;
+    for (size_t page = 0; page < DATA_SIZE / DMA_PAGE_SIZE; ++page) {
+      uint32_t linkId = (page / pagesPerSuperpage) % LINKS;
+      dataCounters[linkId] = writePage(&mData[page * DMA_PAGE_SIZE], linkId, packetCounters[linkId]++ % 256,
+                                       page % pagesPerSuperpage, dataCounters[linkId]);
+    }
+  }
+
+  /// Reads out the superpages of the data like the readout thread of roc-bench-dma does, checking every page
+  /// \param fast Checks the RDHs only, like roc-bench-dma --fast-check
+  uint64_t runDdgCheck(bool fast)
+  {
+    DdgCheck check;
+    check.fast = fast;
+    std::vector<uint32_t> packetCounters(LINKS, DdgCheck::COUNTER_INITIAL_VALUE);
+    std::vector<uint32_t> dataCounters(LINKS, DdgCheck::COUNTER_INITIAL_VALUE);
+    std::vector<uint32_t> eventCounters(LINKS, 0);
+    uint64_t errors = 0;
+    uint64_t pages = 0;
+    auto record = [&](ErrorType::type type, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t) {
+      if (ErrorType::isError(type)) {
+        errors++;
+      }
+    };
+
+    for (size_t superpage = 0; superpage < DATA_SIZE; superpage += SUPERPAGE_SIZE) {
+      size_t readoutBytes = 0;
+      while (readoutBytes < SUPERPAGE_SIZE) {
+        auto page = &mData[superpage + readoutBytes];
+        uint32_t linkId = DataFormat::getLinkId(page);
+        size_t pageSize = DataFormat::getOffset(page);
+        if (linkId >= LINKS || pageSize == 0) {
+          checkErrors("DDG check", 1);
+        }
+        eventCounters[linkId]++;
+        check.checkPage(page, pageSize, readoutBytes == 0, packetCounters[linkId], dataCounters[linkId],
+                        eventCounters[linkId], record);
+        readoutBytes += pageSize;
+        pages++;
+      }
+    }
+    checkErrors("DDG check", errors);
+    return pages;
+  }
+
+  /// The data is generated correct, so any error is a bug of the workload
+  void checkErrors(std::string phase, uint64_t errors)
+  {
+    if (errors != 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(phase + " found " + std::to_string(errors) + " errors in the synthetic data"));
+    }
+  }
+
+  /// Reads the ns/op of every phase from the CSV output of an earlier run
+  std::map<std::string, double> readBaseline()
+  {
+    std::map<std::string, double> baseline;
+    if (mOptions.baseline.empty()) {
+      return baseline;
+    }
+    std::ifstream stream(mOptions.baseline);
+    if (!stream) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Failed to open baseline")
+                                                 << ErrorInfo::FileName(mOptions.baseline));
+    }
+    std::string line;
+    std::getline(stream, line); // Header
+    while (std::getline(stream, line)) {
+      std::vector<std::string> fields;
+      boost::split(fields, line, boost::is_any_of(","));
+      double nanosecondsPerOp;
+      if (fields.size() == 3 && boost::conversion::try_lexical_convert<double>(fields[2], nanosecondsPerOp)) {
+        baseline[fields[0]] = nanosecondsPerOp;
+      }
+    }
+    return baseline;
+  }
+
+  struct OptionsStruct {
+    std::string baseline;
+    bool csvOut = false;
+    int repeat = 200;
+  } mOptions;
+
+  std::vector<char> mBuffer;
+  std::shared_ptr<DmaChannelInterface> mChannel;
+  std::vector<char> mData;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramBenchHotPath().execute(argc, argv);
+}
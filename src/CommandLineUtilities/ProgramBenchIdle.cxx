@@ -0,0 +1,204 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProgramBenchIdle.cxx
+/// \brief Utility that benchmarks the wake-up latency and CPU use of the polling loop idle strategies
+
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "Utilities/IdleStrategy.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+using Utilities::IdleStrategy;
+namespace po = boost::program_options;
+
+namespace
+{
+
+/// CPU time used by the calling thread
+double getThreadCpuSeconds()
+{
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+int64_t getNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // Anonymous namespace
+
+class ProgramBenchIdle : public Program
+{
+ public:
+  virtual Description getDescription()
+  {
+    return { "Bench Idle", "Benchmark the idle strategies of the polling loops",
+             "Measures, for every idle strategy, the latency between an event being posted and a polling thread seeing\n"
+             "it, and the CPU use of the polling thread. Events are posted at random intervals around --interval.\n"
+             "roc-bench-idle\n"
+             "roc-bench-idle --strategies pause,backoff --events 10000 --interval 50 --csv-out" };
+  }
+
+  virtual void addOptions(boost::program_options::options_description& options)
+  {
+    options.add_options()("csv-out",
+                          po::bool_switch(&mOptions.csvOut),
+                          "Toggle csv-formatted output");
+    options.add_options()("events",
+                          po::value<int>(&mOptions.events)->default_value(2000),
+                          "Amount of events per strategy");
+    options.add_options()("interval",
+                          po::value<int>(&mOptions.intervalUs)->default_value(200),
+                          "Average interval between events in microseconds");
+    options.add_options()("sleep-time",
+                          po::value<int>(&mOptions.sleepUs)->default_value(100),
+                          "Sleep time of the sleep strategy, and maximum sleep time of the backoff strategy, in microseconds");
+    options.add_options()("strategies",
+                          po::value<std::string>(&mOptions.strategies)->default_value("busy-spin,pause,yield,backoff,sleep"),
+                          "Comma separated list of strategies to benchmark [busy-spin, pause, yield, backoff, sleep]");
+  }
+
+  virtual void run(const boost::program_options::variables_map&)
+  {
+    std::vector<std::string> names;
+    boost::split(names, mOptions.strategies, boost::is_any_of(","));
+    std::vector<IdleStrategy::Policy::type> policies;
+    for (const auto& name : names) {
+      policies.push_back(IdleStrategy::fromString(boost::trim_copy(name)));
+    }
+
+    auto formatHeader = "  %-10s %-8s %-10s %-10s %-10s %-10s %-8s\n";
+    auto formatRow = "  %-10s %-8d %-10.1f %-10.1f %-10.1f %-10.1f %-8.1f\n";
+    auto header = (boost::format(formatHeader) % "Strategy" % "Events" % "Mean (us)" % "p50 (us)" % "p99 (us)" %
+                   "Max (us)" % "CPU (%)")
+                    .str();
+    auto lineFat = std::string(header.length(), '=') + '\n';
+    auto lineThin = std::string(header.length(), '-') + '\n';
+
+    if (mOptions.csvOut) {
+      std::cout << "Strategy,Events,Mean (us),p50 (us),p99 (us),Max (us),CPU (%)\n";
+    } else {
+      std::cout << lineFat << header << lineThin;
+    }
+
+    for (auto policy : policies) {
+      if (isSigInt()) {
+        break;
+      }
+      auto result = benchmark(policy);
+      if (mOptions.csvOut) {
+        std::cout << IdleStrategy::toString(policy) << "," << result.events << "," << result.mean << "," << result.p50
+                  << "," << result.p99 << "," << result.max << "," << result.cpuPercent << "\n";
+      } else {
+        std::cout << boost::format(formatRow) % IdleStrategy::toString(policy) % result.events % result.mean %
+                       result.p50 % result.p99 % result.max % result.cpuPercent;
+      }
+    }
+
+    if (!mOptions.csvOut) {
+      std::cout << lineFat;
+    }
+  }
+
+ private:
+  struct Result {
+    size_t events = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+    double cpuPercent = 0;
+  };
+
+  Result benchmark(IdleStrategy::Policy::type policy)
+  {
+    std::atomic<int64_t> postTime{ 0 };
+    std::atomic<int> sequence{ 0 };
+    std::vector<double> latencies;
+    latencies.reserve(mOptions.events);
+    double cpuSeconds = 0;
+    double wallSeconds = 0;
+
+    // Polling thread, the one being measured
+    std::thread poller([&] {
+      IdleStrategy idle(policy, std::chrono::microseconds(mOptions.sleepUs));
+      int seen = 0;
+      auto cpuStart = getThreadCpuSeconds();
+      auto wallStart = std::chrono::steady_clock::now();
+
+      while (seen < mOptions.events) {
+        int current = sequence.load(std::memory_order_acquire);
+        bool workDone = current != seen;
+        if (workDone) {
+          // The next event may already have been posted, so clamp at zero
+          latencies.push_back(std::max(0.0, (getNanoseconds() - postTime.load(std::memory_order_relaxed)) / 1000.0));
+          seen = current;
+        }
+        idle.idle(workDone);
+      }
+
+      cpuSeconds = getThreadCpuSeconds() - cpuStart;
+      wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    });
+
+    // Posting thread, sleeps between events
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> distribution(mOptions.intervalUs / 2, (mOptions.intervalUs * 3) / 2);
+    for (int i = 0; i < mOptions.events; ++i) {
+      std::this_thread::sleep_for(std::chrono::microseconds(distribution(generator)));
+      postTime.store(getNanoseconds(), std::memory_order_relaxed);
+      sequence.store(i + 1, std::memory_order_release);
+    }
+    poller.join();
+
+    Result result;
+    result.events = latencies.size();
+    if (!latencies.empty()) {
+      std::sort(latencies.begin(), latencies.end());
+      for (auto latency : latencies) {
+        result.mean += latency;
+      }
+      result.mean /= latencies.size();
+      result.p50 = latencies[latencies.size() / 2];
+      result.p99 = latencies[std::min(latencies.size() - 1, (latencies.size() * 99) / 100)];
+      result.max = latencies.back();
+    }
+    result.cpuPercent = (wallSeconds > 0) ? (100.0 * cpuSeconds / wallSeconds) : 0;
+    return result;
+  }
+
+  struct OptionsStruct {
+    bool csvOut = false;
+    int events = 2000;
+    int intervalUs = 200;
+    int sleepUs = 100;
+    std::string strategies;
+  } mOptions;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramBenchIdle().execute(argc, argv);
+}
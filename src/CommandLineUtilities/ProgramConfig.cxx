@@ -91,6 +91,9 @@ class ProgramConfig : public Program
     options.add_options()("trigger-window-size",
                           po::value<uint32_t>(&mOptions.triggerWindowSize),
                           "Flag to set the size of the trigger window in GBT words");
+    options.add_options()("configuration-program",
+                          po::value<std::string>(&mOptions.configurationProgram)->default_value(""),
+                          "Path of the compiled configuration program to replay, or to write if it does not match");
     Options::addOptionCardId(options);
   }
 
@@ -149,6 +152,9 @@ class ProgramConfig : public Program
       params.setDynamicOffsetEnabled(mOptions.dynamicOffsetEnabled);
       params.setOnuAddress(mOptions.onuAddress);
       params.setTriggerWindowSize(mOptions.triggerWindowSize);
+      if (mOptions.configurationProgram != "") {
+        params.setConfigurationProgram(mOptions.configurationProgram);
+      }
 
       try {
         CardConfigurator(params, mOptions.forceConfig);
@@ -169,6 +175,7 @@ class ProgramConfig : public Program
   struct OptionsStruct {
     std::string clock = "local";
     std::string configUri = "";
+    std::string configurationProgram = "";
     std::string datapathMode = "packet";
     std::string downstreamData = "Ctp";
     std::string gbtMode = "gbt";
@@ -0,0 +1,62 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProgramDecodeErrors.cxx
+/// \brief Utility that decodes the binary error records written by roc-bench-dma
+
+#include <fstream>
+#include <iostream>
+#include "CommandLineUtilities/ErrorRecorder.h"
+#include "CommandLineUtilities/Program.h"
+#include "ExceptionInternal.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+namespace po = boost::program_options;
+
+namespace
+{
+
+class ProgramDecodeErrors : public Program
+{
+ public:
+  virtual Description getDescription()
+  {
+    return { "Decode Errors", "Decode the binary error records written by roc-bench-dma --errors-binary",
+             "roc-decode-errors --file=readout_errors.bin" };
+  }
+
+  virtual void addOptions(boost::program_options::options_description& options)
+  {
+    options.add_options()("file",
+                          po::value<std::string>(&mFile)->default_value("readout_errors.bin"),
+                          "Binary error file to decode");
+  }
+
+  virtual void run(const boost::program_options::variables_map&)
+  {
+    std::ifstream stream(mFile, std::ios::binary);
+    if (!stream) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to open binary error file")
+                                        << ErrorInfo::FileName(mFile));
+    }
+    ErrorRecorder::decodeBinary(stream, std::cout);
+  }
+
+ private:
+  std::string mFile;
+};
+
+} // Anonymous namespace
+
+int main(int argc, char** argv)
+{
+  return ProgramDecodeErrors().execute(argc, argv);
+}
@@ -19,11 +19,13 @@
 #include <iostream>
 #include <future>
 #include <fstream>
+#include <mutex>
 #include <random>
 #include <queue>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
+#include <poll.h>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/exception/diagnostic_information.hpp>
@@ -36,18 +38,27 @@
 #include "CommandLineUtilities/Common.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
+#include "ConsumerLag.h"
 #include "Common/Iommu.h"
 #include "Common/SuffixOption.h"
 #include "DataFormat.h"
+#include "DdgCheck.h"
+#include "ErrorRecorder.h"
 #include "ExceptionInternal.h"
 #include "InfoLogger/InfoLogger.hxx"
+#include "MemoryLoad.h"
 #include "folly/ProducerConsumerQueue.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/ExtendedCounter.h"
 #include "ReadoutCard/MemoryMappedFile.h"
 #include "ReadoutCard/Parameters.h"
 #include "ReadoutCard/ReadoutCard.h"
+#include "ThroughputModel.h"
 #include "time.h"
 #include "Utilities/Hugetlbfs.h"
+#include "Utilities/IdleStrategy.h"
+#include "Utilities/PcieLink.h"
+#include "Utilities/PerfCounters.h"
 #include "Utilities/SmartPointer.h"
 #include "Utilities/Util.h"
 
@@ -64,9 +75,9 @@ namespace po = boost::program_options;
 namespace
 {
 /// Initial value for link counters
-constexpr auto DATA_COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
+constexpr auto DATA_COUNTER_INITIAL_VALUE = DdgCheck::COUNTER_INITIAL_VALUE;
 /// Initial value for link packet counters
-constexpr auto PACKET_COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
+constexpr auto PACKET_COUNTER_INITIAL_VALUE = DdgCheck::COUNTER_INITIAL_VALUE;
 /// Initial value for link event counters
 constexpr auto EVENT_COUNTER_INITIAL_VALUE = std::numeric_limits<uint32_t>::max();
 /// Maximum supported links
@@ -81,12 +92,25 @@ const std::string PROGRESS_FORMAT_HEADER("  %-8s   %-12s  %-12s %-18s  %-12s  %-
 const std::string PROGRESS_FORMAT("  %02s:%02s:%02s   %-12s  %-12s  %-18s  %-12s  %-5.1f");
 /// Path for error log
 auto READOUT_ERRORS_PATH = "readout_errors.txt";
-/// Max amount of errors that are recorded into the error stream
+/// Path for binary error log
+auto READOUT_ERRORS_BINARY_PATH = "readout_errors.bin";
+/// Max amount of error records kept in memory
 constexpr int64_t MAX_RECORDED_ERRORS = 10000;
+/// Max amount of new error records per second
+constexpr int64_t MAX_RECORDED_ERRORS_PER_SECOND = 1000;
 /// End InfoLogger message alias
 constexpr auto endm = InfoLogger::endm;
 /// We use steady clock because otherwise system clock changes could affect the running of the program
 using TimePoint = std::chrono::steady_clock::time_point;
+/// Waits until the arrival notification descriptor of the channel is readable, or the timeout passed
+void waitForArrival(int fd, std::chrono::microseconds timeout)
+{
+  pollfd pfd{ fd, POLLIN, 0 };
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts{ seconds.count(), std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count() };
+  ppoll(&pfd, 1, &ts, nullptr);
+}
+
 /// Struct used for benchmark time limit
 struct TimeLimit {
   uint64_t seconds = 0;
@@ -97,6 +121,7 @@ struct TimeLimit {
 struct SuperpageInfo {
   size_t bufferOffset;
   size_t effectiveSize;
+  TimePoint arrival; ///< When the push thread passed it on
 };
 } // Anonymous namespace
 
@@ -125,6 +150,11 @@ class ProgramDmaBench : public Program
 
   virtual void addOptions(po::options_description& options)
   {
+    options.add_options()("arrival-notification",
+                          po::bool_switch(&mOptions.arrivalNotification),
+                          "When a poll found no work, the push thread sleeps until the channel notifies an arrival, "
+                          "instead of following the idle strategy. --pause-push is the timeout of the sleep, since the "
+                          "superpages the readout frees are not notified");
     options.add_options()("bar-hammer",
                           po::bool_switch(&mOptions.barHammer),
                           "Stress the BAR with repeated writes and measure performance");
@@ -141,25 +171,68 @@ class ProgramDmaBench : public Program
                           SuffixOption<size_t>::make(&mBufferSize)->default_value("1Gi"),
                           "Buffer size in bytes. Rounded down to 2 MiB multiple. Minimum of 2 MiB. Use 2 MiB hugepage by default; |"
                           "if buffer size is a multiple of 1 GiB, will try to use GiB hugepages");
+    options.add_options()("consumer-lag",
+                          po::value<std::string>(&mOptions.consumerLag),
+                          "Measure the cost of processing DMA'd data against the delay before the readout consumes it, "
+                          "to find how long the data stays in the LLC. A list of delays in microseconds, e.g. '0,100,1000'");
+    options.add_options()("consumer-lag-superpages",
+                          po::value<uint64_t>(&mOptions.consumerLagSuperpages)->default_value(1000),
+                          "Superpages to consume at every consumer lag delay");
     options.add_options()("data-source",
                           po::value<std::string>(&mOptions.dataSourceString)->default_value("INTERNAL"),
                           "Data source [FEE, INTERNAL, DIU, SIU, DDG]");
+    options.add_options()("datapath-mode",
+                          po::value<std::string>(&mOptions.datapathMode)->default_value("Packet"),
+                          "Datapath mode the card is configured with, for the throughput model [Packet, Continuous]");
     options.add_options()("dma-channel",
                           po::value<int>(&mOptions.dmaChannel)->default_value(0),
                           "DMA channel selection (note: C-RORC has channels 0 to 5, CRU only 0)");
     options.add_options()("error-check-frequency",
                           po::value<uint64_t>(&mOptions.errorCheckFrequency)->default_value(1),
                           "Frequency of dma pages to check for errors");
+    options.add_options()("errors-binary",
+                          po::bool_switch(&mOptions.errorsBinary),
+                          "Write the error records in binary form to 'readout_errors.bin' instead of as text to "
+                          "'readout_errors.txt'. Decode them with roc-decode-errors");
     options.add_options()("fast-check",
                           po::bool_switch(&mOptions.fastCheckEnabled),
                           "Enable fast error checking");
+    options.add_options()("gbt-mode",
+                          po::value<std::string>(&mOptions.gbtMode)->default_value("GBT"),
+                          "GBT mode the card is configured with, for the throughput model [GBT, WB]");
     Options::addOptionCardId(options);
+    options.add_options()("idle-strategy",
+                          po::value<std::string>(&mOptions.idleStrategy)->default_value("sleep"),
+                          "What the push and readout threads do when a poll found no work [busy-spin, pause, yield, backoff, "
+                          "sleep]. The sleep times are given by --pause-push and --pause-read, which are also the maximum "
+                          "sleep times of the backoff strategy");
+    options.add_options()("latency",
+                          po::bool_switch(&mOptions.latency),
+                          "Measure the card-to-host latency of every superpage from the orbit and BC in its RDH; the "
+                          "distribution is reported at the end (CRU only, not with the internal data source)");
+    options.add_options()("link-liveness",
+                          po::bool_switch(&mOptions.linkLiveness),
+                          "Stop giving superpages to links that are down or do not fill them (CRU only, not with the "
+                          "internal data source)");
     options.add_options()("links",
                           po::value<std::string>(&mOptions.links)->default_value("0"),
                           "Links to open. A comma separated list of integers or ranges, e.g. '0,2,5-10'");
     options.add_options()("max-rdh-packetcount",
                           po::value<size_t>(&mOptions.maxRdhPacketCounter)->default_value(255),
                           "Maximum packet counter expected in the RDH");
+    options.add_options()("mem-load",
+                          po::value<std::string>(&mOptions.memLoadMode),
+                          "Run a CPU memory-bandwidth load during DMA [read, write, copy]; reports the achieved CPU bandwidth and "
+                          "dropped packets along with the DMA rate");
+    options.add_options()("mem-load-cores",
+                          po::value<std::string>(&mOptions.memLoadCores),
+                          "Cores to run the memory load threads on, one thread per core. A CPU list, e.g. '2-5,8'");
+    options.add_options()("mem-load-node",
+                          po::value<int>(&mOptions.memLoadNode)->default_value(-1),
+                          "NUMA node to place the memory load buffers on. Default is the node of each load core");
+    options.add_options()("mem-load-size",
+                          SuffixOption<size_t>::make(&mOptions.memLoadSize)->default_value("256Mi"),
+                          "Memory load buffer size per thread, at least 1Mi. Should be much larger than the last-level cache");
     options.add_options()("no-errorcheck",
                           po::bool_switch(&mOptions.noErrorCheck),
                           "Skip error checking");
@@ -175,6 +248,9 @@ class ProgramDmaBench : public Program
     options.add_options()("no-temperature",
                           po::bool_switch(&mOptions.noTemperature),
                           "No temperature readout");
+    options.add_options()("packet-size",
+                          SuffixOption<size_t>::make(&mOptions.packetSize)->default_value("0"),
+                          "Payload size of the packets in packet mode, for the throughput model. 0 for packets filling the DMA pages");
     options.add_options()("page-size",
                           SuffixOption<size_t>::make(&mOptions.dmaPageSize)->default_value("8Ki"),
                           "Card DMA page size");
@@ -184,6 +260,13 @@ class ProgramDmaBench : public Program
     options.add_options()("pause-read",
                           po::value<uint64_t>(&mOptions.pauseRead)->default_value(10),
                           "Readout thread pause time in microseconds if no work can be done");
+    options.add_options()("perf-counters",
+                          po::bool_switch(&mOptions.perfCounters),
+                          "Count CPU cycles, instructions, LLC misses and stalled cycles in the poll, push and readout "
+                          "paths, and report them per superpage and per GB");
+    options.add_options()("rate-weighted",
+                          po::bool_switch(&mOptions.rateWeighted),
+                          "Give the superpages to the links in proportion to their completion rate (CRU only)");
     options.add_options()("random-pause",
                           po::bool_switch(&mOptions.randomPause),
                           "Randomly pause readout");
@@ -194,6 +277,10 @@ class ProgramDmaBench : public Program
                           SuffixOption<size_t>::make(&mSuperpageSize)->default_value("1Mi"),
                           "Superpage size in bytes. Note that it can't be larger than the buffer. If the IOMMU is not enabled, the "
                           "hugepage size must be a multiple of the superpage size");
+    options.add_options()("superpage-trace",
+                          po::bool_switch(&mOptions.superpageTrace),
+                          "Track the lifecycle of every superpage; report residence times and write a trace viewable in "
+                          "chrome://tracing or Perfetto at the end (CRU only)");
     options.add_options()("time",
                           po::value<std::string>(&mOptions.timeLimitString),
                           "Time limit for benchmark. Any combination of [n]h, [n]m, & [n]s. For example: '5h30m', '10s', '1s2h3m'.");
@@ -203,6 +290,9 @@ class ProgramDmaBench : public Program
     options.add_options()("to-file-bin",
                           po::value<std::string>(&mOptions.fileOutputPathBin),
                           "Read out to given file in binary format (only contains raw data from pages)");
+    options.add_options()("vfio",
+                          po::bool_switch(&mOptions.vfio),
+                          "Access the card through VFIO instead of PDA; it must be bound to vfio-pci and given by PCI address (CRU only)");
   }
 
   virtual void run(const po::variables_map& map)
@@ -229,6 +319,12 @@ class ProgramDmaBench : public Program
     mDataSource = params.getDataSourceRequired();
 
     params.setStbrdEnabled(mOptions.stbrd); //Set STBRD for the CRORC
+    params.setSuperpageTrackingEnabled(mOptions.superpageTrace);
+    params.setLatencyMeasurementEnabled(mOptions.latency);
+    params.setLinkLivenessEnabled(mOptions.linkLiveness);
+    params.setRateWeightedDistributionEnabled(mOptions.rateWeighted);
+    params.setVfioEnabled(mOptions.vfio);
+    params.setArrivalNotificationEnabled(mOptions.arrivalNotification);
 
     // Handle file output options
     mOptions.fileOutputAscii = !mOptions.fileOutputPathAscii.empty();
@@ -257,7 +353,10 @@ class ProgramDmaBench : public Program
     std::string bufferName = (b::format("roc-bench-dma_id=%s_chan=%s_pages") % map["id"].as<std::string>() % mOptions.dmaChannel).str();
 
     Utilities::HugepageType hugepageType;
-    mMemoryMappedFile = Utilities::tryMapFile(mBufferSize, bufferName, !mOptions.noRemovePagesFile, &hugepageType);
+    mMemoryMappedFile = Utilities::tryMapFile(mBufferSize, bufferName, !mOptions.noRemovePagesFile, &hugepageType,
+                                              &mHugepageReservation);
+    getLogger() << "Reserved " << mHugepageReservation->getPages() << " hugepages of "
+                << mHugepageReservation->getPageSize() / 1024 << " KiB" << endm;
 
     mBufferBaseAddress = reinterpret_cast<uintptr_t>(mMemoryMappedFile->getAddress());
     getLogger() << "Using buffer file path: " << mMemoryMappedFile->getFileName() << endm;
@@ -288,6 +387,12 @@ class ProgramDmaBench : public Program
       mBufferFullCheck = true;
     }
 
+    if (!mOptions.memLoadMode.empty() && mOptions.memLoadSize < MemoryLoad::MIN_BUFFER_SIZE) {
+      BOOST_THROW_EXCEPTION(InvalidOptionValueException()
+                            << ErrorInfo::Message("Memory load buffer size must be at least "
+                                                  + std::to_string(MemoryLoad::MIN_BUFFER_SIZE) + " bytes"));
+    }
+
     if (!mOptions.noErrorCheck) {
       if (mOptions.errorCheckFrequency < 0x1 || mOptions.errorCheckFrequency > 0xff) {
         throw ParameterException() << ErrorInfo::Message("Frequency of dma pages to fast check has to be in the range [1,255]");
@@ -300,6 +405,9 @@ class ProgramDmaBench : public Program
       }
       mMaxRdhPacketCounter = mOptions.maxRdhPacketCounter;
       getLogger() << "Maximum RDH packet counter" << mMaxRdhPacketCounter << endm;
+      mDdgCheck.errorCheckFrequency = mErrorCheckFrequency;
+      mDdgCheck.maxPacketCounter = mMaxRdhPacketCounter;
+      mDdgCheck.fast = mFastCheckEnabled;
     }
 
     // Get DMA channel object
@@ -316,17 +424,37 @@ class ProgramDmaBench : public Program
     getLogger() << "Card PCI address: " << mChannel->getPciAddress().toString() << endm;
     getLogger() << "Card NUMA node: " << mChannel->getNumaNode() << endm;
     getLogger() << "Card firmware info: " << mChannel->getFirmwareInfo().value_or("unknown") << endm;
+    initThroughputModel(params);
 
     getLogger() << "Starting benchmark" << endm;
     mChannel->startDma();
 
+    if (!mOptions.memLoadMode.empty()) {
+      auto mode = MemoryLoad::parseMode(mOptions.memLoadMode);
+      auto cores = MemoryLoad::parseCpuList(mOptions.memLoadCores);
+      if (cores.empty()) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Memory load requires --mem-load-cores"));
+      }
+      getLogger() << "Starting " << MemoryLoad::toString(mode) << " memory load on " << cores.size() << " core(s)" << endm;
+      readDroppedPackets();
+      Utilities::resetSmartPtr(mMemoryLoad);
+      mMemoryLoad->start(mode, cores, mOptions.memLoadSize, mOptions.memLoadNode);
+    }
+
+    if (!mOptions.consumerLag.empty()) {
+      // The main thread is the readout thread, which must own the counters
+      auto delays = ConsumerLag::parseDelays(mOptions.consumerLag);
+      getLogger() << "Measuring consumer lag at " << delays.size() << " delay(s)" << endm;
+      Utilities::resetSmartPtr(mConsumerLag, delays, mOptions.consumerLagSuperpages);
+    }
+
     if (mOptions.barHammer) {
       if (mChannel->getCardType() != CardType::Cru) {
         BOOST_THROW_EXCEPTION(ParameterException()
                               << ErrorInfo::Message("BarHammer option currently only supported for CRU"));
       }
       Utilities::resetSmartPtr(mBarHammer);
-      mBarHammer->start(ChannelFactory().getBar(Parameters::makeParameters(cardId, 0)));
+      mBarHammer->start(ChannelFactory().getBar(Parameters::makeParameters(cardId, 0).setVfioEnabled(mOptions.vfio)));
     }
 
     if (!mOptions.timeLimitString.empty()) {
@@ -346,6 +474,11 @@ class ProgramDmaBench : public Program
       mBarHammer->join();
     }
 
+    if (mMemoryLoad) {
+      mMemoryLoad->stop();
+      readDroppedPackets();
+    }
+
     std::cout << "\n\n";
     mChannel->stopDma();
     int numPopped = freeExcessPages(10ms);
@@ -353,6 +486,11 @@ class ProgramDmaBench : public Program
 
     outputErrors();
     outputStats();
+    if (mOptions.superpageTrace) {
+      if (auto path = mChannel->dumpSuperpageTrace()) {
+        getLogger() << "Superpage trace written to " << *path << endm;
+      }
+    }
     getLogger() << "Benchmark complete" << endm;
   }
 
@@ -363,6 +501,8 @@ class ProgramDmaBench : public Program
       throw std::runtime_error("Buffer too small");
     }
 
+    const auto idlePolicy = Utilities::IdleStrategy::fromString(mOptions.idleStrategy);
+
     // Lock-free queues. Usable size is (size-1), so we add 1
     /// Queue for passing filled superpages from the push thread to the readout thread
     folly::ProducerConsumerQueue<SuperpageInfo> readoutQueue{ static_cast<uint32_t>(mSuperpagesInBuffer) + 1 };
@@ -428,6 +568,11 @@ class ProgramDmaBench : public Program
     auto pushFuture = std::async(std::launch::async, [&] {
       try {
         RandomPauses pauses;
+        Utilities::IdleStrategy idle(idlePolicy, std::chrono::microseconds(mOptions.pausePush));
+        auto notificationFd = mChannel->getArrivalNotificationFd();
+        mPerfCountersPush = makePerfCounters();
+        mPerfPoll = Utilities::PerfRegion(mPerfCountersPush.get());
+        mPerfPush = Utilities::PerfRegion(mPerfCountersPush.get());
 
         while (!isStopDma()) {
           // Check if we need to stop in the case of a superpage limit
@@ -439,10 +584,13 @@ class ProgramDmaBench : public Program
           }
 
           // Keep the driver's queue filled
+          mPerfPoll.begin();
           mChannel->fillSuperpages();
+          mPerfPoll.end();
 
-          bool shouldRest = true;
+          bool workDone = false;
 
+          mPerfPush.begin();
           while (mChannel->getTransferQueueAvailable() != 0) {
             Superpage superpage;
             size_t offsetRead;
@@ -451,12 +599,13 @@ class ProgramDmaBench : public Program
               superpage.setSize(mSuperpageSize);
               superpage.setOffset(offsetRead);
               mChannel->pushSuperpage(superpage);
+              workDone = true;
             } else {
-              // freeQueue is backed up and we should rest
-              shouldRest = true;
+              // freeQueue is backed up
               break;
             }
           }
+          mPerfPush.end();
 
           // Check for filled superpages
           while (mChannel->getReadyQueueSize() != 0) {
@@ -469,17 +618,20 @@ class ProgramDmaBench : public Program
             }
 
             // Move full superpage to readout queue
-            if (superpage.isReady() && readoutQueue.write(SuperpageInfo{ superpage.getOffset(), superpage.getReceived() })) {
+            if (superpage.isReady() && readoutQueue.write(SuperpageInfo{ superpage.getOffset(), superpage.getReceived(), std::chrono::steady_clock::now() })) {
               mChannel->popSuperpage();
+              workDone = true;
             } else {
-              // readyQueue(=readout) is backed up, so rest a while
-              shouldRest = true;
+              // readyQueue(=readout) is backed up
               break;
             }
           }
 
-          if (shouldRest) {
-            std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pausePush));
+          // Only rest if there was nothing to do
+          if (notificationFd && !workDone) {
+            waitForArrival(*notificationFd, std::chrono::microseconds(mOptions.pausePush));
+          } else {
+            idle.idle(workDone);
           }
         }
       } catch (std::exception& e) {
@@ -491,6 +643,9 @@ class ProgramDmaBench : public Program
     // Readout thread (main thread)
     try {
       RandomPauses pauses;
+      Utilities::IdleStrategy idle(idlePolicy, std::chrono::microseconds(mOptions.pauseRead));
+      mPerfCountersReadout = makePerfCounters();
+      mPerfReadout = Utilities::PerfRegion(mPerfCountersReadout.get());
 
       while (!isStopDma()) {
         if (!mInfinitePages && mSuperpagesReadOut.load(std::memory_order_relaxed) >= mSuperpageLimit) {
@@ -503,18 +658,28 @@ class ProgramDmaBench : public Program
         }
 
         SuperpageInfo superpageInfo;
-        if (readoutQueue.read(superpageInfo) && !mBufferFullCheck) {
+        if (readSuperpage(readoutQueue, superpageInfo) && !mBufferFullCheck) {
+          idle.reset();
 
           // Read out pages
           size_t readoutBytes = 0;
           auto superpageAddress = mBufferBaseAddress + superpageInfo.bufferOffset;
 
+          if (mConsumerLag) {
+            mConsumerLag->process(superpageAddress, superpageInfo.effectiveSize);
+            if (mConsumerLag->isDone()) {
+              mDmaLoopBreak = true;
+            }
+          }
+
           fetchAddSuperpagesReadOut();
 
+          mPerfReadout.begin();
           bool atStartOfSuperpage = true;
+          int64_t readoutCount = 0;
           while ((readoutBytes < superpageInfo.effectiveSize) && !isStopDma()) {
             auto pageAddress = superpageAddress + readoutBytes;
-            auto readoutCount = fetchAddDmaPagesReadOut();
+            readoutCount = fetchAddDmaPagesReadOut();
             size_t pageSize = readoutPage(pageAddress, readoutCount, atStartOfSuperpage);
 
             atStartOfSuperpage = false; //Update the boolean value as soon as we move...
@@ -524,11 +689,12 @@ class ProgramDmaBench : public Program
             }
             readoutBytes += pageSize;
           }
+          mPerfReadout.end();
 
           if (readoutBytes > mSuperpageSize) {
-            mDmaLoopBreak = true; // Dump superpage somewhere
-            mReadoutStream.open("RDH_CUMULATIVE_SP_SIZE_FAILURE.bin");
-            mReadoutStream.write(reinterpret_cast<const char*>(superpageAddress), mSuperpageSize);
+            mDmaLoopBreak = true;
+            recordError(ErrorType::SuperpageSize, readoutCount, 0, superpageInfo.bufferOffset, 0, mSuperpageSize,
+                        readoutBytes, 0);
             BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("RDH reports cumulative dma page sizes that exceed the superpage size"));
           }
 
@@ -539,12 +705,13 @@ class ProgramDmaBench : public Program
             BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Something went horribly wrong"));
           }
         } else {
-          // No superpages available to read out, so have a nap
-          std::this_thread::sleep_for(std::chrono::microseconds(mOptions.pauseRead));
+          // No superpages available to read out
+          idle.idle();
         }
       }
     } catch (Exception& e) {
       mDmaLoopBreak = true;
+      outputErrors(); // Including the one that stopped the readout
       throw;
     }
 
@@ -552,6 +719,42 @@ class ProgramDmaBench : public Program
     lowPriorityFuture.get();
   }
 
+  /// Gets the next superpage to read out. With the consumer lag measurement, superpages are held back until they are as
+  /// old as the current delay.
+  bool readSuperpage(folly::ProducerConsumerQueue<SuperpageInfo>& readoutQueue, SuperpageInfo& superpageInfo)
+  {
+    if (!mConsumerLag) {
+      return readoutQueue.read(superpageInfo);
+    }
+    while (readoutQueue.read(superpageInfo)) {
+      mConsumerLag->hold(superpageInfo.bufferOffset, superpageInfo.effectiveSize, superpageInfo.arrival);
+    }
+    return mConsumerLag->take(superpageInfo.bufferOffset, superpageInfo.effectiveSize, std::chrono::steady_clock::now());
+  }
+
+  /// Reads the dropped packets counter, which only the CRU has. The channel returns it as an int32_t, so it is taken
+  /// back to the raw 32-bit value, which may be 2^31 or more.
+  void readDroppedPackets()
+  {
+    if (mCardType == CardType::Cru) {
+      mDroppedPackets.update(uint32_t(mChannel->getDroppedPackets()), 0.0);
+    }
+  }
+
+  /// Opens the performance counters of the calling thread, if enabled
+  std::unique_ptr<Utilities::PerfCounters> makePerfCounters()
+  {
+    if (!mOptions.perfCounters) {
+      return {};
+    }
+    auto counters = std::make_unique<Utilities::PerfCounters>();
+    if (!counters->getError().empty()) {
+      std::lock_guard<std::mutex> lock(mPerfMutex);
+      mPerfError = counters->getError();
+    }
+    return counters;
+  }
+
   /// Free the pages that remain after stopping DMA (these may not be filled)
   int freeExcessPages(std::chrono::milliseconds timeout)
   {
@@ -606,8 +809,7 @@ class ProgramDmaBench : public Program
       if (mCardType == CardType::Cru && mDataSource != DataSource::Internal) {
         linkId = DataFormat::getLinkId(reinterpret_cast<const char*>(pageAddress));
         if (linkId >= mDataGeneratorCounters.size()) {
-          mReadoutStream.open("LINK_ID_OUT_OF_RANGE.bin");
-          mReadoutStream.write(reinterpret_cast<const char*>(pageAddress), mSuperpageSize);
+          recordError(ErrorType::LinkIdRange, readoutCount, 0, 0, 0, mDataGeneratorCounters.size(), linkId, 0);
           BOOST_THROW_EXCEPTION(Exception()
                                 << ErrorInfo::Message("Link ID from superpage out of range")
                                 << ErrorInfo::Index(linkId));
@@ -661,7 +863,7 @@ class ProgramDmaBench : public Program
     // Get initial data counter value from page
     if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
       auto dataCounter = getDataGeneratorCounterFromPage(pageAddress, 0x0); // no header!
-      mErrorStream << b::format("resync dataCounter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
+      recordError(ErrorType::ResyncData, eventNumber, linkId, 0, 0, 0, dataCounter, 0);
       mDataGeneratorCounters[linkId] = dataCounter - 1; // -- so that the for loop offset incrementer logic is consistent
     }
 
@@ -695,130 +897,56 @@ class ProgramDmaBench : public Program
 
   bool checkErrorsCruDdg(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId, bool atStartOfSuperpage)
   {
-    // Get memsize from the header
-    const auto memBytes = DataFormat::getMemsize(reinterpret_cast<const char*>(pageAddress)); // Memory size [RDH, Payload]
-
-    if (memBytes < 0x40 || memBytes > pageSize) {
-      // Report RDH error
-      mErrorCount++;
-      if (mErrorCount < MAX_RECORDED_ERRORS) {
-        mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% words out of range\n") % eventNumber % linkId % memBytes % pageSize;
-      }
-      return true;
-    }
-
-    // check link's packet counter here
-    const auto packetCounter = DataFormat::getPacketCounter(reinterpret_cast<const char*>(pageAddress));
-
-    if (mPacketCounters[linkId] == PACKET_COUNTER_INITIAL_VALUE) {
-      mErrorStream << b::format("resync packet counter for e:%d l:%d packet_cnt:%x mpacket_cnt:%x le:%d \n") % eventNumber % linkId % packetCounter %
-                        mPacketCounters[linkId] % mEventCounters[linkId];
-      mPacketCounters[linkId] = packetCounter;
-    } else if (((mPacketCounters[linkId] + mErrorCheckFrequency) % (mMaxRdhPacketCounter + 1)) != packetCounter) { //packetCounter is 8bits long
-      // log packet counter error
-      mErrorCount++;
-      if (mErrorCount < MAX_RECORDED_ERRORS) {
-        mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% packet_cnt:%5% mpacket_cnt:%6% levent:%7% unexpected packet counter\n") % eventNumber % linkId % memBytes % pageSize % packetCounter % mPacketCounters[linkId] % mEventCounters[linkId];
-      }
-      return true;
-    } else {
-      mPacketCounters[linkId] = packetCounter; // same as = (mPacketCounters + mErrorCheckFrequency) % mMaxRdhPacketCounter
-    }
-
-    // check that the TimeFrame starts at the beginning of the superpage
-    const auto triggerType = DataFormat::getTriggerType(reinterpret_cast<const char*>(pageAddress));
-    const auto pagesCounter = DataFormat::getPagesCounter(reinterpret_cast<const char*>(pageAddress));
-
-    if (Utilities::getBit(triggerType, 11) == 0x1 &&
-        pagesCounter == 0x0 &&
-        !atStartOfSuperpage) {
-      // log TF not at the beginning of the superpage error
-      mErrorCount++;
-      if (mErrorCount < MAX_RECORDED_ERRORS) {
-        mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% packet_cnt:%5% mpacket_cnt:%6% levent:%7% TF unaligned w/ start of superpage\n") % eventNumber % linkId % memBytes % pageSize % packetCounter % mPacketCounters[linkId] % mEventCounters[linkId];
-      }
-    }
-
-    // Skip data check if fast check enabled
-    if (mFastCheckEnabled) {
-      return false;
-    }
-
-    // Get counter value only if page is valid...
-    const auto dataCounter = getDataGeneratorCounterFromPage(pageAddress, DataFormat::getHeaderSize());
-    if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
-      mErrorStream << b::format("resync counter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
-      mDataGeneratorCounters[linkId] = dataCounter;
-    }
-    //const uint32_t dataCounter = mDataGeneratorCounters[linkId];
-
-    //skip the header -> address + 0x40
-    const auto payload = reinterpret_cast<const volatile uint32_t*>(pageAddress + DataFormat::getHeaderSize());
-    const auto payloadBytes = memBytes - DataFormat::getHeaderSize();
-
-    bool foundError = false;
-    auto checkValue = [&](uint32_t i, uint32_t expectedValue, uint32_t actualValue) {
-      if (expectedValue != actualValue) {
-        foundError = true;
-        addError(eventNumber, linkId, i, dataCounter, expectedValue, actualValue, payloadBytes);
-      }
-    };
-
-    // Check iterating through 256-bit words
-    uint32_t offset = (dataCounter % (0x100000000)); // mod 0xffffffff + 1
-    uint32_t i = 0;
-
-    // ddg pattern
-    // Every 256-bit word is built as follows:
-    // 32 bits counter       + 32 bits counter       + 16 lsb counter       + 32 bit 0
-    // 32 bits (counter + 1) + 32 bits (counter + 1) + 16 lsb (counter + 1) + 32 bit 0
-
-    while ((i * 4) < payloadBytes) {
-      uint32_t word32 = i; // 32-bit word pointer
-
-      checkValue(word32 + 0, offset, payload[word32 + 0]);          //32-bit counter
-      checkValue(word32 + 1, offset, payload[word32 + 1]);          //32-bit counter
-      checkValue(word32 + 2, offset & 0xffff, payload[word32 + 2]); //16-lsb truncated counter
-      checkValue(word32 + 3, 0x0, payload[word32 + 3]);             //32-bit 0-padding word
-
-      offset = (offset + 1) % (0x100000000); //Increase counter by 1 - mod 0xffffffff + 1
-      i += 4;                                // 4 = expected sizeof(uint32_t);
-    }
-    mDataGeneratorCounters[linkId] = offset;
-    return foundError;
+    return mDdgCheck.checkPage(reinterpret_cast<const char*>(pageAddress), pageSize, atStartOfSuperpage,
+                               mPacketCounters[linkId], mDataGeneratorCounters[linkId], mEventCounters[linkId],
+                               [&](ErrorType::type type, uint32_t counter, uint32_t index, uint32_t expected,
+                                   uint32_t actual, uint32_t size) {
+                                 recordError(type, eventNumber, linkId, counter, index, expected, actual, size);
+                               });
   }
 
   void addError(int64_t eventNumber, int linkId, int index, uint32_t generatorCounter, uint32_t expectedValue,
                 uint32_t actualValue, uint32_t payloadBytes)
   {
-    mErrorCount++;
-    if (mErrorCount < MAX_RECORDED_ERRORS) {
-      mErrorStream << b::format("[ERROR]\tevent:%d link:%d cnt:%x payloadBytes:%d i:%d exp:%x val:%x\n") % eventNumber % linkId % generatorCounter % payloadBytes % index % expectedValue % actualValue;
+    recordError(ErrorType::DataMismatch, eventNumber, linkId, generatorCounter, index, expectedValue, actualValue,
+                payloadBytes);
+  }
+
+  /// Stores an error in binary form, formatting happens only when the errors are output
+  void recordError(ErrorType::type type, int64_t eventNumber, int linkId, uint32_t counter, uint32_t index,
+                   uint32_t expected, uint32_t actual, uint32_t size)
+  {
+    if (ErrorType::isError(type)) {
+      mErrorCount++;
     }
+    ErrorRecord record;
+    record.event = eventNumber;
+    record.link = linkId;
+    record.type = type;
+    record.counter = counter;
+    record.index = index;
+    record.expected = expected;
+    record.actual = actual;
+    record.size = size;
+    mErrorRecorder.record(record);
   }
 
   bool checkErrorsCrorc(uintptr_t pageAddress, size_t pageSize, int64_t eventNumber, int linkId)
   {
     const auto memBytes = DataFormat::getMemsize(reinterpret_cast<const char*>(pageAddress));
     if (memBytes > pageSize) {
-      mErrorCount++;
-      if (mErrorCount < MAX_RECORDED_ERRORS) {
-        mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% payloadBytes:%3% size:%4% words out of ranger\n") % eventNumber % linkId % memBytes % pageSize;
-      }
+      recordError(ErrorType::RdhSizeRange, eventNumber, linkId, 0, 0, pageSize, memBytes, 0);
       return true;
     }
 
     uint32_t packetCounter = DataFormat::getPacketCounter(reinterpret_cast<const char*>(pageAddress));
 
     if (mPacketCounters[linkId] == PACKET_COUNTER_INITIAL_VALUE) {
-      mErrorStream << b::format("resync packet counter for e%d l:%d packet_cnt:%x mpacket_cnt:%x, le:%d \n") % eventNumber % linkId % packetCounter %
-                        mPacketCounters[linkId] % mEventCounters[linkId];
+      recordError(ErrorType::ResyncPacket, eventNumber, linkId, mEventCounters[linkId], 0, 0, packetCounter, 0);
       mPacketCounters[linkId] = packetCounter;
     } else if (((mPacketCounters[linkId] + mErrorCheckFrequency) % (mMaxRdhPacketCounter + 1)) != packetCounter) {
-      mErrorCount++;
-      if (mErrorCount < MAX_RECORDED_ERRORS) {
-        mErrorStream << b::format("[RDHERR]\tevent:%1% l:%2% packet_cnt:%3% mpacket_cnt:%4% unexpected packet counter\n") % eventNumber % linkId % packetCounter % mPacketCounters[linkId];
-      }
+      recordError(ErrorType::PacketCounter, eventNumber, linkId, mEventCounters[linkId], 0, mPacketCounters[linkId],
+                  packetCounter, memBytes);
       return true;
     } else {
       mPacketCounters[linkId] = packetCounter;
@@ -831,7 +959,7 @@ class ProgramDmaBench : public Program
     // Get counter value only if page is valid...
     const auto dataCounter = getDataGeneratorCounterFromPage(pageAddress, DataFormat::getHeaderSize());
     if (mDataGeneratorCounters[linkId] == DATA_COUNTER_INITIAL_VALUE) {
-      mErrorStream << b::format("resync counter for e:%d l:%d cnt:%x\n") % eventNumber % linkId % dataCounter;
+      recordError(ErrorType::ResyncData, eventNumber, linkId, 0, 0, 0, dataCounter, 0);
       mDataGeneratorCounters[linkId] = dataCounter;
     }
 
@@ -921,6 +1049,36 @@ class ProgramDmaBench : public Program
          << line2;
   }
 
+  /// Sets up the throughput model from the options and the card's PCIe link
+  void initThroughputModel(const Parameters& params)
+  {
+    auto& model = mModelConfiguration;
+    model.cardType = mCardType;
+    model.gbtMode = GbtMode::fromString(mOptions.gbtMode);
+    model.datapathMode = DatapathMode::fromString(mOptions.datapathMode);
+    if (mDataSource == DataSource::Internal) {
+      model.links = 0;
+    } else {
+      model.links = (mCardType == CardType::Crorc) ? 1 : params.getLinkMaskRequired().size();
+    }
+    model.dmaPageSize = mPageSize;
+    model.rdhSize = (mCardType == CardType::Crorc) ? 0 : DataFormat::getHeaderSize();
+    model.packetSize = mOptions.packetSize;
+    model.superpageSize = mSuperpageSize;
+
+    if (auto link = Utilities::getPcieLink(mChannel->getPciAddress())) {
+      model.pcieGigatransfersPerSecond = link->gigatransfersPerSecond;
+      model.pcieLanes = link->lanes;
+    } else {
+      // Nominal links: the C-RORC is PCIe Gen2 x8, a CRU endpoint Gen3 x8
+      model.pcieGigatransfersPerSecond = (mCardType == CardType::Crorc) ? 5.0 : 8.0;
+      model.pcieLanes = 8;
+      getLogger() << InfoLogger::Warning << "Could not read PCIe link, assuming nominal link for throughput model"
+                  << endm;
+    }
+    getLogger() << "PCIe link: " << model.pcieGigatransfersPerSecond << " GT/s x" << model.pcieLanes << endm;
+  }
+
   void outputStats()
   {
     // Calculating throughput
@@ -950,6 +1108,26 @@ class ProgramDmaBench : public Program
       } else {
         put("Errors", mErrorCount);
       }
+
+      // The byte count is of the written bytes, the model is of the filled buffer
+      ThroughputModel model(mModelConfiguration);
+      double bufferBytesPerSecond = (mOptions.byteCountEnabled ? bytes / model.getWrittenFraction() : bytes) / runTime;
+      for (const auto& ceiling : model.getCeilings()) {
+        if (std::isinf(ceiling.bytesPerSecond)) {
+          put("Model " + ceiling.layer + " GB/s", "n/a");
+        } else {
+          put("Model " + ceiling.layer + " GB/s", b::format("%.3f (%.1f%% used)") % (ceiling.bytesPerSecond / 1e9)
+                                                     % (100 * bufferBytesPerSecond / ceiling.bytesPerSecond));
+        }
+      }
+      put("Model limited by", model.getLimit().layer);
+      put("Model payload GB/s", model.getLimit().bytesPerSecond * model.getPayloadFraction() / 1e9);
+    }
+    if (mOptions.perfCounters) {
+      outputPerfCounters(put, bytes);
+    }
+    if (mConsumerLag) {
+      outputConsumerLag();
     }
     if (mBufferFullCheck) {
       put("Total time needed to fill the buffer (ns) ", std::chrono::duration_cast<std::chrono::nanoseconds>(mBufferFullTimeFinish - mBufferFullTimeStart).count());
@@ -967,18 +1145,89 @@ class ProgramDmaBench : public Program
       put("BAR MB/s", MBs);
     }
 
+    if (mMemoryLoad) {
+      double loadGB = mMemoryLoad->getBytes() / (1000 * 1000 * 1000);
+      put("Memory load mode", MemoryLoad::toString(mMemoryLoad->getMode()));
+      put("Memory load threads", mMemoryLoad->getThreads());
+      put("Memory load GB", loadGB);
+      put("Memory load GB/s", loadGB / mMemoryLoad->getSeconds());
+      if (mDroppedPackets.isValid()) {
+        put("Dropped packets", mDroppedPackets.getDelta());
+      } else {
+        put("Dropped packets", "n/a");
+      }
+    }
+
     cout << '\n';
   }
 
+  template <typename Put>
+  void outputPerfCounters(Put put, double bytes)
+  {
+    if (!mPerfError.empty()) {
+      put("Perf unavailable", mPerfError);
+    }
+    const double superpages = mSuperpagesReadOut.load();
+    const double GB = bytes / (1000 * 1000 * 1000);
+    auto putRegion = [&](std::string name, const Utilities::PerfRegion& region) {
+      const auto& total = region.getTotal();
+      if (region.getCalls() == 0 || total.timeEnabled == 0 || superpages == 0) {
+        return;
+      }
+      for (int i = 0; i < Utilities::PerfEvent::COUNT; ++i) {
+        auto event = Utilities::PerfEvent::type(i);
+        double count = total[event];
+        put("Perf " + name + " " + Utilities::PerfEvent::toString(event),
+            (count == 0) ? std::string("n/a") : (b::format("%.4g /SP, %.4g /GB") % (count / superpages) % (count / GB)).str());
+      }
+      if (total[Utilities::PerfEvent::Cycles] > 0) {
+        put("Perf " + name + " IPC", double(total[Utilities::PerfEvent::Instructions]) / total[Utilities::PerfEvent::Cycles]);
+      }
+    };
+    putRegion("poll", mPerfPoll);
+    putRegion("push", mPerfPush);
+    putRegion("readout", mPerfReadout);
+  }
+
+  /// Prints the processing cost against the delay, one line per delay
+  void outputConsumerLag()
+  {
+    cout << '\n'
+         << b::format("  %-12s  %-10s  %-10s  %-10s  %-8s  %-14s\n") % "Lag (us)" % "Superpages" % "Mean depth"
+              % "Max depth" % "ns/KiB" % "LLC misses/KiB";
+    for (const auto& step : mConsumerLag->getSteps()) {
+      if (step.superpages == 0) {
+        continue;
+      }
+      const double KiB = double(step.bytes) / 1024;
+      cout << b::format("  %-12d  %-10d  %-10.1f  %-10d  %-8.1f  %-14s\n") % step.delay.count() % step.superpages
+                % (double(step.depthSum) / step.superpages) % step.maxDepth % (step.seconds * 1e9 / KiB)
+                % (mConsumerLag->isLlcMissesAvailable() ? (b::format("%.2f") % (step.llcMisses / KiB)).str() : "n/a");
+    }
+  }
+
   void outputErrors()
   {
-    auto errorStr = mErrorStream.str();
+    if (mErrorRecorder.empty()) {
+      return;
+    }
 
-    if (!errorStr.empty()) {
-      getLogger() << "Outputting " << std::min(mErrorCount, MAX_RECORDED_ERRORS) << " errors to '"
+    if (mOptions.errorsBinary) {
+      getLogger() << "Outputting " << mErrorRecorder.getRecords().size() << " error records to '"
+                  << READOUT_ERRORS_BINARY_PATH << "', decode with roc-decode-errors" << endm;
+      std::ofstream stream(READOUT_ERRORS_BINARY_PATH, std::ios::binary);
+      mErrorRecorder.writeBinary(stream);
+    } else {
+      getLogger() << "Outputting " << mErrorRecorder.getRecords().size() << " error records to '"
                   << READOUT_ERRORS_PATH << "'" << endm;
       std::ofstream stream(READOUT_ERRORS_PATH);
-      stream << errorStr;
+      mErrorRecorder.decode(stream);
+    }
+
+    if (mErrorRecorder.getDroppedCount() > 0 || mErrorRecorder.getRateLimitedCount() > 0) {
+      getLogger() << "Not recorded: " << mErrorRecorder.getDroppedCount() << " error records over the limit of "
+                  << MAX_RECORDED_ERRORS << ", " << mErrorRecorder.getRateLimitedCount() << " over the rate limit of "
+                  << MAX_RECORDED_ERRORS_PER_SECOND << "/s" << endm;
     }
   }
 
@@ -1107,6 +1356,24 @@ class ProgramDmaBench : public Program
     size_t maxRdhPacketCounter;
     bool stbrd = false;
     bool byteCountEnabled = false;
+    bool superpageTrace = false;
+    bool errorsBinary = false;
+    bool latency = false;
+    bool linkLiveness = false;
+    bool rateWeighted = false;
+    bool perfCounters = false;
+    bool vfio = false;
+    bool arrivalNotification = false;
+    std::string consumerLag;
+    uint64_t consumerLagSuperpages;
+    std::string idleStrategy;
+    std::string gbtMode;
+    std::string datapathMode;
+    size_t packetSize;
+    std::string memLoadMode;
+    std::string memLoadCores;
+    int memLoadNode = -1;
+    size_t memLoadSize;
   } mOptions;
 
   /// The DMA channel
@@ -1165,17 +1432,44 @@ class ProgramDmaBench : public Program
   /// The base address of the channel DMA buffer
   uintptr_t mBufferBaseAddress;
 
+  /// The reservation of the hugepages of the DMA buffer, listing it in the node-wide registry
+  std::unique_ptr<Utilities::HugepageReservation> mHugepageReservation;
+
   /// The memory mapped file that contains the channel DMA buffer
   std::unique_ptr<MemoryMappedFile> mMemoryMappedFile;
 
   /// Object for BAR throughput testing
   std::unique_ptr<BarHammer> mBarHammer;
 
+  /// Object for CPU memory-bandwidth load during DMA
+  std::unique_ptr<MemoryLoad> mMemoryLoad;
+
+  /// Object for measuring the processing cost against the consumer lag
+  std::unique_ptr<ConsumerLag> mConsumerLag;
+
+  /// Performance counters of the push thread and of the readout thread. They are opened by their thread, and owned
+  /// here so the regions do not outlive them.
+  std::unique_ptr<Utilities::PerfCounters> mPerfCountersPush;
+  std::unique_ptr<Utilities::PerfCounters> mPerfCountersReadout;
+
+  /// CPU performance counts of the poll (fillSuperpages()), push and readout paths. Each is only used by one thread
+  /// while the DMA runs.
+  Utilities::PerfRegion mPerfPoll;
+  Utilities::PerfRegion mPerfPush;
+  Utilities::PerfRegion mPerfReadout;
+
+  /// Why some performance counters are unavailable
+  std::string mPerfError;
+  std::mutex mPerfMutex;
+
+  /// Dropped packets counter of the firmware, read at the start and the end of the memory load
+  ExtendedCounter mDroppedPackets;
+
   /// Stream for file readout, only opened if enabled by the --file program options
   std::ofstream mReadoutStream;
 
-  /// Stream for error output
-  std::ostringstream mErrorStream;
+  /// Binary records of the errors found, for output at the end
+  ErrorRecorder mErrorRecorder{ MAX_RECORDED_ERRORS, MAX_RECORDED_ERRORS_PER_SECOND };
 
   /// Was the header printed?
   bool mHeaderPrinted = false;
@@ -1192,6 +1486,9 @@ class ProgramDmaBench : public Program
   /// The frequency of dma pages to error check
   uint64_t mErrorCheckFrequency = 1;
 
+  /// Check of the pages of the CRU's data generator
+  DdgCheck mDdgCheck;
+
   struct RunTime {
     TimePoint start; ///< Start of run time
     TimePoint end;   ///< End of run time
@@ -1211,6 +1508,9 @@ class ProgramDmaBench : public Program
 
   /// Data Source
   DataSource::type mDataSource;
+
+  /// Configuration of the throughput model the measured throughput is compared to
+  ThroughputModel::Configuration mModelConfiguration;
 };
 
 int main(int argc, char** argv)
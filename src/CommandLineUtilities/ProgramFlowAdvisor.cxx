@@ -0,0 +1,362 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProgramFlowAdvisor.cxx
+/// \brief Utility that sweeps the flow control settings against superpage supply rates, and recommends one
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
+#include "CommandLineUtilities/Options.h"
+#include "CommandLineUtilities/Program.h"
+#include "Cru/CruBar.h"
+#include "FlowControlAdvisor.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/CounterMonitor.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "Utilities/Hugetlbfs.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+using namespace AliceO2::InfoLogger;
+namespace po = boost::program_options;
+
+namespace
+{
+
+/// Parses a comma separated list of numbers, e.g. "500,1000"
+template <typename T>
+std::vector<T> parseList(const std::string& string, const std::string& option)
+{
+  std::vector<T> values;
+  std::vector<std::string> items;
+  boost::split(items, string, boost::is_any_of(","));
+  for (auto item : items) {
+    boost::trim(item);
+    T value;
+    if (!boost::conversion::try_lexical_convert<T>(item, value)) {
+      BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("Malformed list '" + string + "' of " + option));
+    }
+    values.push_back(value);
+  }
+  return values;
+}
+
+/// Reads the flow control settings of the datapath wrappers, and writes them back on destruction
+class FlowControlRestorer
+{
+ public:
+  FlowControlRestorer(std::shared_ptr<CruBar> cruBar) : mCruBar(cruBar), mInfo(cruBar->getFlowControlInfo())
+  {
+  }
+
+  ~FlowControlRestorer()
+  {
+    try {
+      mCruBar->setFlowControlInfo(mInfo);
+    } catch (const std::exception& e) {
+      std::cerr << "Failed to restore the flow control settings: " << e.what() << std::endl;
+    }
+  }
+
+  FlowControlRestorer(const FlowControlRestorer&) = delete;
+  FlowControlRestorer& operator=(const FlowControlRestorer&) = delete;
+
+ private:
+  std::shared_ptr<CruBar> mCruBar;
+  Cru::FlowControlInfo mInfo;
+};
+
+} // Anonymous namespace
+
+class ProgramFlowAdvisor : public Program
+{
+ public:
+  virtual Description getDescription()
+  {
+    return { "Flow Advisor", "Recommend the flow control and trigger window settings of the CRU",
+             "Measures the accepted, rejected, forced and dropped packets of every flow control setting (with and without\n"
+             "rejection, and every trigger window size) against a range of superpage supply rates, and recommends the\n"
+             "setting with the highest accepted throughput at the consumer budget. Settings that drop packets are only\n"
+             "recommended if all do. On a CRU the data comes from the given source, usually the internal generator.\n"
+             "On the dummy card (--id -1) the wrapper is simulated, with the triggers described by the --model-* options.\n"
+             "roc-flow-advisor --id -1\n"
+             "roc-flow-advisor --id 42:00.0 --links 0-11 --supply-rates 500,1000,2000 --budget 1000" };
+  }
+
+  virtual void addOptions(boost::program_options::options_description& options)
+  {
+    Options::addOptionCardId(options);
+    Options::addOptionChannel(options);
+    options.add_options()("budget",
+                          po::value<double>(&mOptions.budget)->default_value(0),
+                          "Superpages per second the consumer can supply, 0 for the highest supply rate");
+    options.add_options()("csv-out",
+                          po::bool_switch(&mOptions.csvOut),
+                          "Toggle csv-formatted output");
+    options.add_options()("data-source",
+                          po::value<std::string>(&mOptions.dataSource)->default_value("DDG"),
+                          "Data source of the CRU [FEE, INTERNAL, DDG]");
+    options.add_options()("duration",
+                          po::value<double>(&mOptions.duration)->default_value(1.0),
+                          "Seconds to measure every setting and supply rate for (simulated ones on the dummy card)");
+    options.add_options()("links",
+                          po::value<std::string>(&mOptions.links)->default_value("0"),
+                          "Links of the CRU to enable, e.g. 0-11");
+    options.add_options()("max-drop-rate",
+                          po::value<double>(&mOptions.maxDroppedRate)->default_value(0),
+                          "Dropped packets per second still acceptable for a recommended setting");
+    options.add_options()("model-buffer-words",
+                          po::value<uint32_t>(&mModel.bufferWords)->default_value(mModel.bufferWords),
+                          "Simulated buffer of the wrapper in GBT words");
+    options.add_options()("model-links",
+                          po::value<int>(&mModel.links)->default_value(mModel.links),
+                          "Simulated links");
+    options.add_options()("model-trigger-rate",
+                          po::value<double>(&mModel.triggerRate)->default_value(mModel.triggerRate),
+                          "Simulated triggers per second per link");
+    options.add_options()("model-trigger-words",
+                          po::value<std::string>(&mOptions.triggerWords)->default_value("400,1200"),
+                          "Minimum and maximum size of the simulated triggers in GBT words");
+    options.add_options()("superpage-size",
+                          po::value<size_t>(&mOptions.superpageSizeMiB)->default_value(1),
+                          "Superpage size in MiB");
+    options.add_options()("superpages",
+                          po::value<size_t>(&mOptions.superpages)->default_value(32),
+                          "Superpages in the DMA buffer of the CRU, and in the simulated transfer queue");
+    options.add_options()("supply-rates",
+                          po::value<std::string>(&mOptions.supplyRates)->default_value("1000,1500,2000,2500,3000"),
+                          "Comma separated list of superpage supply rates in superpages per second");
+    options.add_options()("trigger-windows",
+                          po::value<std::string>(&mOptions.triggerWindows)->default_value("250,500,1000,2000,4000"),
+                          "Comma separated list of trigger window sizes in GBT words, at most 4095");
+  }
+
+  virtual void run(const boost::program_options::variables_map& map)
+  {
+    auto supplyRates = parseList<double>(mOptions.supplyRates, "--supply-rates");
+    auto triggerWindows = parseList<uint32_t>(mOptions.triggerWindows, "--trigger-windows");
+    for (auto window : triggerWindows) {
+      if (window > 4095) {
+        BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("Trigger window sizes are at most 4095 GBT words"));
+      }
+    }
+    if (mOptions.budget > 0 && std::find(supplyRates.begin(), supplyRates.end(), mOptions.budget) == supplyRates.end()) {
+      supplyRates.push_back(mOptions.budget);
+    }
+    std::sort(supplyRates.begin(), supplyRates.end());
+
+    std::vector<FlowControlSetting> settings;
+    for (bool allowRejection : { false, true }) {
+      for (auto window : triggerWindows) {
+        settings.push_back({ allowRejection, window });
+      }
+    }
+
+    auto cardId = Options::getOptionCardId(map);
+    auto bar2 = ChannelFactory().getBar(Parameters::makeParameters(cardId, 2));
+    std::shared_ptr<CruBar> cruBar2;
+    if (bar2->getCardType() == CardType::Cru) {
+      cruBar2 = std::dynamic_pointer_cast<CruBar>(bar2);
+      mapBuffer(map);
+    } else if (bar2->getCardType() == CardType::Dummy) {
+      auto triggerWords = parseList<uint32_t>(mOptions.triggerWords, "--model-trigger-words");
+      if (triggerWords.size() != 2 || triggerWords[0] > triggerWords[1]) {
+        BOOST_THROW_EXCEPTION(InvalidOptionValueException() << ErrorInfo::Message("--model-trigger-words needs a minimum and a maximum"));
+      }
+      mModel.triggerWordsMin = triggerWords[0];
+      mModel.triggerWordsMax = triggerWords[1];
+      mModel.pagesPerSuperpage = (mOptions.superpageSizeMiB * 1024 * 1024) / (8 * 1024);
+      mModel.transferQueueSuperpages = mOptions.superpages;
+      mModel.seconds = mOptions.duration;
+    } else {
+      std::cout << "Flow control is only available on the CRU" << std::endl;
+      return;
+    }
+
+    // The card gets its own settings back after the sweep, also if it is cut short by an exception
+    boost::optional<FlowControlRestorer> restorer;
+    if (cruBar2) {
+      restorer.emplace(cruBar2);
+    }
+
+    auto formatHeader = "  %-9s %-8s %-12s %-14s %-14s %-14s %-14s\n";
+    auto formatRow = "  %-9s %-8d %-12.0f %-14.1f %-14.1f %-14.1f %-14.1f\n";
+    auto header = (boost::format(formatHeader) % "Rejection" % "Window" % "Supply SP/s" % "Accepted/s" % "Rejected/s" %
+                   "Forced/s" % "Dropped/s")
+                    .str();
+    auto lineFat = std::string(header.length(), '=') + '\n';
+    auto lineThin = std::string(header.length(), '-') + '\n';
+    if (mOptions.csvOut) {
+      std::cout << "Rejection,Window,Supply SP/s,Accepted/s,Rejected/s,Forced/s,Dropped/s\n";
+    } else {
+      std::cout << lineFat << header << lineThin;
+    }
+
+    FlowControlAdvisor advisor;
+    for (const auto& setting : settings) {
+      for (auto supplyRate : supplyRates) {
+        if (isSigInt()) {
+          break;
+        }
+        FlowControlAdvisor::Measurement measurement;
+        measurement.setting = setting;
+        measurement.supplyRate = supplyRate;
+        if (cruBar2) {
+          cruBar2->setFlowControl(setting.allowRejection, setting.triggerWindowSize);
+          measure(cardId, map, bar2, measurement);
+        } else {
+          measurement.counts = FlowControlModel(mModel).run(setting, supplyRate);
+          measurement.seconds = mOptions.duration;
+        }
+        advisor.add(measurement);
+
+        auto rate = [&](uint64_t count) { return measurement.seconds > 0 ? count / measurement.seconds : 0.0; };
+        auto rejection = setting.allowRejection ? "on" : "off";
+        const auto& counts = measurement.counts;
+        if (mOptions.csvOut) {
+          std::cout << rejection << "," << setting.triggerWindowSize << "," << supplyRate << "," << rate(counts.accepted)
+                    << "," << rate(counts.rejected) << "," << rate(counts.forced) << "," << rate(counts.dropped) << "\n";
+        } else {
+          std::cout << boost::format(formatRow) % rejection % setting.triggerWindowSize % supplyRate %
+                         rate(counts.accepted) % rate(counts.rejected) % rate(counts.forced) % rate(counts.dropped);
+        }
+      }
+    }
+
+    restorer.reset();
+
+    if (mOptions.csvOut) {
+      return;
+    }
+    std::cout << lineFat;
+    auto best = advisor.recommend(mOptions.budget, mOptions.maxDroppedRate);
+    if (!best) {
+      std::cout << "No supply rate within the budget\n";
+      return;
+    }
+    std::cout << boost::format("Recommended: rejection %s, trigger window %d GBT words (%.1f accepted and %.1f dropped "
+                               "packets/s at %.0f superpages/s)\n") %
+                   (best->setting.allowRejection ? "on" : "off") % best->setting.triggerWindowSize %
+                   best->getAcceptedRate() % best->getDroppedRate() % best->supplyRate;
+    std::cout << "  roc-config" << (best->setting.allowRejection ? " --allow-rejection" : "")
+              << " --trigger-window-size " << best->setting.triggerWindowSize << "\n";
+    if (best->getDroppedRate() > mOptions.maxDroppedRate) {
+      std::cout << "All settings drop packets at this supply rate\n";
+    }
+  }
+
+ private:
+  void mapBuffer(const boost::program_options::variables_map& map)
+  {
+    mSuperpageSize = mOptions.superpageSizeMiB * 1024 * 1024;
+    auto bufferName = (boost::format("roc-flow-advisor_id=%s_chan=%s_pages") % map["id"].as<std::string>() %
+                       Options::getOptionChannel(map))
+                        .str();
+    mMemoryMappedFile = Utilities::tryMapFile(mSuperpageSize * mOptions.superpages, bufferName, true, nullptr,
+                                              &mHugepageReservation);
+  }
+
+  /// Runs the DMA of the CRU for the duration, supplying superpages at the rate of the measurement, and reads the packet
+  /// counters over it
+  void measure(Parameters::CardIdType cardId, const boost::program_options::variables_map& map,
+               std::shared_ptr<BarInterface> bar2, FlowControlAdvisor::Measurement& measurement)
+  {
+    auto params = Parameters::makeParameters(cardId, Options::getOptionChannel(map));
+    params.setBufferParameters(buffer_parameters::Memory{ mMemoryMappedFile->getAddress(), mMemoryMappedFile->getSize() });
+    params.setLinkMask(Parameters::linkMaskFromString(mOptions.links));
+    params.setDataSource(DataSource::fromString(mOptions.dataSource));
+    auto channel = ChannelFactory().getDmaChannel(params);
+
+    std::deque<size_t> freeSuperpages;
+    for (size_t i = 0; i < mOptions.superpages; ++i) {
+      freeSuperpages.push_back(i * mSuperpageSize);
+    }
+
+    CounterMonitor monitor(bar2);
+    monitor.sample();
+    channel->startDma();
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(mOptions.duration));
+    auto lastSample = start;
+    auto lastSupply = start;
+    double credit = 0;
+    while (!isSigInt()) {
+      auto now = std::chrono::steady_clock::now();
+      if (now >= end) {
+        break;
+      }
+      // The consumer frees superpages at the supply rate, and no faster
+      credit = std::min(double(mOptions.superpages),
+                        credit + std::chrono::duration<double>(now - lastSupply).count() * measurement.supplyRate);
+      lastSupply = now;
+      while (credit >= 1.0 && !freeSuperpages.empty() && channel->getTransferQueueAvailable() > 0) {
+        channel->pushSuperpage(Superpage(freeSuperpages.front(), mSuperpageSize));
+        freeSuperpages.pop_front();
+        credit -= 1.0;
+      }
+      channel->fillSuperpages();
+      while (channel->getReadyQueueSize() > 0) {
+        freeSuperpages.push_back(channel->popSuperpage().getOffset());
+      }
+      // Sampled often enough to extend the counters past their wraps
+      if (now - lastSample > std::chrono::milliseconds(100)) {
+        monitor.sample();
+        lastSample = now;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+
+    monitor.sample();
+    channel->stopDma();
+    auto snapshot = monitor.getSnapshot();
+    measurement.seconds = std::chrono::duration<double>(snapshot.time - start).count();
+    for (const auto& el : snapshot.links) {
+      measurement.counts.accepted += el.second.accepted.getDelta();
+      measurement.counts.rejected += el.second.rejected.getDelta();
+      measurement.counts.forced += el.second.forced.getDelta();
+    }
+    for (const auto& el : snapshot.wrappers) {
+      measurement.counts.dropped += el.second.dropped.getDelta();
+    }
+  }
+
+  struct OptionsStruct {
+    double budget = 0;
+    bool csvOut = false;
+    std::string dataSource;
+    double duration = 1.0;
+    std::string links;
+    double maxDroppedRate = 0;
+    size_t superpageSizeMiB = 1;
+    size_t superpages = 32;
+    std::string supplyRates;
+    std::string triggerWindows;
+    std::string triggerWords;
+  } mOptions;
+
+  FlowControlModel::Configuration mModel;
+  size_t mSuperpageSize = 0;
+  std::unique_ptr<Utilities::HugepageReservation> mHugepageReservation;
+  std::unique_ptr<MemoryMappedFile> mMemoryMappedFile;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramFlowAdvisor().execute(argc, argv);
+}
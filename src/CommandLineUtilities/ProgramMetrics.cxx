@@ -13,9 +13,13 @@
 ///
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include "Cru/Constants.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/CounterMonitor.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
 #include "RocPciDevice.h"
@@ -34,7 +38,8 @@ class ProgramMetrics : public Program
   {
     return { "Metrics", "Return current RoC parameters",
              "roc-metrics --id -1\n"
-             "roc-metrics --id 42:00.0\n" };
+             "roc-metrics --id 42:00.0\n"
+             "roc-metrics --id -1 --duration 10\n" };
   }
 
   virtual void addOptions(boost::program_options::options_description& options)
@@ -43,6 +48,12 @@ class ProgramMetrics : public Program
     options.add_options()("csv-out",
                           po::bool_switch(&mOptions.csvOut),
                           "Toggle csv-formatted output");
+    options.add_options()("duration",
+                          po::value<double>(&mOptions.duration)->default_value(0),
+                          "Sample the dropped packets counter of CRUs for this many seconds and report the 64-bit delta and rate");
+    options.add_options()("interval",
+                          po::value<int>(&mOptions.intervalMs)->default_value(CounterMonitor::DEFAULT_INTERVAL.count()),
+                          "Sampling interval in milliseconds for --duration");
   }
 
   virtual void run(const boost::program_options::variables_map& map)
@@ -66,15 +77,49 @@ class ProgramMetrics : public Program
       std::cout << "Something went wrong parsing the card id" << std::endl;
     }
 
+    // With a duration, the dropped packets are sampled concurrently for all CRUs so the 32-bit register wraps are tracked
+    bool monitoring = mOptions.duration > 0;
+    std::map<std::string, std::unique_ptr<CounterMonitor>> monitors;
+    double elapsed = 0;
+    if (monitoring) {
+      for (const auto& card : cardsFound) {
+        if (card.cardType == CardType::Cru) {
+          monitors[card.pciAddress.toString()] = std::make_unique<CounterMonitor>(card.pciAddress);
+        }
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (auto& monitor : monitors) {
+        monitor.second->start(std::chrono::milliseconds(mOptions.intervalMs));
+      }
+      auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(mOptions.duration));
+      while (std::chrono::steady_clock::now() < end && !isSigInt()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      for (auto& monitor : monitors) {
+        monitor.second->stop();
+        monitor.second->sample();
+      }
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
     std::ostringstream table;
     auto formatHeader = "  %-3s %-6s %-10s %-10s %-19s %-20s %-19s %-8s %-17s %-17s\n";
     auto formatRow = "  %-3s %-6s %-10s %-10s %-19s %-20s %-19s %-8s %-17s %-17s\n";
-    auto header = (boost::format(formatHeader) % "#" % "Type" % "PCI Addr" % "Temp (C)" % "#Dropped Packets" % "CTP Clock (MHz)" % "Local Clock (MHz)" % "#links" % "#Wrapper 0 links" % "#Wrapper 1 links").str();
+    if (monitoring) {
+      formatHeader = "  %-3s %-6s %-10s %-10s %-19s %-14s %-20s %-19s %-8s %-17s %-17s\n";
+      formatRow = "  %-3s %-6s %-10s %-10s %-19s %-14.1f %-20s %-19s %-8s %-17s %-17s\n";
+    }
+    auto headerFormat = boost::format(formatHeader) % "#" % "Type" % "PCI Addr" % "Temp (C)" % "#Dropped Packets";
+    if (monitoring) {
+      headerFormat % "Dropped/s";
+    }
+    auto header = (headerFormat % "CTP Clock (MHz)" % "Local Clock (MHz)" % "#links" % "#Wrapper 0 links" % "#Wrapper 1 links").str();
     auto lineFat = std::string(header.length(), '=') + '\n';
     auto lineThin = std::string(header.length(), '-') + '\n';
 
     if (mOptions.csvOut) {
-      auto csvHeader = "#,Type,PCI Addr,Temp (C),#Dropped Packets,CTP Clock (MHz),Local Clock (MHz),#links,#Wrapper 0 links, #Wrapper 1 links\n";
+      auto csvHeader = monitoring ? "#,Type,PCI Addr,Temp (C),#Dropped Packets,Dropped/s,CTP Clock (MHz),Local Clock (MHz),#links,#Wrapper 0 links, #Wrapper 1 links\n"
+                                  : "#,Type,PCI Addr,Temp (C),#Dropped Packets,CTP Clock (MHz),Local Clock (MHz),#links,#Wrapper 0 links, #Wrapper 1 links\n";
       std::cout << csvHeader;
     } else {
       table << lineFat << header << lineThin;
@@ -88,7 +133,14 @@ class ProgramMetrics : public Program
       auto bar2 = ChannelFactory().getBar(params2);
 
       float temperature = bar2->getTemperature().value_or(0);
-      int32_t dropped = bar2->getDroppedPackets(bar0->getEndpointNumber());
+      int64_t dropped = bar2->getDroppedPackets(bar0->getEndpointNumber());
+      double droppedRate = 0;
+      auto monitor = monitors.find(card.pciAddress.toString());
+      if (monitor != monitors.end()) {
+        auto counter = monitor->second->getSnapshot().wrappers[bar0->getEndpointNumber()].dropped;
+        dropped = counter.getDelta();
+        droppedRate = (elapsed > 0) ? (counter.getDelta() / elapsed) : 0.0;
+      }
       float ctp_clock = bar2->getCTPClock() / 1e6;
       float local_clock = bar2->getLocalClock() / 1e6;
       int32_t links = bar2->getLinks();
@@ -96,10 +148,14 @@ class ProgramMetrics : public Program
       uint32_t links1 = bar2->getLinksPerWrapper(1);
 
       if (mOptions.csvOut) {
-        auto csvLine = std::to_string(i) + "," + CardType::toString(card.cardType) + "," + card.pciAddress.toString() + "," + std::to_string(temperature) + "," + std::to_string(dropped) + "," + std::to_string(ctp_clock) + "," + std::to_string(local_clock) + "," + std::to_string(links) + "," + std::to_string(links0) + "," + std::to_string(links1) + "\n";
+        auto csvLine = std::to_string(i) + "," + CardType::toString(card.cardType) + "," + card.pciAddress.toString() + "," + std::to_string(temperature) + "," + std::to_string(dropped) + "," + (monitoring ? std::to_string(droppedRate) + "," : "") + std::to_string(ctp_clock) + "," + std::to_string(local_clock) + "," + std::to_string(links) + "," + std::to_string(links0) + "," + std::to_string(links1) + "\n";
         std::cout << csvLine;
       } else {
-        auto format = boost::format(formatRow) % i % CardType::toString(card.cardType) % card.pciAddress.toString() % temperature % dropped % ctp_clock % local_clock % links % links0 % links1;
+        auto format = boost::format(formatRow) % i % CardType::toString(card.cardType) % card.pciAddress.toString() % temperature % dropped;
+        if (monitoring) {
+          format % droppedRate;
+        }
+        format % ctp_clock % local_clock % links % links0 % links1;
 
         table << format;
       }
@@ -116,6 +172,8 @@ class ProgramMetrics : public Program
  private:
   struct OptionsStruct {
     bool csvOut = false;
+    double duration = 0;
+    int intervalMs = 0;
   } mOptions;
 };
 
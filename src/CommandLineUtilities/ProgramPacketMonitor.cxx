@@ -13,11 +13,14 @@
 ///
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include "Cru/Common.h"
 #include "Cru/Constants.h"
 #include "Cru/CruBar.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/CounterMonitor.h"
 #include "CommandLineUtilities/Options.h"
 #include "CommandLineUtilities/Program.h"
 #include <boost/format.hpp>
@@ -33,7 +36,8 @@ class ProgramPacketMonitor : public Program
   virtual Description getDescription()
   {
     return { "Packet Monitor", "Return RoC packet monitoring information",
-             "roc-pkt-monitor --id 42:00.0\n" };
+             "roc-pkt-monitor --id 42:00.0\n"
+             "roc-pkt-monitor --id 42:00.0 --duration 60\n" };
   }
 
   virtual void addOptions(boost::program_options::options_description& options)
@@ -42,6 +46,12 @@ class ProgramPacketMonitor : public Program
     options.add_options()("csv-out",
                           po::bool_switch(&mOptions.csvOut),
                           "Toggle csv-formatted output");
+    options.add_options()("duration",
+                          po::value<double>(&mOptions.duration)->default_value(0),
+                          "Sample the counters for this many seconds and report 64-bit deltas and average rates");
+    options.add_options()("interval",
+                          po::value<int>(&mOptions.intervalMs)->default_value(CounterMonitor::DEFAULT_INTERVAL.count()),
+                          "Sampling interval in milliseconds for --duration; must be shorter than the counters' wrap period");
   }
 
   virtual void run(const boost::program_options::variables_map& map)
@@ -60,6 +70,11 @@ class ProgramPacketMonitor : public Program
       return;
     }
 
+    if (mOptions.duration > 0) {
+      monitorCounters(bar2);
+      return;
+    }
+
     auto cruBar2 = std::dynamic_pointer_cast<CruBar>(bar2);
 
     Cru::PacketMonitoringInfo packetMonitoringInfo = cruBar2->monitorPackets();
@@ -141,8 +156,80 @@ class ProgramPacketMonitor : public Program
   }
 
  private:
+  /// Samples the counters over the requested duration, extending them to 64 bits to survive register wraps
+  void monitorCounters(std::shared_ptr<BarInterface> bar2)
+  {
+    CounterMonitor monitor(bar2);
+    auto interval = std::chrono::milliseconds(mOptions.intervalMs);
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(mOptions.duration));
+
+    monitor.sample();
+    while (std::chrono::steady_clock::now() < end && !isSigInt()) {
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(interval, end - std::chrono::steady_clock::now()));
+      monitor.sample();
+    }
+
+    auto snapshot = monitor.getSnapshot();
+    double elapsed = std::chrono::duration<double>(snapshot.time - start).count();
+    auto rate = [&](const ExtendedCounter& counter) { return (elapsed > 0) ? (counter.getDelta() / elapsed) : 0.0; };
+
+    /* LINKS */
+    std::ostringstream table;
+    auto formatHeader = "  %-9s %-20s %-20s %-20s %-14s %-14s %-14s\n";
+    auto formatRow = "  %-9s %-20s %-20s %-20s %-14.1f %-14.1f %-14.1f\n";
+    auto header = (boost::format(formatHeader) % "Link ID" % "Accepted" % "Rejected" % "Forced" % "Accepted/s" % "Rejected/s" % "Forced/s").str();
+    auto lineFat = std::string(header.length(), '=') + '\n';
+    auto lineThin = std::string(header.length(), '-') + '\n';
+
+    if (mOptions.csvOut) {
+      std::cout << "Link ID,Accepted,Rejected,Forced,Accepted/s,Rejected/s,Forced/s\n";
+    } else {
+      table << lineFat << header << lineThin;
+    }
+
+    for (const auto& el : snapshot.links) {
+      const auto& link = el.second;
+      if (mOptions.csvOut) {
+        std::cout << el.first << "," << link.accepted.getDelta() << "," << link.rejected.getDelta() << "," << link.forced.getDelta() << ","
+                  << rate(link.accepted) << "," << rate(link.rejected) << "," << rate(link.forced) << "\n";
+      } else {
+        table << boost::format(formatRow) % el.first % link.accepted.getDelta() % link.rejected.getDelta() % link.forced.getDelta() %
+                   rate(link.accepted) % rate(link.rejected) % rate(link.forced);
+      }
+    }
+
+    /* WRAPPERS */
+    formatHeader = "  %-9s %-20s %-14s %-8s\n";
+    formatRow = "  %-9s %-20s %-14.1f %-8s\n";
+    auto wrapperHeader = (boost::format(formatHeader) % "Wrapper" % "Dropped" % "Dropped/s" % "Wraps").str();
+
+    if (mOptions.csvOut) {
+      std::cout << "Wrapper,Dropped,Dropped/s,Wraps\n";
+    } else {
+      table << lineFat << wrapperHeader << lineThin;
+    }
+
+    for (const auto& el : snapshot.wrappers) {
+      const auto& dropped = el.second.dropped;
+      if (mOptions.csvOut) {
+        std::cout << el.first << "," << dropped.getDelta() << "," << rate(dropped) << "," << dropped.getWraps() << "\n";
+      } else {
+        table << boost::format(formatRow) % el.first % dropped.getDelta() % rate(dropped) % dropped.getWraps();
+      }
+    }
+
+    if (!mOptions.csvOut) {
+      table << lineFat;
+      std::cout << "Sampled " << snapshot.samples << " times over " << elapsed << " s\n";
+      std::cout << table.str();
+    }
+  }
+
   struct OptionsStruct {
     bool csvOut = false;
+    double duration = 0;
+    int intervalMs = 0;
   } mOptions;
 };
 
@@ -0,0 +1,104 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProgramRegisterBatch.cxx
+/// \brief Utility that executes a script of register operations
+
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CommandLineUtilities/Program.h"
+#include "CommandLineUtilities/RegisterBatch.h"
+#include "ReadoutCard/ChannelFactory.h"
+
+using namespace AliceO2::roc::CommandLineUtilities;
+using namespace AliceO2::roc;
+namespace po = boost::program_options;
+
+class ProgramRegisterBatch : public Program
+{
+ public:
+  virtual Description getDescription()
+  {
+    return { "Register Batch",
+             "Executes a script of register operations, from a file or stdin, keeping the BARs open.\n"
+             "One operation per line, '#' starts a comment:\n"
+             "  card <id> [channel]\n"
+             "  read <address>\n"
+             "  write <address> <value>\n"
+             "  modify <address> <position> <width> <value>\n"
+             "  wait <address> <position> <width> <value> [timeout ms]\n"
+             "  sleep <microseconds>\n"
+             "Writes one CSV line per operation: line,operation,address,value,status,message",
+             "roc-reg-batch --id=12345 --channel=0 --file=script.txt" };
+  }
+
+  virtual void addOptions(boost::program_options::options_description& options)
+  {
+    Options::addOptionCardId(options);
+    Options::addOptionChannel(options);
+    options.add_options()("file",
+                          po::value<std::string>(&mOptions.file),
+                          "Script to execute, instead of stdin");
+    options.add_options()("keep-going",
+                          po::bool_switch(&mOptions.keepGoing),
+                          "Go on after an operation fails or times out");
+    options.add_options()("line-buffered",
+                          po::bool_switch(&mOptions.lineBuffered),
+                          "Flush every result line. On by default when the script comes from a pipe or a terminal");
+  }
+
+  virtual void run(const boost::program_options::variables_map& map)
+  {
+    // A process that writes the script through a pipe may wait for each result before writing the next operation
+    struct stat stdinStatus;
+    const bool stdinIsFile = fstat(STDIN_FILENO, &stdinStatus) == 0 && S_ISREG(stdinStatus.st_mode);
+    const bool lineBuffered = mOptions.lineBuffered || (mOptions.file.empty() && !stdinIsFile);
+
+    RegisterBatch batch(
+      [](const std::string& cardId, int channel) {
+        return ChannelFactory().getBar(Parameters::cardIdFromString(cardId), channel);
+      },
+      mOptions.keepGoing, lineBuffered);
+
+    if (map.count("id")) {
+      batch.selectCard(Options::getOptionCardIdString(map), map.count("channel") ? Options::getOptionChannel(map) : 0);
+    }
+
+    size_t failures;
+    if (mOptions.file.empty()) {
+      failures = batch.run(std::cin, std::cout);
+    } else {
+      std::ifstream file(mOptions.file);
+      if (!file.is_open()) {
+        BOOST_THROW_EXCEPTION(InvalidOptionValueException()
+                              << ErrorInfo::Message("Failed to open script file '" + mOptions.file + "'"));
+      }
+      failures = batch.run(file, std::cout);
+    }
+    std::cout.flush();
+
+    if (failures > 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(std::to_string(failures) + " operation(s) failed"));
+    }
+  }
+
+  struct OptionsStruct {
+    std::string file;
+    bool keepGoing = false;
+    bool lineBuffered = false;
+  } mOptions;
+};
+
+int main(int argc, char** argv)
+{
+  return ProgramRegisterBatch().execute(argc, argv);
+}
@@ -0,0 +1,318 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file RegisterBatch.h
+/// \brief Definition of the RegisterBatch class.
+
+#ifndef ALICEO2_READOUTCARD_REGISTERBATCH_H
+#define ALICEO2_READOUTCARD_REGISTERBATCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+#include "ReadoutCard/TimeSource.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace CommandLineUtilities
+{
+
+/// Executes a script of register operations against BARs that stay open for the whole script, so that a sequence of
+/// register accesses does not pay for a process start and a BAR mapping per access.
+/// The script has one operation per line, with a word starting with '#' starting a comment, except for the card
+/// sequence numbers like "#0":
+///   card <id> [channel]                                  Selects the BAR of the operations that follow
+///   read <address>
+///   write <address> <value>
+///   modify <address> <position> <width> <value>
+///   wait <address> <position> <width> <value> [timeout ms]  Polls until the bits hold the value, 1000 ms by default
+///   sleep <microseconds>
+/// Addresses are hexadecimal byte addresses, which must be a multiple of 4. Values are decimal, or hexadecimal with a
+/// "0x" prefix, as for the register tools' options.
+/// Every operation writes one CSV line of the form "line,operation,address,value,status,message", where the status is
+/// "ok", "timeout" or "error". When line buffered, every line is flushed as soon as it is written, so a process that
+/// drives the script through a pipe can wait for the result of an operation before it writes the next one.
+class RegisterBatch
+{
+ public:
+  /// Opens the BAR of a card's channel
+  using BarOpener = std::function<std::shared_ptr<RegisterReadWriteInterface>(const std::string& cardId, int channel)>;
+
+  /// \param opener Opens the BARs, once per card and channel
+  /// \param keepGoing Go on after an operation fails, instead of stopping the script
+  /// \param lineBuffered Flush the output after every line
+  RegisterBatch(BarOpener opener, bool keepGoing = false, bool lineBuffered = false)
+    : mOpener(opener), mKeepGoing(keepGoing), mLineBuffered(lineBuffered)
+  {
+  }
+
+  /// Selects the BAR of the operations that follow, as the "card" operation does
+  void selectCard(const std::string& cardId, int channel = 0)
+  {
+    auto key = std::make_pair(cardId, channel);
+    auto found = mBars.find(key);
+    if (found == mBars.end()) {
+      found = mBars.emplace(key, mOpener(cardId, channel)).first;
+    }
+    mBar = found->second.get();
+  }
+
+  /// Executes every line of the script
+  /// \return The number of operations that failed
+  size_t run(std::istream& input, std::ostream& output)
+  {
+    output << "line,operation,address,value,status,message\n";
+    if (mLineBuffered) {
+      output.flush();
+    }
+    size_t failures = 0;
+    size_t lineNumber = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+      lineNumber++;
+      if (!execute(line, lineNumber, output)) {
+        failures++;
+        if (!mKeepGoing) {
+          break;
+        }
+      }
+    }
+    return failures;
+  }
+
+  /// Executes one line of the script, writing its result unless it holds no operation
+  /// \return False if the operation failed or timed out
+  bool execute(const std::string& line, size_t lineNumber, std::ostream& output)
+  {
+    auto tokens = tokenize(line);
+    if (tokens.empty()) {
+      return true;
+    }
+
+    Result result;
+    result.operation = tokens[0];
+    try {
+      executeOperation(tokens, result);
+    } catch (const std::exception& e) {
+      result.status = "error";
+      result.message = getMessage(e);
+    }
+
+    output << lineNumber << ',' << result.operation << ',' << result.address << ',' << result.value << ','
+           << result.status << ',' << result.message << '\n';
+    if (mLineBuffered) {
+      output.flush();
+    }
+    return result.status == "ok";
+  }
+
+  /// Interval between the reads of a "wait" operation
+  static constexpr std::chrono::microseconds POLL_INTERVAL{ 10 };
+
+ private:
+  struct Result {
+    std::string operation;
+    std::string address;
+    std::string value;
+    std::string status = "ok";
+    std::string message;
+  };
+
+  static std::vector<std::string> tokenize(const std::string& line)
+  {
+    std::istringstream stream(line);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (stream >> token) {
+      // A card ID may be a sequence number like "#0"
+      bool isCardId = tokens.size() == 1 && tokens[0] == "card";
+      if (token[0] == '#' && !isCardId) {
+        break;
+      }
+      tokens.push_back(token);
+    }
+    return tokens;
+  }
+
+  static std::string getMessage(const std::exception& e)
+  {
+    std::string message;
+    if (auto info = boost::get_error_info<ErrorInfo::Message>(e)) {
+      message = *info;
+    } else {
+      message = e.what();
+    }
+    // Keep the message in its column
+    for (auto& c : message) {
+      if (c == ',' || c == '\n') {
+        c = ' ';
+      }
+    }
+    return message;
+  }
+
+  static void checkArguments(const std::vector<std::string>& tokens, size_t min, size_t max)
+  {
+    if (tokens.size() < min + 1 || tokens.size() > max + 1) {
+      BOOST_THROW_EXCEPTION(ParseException()
+                            << ErrorInfo::Message("Wrong number of arguments for '" + tokens[0] + "'"));
+    }
+  }
+
+  static uint32_t parseAddress(const std::string& string)
+  {
+    std::istringstream stream(string);
+    uint32_t address;
+    stream >> std::hex >> address;
+    if (stream.fail() || !(stream >> std::ws).eof()) {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Malformed address '" + string + "'"));
+    }
+    if (address % 4 != 0) {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Address must be a multiple of 4"));
+    }
+    return address;
+  }
+
+  static uint32_t parseValue(const std::string& string)
+  {
+    std::istringstream stream;
+    if (string.find("0x") == 0) {
+      stream.str(string.substr(2));
+      stream >> std::hex;
+    } else {
+      stream.str(string);
+    }
+    uint32_t value;
+    stream >> value;
+    if (string.find('-') != std::string::npos || stream.fail() || !(stream >> std::ws).eof()) {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Malformed value '" + string + "'"));
+    }
+    return value;
+  }
+
+  /// Parses a bit field, which must fit in a register
+  static std::pair<int, int> parseField(const std::string& position, const std::string& width)
+  {
+    auto p = parseValue(position);
+    auto w = parseValue(width);
+    // Not p + w > 32, which wraps around for a huge position
+    if (w < 1 || w > 32 || p >= 32 || w > 32 - p) {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Bit field out of the register"));
+    }
+    return { int(p), int(w) };
+  }
+
+  static uint32_t getFieldMask(std::pair<int, int> field)
+  {
+    return (field.second == 32 ? ~uint32_t(0) : ((uint32_t(1) << field.second) - 1)) << field.first;
+  }
+
+  static std::string formatAddress(uint32_t address)
+  {
+    return (boost::format("0x%x") % address).str();
+  }
+
+  static std::string formatValue(uint32_t value)
+  {
+    return (boost::format("0x%08x") % value).str();
+  }
+
+  RegisterReadWriteInterface& getBar()
+  {
+    if (!mBar) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No card selected"));
+    }
+    return *mBar;
+  }
+
+  void executeOperation(const std::vector<std::string>& tokens, Result& result)
+  {
+    const auto& operation = tokens[0];
+    if (operation == "card") {
+      checkArguments(tokens, 1, 2);
+      int channel = tokens.size() > 2 ? int(parseValue(tokens[2])) : 0;
+      selectCard(tokens[1], channel);
+      result.value = tokens[1] + ':' + std::to_string(channel);
+    } else if (operation == "read") {
+      checkArguments(tokens, 1, 1);
+      auto address = parseAddress(tokens[1]);
+      result.address = formatAddress(address);
+      result.value = formatValue(getBar().readRegister(address / 4));
+    } else if (operation == "write") {
+      checkArguments(tokens, 2, 2);
+      auto address = parseAddress(tokens[1]);
+      auto value = parseValue(tokens[2]);
+      result.address = formatAddress(address);
+      getBar().writeRegister(address / 4, value);
+      result.value = formatValue(value);
+    } else if (operation == "modify") {
+      checkArguments(tokens, 4, 4);
+      auto address = parseAddress(tokens[1]);
+      auto field = parseField(tokens[2], tokens[3]);
+      auto value = parseValue(tokens[4]);
+      result.address = formatAddress(address);
+      getBar().modifyRegister(address / 4, field.first, field.second, value);
+      result.value = formatValue(value);
+    } else if (operation == "wait") {
+      checkArguments(tokens, 4, 5);
+      auto address = parseAddress(tokens[1]);
+      auto mask = getFieldMask(parseField(tokens[2], tokens[3]));
+      auto expected = (parseValue(tokens[4]) << parseValue(tokens[2])) & mask;
+      auto timeout = std::chrono::milliseconds(tokens.size() > 5 ? parseValue(tokens[5]) : 1000);
+      result.address = formatAddress(address);
+
+      auto& bar = getBar();
+      auto& timeSource = TimeSource::get();
+      auto start = timeSource.now();
+      uint32_t value;
+      while (((value = bar.readRegister(address / 4)) & mask) != expected) {
+        if (timeSource.now() - start > timeout) {
+          result.status = "timeout";
+          break;
+        }
+        timeSource.sleepFor(POLL_INTERVAL);
+      }
+      result.value = formatValue(value);
+    } else if (operation == "sleep") {
+      checkArguments(tokens, 1, 1);
+      auto duration = std::chrono::microseconds(parseValue(tokens[1]));
+      TimeSource::get().sleepFor(duration);
+      result.value = std::to_string(duration.count());
+    } else {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Unknown operation '" + operation + "'"));
+    }
+  }
+
+  BarOpener mOpener;
+  bool mKeepGoing;
+  bool mLineBuffered;
+  /// BARs opened so far, by card ID and channel
+  std::map<std::pair<std::string, int>, std::shared_ptr<RegisterReadWriteInterface>> mBars;
+  RegisterReadWriteInterface* mBar = nullptr;
+};
+
+} // namespace CommandLineUtilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_REGISTERBATCH_H
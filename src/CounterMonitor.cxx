@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CounterMonitor.cxx
+/// \brief Implementation of the CounterMonitor class.
+
+#include "Cru/CruBar.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/CounterMonitor.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+constexpr std::chrono::milliseconds CounterMonitor::DEFAULT_INTERVAL;
+
+CounterMonitor::CounterMonitor(Parameters::CardIdType cardId)
+  : CounterMonitor(ChannelFactory().getBar(Parameters::makeParameters(cardId, 2))) //counters available on BAR2
+{
+}
+
+CounterMonitor::CounterMonitor(std::shared_ptr<BarInterface> bar2) : mBar2(bar2)
+{
+  if (mBar2->getCardType() != CardType::Cru) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Counter monitoring is only supported for the CRU")
+                                      << ErrorInfo::CardType(mBar2->getCardType()));
+  }
+}
+
+CounterMonitor::~CounterMonitor()
+{
+  stop();
+}
+
+void CounterMonitor::sample()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  sampleLocked();
+}
+
+void CounterMonitor::sampleLocked()
+{
+  auto cruBar2 = std::dynamic_pointer_cast<CruBar>(mBar2);
+
+  // Only the first sample pays for the link map discovery, the rest is the bare counter reads
+  Cru::PacketMonitoringInfo info = cruBar2->monitorPackets(mRefreshLinks);
+  mRefreshLinks = false;
+
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = (mSnapshot.samples == 0) ? 0.0 : std::chrono::duration<double>(now - mSnapshot.time).count();
+
+  for (const auto& el : info.linkPacketInfoMap) {
+    auto& link = mSnapshot.links[el.first];
+    link.accepted.update(el.second.accepted, elapsed);
+    link.rejected.update(el.second.rejected, elapsed);
+    link.forced.update(el.second.forced, elapsed);
+  }
+
+  for (const auto& el : info.wrapperPacketInfoMap) {
+    mSnapshot.wrappers[el.first].dropped.update(el.second.dropped, elapsed);
+  }
+
+  mSnapshot.time = now;
+  mSnapshot.samples++;
+}
+
+void CounterMonitor::start(std::chrono::milliseconds interval)
+{
+  if (mRunning.exchange(true)) {
+    return;
+  }
+
+  mThread = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> waitLock(mWaitMutex);
+    while (mRunning) {
+      sample();
+      mWaitCondition.wait_for(waitLock, interval, [&]() { return !mRunning; });
+    }
+  });
+}
+
+void CounterMonitor::stop()
+{
+  {
+    std::lock_guard<std::mutex> waitLock(mWaitMutex);
+    mRunning = false;
+  }
+  mWaitCondition.notify_all();
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+CounterMonitor::Snapshot CounterMonitor::getSnapshot()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mSnapshot;
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -32,9 +32,11 @@
 #include "Crorc/Constants.h"
 #include "ExceptionInternal.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
+#include "ReadoutCard/TimeSource.h"
+#include "Utilities/IdleStrategy.h"
+#include "Utilities/PcieHealth.h"
 
 using namespace std::chrono_literals;
-using std::this_thread::sleep_for;
 namespace b = boost;
 namespace chrono = std::chrono;
 
@@ -107,7 +109,7 @@ template <typename SleepTime>
 void writeSleep(RegisterReadWriteInterface& bar0, int index, int value, SleepTime sleepTime)
 {
   bar0.writeRegister(index, value);
-  sleep_for(sleepTime);
+  TimeSource::get().sleepFor(sleepTime);
 }
 
 /// Writes to F_IFDSR and sleeps
@@ -143,7 +145,7 @@ void checkStatus(RegisterReadWriteInterface& channel)
     if (readStatus(channel) == MAGIC_VALUE_0) {
       return;
     }
-    sleep_for(100us);
+    TimeSource::get().sleepFor(100us);
   }
   BOOST_THROW_EXCEPTION(TimeoutException() << ErrorInfo::Message("Bad flash status"));
 }
@@ -209,8 +211,11 @@ void wait(RegisterReadWriteInterface& channel)
   int status = 0;
   while (status == 0) {
     status = channel.readRegister(REGISTER_READY);
+    if (status == 0) {
+      Utilities::IdleStrategy::cpuRelax();
+    }
   }
-  sleep_for(1us);
+  TimeSource::get().sleepFor(1us);
 }
 } // Anonymous namespace
 } // namespace Flash
@@ -342,7 +347,7 @@ void programFlash(RegisterReadWriteInterface& channel, std::string dataFilePath,
     out << format("\nCompleted programming %d words\n") % numberOfLinesRead;
     // READ STATUS REG
     channel.writeRegister(Flash::REGISTER_DATA_STATUS, Flash::MAGIC_VALUE_6);
-    sleep_for(1us);
+    TimeSource::get().sleepFor(1us);
     Flash::checkStatus(channel);
   } catch (const InterruptedException& e) {
     out << "Flash programming interrupted\n";
@@ -447,7 +452,20 @@ void Crorc::ddlSendCommand(int dest, uint32_t command, int transid, uint32_t par
 long long int Crorc::ddlWaitStatus(long long int timeout)
 {
   for (int i = 0; i < timeout; ++i) {
-    if (checkRxStatus()) {
+    uint32_t status = read(Rorc::C_CSR);
+    if (Utilities::isAllOnes(status)) {
+      // A lost card reads all ones, which would pass for a full status FIFO
+      if (mPciAddress) {
+        if (!Utilities::isDeviceResponding(*mPciAddress)) {
+          Utilities::throwDeviceLost(*mPciAddress, "waiting on DDL");
+        }
+      } else {
+        BOOST_THROW_EXCEPTION(DeviceLostException() << ErrorInfo::Message("Card does not respond while waiting on DDL")
+                                                    << ErrorInfo::PossibleCauses({ "Card dropped off the PCIe bus",
+                                                                                   "Uncorrectable PCIe error" }));
+      }
+    }
+    if (status & Rorc::CcsrStatus::RXSTAT_NOT_EMPTY) {
       return i;
     }
   }
@@ -646,7 +664,7 @@ void Crorc::ddlResetSiu(int cycle, long long int time)
 
   for (int i = 0; i < cycle; i++) {
     try {
-      sleep_for(10ms);
+      TimeSource::get().sleepFor(10ms);
 
       transid = incr15(transid);
       StWord stword = ddlReadDiu(transid, time);
@@ -724,9 +742,10 @@ void Crorc::resetCommand(int option, const DiuConfig& diuConfig)
 /// \param timeoutMicroseconds Time-out value in usecs
 void Crorc::emptyDataFifos(int timeoutMicroseconds)
 {
-  auto endTime = chrono::steady_clock::now() + chrono::microseconds(timeoutMicroseconds);
+  auto& timeSource = TimeSource::get();
+  auto endTime = timeSource.now() + chrono::microseconds(timeoutMicroseconds);
 
-  while (chrono::steady_clock::now() < endTime) {
+  while (timeSource.now() < endTime) {
     if (!checkRxData()) {
       return;
     }
@@ -752,14 +771,14 @@ void Crorc::armDdl(int resetMask, const DiuConfig& diuConfig)
     reset(Rorc::Reset::RORC);
     reset(Rorc::Reset::DIU);
     reset(Rorc::Reset::SIU);
-    sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
     assertLinkUp();
     emptyDataFifos(100000);
 
     reset(Rorc::Reset::SIU);
     reset(Rorc::Reset::DIU);
     reset(Rorc::Reset::RORC);
-    sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
     assertLinkUp();
   }
   if (resetMask & Rorc::Reset::DIU) {
@@ -1092,7 +1111,7 @@ std::tuple<std::string, uint32_t> Crorc::siuStatus()
 {
   DiuConfig diuConfig = initDiuVersion();
   resetCommand(Rorc::Reset::SIU, diuConfig);
-  sleep_for(100ms);
+  TimeSource::get().sleepFor(100ms);
 
   long long int time = Ddl::RESPONSE_TIME * diuConfig.pciLoopPerUsec;
 
@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "ReadoutCard/RegisterReadWriteInterface.h"
 #include "RxFreeFifoState.h"
 #include "StWord.h"
@@ -46,8 +47,9 @@ void readFlashRange(RegisterReadWriteInterface& bar0, int addressFlash, int word
 class Crorc
 {
  public:
-  Crorc(RegisterReadWriteInterface& bar)
-    : bar(bar)
+  /// \param pciAddress Address of the card, to tell a lost card from a register that reads all ones
+  Crorc(RegisterReadWriteInterface& bar, boost::optional<PciAddress> pciAddress = boost::none)
+    : bar(bar), mPciAddress(pciAddress)
   {
   }
 
@@ -180,6 +182,7 @@ class Crorc
 
  private:
   RegisterReadWriteInterface& bar;
+  boost::optional<PciAddress> mPciAddress;
 
   bool arch64()
   {
@@ -25,6 +25,7 @@
 #include "ChannelPaths.h"
 #include "Crorc/Constants.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/TimeSource.h"
 #include "Utilities/SmartPointer.h"
 
 namespace b = boost;
@@ -53,6 +54,11 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
                                            << ErrorInfo::DmaPageSize(mPageSize));
   }
 
+  // The ReadyFIFO is registered with PDA
+  if (parameters.getVfioEnabled().get_value_or(false)) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("CRORC does not support VFIO"));
+  }
+
   // Check that the data source is valid. If not throw
   if (mDataSource == DataSource::Ddg) {
     BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message("CRORC does not support specified data source")
@@ -92,10 +98,13 @@ CrorcDmaChannel::CrorcDmaChannel(const Parameters& parameters)
     mReadyFifoAddressBus = entry.addressBus;
   }
 
-  getReadyFifoUser()->reset();
   mDmaBufferUserspace = getBufferProvider().getAddress();
 
-  deviceResetChannel(mInitialResetLevel);
+  // An adopted DMA is still writing to the ReadyFIFO, so it must not be cleared
+  if (!isAdoptingDma()) {
+    getReadyFifoUser()->reset();
+    deviceResetChannel(mInitialResetLevel);
+  }
 }
 
 auto CrorcDmaChannel::allowedChannels() -> AllowedChannels
@@ -167,7 +176,7 @@ void CrorcDmaChannel::startPendingDma()
     }
   }
 
-  std::this_thread::sleep_for(100ms);
+  TimeSource::get().sleepFor(100ms);
 
   mPendingDmaStart = false;
   log("DMA started");
@@ -186,6 +195,52 @@ void CrorcDmaChannel::deviceStopDma()
   getCrorc().stopDataReceiver();
 }
 
+void CrorcDmaChannel::deviceExportDma(DmaHandover& handover)
+{
+  for (const auto& superpage : mTransferQueue) {
+    handover.superpages.push_back({ superpage.getOffset(), superpage.getSize(), superpage.getReceived(), 0, 0 });
+  }
+  for (const auto& superpage : mReadyQueue) {
+    handover.superpages.push_back({ superpage.getOffset(), superpage.getSize(), superpage.getReceived(), 0, 1 });
+  }
+  handover.fifoBusAddress = mReadyFifoAddressBus;
+  handover.fifoFront = mFreeFifoFront;
+  handover.fifoBack = mFreeFifoBack;
+  handover.fifoSize = mFreeFifoSize;
+  handover.pendingDmaStart = mPendingDmaStart;
+
+  // The card keeps writing to the ReadyFIFO, so its file and its registration must outlive us
+  mBufferFifoFile->setDeleteFileOnDestruction(false);
+  mPdaDmaBufferFifo->keepRegistered();
+}
+
+void CrorcDmaChannel::deviceAdoptDma(const DmaHandover& handover)
+{
+  if (handover.fifoBusAddress != mReadyFifoAddressBus) {
+    BOOST_THROW_EXCEPTION(CrorcException() << ErrorInfo::Message("Adopt DMA failed: ReadyFIFO bus address differs from the handed over one"));
+  }
+
+  // Find DIU version, required for stopping the DMA
+  mDiuConfig = getCrorc().initDiuVersion();
+
+  mReadyQueue.clear();
+  mTransferQueue.clear();
+  for (const auto& entry : handover.superpages) {
+    Superpage superpage(entry.offset, entry.size);
+    superpage.setReceived(entry.received);
+    if (entry.ready) {
+      superpage.setReady(true);
+      mReadyQueue.push_back(superpage);
+    } else {
+      mTransferQueue.push_back(superpage);
+    }
+  }
+  mFreeFifoFront = handover.fifoFront;
+  mFreeFifoBack = handover.fifoBack;
+  mFreeFifoSize = handover.fifoSize;
+  mPendingDmaStart = handover.pendingDmaStart;
+}
+
 void CrorcDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
 {
   mDiuConfig = getCrorc().initDiuVersion();
@@ -208,15 +263,15 @@ void CrorcDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
     log("Resetting SIU...");
     log("Switching off CRORC loopback");
     getCrorc().setLoopbackOff();
-    std::this_thread::sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
 
     log("Resetting DIU");
     getCrorc().resetCommand(Rorc::Reset::DIU, mDiuConfig);
-    std::this_thread::sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
 
     log("Resetting SIU");
     getCrorc().resetCommand(Rorc::Reset::SIU, mDiuConfig);
-    std::this_thread::sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
 
     status = getCrorc().ddlReadDiu(0, timeout);
     if (((status.stw >> 15) & 0x7) == 0x6) {
@@ -247,14 +302,14 @@ void CrorcDmaChannel::armDdl(ResetLevel::type resetLevel)
       if ((resetLevel == ResetLevel::InternalDiuSiu) && (mDataSource != DataSource::Diu)) //SIU & FEE
       {
         // Wait a little before SIU reset.
-        std::this_thread::sleep_for(100ms); /// XXX Why???
+        TimeSource::get().sleepFor(100ms); /// XXX Why???
         // Reset SIU.
         getCrorc().armDdl(Rorc::Reset::SIU, mDiuConfig);
         getCrorc().armDdl(Rorc::Reset::DIU, mDiuConfig);
       }
 
       getCrorc().armDdl(Rorc::Reset::RORC, mDiuConfig);
-      std::this_thread::sleep_for(100ms);
+      TimeSource::get().sleepFor(100ms);
 
       if ((resetLevel == ResetLevel::InternalDiuSiu) && (mDataSource != DataSource::Diu)) //SIU & FEE
       {
@@ -263,11 +318,11 @@ void CrorcDmaChannel::armDdl(ResetLevel::type resetLevel)
       }
 
       getCrorc().diuCommand(Ddl::RandCIFST);
-      std::this_thread::sleep_for(100ms);
+      TimeSource::get().sleepFor(100ms);
     }
 
     getCrorc().resetCommand(Rorc::Reset::FF, mDiuConfig);
-    std::this_thread::sleep_for(100ms); /// XXX Give card some time to reset the FreeFIFO
+    TimeSource::get().sleepFor(100ms); /// XXX Give card some time to reset the FreeFIFO
     getCrorc().assertFreeFifoEmpty();
   } catch (Exception& e) {
     e << ErrorInfo::ResetLevel(resetLevel);
@@ -276,7 +331,7 @@ void CrorcDmaChannel::armDdl(ResetLevel::type resetLevel)
   }
 
   // Wait a little after reset.
-  std::this_thread::sleep_for(100ms); /// XXX Why???
+  TimeSource::get().sleepFor(100ms); /// XXX Why???
 }
 
 void CrorcDmaChannel::startDataGenerator()
@@ -285,12 +340,12 @@ void CrorcDmaChannel::startDataGenerator()
 
   if (DataSource::Internal == mDataSource) {
     getCrorc().setLoopbackOn();
-    std::this_thread::sleep_for(100ms); // XXX Why???
+    TimeSource::get().sleepFor(100ms); // XXX Why???
   }
 
   if (DataSource::Siu == mDataSource) {
     getCrorc().setSiuLoopback(mDiuConfig);
-    std::this_thread::sleep_for(100ms); // XXX Why???
+    TimeSource::get().sleepFor(100ms); // XXX Why???
     getCrorc().assertLinkUp();
     getCrorc().siuCommand(Ddl::RandCIFST);
     getCrorc().diuCommand(Ddl::RandCIFST);
@@ -298,7 +353,7 @@ void CrorcDmaChannel::startDataGenerator()
 
   if (DataSource::Diu == mDataSource) {
     getCrorc().setDiuLoopback(mDiuConfig);
-    std::this_thread::sleep_for(100ms);
+    TimeSource::get().sleepFor(100ms);
     getCrorc().diuCommand(Ddl::RandCIFST);
   }
 
@@ -361,6 +416,8 @@ auto CrorcDmaChannel::popSuperpage() -> Superpage
 
 void CrorcDmaChannel::fillSuperpages()
 {
+  acknowledgeArrivals();
+
   if (mPendingDmaStart) {
     if (!mTransferQueue.empty()) {
       startPendingDma();
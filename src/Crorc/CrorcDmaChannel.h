@@ -67,6 +67,8 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   virtual void deviceStartDma() override;
   virtual void deviceStopDma() override;
   virtual void deviceResetChannel(ResetLevel::type resetLevel) override;
+  virtual void deviceExportDma(DmaHandover& handover) override;
+  virtual void deviceAdoptDma(const DmaHandover& handover) override;
 
  private:
   /// Superpage size supported by the CRORC backend
@@ -100,7 +102,7 @@ class CrorcDmaChannel final : public DmaChannelPdaBase
   /// C-RORC function helper
   Crorc::Crorc getCrorc()
   {
-    return { *(getBar()) };
+    return { *(getBar()), getPciAddress() };
   }
 
   ReadyFifo* getReadyFifoUser()
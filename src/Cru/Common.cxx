@@ -15,6 +15,9 @@
 
 #include <chrono>
 #include "Common.h"
+#include "RegisterProgram.h"
+#include "ReadoutCard/TimeSource.h"
+#include "Utilities/IdleStrategy.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2
@@ -179,17 +182,30 @@ void fpllcal0(std::shared_ptr<Pda::PdaBar> pdaBar, uint32_t baseAddress, bool co
 
 uint32_t waitForBit(std::shared_ptr<Pda::PdaBar> pdaBar, uint32_t address, uint32_t position, uint32_t value)
 {
-  auto start = std::chrono::system_clock::now();
+  RegisterProgramRecorder::PollScope poll(pdaBar->getRecorder(), address / 4, 1u << position, value << position,
+                                          std::chrono::milliseconds(500));
+  auto& timeSource = TimeSource::get();
+  auto start = timeSource.now();
   auto curr = start;
   auto elapsed = curr - start;
 
-  uint32_t readValue = pdaBar->readRegister(address / 4);
-  uint32_t bit = Utilities::getBit(readValue, position);
+  auto readBit = [&]() {
+    uint32_t readValue = pdaBar->readRegister(address / 4);
+    if (Utilities::isAllOnes(readValue)) {
+      // A lost card would keep us waiting for the whole timeout, also when it is lost while we wait
+      pdaBar->checkDeviceLost("waiting for a register bit");
+    }
+    return Utilities::getBit(readValue, position);
+  };
+
+  uint32_t bit = readBit();
 
+  // The bits can take up to the whole timeout, so back off to sleeping rather than hold a core for it
+  Utilities::IdleStrategy idleStrategy(Utilities::IdleStrategy::Policy::Backoff);
   while ((elapsed <= std::chrono::milliseconds(500)) && bit != value) {
-    readValue = pdaBar->readRegister(address / 4);
-    bit = Utilities::getBit(readValue, position);
-    curr = std::chrono::system_clock::now();
+    idleStrategy.idle();
+    bit = readBit();
+    curr = timeSource.now();
     elapsed = curr - start;
   }
   return bit;
@@ -105,6 +105,12 @@ struct PacketMonitoringInfo {
   std::map<int, WrapperPacketInfo> wrapperPacketInfoMap;
 };
 
+/// Flow control registers of the two datapath wrappers, as read from the card
+struct FlowControlInfo {
+  uint32_t flowControl[2];
+  uint32_t triggerWindowSize[2];
+};
+
 enum TriggerMode {
   Manual,
   Periodic,
@@ -16,10 +16,12 @@
 
 #include <bitset>
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <thread>
+#include <unistd.h>
 #include "CruBar.h"
 #include "Eeprom.h"
 #include "Gbt.h"
@@ -27,7 +29,9 @@
 #include "Ttc.h"
 #include "PatternPlayer.h"
 #include "DatapathWrapper.h"
+#include "RegisterProgram.h"
 #include "boost/format.hpp"
+#include "ReadoutCard/TimeSource.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2
@@ -37,6 +41,9 @@ namespace roc
 
 using Link = Cru::Link;
 
+/// Sections of the configuration a configuration program runs live
+constexpr uint32_t LIVE_SECTION_PON_TX = 0;
+
 CruBar::CruBar(const Parameters& parameters)
   : BarInterfaceBase(parameters),
     mClock(parameters.getClock().get_value_or(Clock::Local)),
@@ -50,7 +57,8 @@ CruBar::CruBar(const Parameters& parameters)
     mPonUpstream(parameters.getPonUpstreamEnabled().get_value_or(false)),
     mOnuAddress(parameters.getOnuAddress().get_value_or(0x0)),
     mDynamicOffset(parameters.getDynamicOffsetEnabled().get_value_or(false)),
-    mTriggerWindowSize(parameters.getTriggerWindowSize().get_value_or(1000))
+    mTriggerWindowSize(parameters.getTriggerWindowSize().get_value_or(1000)),
+    mConfigurationProgram(parameters.getConfigurationProgram().get_value_or(""))
 {
   if (getIndex() == 0) {
     mFeatures = parseFirmwareFeatures();
@@ -451,14 +459,18 @@ Cru::ReportInfo CruBar::report()
   return reportInfo;
 }
 
-Cru::PacketMonitoringInfo CruBar::monitorPackets()
+/// Reads the packet counters of all links and wrappers
+/// \param refreshLinkMap If false, reuses the link map of the previous call to spare the wrapper register reads
+Cru::PacketMonitoringInfo CruBar::monitorPackets(bool refreshLinkMap)
 {
   std::map<int, Cru::LinkPacketInfo> linkPacketInfoMap;
   std::map<int, Cru::WrapperPacketInfo> wrapperPacketInfoMap;
 
   DatapathWrapper datapathWrapper = DatapathWrapper(mPdaBar);
-  std::map<int, Link> linkMap = initializeLinkMap();
-  for (auto& el : linkMap) {
+  if (refreshLinkMap || mMonitoringLinkMap.empty()) {
+    mMonitoringLinkMap = initializeLinkMap();
+  }
+  for (auto& el : mMonitoringLinkMap) {
     uint32_t accepted = datapathWrapper.getAcceptedPackets(el.second);
     uint32_t rejected = datapathWrapper.getRejectedPackets(el.second);
     uint32_t forced = datapathWrapper.getForcedPackets(el.second);
@@ -474,6 +486,27 @@ Cru::PacketMonitoringInfo CruBar::monitorPackets()
   return { linkPacketInfoMap, wrapperPacketInfoMap };
 }
 
+/// Reads the status of a DMA link, i.e. of a link of the endpoint's datapath wrapper
+/// The sticky bit is not cleared, so that roc-status still sees a link that was down. The status is therefore Down
+/// from the moment the link went down until the sticky bit is cleared, even if the link is back up.
+/// \return The status, or none if the link is not in the link map
+boost::optional<Cru::LinkStatus> CruBar::getLinkStatus(int endpoint, uint32_t link)
+{
+  // The link map and the lookup are built on the first call, since the status is polled
+  if (!mLinkStatusGbt) {
+    mLinkStatusLinkMap = initializeLinkMap();
+    for (auto& el : mLinkStatusLinkMap) {
+      mLinkStatusLinks.insert({ { el.second.dwrapper, el.second.dwrapperId }, el.second });
+    }
+    mLinkStatusGbt = std::make_unique<Gbt>(mPdaBar, mLinkStatusLinkMap, mWrapperCount);
+  }
+  auto entry = mLinkStatusLinks.find({ endpoint, link });
+  if (entry == mLinkStatusLinks.end()) {
+    return {};
+  }
+  return mLinkStatusGbt->getLinkStatus(entry->second);
+}
+
 void CruBar::reconfigure()
 {
   // Get current info
@@ -495,8 +528,91 @@ void CruBar::reconfigure()
   }
 }
 
-/// Configures the CRU according to the parameters passed on init
+/// Configures the CRU according to the parameters passed on init, by replaying the configuration program if one is
+/// set and matches, or by compiling it otherwise
 void CruBar::configure()
+{
+  if (mConfigurationProgram.empty()) {
+    runConfiguration();
+    return;
+  }
+
+  auto firmware = getFirmwareInfo().get_value_or("");
+  auto parametersKey = getConfigurationKey();
+
+  std::ifstream input(mConfigurationProgram);
+  if (input.good()) {
+    auto program = RegisterProgram::load(input);
+    if (program.matches(firmware, parametersKey)) {
+      log((boost::format("Replaying configuration program %s (%d operations)") % mConfigurationProgram %
+           program.getOperations().size())
+            .str());
+      auto runLiveSection = [&](uint32_t section) {
+        if (section != LIVE_SECTION_PON_TX) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Unknown live section in configuration program")
+                                            << ErrorInfo::FileName(mConfigurationProgram));
+        }
+        Ttc ttc = Ttc(mPdaBar);
+        configurePonTx(ttc);
+      };
+      if (program.replay(*mPdaBar, runLiveSection)) {
+        log("CRU configuration done.");
+        return;
+      }
+      // The card did not behave as when the program was compiled, so the program is not trusted anymore
+      log("A poll of configuration program " + mConfigurationProgram + " timed out, discarding it and recompiling",
+          InfoLogger::InfoLogger::Warning);
+      input.close();
+      std::remove(mConfigurationProgram.c_str());
+    } else {
+      log("Configuration program " + mConfigurationProgram + " is for another firmware or configuration, recompiling");
+    }
+  }
+
+  RegisterProgram program(firmware, parametersKey);
+  RegisterProgramRecorder recorder(program);
+  {
+    // Only this thread's sleeps are the configuration's, others (e.g. waiting for a lock) must not be recorded
+    ScopedThreadTimeSource scopedTimeSource(recorder);
+    mPdaBar->setRecorder(&recorder);
+    try {
+      // The program has to hold the configuration of the links as well
+      mLinkMap.clear();
+      runConfiguration();
+    } catch (...) {
+      mPdaBar->setRecorder(nullptr);
+      throw;
+    }
+    mPdaBar->setRecorder(nullptr);
+  }
+  log((boost::format("Compiled %d register writes into %d operations") % recorder.getWrites() %
+       program.getOperations().size())
+        .str());
+
+  // Written aside and renamed, so that others configuring the same way never read a partial program
+  auto temporary = mConfigurationProgram + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream output(temporary);
+    program.save(output);
+  }
+  if (std::rename(temporary.c_str(), mConfigurationProgram.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    log("Failed to write configuration program " + mConfigurationProgram, InfoLogger::InfoLogger::Error);
+  }
+}
+
+/// Resets the PON TX fPLL and scans its phase. How many steps the scan takes depends on what it reads, so a
+/// configuration program runs it live.
+void CruBar::configurePonTx(Ttc& ttc)
+{
+  ttc.resetFpll();
+  if (!ttc.configurePonTx(mOnuAddress)) {
+    log("PON TX fPLL phase scan failed", InfoLogger::InfoLogger::Error);
+  }
+}
+
+/// Runs the configuration of the CRU
+void CruBar::runConfiguration()
 {
   if (mLinkMap.empty()) {
     populateLinkMap(mLinkMap);
@@ -514,10 +630,8 @@ void CruBar::configure()
   }
 
   if (mPonUpstream) {
-    ttc.resetFpll();
-    if (!ttc.configurePonTx(mOnuAddress)) {
-      log("PON TX fPLL phase scan failed", InfoLogger::InfoLogger::Error);
-    }
+    RegisterProgramRecorder::LiveScope live(mPdaBar->getRecorder(), LIVE_SECTION_PON_TX);
+    configurePonTx(ttc);
   }
 
   log("Setting downstream data");
@@ -572,6 +686,26 @@ void CruBar::configure()
   log("CRU configuration done.");
 }
 
+/// Gets the configuration parameters a configuration program depends on, as a string
+std::string CruBar::getConfigurationKey()
+{
+  std::string linkMask;
+  for (auto link : mLinkMask) {
+    linkMask += (linkMask.empty() ? "" : ",") + std::to_string(link);
+  }
+  std::string gbtMuxMap;
+  for (auto const& el : mGbtMuxMap) {
+    gbtMuxMap += (gbtMuxMap.empty() ? "" : ",") + std::to_string(el.first) + ":" + GbtMux::toString(el.second);
+  }
+  return (boost::format("clock=%s datapath=%s downstream=%s gbt=%s mux=%s muxmap=%s links=%s rejection=%d "
+                        "loopback=%d pon=%d onu=%d dynamic=%d window=%d cru=%d") %
+          Clock::toString(mClock) % DatapathMode::toString(mDatapathMode) %
+          DownstreamData::toString(mDownstreamData) % GbtMode::toString(mGbtMode) % GbtMux::toString(mGbtMux) %
+          gbtMuxMap % linkMask % mAllowRejection % mLoopback % mPonUpstream % mOnuAddress % mDynamicOffset %
+          mTriggerWindowSize % mCruId)
+    .str();
+}
+
 /// Sets the mWrapperCount variable
 void CruBar::setWrapperCount()
 {
@@ -701,6 +835,41 @@ void CruBar::disableDataTaking()
   modifyRegister(Cru::Registers::BSP_USER_CONTROL.index, 0, 1, 0x0);
 }
 
+/// Sets the flow control and the trigger window size of both datapath wrappers, without reconfiguring the card
+/// \param triggerWindowSize Size in GBT words
+void CruBar::setFlowControl(bool allowRejection, uint32_t triggerWindowSize)
+{
+  DatapathWrapper datapathWrapper = DatapathWrapper(mPdaBar);
+  for (int wrapper = 0; wrapper <= 1; wrapper++) {
+    datapathWrapper.setFlowControl(wrapper, allowRejection ? 0x1 : 0x0);
+    datapathWrapper.setTriggerWindowSize(wrapper, triggerWindowSize);
+  }
+}
+
+/// Gets the flow control and the trigger window size of each datapath wrapper
+Cru::FlowControlInfo CruBar::getFlowControlInfo()
+{
+  DatapathWrapper datapathWrapper = DatapathWrapper(mPdaBar);
+  Cru::FlowControlInfo info;
+  for (int wrapper = 0; wrapper <= 1; wrapper++) {
+    info.flowControl[wrapper] = datapathWrapper.getFlowControl(wrapper);
+    info.triggerWindowSize[wrapper] = datapathWrapper.getTriggerWindowSize(wrapper);
+  }
+  return info;
+}
+
+/// Puts back the flow control and the trigger window size of each datapath wrapper, as got by getFlowControlInfo()
+void CruBar::setFlowControlInfo(const Cru::FlowControlInfo& info)
+{
+  DatapathWrapper datapathWrapper = DatapathWrapper(mPdaBar);
+  for (int wrapper = 0; wrapper <= 1; wrapper++) {
+    datapathWrapper.setFlowControl(wrapper, info.flowControl[wrapper]);
+  }
+  for (int wrapper = 0; wrapper <= 1; wrapper++) {
+    datapathWrapper.setTriggerWindowSize(wrapper, info.triggerWindowSize[wrapper]);
+  }
+}
+
 void CruBar::setDebugModeEnabled(bool enabled)
 {
   if (enabled) {
@@ -18,6 +18,7 @@
 #define ALICEO2_READOUTCARD_CRU_CRUBAR_H_
 
 #include <cstddef>
+#include <memory>
 #include <set>
 #include <map>
 #include <boost/optional/optional.hpp>
@@ -35,6 +36,9 @@ namespace AliceO2
 namespace roc
 {
 
+class Gbt;
+class Ttc;
+
 class CruBar final : public BarInterfaceBase
 {
   using Link = Cru::Link;
@@ -82,13 +86,18 @@ class CruBar final : public BarInterfaceBase
   void configure() override;
   void reconfigure() override;
   Cru::ReportInfo report();
-  Cru::PacketMonitoringInfo monitorPackets();
+  Cru::PacketMonitoringInfo monitorPackets(bool refreshLinkMap = true);
+  boost::optional<Cru::LinkStatus> getLinkStatus(int endpoint, uint32_t link);
   void emulateCtp(Cru::CtpInfo);
   void patternPlayer(Cru::PatternPlayerInfo patternPlayerInfo);
 
   void enableDataTaking();
   void disableDataTaking();
 
+  void setFlowControl(bool allowRejection, uint32_t triggerWindowSize);
+  Cru::FlowControlInfo getFlowControlInfo();
+  void setFlowControlInfo(const Cru::FlowControlInfo& info);
+
   void setDebugModeEnabled(bool enabled);
   bool getDebugModeEnabled();
 
@@ -109,6 +118,9 @@ class CruBar final : public BarInterfaceBase
   bool checkPonUpstreamStatusExpected(uint32_t ponUpstreamRegister, uint32_t onuAddress);
   std::map<int, Link> initializeLinkMap();
   void populateLinkMap(std::map<int, Link>& linkMap);
+  void runConfiguration();
+  void configurePonTx(Ttc& ttc);
+  std::string getConfigurationKey();
 
   uint32_t getDdgBurstLength();
   //void checkParameters();
@@ -130,12 +142,19 @@ class CruBar final : public BarInterfaceBase
   int mWrapperCount = 0;
   std::set<uint32_t> mLinkMask;
   std::map<int, Link> mLinkMap;
+  std::map<int, Link> mMonitoringLinkMap;
+
+  /// Links of getLinkStatus(), by datapath wrapper and link within it
+  std::map<int, Link> mLinkStatusLinkMap;
+  std::map<std::pair<int, uint32_t>, Link> mLinkStatusLinks;
+  std::unique_ptr<Gbt> mLinkStatusGbt;
   std::map<uint32_t, uint32_t> mRegisterMap;
   std::map<uint32_t, GbtMux::type> mGbtMuxMap;
   bool mPonUpstream;
   uint32_t mOnuAddress;
   bool mDynamicOffset;
   uint32_t mTriggerWindowSize;
+  std::string mConfigurationProgram;
 
   /// Per-link counter to verify superpage sizes received are valid
   uint32_t mSuperpageSizeIndexCounter[Cru::MAX_LINKS] = { 0 };
@@ -14,11 +14,16 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 /// \author Kostas Alexopoulos (kostas.alexopoulos@cern.ch)
 
+#include <algorithm>
+#include <fstream>
 #include <thread>
 #include <boost/format.hpp>
 #include "CruDmaChannel.h"
+#include "DataFormat.h"
 #include "ExceptionInternal.h"
 #include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/TimeSource.h"
+#include "Utilities/PcieHealth.h"
 
 using namespace std::literals;
 using boost::format;
@@ -32,6 +37,11 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
   : DmaChannelPdaBase(parameters, allowedChannels()),                           //
     mInitialResetLevel(ResetLevel::Internal),                                   // It's good to reset at least the card channel in general
     mDataSource(parameters.getDataSource().get_value_or(DataSource::Internal)), // DG loopback mode by default
+    mOrderedDelivery(parameters.getOrderedDeliveryEnabled().get_value_or(false)),
+    mSuperpageTracking(parameters.getSuperpageTrackingEnabled().get_value_or(false)),
+    mLatencyMeasurement(parameters.getLatencyMeasurementEnabled().get_value_or(false)),
+    mLinkLivenessEnabled(parameters.getLinkLivenessEnabled().get_value_or(false)),
+    mRateWeightedDistribution(parameters.getRateWeightedDistributionEnabled().get_value_or(false)),
     mDmaPageSize(parameters.getDmaPageSize().get_value_or(Cru::DMA_PAGE_SIZE))
 {
 
@@ -57,6 +67,7 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
   cruBar = std::move(std::dynamic_pointer_cast<CruBar>(bar));   // Initialize BAR 0
   cruBar2 = std::move(std::dynamic_pointer_cast<CruBar>(bar2)); // Initialize BAR 2
   mFeatures = getBar()->getFirmwareFeatures();                  // Get which features of the firmware are enabled
+  mEndpoint = getBar()->getEndpointNumber();
 
   if (mFeatures.standalone) {
     std::stringstream stream;
@@ -85,6 +96,56 @@ CruDmaChannel::CruDmaChannel(const Parameters& parameters)
     }
     log(stream.str());
   }
+
+  mFlightRecorder = FlightRecorder<Cru::MAX_LINKS>(mLinks.size());
+
+  if (mOrderedDelivery && mDataSource == DataSource::Internal) {
+    log("Ordered delivery needs the RDH, disabled for the internal data source", InfoLogger::InfoLogger::Warning);
+    mOrderedDelivery = false;
+  }
+
+  if (mOrderedDelivery) {
+    auto window = parameters.getOrderedDeliveryWindow().get_value_or(LINK_QUEUE_CAPACITY);
+    if (window == 0 || window > READY_QUEUE_CAPACITY) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Ordered delivery window must be between 1 and the ready queue capacity"));
+    }
+    auto timeout = parameters.getOrderedDeliveryTimeout() ? std::chrono::milliseconds(*parameters.getOrderedDeliveryTimeout()) : ORDERED_DELIVERY_TIMEOUT;
+    mOrderedQueue = OrbitOrderedQueue<Superpage>(mLinks.size(), window, timeout);
+    log((format("Ordered delivery enabled with window %1% and timeout %2% ms") % window % timeout.count()).str());
+  }
+
+  if (mSuperpageTracking) {
+    mSuperpageTracker = std::make_unique<SuperpageTracker<Cru::MAX_LINKS>>();
+    if (auto threshold = parameters.getSuperpageTrackingThreshold()) {
+      mSuperpageTrackingThreshold = std::chrono::milliseconds(*threshold);
+    }
+    log((format("Superpage tracking enabled with threshold %1% ms") % mSuperpageTrackingThreshold.count()).str());
+  }
+
+  if (mLatencyMeasurement) {
+    if (mDataSource == DataSource::Internal) {
+      log("Latency measurement needs the RDH, disabled for the internal data source", InfoLogger::InfoLogger::Warning);
+      mLatencyMeasurement = false;
+    } else {
+      log("Latency measurement enabled");
+    }
+  }
+
+  if (mLinkLivenessEnabled) {
+    if (mDataSource == DataSource::Internal) {
+      log("Link liveness needs the links, disabled for the internal data source", InfoLogger::InfoLogger::Warning);
+      mLinkLivenessEnabled = false;
+    } else {
+      auto timeout = parameters.getLinkLivenessTimeout() ? std::chrono::milliseconds(*parameters.getLinkLivenessTimeout()) : LINK_LIVENESS_TIMEOUT;
+      mLinkLiveness = LinkLiveness(mLinks.size(), timeout);
+      log((format("Link liveness enabled with timeout %1% ms") % timeout.count()).str());
+    }
+  }
+
+  if (mRateWeightedDistribution) {
+    mDistribution = RateWeightedDistribution(mLinks.size(), RATE_WEIGHTED_DISTRIBUTION_FLOOR);
+    log((format("Rate weighted superpage distribution enabled with floor %1%") % RATE_WEIGHTED_DISTRIBUTION_FLOOR).str());
+  }
 }
 
 auto CruDmaChannel::allowedChannels() -> AllowedChannels
@@ -95,12 +156,62 @@ auto CruDmaChannel::allowedChannels() -> AllowedChannels
 
 CruDmaChannel::~CruDmaChannel()
 {
-  setBufferNonReady();
+  // A handed over DMA keeps running for the successor
+  if (!isHandedOver()) {
+    setBufferNonReady();
+  }
   if (mReadyQueue.size() > 0) {
     log((format("Remaining superpages in the ready queue: %1%") % mReadyQueue.size()).str());
   }
+  if (mOrderedQueue.getOutOfOrderCount() > 0) {
+    log((format("Superpages delivered out of orbit order: %1%") % mOrderedQueue.getOutOfOrderCount()).str());
+  }
+  if (mSuperpageTracking) {
+    std::stringstream stream;
+    mSuperpageTracker->writeReport(stream);
+    log(stream.str());
+  }
+  if (mLatencyMeasurement) {
+    std::stringstream stream;
+    auto writeRow = [&](const std::string& link, const LatencyHistogram& histogram) {
+      stream << format("  %-5s %10s %10.1f %10s %10s %10s\n") % link % histogram.count % histogram.getMean()
+                  % histogram.getQuantile(0.5) % histogram.getQuantile(0.99) % histogram.maxUs;
+    };
+    LatencyHistogram total;
+    for (const auto& histogram : mLatencyHistograms) {
+      total.merge(histogram);
+    }
+    stream << format("Card-to-host latency in µs, drift %.2f ppm, %d clock resyncs\n") % mClockCorrelator.getDriftPpm()
+                % mClockCorrelator.getResyncCount();
+    stream << format("  %-5s %10s %10s %10s %10s %10s\n") % "link" % "count" % "mean" % "p50" % "p99" % "max";
+    writeRow("all", total);
+    for (size_t link = 0; link < mLatencyHistograms.size(); ++link) {
+      if (mLatencyHistograms[link].count > 0) {
+        writeRow(std::to_string(link), mLatencyHistograms[link]);
+      }
+    }
+    log(stream.str());
+  }
+  if (mLinkLivenessEnabled) {
+    for (LinkIndex index = 0; index < mLinks.size(); ++index) {
+      const auto& statistics = mLinkLiveness.getStatistics(index);
+      if (statistics.idleTransitions + statistics.deadTransitions > 0) {
+        log((format("Link %1% went idle %2% time(s), dead %3% time(s), recovered %4% time(s)")
+             % mLinks[index].id % statistics.idleTransitions % statistics.deadTransitions % statistics.recoveries).str());
+      }
+    }
+  }
+  if (mRateWeightedDistribution) {
+    std::stringstream stream;
+    stream << "Superpage completion rates per link:";
+    for (LinkIndex index = 0; index < mLinks.size(); ++index) {
+      stream << format(" %1%: %2$.1f/s (%3$.0f%%)") % mLinks[index].id % mDistribution.getRate(index)
+                  % (100 * mDistribution.getShare(index));
+    }
+    log(stream.str());
+  }
 
-  if (mDataSource == DataSource::Internal) {
+  if (mDataSource == DataSource::Internal && !isHandedOver()) {
     resetDebugMode();
   }
 }
@@ -132,6 +243,14 @@ void CruDmaChannel::deviceStartDma()
     link.superpageCounter = 0;
   }
   mReadyQueue.clear();
+  mOrderedQueue.reset(std::chrono::steady_clock::now());
+  if (mSuperpageTracking) {
+    mSuperpageTracker->reset(std::chrono::steady_clock::now());
+  }
+  mClockCorrelator.reset();
+  mLatencyHistograms = {};
+  mLinkLiveness.reset(std::chrono::steady_clock::now());
+  mDistribution.reset(std::chrono::steady_clock::now());
   mLinkQueuesTotalAvailable = LINK_QUEUE_CAPACITY * mLinks.size();
 
   // Start DMA
@@ -148,7 +267,7 @@ void CruDmaChannel::deviceStartDma()
 void CruDmaChannel::setBufferReady()
 {
   getBar()->setDataEmulatorEnabled(true);
-  std::this_thread::sleep_for(10ms);
+  TimeSource::get().sleepFor(10ms);
 }
 
 /// Set buffer to non-ready
@@ -159,18 +278,26 @@ void CruDmaChannel::setBufferNonReady()
 
 void CruDmaChannel::deviceStopDma()
 {
+  if (mDeviceLost) {
+    reclaimUnfilledSuperpages();
+    releaseOrderedSuperpages(true);
+    return;
+  }
   setBufferNonReady();
   getBar2()->disableDataTaking();
   int moved = 0;
   for (auto& link : mLinks) {
     int32_t superpageCount = getBar()->getSuperpageCount(link.id);
+    if (Utilities::isAllOnes(superpageCount) && checkDeviceLost()) {
+      return;
+    }
     if (superpageCount == 0) { // Do not pop superpages if the link has been inactive
       continue;
     }
     uint32_t amountAvailable = superpageCount - link.superpageCounter;
     //log((format("superpageCount %1% amountAvailable %2%") % superpageCount % amountAvailable).str());
     for (uint32_t i = 0; i < (amountAvailable + 1); ++i) { // get an extra, possibly partly filled superpage
-      if (mReadyQueue.size() >= READY_QUEUE_CAPACITY) {
+      if (getReadyQueueOccupancy() >= READY_QUEUE_CAPACITY) {
         break;
       }
 
@@ -183,12 +310,104 @@ void CruDmaChannel::deviceStopDma()
         moved++;
       }
     }
-    assert(link.queue.empty());
+    if (!mLinkLivenessEnabled) {
+      assert(link.queue.empty());
+    }
+  }
+  if (mLinkLivenessEnabled) {
+    reclaimUnfilledSuperpages();
   }
   assert(mLinkQueuesTotalAvailable == LINK_QUEUE_CAPACITY * mLinks.size());
+  releaseOrderedSuperpages(true);
   log((format("Moved %1% remaining superpage(s) to ready queue") % moved).str());
 }
 
+void CruDmaChannel::reclaimUnfilledSuperpages()
+{
+  // The firmware can not give back the descriptors of a single link, so the superpages of dead and idle links are
+  // stranded until the DMA is stopped. They are returned empty, so the user gets the buffer back.
+  int reclaimed = 0;
+  for (auto& link : mLinks) {
+    while (!link.queue.empty() && getReadyQueueOccupancy() < READY_QUEUE_CAPACITY) {
+      auto& superpage = link.queue.front();
+      superpage.setReady(true);
+      superpage.setReceived(0);
+      mReadyQueue.push_back(superpage);
+      link.queue.pop_front();
+      mLinkQueuesTotalAvailable++;
+      reclaimed++;
+    }
+  }
+  if (reclaimed > 0) {
+    log((format("Reclaimed %1% unfilled superpage(s) of inactive links") % reclaimed).str(), InfoLogger::InfoLogger::Warning);
+  }
+}
+
+bool CruDmaChannel::checkDeviceLost()
+{
+  if (Utilities::isDeviceResponding(getPciAddress())) {
+    return false;
+  }
+  mDeviceLost = true;
+  log("Card does not respond, DMA bookkeeping stopped; returning the superpages in flight as empty", InfoLogger::InfoLogger::Error);
+  reclaimUnfilledSuperpages();
+  releaseOrderedSuperpages(true);
+  return true;
+}
+
+void CruDmaChannel::deviceExportDma(DmaHandover& handover)
+{
+  // Superpages held back for ordering are handed over as ready ones
+  releaseOrderedSuperpages(true);
+
+  for (LinkIndex index = 0; index < mLinks.size(); ++index) {
+    const auto& link = mLinks[index];
+    handover.links.push_back({ link.id, link.superpageCounter });
+    for (const auto& superpage : link.queue) {
+      handover.superpages.push_back({ superpage.getOffset(), superpage.getSize(), superpage.getReceived(), index, 0 });
+    }
+  }
+  for (const auto& superpage : mReadyQueue) {
+    handover.superpages.push_back({ superpage.getOffset(), superpage.getSize(), superpage.getReceived(), 0, 1 });
+  }
+}
+
+void CruDmaChannel::deviceAdoptDma(const DmaHandover& handover)
+{
+  if (handover.links.size() != mLinks.size() ||
+      !std::equal(mLinks.begin(), mLinks.end(), handover.links.begin(),
+                  [](const Link& link, const DmaHandover::LinkEntry& entry) { return link.id == entry.id; })) {
+    BOOST_THROW_EXCEPTION(CruException() << ErrorInfo::Message("Adopt DMA failed: link mask differs from the handed over one"));
+  }
+
+  for (LinkIndex index = 0; index < mLinks.size(); ++index) {
+    mLinks[index].queue.clear();
+    mLinks[index].superpageCounter = handover.links[index].superpageCounter;
+  }
+  mReadyQueue.clear();
+  mOrderedQueue.reset(std::chrono::steady_clock::now());
+  if (mSuperpageTracking) {
+    mSuperpageTracker->reset(std::chrono::steady_clock::now());
+  }
+  mClockCorrelator.reset();
+  mLatencyHistograms = {};
+  mLinkLiveness.reset(std::chrono::steady_clock::now());
+  mDistribution.reset(std::chrono::steady_clock::now());
+  mLinkQueuesTotalAvailable = LINK_QUEUE_CAPACITY * mLinks.size();
+
+  for (const auto& entry : handover.superpages) {
+    Superpage superpage(entry.offset, entry.size);
+    superpage.setReceived(entry.received);
+    if (entry.ready) {
+      superpage.setReady(true);
+      mReadyQueue.push_back(superpage);
+    } else {
+      mLinks.at(entry.link).queue.push_back(superpage);
+      mLinkQueuesTotalAvailable--;
+    }
+  }
+}
+
 void CruDmaChannel::deviceResetChannel(ResetLevel::type resetLevel)
 {
   if (resetLevel == ResetLevel::Nothing) {
@@ -205,18 +424,30 @@ CardType::type CruDmaChannel::getCardType()
 void CruDmaChannel::resetCru()
 {
   getBar()->resetDataGeneratorCounter();
-  std::this_thread::sleep_for(100ms);
+  TimeSource::get().sleepFor(100ms);
   getBar()->resetCard();
-  std::this_thread::sleep_for(100ms);
+  TimeSource::get().sleepFor(100ms);
 }
 
 auto CruDmaChannel::getNextLinkIndex() -> LinkIndex
 {
+  auto allowedDepth = [&](size_t i) {
+    return mLinkLivenessEnabled ? mLinkLiveness.getAllowedDepth(i, LINK_QUEUE_CAPACITY) : LINK_QUEUE_CAPACITY;
+  };
+
+  if (mRateWeightedDistribution) {
+    auto index = mDistribution.pick([&](size_t i) { return mLinks[i].queue.size(); }, allowedDepth);
+    return index == RateWeightedDistribution::NO_LINK ? std::numeric_limits<LinkIndex>::max() : index;
+  }
+
   auto smallestQueueIndex = std::numeric_limits<LinkIndex>::max();
   auto smallestQueueSize = std::numeric_limits<size_t>::max();
 
   for (size_t i = 0; i < mLinks.size(); ++i) {
     auto queueSize = mLinks[i].queue.size();
+    if (mLinkLivenessEnabled && queueSize >= allowedDepth(i)) {
+      continue;
+    }
     if (queueSize < smallestQueueSize) {
       smallestQueueIndex = i;
       smallestQueueSize = queueSize;
@@ -228,6 +459,9 @@ auto CruDmaChannel::getNextLinkIndex() -> LinkIndex
 
 void CruDmaChannel::pushSuperpage(Superpage superpage)
 {
+  if (mDeviceLost) {
+    Utilities::throwDeviceLost(getPciAddress(), "pushing a superpage");
+  }
   checkSuperpage(superpage);
 
   if (mLinkQueuesTotalAvailable == 0) {
@@ -237,7 +471,11 @@ void CruDmaChannel::pushSuperpage(Superpage superpage)
   }
 
   // Get the next link to push
-  auto& link = mLinks[getNextLinkIndex()];
+  auto linkIndex = getNextLinkIndex();
+  if (linkIndex >= mLinks.size()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Could not push superpage, no live link has space"));
+  }
+  auto& link = mLinks[linkIndex];
 
   if (link.queue.size() >= LINK_QUEUE_CAPACITY) {
     // Is the link's FIFO out of space?
@@ -247,6 +485,10 @@ void CruDmaChannel::pushSuperpage(Superpage superpage)
 
   // Once we've confirmed the link has a slot available, we push the superpage
   pushSuperpageToLink(link, superpage);
+  mFlightRecorder.countPush();
+  if (mSuperpageTracking) {
+    mSuperpageTracker->push(superpage.getOffset(), link.id, std::chrono::steady_clock::now());
+  }
   auto dmaPages = superpage.getSize() / mDmaPageSize;
   auto busAddress = getBusOffsetAddress(superpage.getOffset());
   getBar()->pushSuperpageDescriptor(link.id, dmaPages, busAddress);
@@ -267,6 +509,10 @@ auto CruDmaChannel::popSuperpage() -> Superpage
   }
   auto superpage = mReadyQueue.front();
   mReadyQueue.pop_front();
+  mFlightRecorder.countPop();
+  if (mSuperpageTracking) {
+    mSuperpageTracker->pop(superpage.getOffset(), std::chrono::steady_clock::now());
+  }
   return superpage;
 }
 
@@ -283,6 +529,9 @@ void CruDmaChannel::transferSuperpageFromLinkToReady(Link& link, bool isPopped)
   }
 
   link.queue.front().setReady(true);
+  if (mSuperpageTracking) {
+    mSuperpageTracker->complete(link.queue.front().getOffset(), std::chrono::steady_clock::now());
+  }
 
   if (isPopped) {
     link.queue.front().setReceived(0x40); // Only RDH in case it's popped
@@ -293,21 +542,60 @@ void CruDmaChannel::transferSuperpageFromLinkToReady(Link& link, bool isPopped)
     } else {
       link.queue.front().setReceived(superpageSize);
     }
+    if (mLatencyMeasurement) {
+      measureLatency(link.queue.front(), link.id);
+    }
+    if (mLinkLivenessEnabled) {
+      auto index = &link - mLinks.data();
+      if (mLinkLiveness.complete(index, std::chrono::steady_clock::now()) != LinkState::Alive) {
+        log((format("Link %1% recovered") % link.id).str());
+      }
+    }
   }
 
-  mReadyQueue.push_back(link.queue.front());
+  if (mOrderedDelivery) {
+    auto& superpage = link.queue.front();
+    auto data = reinterpret_cast<const char*>(getBufferProvider().getAddress() + superpage.getOffset());
+    mOrderedQueue.push(&link - mLinks.data(), DataFormat::getHeartbeatOrbit(data), superpage, std::chrono::steady_clock::now());
+  } else {
+    mReadyQueue.push_back(link.queue.front());
+  }
   link.queue.pop_front();
   link.superpageCounter++;
   mLinkQueuesTotalAvailable++;
 }
 
+void CruDmaChannel::measureLatency(Superpage& superpage, LinkId linkId)
+{
+  // The first RDH is the oldest data of the superpage
+  auto data = reinterpret_cast<const char*>(getBufferProvider().getAddress() + superpage.getOffset());
+  auto hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+  auto latency = mClockCorrelator.addSample(DataFormat::getTriggerOrbit(data), DataFormat::getTriggerBc(data), hostNs.count());
+  superpage.setLatency(latency);
+  if (mClockCorrelator.isSynchronized()) {
+    mLatencyHistograms[linkId].add(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  }
+}
+
 void CruDmaChannel::fillSuperpages()
 {
+  if (mDeviceLost) {
+    Utilities::throwDeviceLost(getPciAddress(), "polling the superpage counters");
+  }
+  acknowledgeArrivals();
+
+  auto now = FlightRecorder<Cru::MAX_LINKS>::Clock::now();
+  bool sampleDue = mFlightRecorder.poll(now);
+
   // Check for arrivals & handle them
   const auto links = mLinks.size();
   for (LinkIndex linkIndex = 0; linkIndex < links; ++linkIndex) {
     auto& link = mLinks[linkIndex];
     uint32_t superpageCount = getBar()->getSuperpageCount(link.id);
+    if (Utilities::isAllOnes(superpageCount) && checkDeviceLost()) {
+      // The superpages already moved to the ready queue were filled before the card was lost, and stay valid
+      Utilities::throwDeviceLost(getPciAddress(), "polling the superpage counters");
+    }
     auto available = superpageCount > link.superpageCounter;
     if (available) {
       uint32_t amountAvailable = superpageCount - link.superpageCounter;
@@ -322,20 +610,159 @@ void CruDmaChannel::fillSuperpages()
       }
 
       for (uint32_t i = 0; i < amountAvailable; ++i) {
-        if (mReadyQueue.size() >= READY_QUEUE_CAPACITY) {
+        if (getReadyQueueOccupancy() >= READY_QUEUE_CAPACITY) {
           break;
         }
 
         // Front superpage has arrived
         transferSuperpageFromLinkToReady(link);
+        mFlightRecorder.countArrival();
+        if (mRateWeightedDistribution) {
+          mDistribution.countArrival(linkIndex);
+        }
       }
     }
   }
+
+  if (mRateWeightedDistribution) {
+    mDistribution.update(now);
+  }
+
+  if (mOrderedDelivery) {
+    releaseOrderedSuperpages();
+  }
+
+  if (mSuperpageTracking && now >= mSuperpageTrackingNextCheck) {
+    checkSuperpageTracker(now);
+  }
+
+  if (mLinkLivenessEnabled && now >= mLinkLivenessNextCheck) {
+    checkLinkLiveness(now);
+  }
+
+  if (sampleDue) {
+    recordFlightSample(now);
+  }
+}
+
+void CruDmaChannel::releaseOrderedSuperpages(bool flush)
+{
+  auto now = std::chrono::steady_clock::now();
+  Superpage superpage;
+  while (!mReadyQueue.full() && mOrderedQueue.pop(superpage, now, flush)) {
+    mReadyQueue.push_back(superpage);
+  }
+}
+
+void CruDmaChannel::recordFlightSample(FlightRecorder<Cru::MAX_LINKS>::Clock::time_point now)
+{
+  mFlightRecorder.setReadyQueueSize(mReadyQueue.size());
+  for (size_t i = 0; i < mLinks.size(); ++i) {
+    mFlightRecorder.setLinkQueueSize(i, mLinks[i].queue.size());
+  }
+  if (mFlightRecorder.isDropCheckDue(now)) {
+    mFlightRecorder.setDroppedPackets(getBar2()->getDroppedPackets(mEndpoint));
+  }
+  mFlightRecorder.commit();
+
+  if (mFlightRecorder.isFrozen()) {
+    if (mFlightRecorderDumps < MAX_FLIGHT_RECORDER_DUMPS) {
+      mFlightRecorderDumps++;
+      auto path = getPaths().flightRecorder(mFlightRecorderFiles++);
+      // Thousands of CSV rows take too long to write in the polling loop, so the samples are handed to the writer
+      auto snapshot = std::make_shared<FlightRecorder<Cru::MAX_LINKS>::Snapshot>(mFlightRecorder.take("packets dropped"));
+      mFlightRecorderWriter.post([path, snapshot] {
+        std::ofstream stream(path);
+        snapshot->dump(stream);
+      });
+      log("Packets dropped, dumping flight recorder to " + path, InfoLogger::InfoLogger::Warning);
+    } else {
+      mFlightRecorder.rearm();
+    }
+  }
+}
+
+boost::optional<std::string> CruDmaChannel::dumpFlightRecorder()
+{
+  auto path = getPaths().flightRecorder(mFlightRecorderFiles++);
+  std::ofstream stream(path);
+  mFlightRecorder.dump(stream, "dump requested");
+  return path;
+}
+
+void CruDmaChannel::checkLinkLiveness(LinkLiveness::Clock::time_point now)
+{
+  mLinkLivenessNextCheck = now + LINK_LIVENESS_CHECK_INTERVAL;
+  for (LinkIndex index = 0; index < mLinks.size(); ++index) {
+    auto& link = mLinks[index];
+    // A link missing from the link map can only be judged by its completions
+    auto status = getBar2()->getLinkStatus(mEndpoint, link.id).value_or(Cru::LinkStatus::Up);
+    // The status is sticky: it stays down from the moment the link went down until it is cleared, e.g. by roc-status.
+    // So the link is dead when the status goes down, and is then probed like an idle link, since the status can not
+    // tell when it is back up.
+    bool statusDown = status == Cru::LinkStatus::Down;
+    bool wentDown = statusDown && !link.statusDown;
+    link.statusDown = statusDown;
+    auto previous = mLinkLiveness.update(index, !wentDown, false, link.queue.size(), now);
+    auto state = mLinkLiveness.getState(index);
+    if (state != previous) {
+      auto recovery = statusDown ? "was down, probing it" : "is back up";
+      log((format("Link %1% %2%, holding %3% superpage(s)") % link.id
+           % (state == LinkState::Dead ? "is down" : state == LinkState::Idle && previous == LinkState::Dead ? recovery : "stopped completing superpages")
+           % link.queue.size()).str(),
+          state == LinkState::Dead ? InfoLogger::InfoLogger::Error : InfoLogger::InfoLogger::Warning);
+    }
+  }
+}
+
+void CruDmaChannel::checkSuperpageTracker(SuperpageTracker<Cru::MAX_LINKS>::Clock::time_point now)
+{
+  mSuperpageTrackingNextCheck = now + SUPERPAGE_TRACKING_CHECK_INTERVAL;
+  auto overdues = mSuperpageTracker->checkOverdue(now, mSuperpageTrackingThreshold);
+  for (size_t i = 0; i < std::min(overdues.size(), MAX_SUPERPAGE_TRACKING_WARNINGS); ++i) {
+    const auto& overdue = overdues[i];
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(overdue.age).count();
+    log((format("Superpage at offset 0x%x of link %d in stage '%s' for %d ms") % overdue.offset % overdue.link %
+         SuperpageStage::toString(overdue.stage) % age)
+          .str(),
+        InfoLogger::InfoLogger::Warning);
+  }
+  if (overdues.size() > MAX_SUPERPAGE_TRACKING_WARNINGS) {
+    log((format("%1% more superpages stuck for over %2% ms") % (overdues.size() - MAX_SUPERPAGE_TRACKING_WARNINGS) %
+         mSuperpageTrackingThreshold.count())
+          .str(),
+        InfoLogger::InfoLogger::Warning);
+  }
+}
+
+boost::optional<std::string> CruDmaChannel::dumpSuperpageTrace()
+{
+  if (!mSuperpageTracking) {
+    return {};
+  }
+  auto path = getPaths().superpageTrace(mSuperpageTraceDumps++);
+  std::ofstream stream(path);
+  mSuperpageTracker->writeTrace(stream, std::chrono::steady_clock::now());
+
+  std::stringstream report;
+  mSuperpageTracker->writeReport(report);
+  log(report.str());
+  return path;
 }
 
 int CruDmaChannel::getTransferQueueAvailable()
 {
-  return mLinkQueuesTotalAvailable;
+  if (!mLinkLivenessEnabled) {
+    return mLinkQueuesTotalAvailable;
+  }
+
+  // Only the space of the live links can be used
+  size_t available = 0;
+  for (size_t i = 0; i < mLinks.size(); ++i) {
+    auto depth = mLinkLiveness.getAllowedDepth(i, LINK_QUEUE_CAPACITY);
+    available += depth > mLinks[i].queue.size() ? depth - mLinks[i].queue.size() : 0;
+  }
+  return available;
 }
 
 // Return a boolean that denotes whether the transfer queue is empty
@@ -22,8 +22,15 @@
 #include <deque>
 //#define BOOST_CB_ENABLE_DEBUG 1
 #include <boost/circular_buffer.hpp>
+#include "ClockCorrelator.h"
 #include "Cru/CruBar.h"
 #include "Cru/FirmwareFeatures.h"
+#include "FlightRecorder.h"
+#include "LinkLiveness.h"
+#include "RateWeightedDistribution.h"
+#include "LatencyHistogram.h"
+#include "OrbitOrderedQueue.h"
+#include "SuperpageTracker.h"
 #include "ReadoutCard/Parameters.h"
 
 namespace AliceO2
@@ -57,12 +64,16 @@ class CruDmaChannel final : public DmaChannelPdaBase
   virtual boost::optional<float> getTemperature() override;
   virtual boost::optional<std::string> getFirmwareInfo() override;
   virtual boost::optional<std::string> getCardId() override;
+  virtual boost::optional<std::string> dumpFlightRecorder() override;
+  virtual boost::optional<std::string> dumpSuperpageTrace() override;
   AllowedChannels allowedChannels();
 
  protected:
   virtual void deviceStartDma() override;
   virtual void deviceStopDma() override;
   virtual void deviceResetChannel(ResetLevel::type resetLevel) override;
+  virtual void deviceExportDma(DmaHandover& handover) override;
+  virtual void deviceAdoptDma(const DmaHandover& handover) override;
 
  private:
   /// Max amount of superpages per link.
@@ -73,6 +84,30 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// This is an arbitrary size, can easily be increased if more headroom is needed.
   static constexpr size_t READY_QUEUE_CAPACITY = Cru::MAX_SUPERPAGE_DESCRIPTORS * Cru::MAX_LINKS;
 
+  /// Default time after which ordered delivery stops waiting for a link without data
+  static constexpr std::chrono::milliseconds ORDERED_DELIVERY_TIMEOUT{ 100 };
+
+  /// Default time after which a superpage stuck in a stage of its lifecycle is reported
+  static constexpr std::chrono::milliseconds SUPERPAGE_TRACKING_THRESHOLD{ 1000 };
+
+  /// Time between two checks for stuck superpages
+  static constexpr std::chrono::milliseconds SUPERPAGE_TRACKING_CHECK_INTERVAL{ 100 };
+
+  /// Max amount of stuck superpages reported individually per check
+  static constexpr size_t MAX_SUPERPAGE_TRACKING_WARNINGS = 10;
+
+  /// Default time without a completion after which a link with superpages is idle
+  static constexpr std::chrono::milliseconds LINK_LIVENESS_TIMEOUT{ 1000 };
+
+  /// Superpages every link is kept at by the rate weighted distribution, however quiet it is
+  static constexpr size_t RATE_WEIGHTED_DISTRIBUTION_FLOOR = 4;
+
+  /// Time between two checks of the link liveness
+  static constexpr std::chrono::milliseconds LINK_LIVENESS_CHECK_INTERVAL{ 100 };
+
+  /// Max amount of automatic flight recorder dumps during the lifetime of the channel
+  static constexpr int MAX_FLIGHT_RECORDER_DUMPS = 10;
+
   /// Queue for one link
   using SuperpageQueue = boost::circular_buffer<Superpage>;
 
@@ -92,6 +127,9 @@ class CruDmaChannel final : public DmaChannelPdaBase
 
     /// The superpage queue
     SuperpageQueue queue{ LINK_QUEUE_CAPACITY };
+
+    /// The sticky link status was down at the last liveness check
+    bool statusDown = false;
   };
 
   void resetCru();
@@ -117,12 +155,42 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// Mark the front superpage of a link ready and transfer it to the ready queue
   void transferSuperpageFromLinkToReady(Link& link, bool isPopped = false);
 
+  /// Move the superpages that can be released in orbit order to the ready queue
+  /// \param flush Release all of them, regardless of the links that have not delivered yet
+  void releaseOrderedSuperpages(bool flush = false);
+
+  /// Amount of superpages in the ready queue, including those held back for ordering
+  size_t getReadyQueueOccupancy()
+  {
+    return mReadyQueue.size() + mOrderedQueue.size();
+  }
+
   /// Enable debug mode by writing to the appropriate CRU register
   void enableDebugMode();
 
   /// Reset debug mode to the state it was in prior to the start of execution
   void resetDebugMode();
 
+  /// Records the queue state into the flight recorder, and dumps it if it captured a drop
+  void recordFlightSample(FlightRecorder<Cru::MAX_LINKS>::Clock::time_point now);
+
+  /// Tags a superpage that arrived with its card-to-host latency
+  void measureLatency(Superpage& superpage, LinkId linkId);
+
+  /// Reports the superpages that are stuck in a stage of their lifecycle
+  void checkSuperpageTracker(SuperpageTracker<Cru::MAX_LINKS>::Clock::time_point now);
+
+  /// Updates the liveness of the links from their status, and reports the links that changed state
+  void checkLinkLiveness(LinkLiveness::Clock::time_point now);
+
+  /// Moves the superpages the links did not fill to the ready queue as empty, once the DMA is stopped
+  void reclaimUnfilledSuperpages();
+
+  /// Called when a BAR read returned all ones. If the card does not respond, stops the DMA bookkeeping and moves the
+  /// superpages in flight to the ready queue as empty.
+  /// \return True if the card is lost
+  bool checkDeviceLost();
+
   /// BAR 0 is needed for DMA engine interaction and various other functions
   std::shared_ptr<CruBar> cruBar;
 
@@ -141,6 +209,51 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// Queue for superpages that have been transferred and are waiting for popping by the user
   SuperpageQueue mReadyQueue{ READY_QUEUE_CAPACITY };
 
+  /// Superpages that have arrived but are held back until they can be delivered in orbit order
+  OrbitOrderedQueue<Superpage> mOrderedQueue;
+
+  /// Recent history of the queues, to investigate dropped packets
+  FlightRecorder<Cru::MAX_LINKS> mFlightRecorder;
+
+  /// Amount of automatic flight recorder dumps, which are capped by MAX_FLIGHT_RECORDER_DUMPS
+  int mFlightRecorderDumps = 0;
+
+  /// Amount of flight recorder files, of the automatic and the requested dumps
+  int mFlightRecorderFiles = 0;
+
+  /// Writes the automatic flight recorder dumps
+  FlightRecorderWriter mFlightRecorderWriter;
+
+  /// Lifecycle of the superpages, only allocated if enabled, since its trace takes a few MiB
+  std::unique_ptr<SuperpageTracker<Cru::MAX_LINKS>> mSuperpageTracker;
+
+  /// Time after which a superpage stuck in a stage is reported
+  std::chrono::milliseconds mSuperpageTrackingThreshold = SUPERPAGE_TRACKING_THRESHOLD;
+
+  /// Next check for stuck superpages
+  SuperpageTracker<Cru::MAX_LINKS>::Clock::time_point mSuperpageTrackingNextCheck;
+
+  /// Amount of superpage traces written
+  int mSuperpageTraceDumps = 0;
+
+  /// Relates the orbit/BC of the arriving superpages to the host clock, if latency measurement is enabled
+  ClockCorrelator mClockCorrelator;
+
+  /// Card-to-host latencies of the superpages per link
+  std::array<LatencyHistogram, Cru::MAX_LINKS> mLatencyHistograms;
+
+  /// Liveness of the links, if enabled
+  LinkLiveness mLinkLiveness;
+
+  /// Next check of the link liveness
+  LinkLiveness::Clock::time_point mLinkLivenessNextCheck;
+
+  /// Completion rates of the links, if rate weighted distribution is enabled
+  RateWeightedDistribution mDistribution;
+
+  /// Endpoint of the card, to read its drop counter
+  int mEndpoint;
+
   // These variables are configuration parameters
 
   /// Reset level on initialization of channel
@@ -149,6 +262,24 @@ class CruDmaChannel final : public DmaChannelPdaBase
   /// Gives the data source
   const DataSource::type mDataSource;
 
+  /// Merge the links into the ready queue in orbit order
+  bool mOrderedDelivery;
+
+  /// Track the lifecycle of the superpages
+  const bool mSuperpageTracking;
+
+  /// Tag the superpages with their card-to-host latency
+  bool mLatencyMeasurement;
+
+  /// Schedule superpages only to live links
+  bool mLinkLivenessEnabled;
+
+  /// Give the superpages to the links in proportion to their completion rate
+  const bool mRateWeightedDistribution;
+
+  /// The card stopped responding, so the BARs must not be used anymore
+  bool mDeviceLost = false;
+
   /// Flag to know if we should reset the debug register after we fiddle with it
   bool mDebugRegisterReset = false;
 
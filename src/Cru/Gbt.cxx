@@ -249,6 +249,15 @@ LinkStatus Gbt::getStickyBit(Link link)
   return (lockedData == 0x1 && ready == 0x1) ? LinkStatus::Up : LinkStatus::Down;
 }
 
+/// Reads the status of a link without clearing its sticky bit, so it is down if the link went down since the last clear
+LinkStatus Gbt::getLinkStatus(Link link)
+{
+  uint32_t data = mPdaBar->readRegister(getStatusAddress(link) / 4);
+  uint32_t lockedData = Utilities::getBit(~data, 14); //phy up 1 = locked, 0 = down
+  uint32_t ready = Utilities::getBit(~data, 15);      //data layer up 1 = locked, 0 = down
+  return (lockedData == 0x1 && ready == 0x1) ? LinkStatus::Up : LinkStatus::Down;
+}
+
 void Gbt::resetStickyBit(Link link)
 {
   uint32_t addr = getClearErrorAddress(link);
@@ -45,6 +45,7 @@ class Gbt
   void getGbtMuxes();
   void getLoopbacks();
   LinkStatus getStickyBit(Link link);
+  LinkStatus getLinkStatus(Link link);
   uint32_t getRxClockFrequency(Link link);
   uint32_t getTxClockFrequency(Link link);
 
@@ -19,6 +19,8 @@
 #include <thread>
 #include <cmath>
 #include "I2c.h"
+#include "RegisterProgram.h"
+#include "ReadoutCard/TimeSource.h"
 #include "Utilities/Util.h"
 
 namespace AliceO2
@@ -75,7 +77,7 @@ void I2c::configurePll()
     writeI2c(reg.first & 0xff, reg.second);
 
     if (reg.first == 0x0540) {
-      std::this_thread::sleep_for(std::chrono::seconds(1));
+      TimeSource::get().sleepFor(std::chrono::seconds(1));
     }
   }
   resetI2c();
@@ -152,12 +154,14 @@ uint32_t I2c::readI2c(uint32_t address)
 
 void I2c::waitForI2cReady()
 {
+  RegisterProgramRecorder::PollScope poll(mPdaBar->getRecorder(), mI2cData / 4, 1u << 31, 1u << 31,
+                                          std::chrono::milliseconds(1));
   int done = 0;
   uint32_t readValue = 0;
   while (readValue == 0 && done < 10) {
     readValue = mPdaBar->readRegister(mI2cData / 4);
     readValue = Utilities::getBit(readValue, 31);
-    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    TimeSource::get().sleepFor(std::chrono::microseconds(100));
     done++;
   }
 }
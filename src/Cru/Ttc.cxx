@@ -17,6 +17,7 @@
 #include "Constants.h"
 #include "I2c.h"
 #include "Ttc.h"
+#include "ReadoutCard/TimeSource.h"
 #include "register_maps/Si5345-RevD_local_pll1_zdb-Registers.h"
 #include "register_maps/Si5345-RevD_local_pll2_zdb-Registers.h"
 #include "register_maps/Si5345-RevD_ttc_pll1_zdb-Registers.h"
@@ -66,7 +67,7 @@ void Ttc::configurePlls(uint32_t clock)
   p2.configurePll();
   p3.configurePll();
 
-  std::this_thread::sleep_for(std::chrono::seconds(2));
+  TimeSource::get().sleepFor(std::chrono::seconds(2));
 }
 
 void Ttc::setRefGen(int frequency)
@@ -141,7 +142,7 @@ void Ttc::calibrateTtc()
 {
   // Reset ONU core
   mPdaBar->modifyRegister(Cru::Registers::ONU_USER_LOGIC.index, 0, 1, 0x1);
-  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  TimeSource::get().sleepFor(std::chrono::milliseconds(500));
   mPdaBar->modifyRegister(Cru::Registers::ONU_USER_LOGIC.index, 0, 1, 0x0);
 
   // Switch to refclk #0
@@ -161,7 +162,7 @@ void Ttc::calibrateTtc()
   //Calibrate PON TX
   Cru::txcal0(mPdaBar, Cru::Registers::PON_WRAPPER_TX.address);
 
-  std::this_thread::sleep_for(std::chrono::seconds(2));
+  TimeSource::get().sleepFor(std::chrono::seconds(2));
 
   //Check MGT RX ready, RX locked and RX40 locked
   uint32_t calStatus = mPdaBar->readRegister((Cru::Registers::ONU_USER_LOGIC.address + 0xc) / 4);
@@ -57,6 +57,21 @@ uint32_t getOffset(const char* data)
   return Utilities::getBits(getWord(data, 2), 0, 15); //bits #[64-79] from RDH word 0
 }
 
+uint32_t getTriggerOrbit(const char* data)
+{
+  return getWord(data, 4); //bits #[0-31] from RDH word 1
+}
+
+uint32_t getHeartbeatOrbit(const char* data)
+{
+  return getWord(data, 5); //bits #[32-63] from RDH word 1
+}
+
+uint32_t getTriggerBc(const char* data)
+{
+  return Utilities::getBits(getWord(data, 8), 0, 11); //bits #[0-11] from RDH word 2
+}
+
 uint32_t getTriggerType(const char* data)
 {
   return Utilities::getBits(getWord(data, 9), 0, 31); //bits #[32-63] from RDH word 2
@@ -48,8 +48,19 @@ class DmaBufferProviderInterface
   /// Get userspace address of an entry of the scatter-gather list
   virtual uintptr_t getScatterGatherEntryAddress(int index) const = 0;
 
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const = 0;
+
   /// Gets the bus address that corresponds to the userspace address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t offset) const = 0;
+
+  /// Leaves the buffer registered with the device when the provider is destroyed, for a DMA handed over to another
+  /// process, which the card keeps writing to
+  /// \return False if the provider does not support it
+  virtual bool keepRegistered()
+  {
+    return false;
+  }
 };
 
 } // namespace roc
@@ -71,12 +71,25 @@ class FilePdaDmaBufferProvider : public DmaBufferProviderInterface
     return mPdaBuffer.getScatterGatherList().at(index).addressUser;
   }
 
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const
+  {
+    return mPdaBuffer.getScatterGatherList().at(index).addressBus;
+  }
+
   /// Function for getting the bus address that corresponds to the user address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t offset) const
   {
     return mPdaBuffer.getBusOffsetAddress(offset);
   }
 
+  /// The file outlives the process, so the buffer can stay registered for the successor of a DMA handover
+  virtual bool keepRegistered() override
+  {
+    mPdaBuffer.keepRegistered();
+    return true;
+  }
+
  private:
   MemoryMappedFile mMappedFile;
   void* mAddress;
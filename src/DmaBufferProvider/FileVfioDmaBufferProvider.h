@@ -0,0 +1,107 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FileVfioDmaBufferProvider.h
+/// \brief Definition of the FileVfioDmaBufferProvider class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEVFIODMABUFFERPROVIDER_H_
+#define ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEVFIODMABUFFERPROVIDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include "ExceptionInternal.h"
+#include "ReadoutCard/MemoryMappedFile.h"
+#include "Vfio/VfioDevice.h"
+#include "Vfio/VfioDmaBuffer.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Implementation of the DmaBufferProviderInterface for file-based memory mapped DMA buffers mapped with VFIO.
+/// The buffer is IOVA-contiguous, so its scatter-gather list has a single entry.
+class FileVfioDmaBufferProvider : public DmaBufferProviderInterface
+{
+ public:
+  FileVfioDmaBufferProvider(std::shared_ptr<Vfio::VfioDevice> device, std::string path, size_t size)
+    : mMappedFile(path, size), mAddress(mMappedFile.getAddress()), mSize(mMappedFile.getSize()), mVfioBuffer(std::move(device), mAddress, mSize)
+  {
+  }
+
+  virtual ~FileVfioDmaBufferProvider() = default;
+
+  /// Get starting userspace address of the DMA buffer
+  virtual uintptr_t getAddress() const
+  {
+    return reinterpret_cast<uintptr_t>(mAddress);
+  }
+
+  /// Get total size of the DMA buffer
+  virtual size_t getSize() const
+  {
+    return mSize;
+  }
+
+  /// Amount of entries in the scatter-gather list
+  virtual size_t getScatterGatherListSize() const
+  {
+    return 1;
+  }
+
+  /// Get size of an entry of the scatter-gather list
+  virtual size_t getScatterGatherEntrySize(int index) const
+  {
+    checkIndex(index);
+    return mSize;
+  }
+
+  /// Get userspace address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryAddress(int index) const
+  {
+    checkIndex(index);
+    return getAddress();
+  }
+
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const
+  {
+    checkIndex(index);
+    return mVfioBuffer.getIova();
+  }
+
+  /// Function for getting the bus address that corresponds to the user address + given offset
+  virtual uintptr_t getBusOffsetAddress(size_t offset) const
+  {
+    return mVfioBuffer.getBusOffsetAddress(offset);
+  }
+
+ private:
+  void checkIndex(int index) const
+  {
+    if (index != 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Scatter-gather list index out of range")
+                                        << ErrorInfo::Index(index));
+    }
+  }
+
+  MemoryMappedFile mMappedFile;
+  void* mAddress;
+  size_t mSize;
+  Vfio::VfioDmaBuffer mVfioBuffer;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_FILEVFIODMABUFFERPROVIDER_H_
@@ -65,6 +65,12 @@ class NullDmaBufferProvider : public DmaBufferProviderInterface
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No scatter-gather list provided"));
   }
 
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int) const
+  {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No scatter-gather list provided"));
+  }
+
   /// Function for getting the bus address that corresponds to the user address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t) const
   {
@@ -0,0 +1,205 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PartitionDmaBufferProvider.h
+/// \brief Definition of the PartitionDmaBufferProvider class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_PARTITIONDMABUFFERPROVIDER_H_
+#define ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_PARTITIONDMABUFFERPROVIDER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Implementation of the DmaBufferProviderInterface for a partition of a DMA buffer that is registered once, and shared
+/// by several channels of the same PCI function. Each channel sees its partition as a buffer of its own, starting at
+/// offset 0, with the scatter-gather entries of the shared buffer clipped to it.
+class PartitionDmaBufferProvider : public DmaBufferProviderInterface
+{
+ public:
+  /// \param shared Provider of the whole buffer
+  /// \param offset Offset of the partition in the whole buffer
+  /// \param size Size of the partition
+  PartitionDmaBufferProvider(std::shared_ptr<const DmaBufferProviderInterface> shared, size_t offset, size_t size)
+    : mShared(std::move(shared)), mOffset(offset), mSize(size)
+  {
+    if (mOffset + mSize > mShared->getSize() || mSize == 0) {
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Buffer partition out of range of the shared buffer")
+                                                 << ErrorInfo::Offset(offset)
+                                                 << ErrorInfo::DmaBufferSize(mShared->getSize()));
+    }
+
+    // Clip the entries of the shared buffer to the partition
+    const uintptr_t start = mShared->getAddress() + mOffset;
+    const uintptr_t end = start + mSize;
+    for (size_t i = 0; i < mShared->getScatterGatherListSize(); ++i) {
+      const uintptr_t entryStart = mShared->getScatterGatherEntryAddress(i);
+      const uintptr_t entryEnd = entryStart + mShared->getScatterGatherEntrySize(i);
+      if (entryEnd <= start || entryStart >= end) {
+        continue;
+      }
+      const uintptr_t clippedStart = std::max(entryStart, start);
+      const uintptr_t clippedEnd = std::min(entryEnd, end);
+      mEntries.push_back({ clippedEnd - clippedStart, clippedStart,
+                           mShared->getScatterGatherEntryBusAddress(i) + (clippedStart - entryStart) });
+    }
+  }
+
+  virtual ~PartitionDmaBufferProvider()
+  {
+    if (!mKey.empty()) {
+      std::lock_guard<std::mutex> lock(getSharedMutex());
+      getSharedBuffers()[mKey].partitions.erase(mOffset);
+    }
+  }
+
+  /// Makes a partition of a shared buffer, creating the buffer if no channel of this process uses it yet. The buffer is
+  /// released with the last partition.
+  /// \param key Identifies the buffer and the device it is registered with
+  /// \param create Function creating the provider of the whole buffer
+  /// \param offset Offset of the partition in the whole buffer
+  /// \param size Size of the partition
+  /// \exception ParameterException The partition is out of range, or overlaps a partition in use of the same buffer
+  static std::unique_ptr<PartitionDmaBufferProvider> makeShared(const std::string& key,
+                                                                std::function<std::unique_ptr<DmaBufferProviderInterface>()> create,
+                                                                size_t offset, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(getSharedMutex());
+    auto& entry = getSharedBuffers()[key];
+
+    // The partitions are ordered by offset, so only the neighbours of the new one can overlap it
+    auto next = entry.partitions.lower_bound(offset);
+    bool overlapsNext = (next != entry.partitions.end()) && (next->first < offset + size);
+    bool overlapsPrevious = (next != entry.partitions.begin()) && (std::prev(next)->first + std::prev(next)->second > offset);
+    if (overlapsNext || overlapsPrevious) {
+      auto other = overlapsNext ? next : std::prev(next);
+      BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Buffer partition overlaps the partition at offset " +
+                                                                       std::to_string(other->first) + " of size " +
+                                                                       std::to_string(other->second) + " in use")
+                                                 << ErrorInfo::Offset(offset));
+    }
+
+    auto shared = entry.buffer.lock();
+    if (!shared) {
+      shared = create();
+      entry.buffer = shared;
+    }
+    auto partition = std::make_unique<PartitionDmaBufferProvider>(shared, offset, size);
+    partition->mKey = key;
+    entry.partitions.emplace(offset, size);
+    return partition;
+  }
+
+  /// Get starting userspace address of the DMA buffer
+  virtual uintptr_t getAddress() const
+  {
+    return mShared->getAddress() + mOffset;
+  }
+
+  /// Get total size of the DMA buffer
+  virtual size_t getSize() const
+  {
+    return mSize;
+  }
+
+  /// Amount of entries in the scatter-gather list
+  virtual size_t getScatterGatherListSize() const
+  {
+    return mEntries.size();
+  }
+
+  /// Get size of an entry of the scatter-gather list
+  virtual size_t getScatterGatherEntrySize(int index) const
+  {
+    return mEntries.at(index).size;
+  }
+
+  /// Get userspace address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryAddress(int index) const
+  {
+    return mEntries.at(index).addressUser;
+  }
+
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const
+  {
+    return mEntries.at(index).addressBus;
+  }
+
+  /// Function for getting the bus address that corresponds to the user address + given offset
+  virtual uintptr_t getBusOffsetAddress(size_t offset) const
+  {
+    if (offset >= mSize) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Offset out of range of the buffer partition")
+                                        << ErrorInfo::Offset(offset));
+    }
+    return mShared->getBusOffsetAddress(mOffset + offset);
+  }
+
+  size_t getOffset() const
+  {
+    return mOffset;
+  }
+
+  const DmaBufferProviderInterface& getSharedBuffer() const
+  {
+    return *mShared;
+  }
+
+ private:
+  /// A buffer shared by partitions, and the partitions in use
+  struct SharedBuffer {
+    std::weak_ptr<const DmaBufferProviderInterface> buffer;
+    std::map<size_t, size_t> partitions; ///< Offset to size
+  };
+
+  static std::mutex& getSharedMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::map<std::string, SharedBuffer>& getSharedBuffers()
+  {
+    static std::map<std::string, SharedBuffer> buffers;
+    return buffers;
+  }
+
+  struct Entry {
+    size_t size;
+    uintptr_t addressUser;
+    uintptr_t addressBus;
+  };
+
+  std::shared_ptr<const DmaBufferProviderInterface> mShared;
+  size_t mOffset;
+  size_t mSize;
+  std::vector<Entry> mEntries;
+  std::string mKey; ///< Key of the shared buffer, if made by makeShared()
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_PARTITIONDMABUFFERPROVIDER_H_
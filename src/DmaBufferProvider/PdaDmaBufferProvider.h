@@ -70,6 +70,12 @@ class PdaDmaBufferProvider : public DmaBufferProviderInterface
     return mPdaBuffer.getScatterGatherList().at(index).addressUser;
   }
 
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const
+  {
+    return mPdaBuffer.getScatterGatherList().at(index).addressBus;
+  }
+
   /// Function for getting the bus address that corresponds to the user address + given offset
   virtual uintptr_t getBusOffsetAddress(size_t offset) const
   {
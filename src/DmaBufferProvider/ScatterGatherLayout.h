@@ -0,0 +1,142 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ScatterGatherLayout.h
+/// \brief Definition of the ScatterGatherLayout class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_SCATTERGATHERLAYOUT_H_
+#define ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_SCATTERGATHERLAYOUT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Describes a DMA buffer as a list of bus-contiguous segments, by merging the scatter-gather entries that are
+/// contiguous both in userspace and on the bus.
+/// The card receives a single bus address per superpage, so a superpage is only valid if it lies within one segment.
+/// The planner places superpages so that none of them crosses a segment boundary, and reports the capacity lost to
+/// fragmentation.
+class ScatterGatherLayout
+{
+ public:
+  /// A bus-contiguous part of the buffer
+  struct Segment {
+    size_t offset;        ///< Offset from the start of the buffer
+    size_t size;          ///< Size in bytes
+    uintptr_t busAddress; ///< Bus address of the start of the segment
+  };
+
+  /// Placement of superpages of a given size in the buffer
+  struct Plan {
+    size_t superpageSize = 0;
+    std::vector<size_t> offsets;    ///< Offsets of the largest set of valid superpages
+    std::vector<size_t> straddling; ///< Offsets of the back-to-back layout (n * superpageSize) crossing a boundary
+    size_t usableSize = 0;          ///< Capacity covered by the valid superpages
+    size_t lostSize = 0;            ///< Capacity of the buffer not covered by any valid superpage
+  };
+
+  explicit ScatterGatherLayout(const DmaBufferProviderInterface& provider) : mBufferSize(provider.getSize())
+  {
+    const auto entries = provider.getScatterGatherListSize();
+    if (entries == 0) {
+      return;
+    }
+    const auto base = provider.getScatterGatherEntryAddress(0);
+
+    for (size_t i = 0; i < entries; ++i) {
+      const auto address = provider.getScatterGatherEntryAddress(i);
+      const auto busAddress = provider.getScatterGatherEntryBusAddress(i);
+      const auto size = provider.getScatterGatherEntrySize(i);
+      const auto offset = address - base;
+
+      if (!mSegments.empty()) {
+        auto& last = mSegments.back();
+        if ((last.offset + last.size) == offset && (last.busAddress + last.size) == busAddress) {
+          last.size += size;
+          continue;
+        }
+      }
+      mSegments.push_back({ offset, size, busAddress });
+    }
+  }
+
+  const std::vector<Segment>& getSegments() const
+  {
+    return mSegments;
+  }
+
+  size_t getLargestSegmentSize() const
+  {
+    size_t largest = 0;
+    for (const auto& segment : mSegments) {
+      largest = std::max(largest, segment.size);
+    }
+    return largest;
+  }
+
+  /// Does the given range lie within one bus-contiguous segment
+  bool isContiguous(size_t offset, size_t size) const
+  {
+    // Find the last segment starting at or before the offset
+    auto next = std::upper_bound(mSegments.begin(), mSegments.end(), offset,
+                                 [](size_t value, const Segment& segment) { return value < segment.offset; });
+    if (next == mSegments.begin()) {
+      return false;
+    }
+    const auto& segment = *(next - 1);
+    return (offset + size) <= (segment.offset + segment.size);
+  }
+
+  /// Computes the largest set of superpages of the given size that each lie within one segment
+  /// \param superpageSize Size of the superpages
+  /// \param alignment Required alignment of the superpage offsets
+  Plan plan(size_t superpageSize, size_t alignment = 1) const
+  {
+    Plan plan;
+    plan.superpageSize = superpageSize;
+    if (superpageSize == 0) {
+      return plan;
+    }
+
+    for (const auto& segment : mSegments) {
+      auto offset = ((segment.offset + alignment - 1) / alignment) * alignment;
+      while ((offset + superpageSize) <= (segment.offset + segment.size)) {
+        plan.offsets.push_back(offset);
+        offset += superpageSize;
+      }
+    }
+
+    for (size_t offset = 0; (offset + superpageSize) <= mBufferSize; offset += superpageSize) {
+      if (!isContiguous(offset, superpageSize)) {
+        plan.straddling.push_back(offset);
+      }
+    }
+
+    plan.usableSize = plan.offsets.size() * superpageSize;
+    plan.lostSize = mBufferSize - std::min(mBufferSize, plan.usableSize);
+    return plan;
+  }
+
+ private:
+  size_t mBufferSize;
+  std::vector<Segment> mSegments;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_SCATTERGATHERLAYOUT_H_
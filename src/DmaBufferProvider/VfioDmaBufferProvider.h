@@ -0,0 +1,104 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file VfioDmaBufferProvider.h
+/// \brief Definition of the VfioDmaBufferProvider class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_VFIODMABUFFERPROVIDER_H_
+#define ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_VFIODMABUFFERPROVIDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include "ExceptionInternal.h"
+#include "Vfio/VfioDevice.h"
+#include "Vfio/VfioDmaBuffer.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Implementation of the DmaBufferProviderInterface for in-memory DMA buffers mapped with VFIO.
+/// The buffer is IOVA-contiguous, so its scatter-gather list has a single entry.
+class VfioDmaBufferProvider : public DmaBufferProviderInterface
+{
+ public:
+  VfioDmaBufferProvider(std::shared_ptr<Vfio::VfioDevice> device, void* userBufferAddress, size_t userBufferSize)
+    : mAddress(userBufferAddress), mSize(userBufferSize), mVfioBuffer(std::move(device), userBufferAddress, userBufferSize)
+  {
+  }
+
+  virtual ~VfioDmaBufferProvider() = default;
+
+  /// Get starting userspace address of the DMA buffer
+  virtual uintptr_t getAddress() const
+  {
+    return reinterpret_cast<uintptr_t>(mAddress);
+  }
+
+  /// Get total size of the DMA buffer
+  virtual size_t getSize() const
+  {
+    return mSize;
+  }
+
+  /// Amount of entries in the scatter-gather list
+  virtual size_t getScatterGatherListSize() const
+  {
+    return 1;
+  }
+
+  /// Get size of an entry of the scatter-gather list
+  virtual size_t getScatterGatherEntrySize(int index) const
+  {
+    checkIndex(index);
+    return mSize;
+  }
+
+  /// Get userspace address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryAddress(int index) const
+  {
+    checkIndex(index);
+    return getAddress();
+  }
+
+  /// Get bus address of an entry of the scatter-gather list
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const
+  {
+    checkIndex(index);
+    return mVfioBuffer.getIova();
+  }
+
+  /// Function for getting the bus address that corresponds to the user address + given offset
+  virtual uintptr_t getBusOffsetAddress(size_t offset) const
+  {
+    return mVfioBuffer.getBusOffsetAddress(offset);
+  }
+
+ private:
+  void checkIndex(int index) const
+  {
+    if (index != 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Scatter-gather list index out of range")
+                                        << ErrorInfo::Index(index));
+    }
+  }
+
+  void* mAddress;
+  size_t mSize;
+  Vfio::VfioDmaBuffer mVfioBuffer;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMABUFFERPROVIDER_VFIODMABUFFERPROVIDER_H_
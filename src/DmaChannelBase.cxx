@@ -19,6 +19,7 @@
 #include <iostream>
 //#include "ChannelPaths.h"
 #include "Common/System.h"
+#include "DmaHandover.h"
 #include "Utilities/SmartPointer.h"
 #include "Visitor.h"
 
@@ -123,12 +124,16 @@ DmaChannelBase::DmaChannelBase(CardDescriptor cardDescriptor, Parameters& parame
 
   log("Acquired DMA channel lock", InfoLogger::InfoLogger::Debug);
 
-  freeUnusedChannelBuffer();
+  if (DmaHandover::mayFreeChannelBuffers(parameters.getAdoptDmaEnabled().get_value_or(false), false)) {
+    freeUnusedChannelBuffer();
+  }
 }
 
 DmaChannelBase::~DmaChannelBase()
 {
-  freeUnusedChannelBuffer();
+  if (DmaHandover::mayFreeChannelBuffers(false, mHandedOver)) {
+    freeUnusedChannelBuffer();
+  }
   log("Releasing DMA channel lock", InfoLogger::InfoLogger::Debug);
 }
 
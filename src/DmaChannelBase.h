@@ -72,6 +72,30 @@ class DmaChannelBase : public DmaChannelInterface
     return {};
   }
 
+  /// Default implementation for optional function
+  virtual boost::optional<std::string> dumpFlightRecorder() override
+  {
+    return {};
+  }
+
+  /// Default implementation for optional function
+  virtual boost::optional<std::string> dumpSuperpageTrace() override
+  {
+    return {};
+  }
+
+  /// Default implementation for optional function
+  virtual boost::optional<std::string> handOverDma() override
+  {
+    return {};
+  }
+
+  /// Default implementation for optional function
+  virtual boost::optional<int> getArrivalNotificationFd() override
+  {
+    return {};
+  }
+
  protected:
   /// Namespace for enum describing the initialization state of the shared data
   struct InitializationState {
@@ -119,6 +143,13 @@ class DmaChannelBase : public DmaChannelInterface
     mLogLevel = severity;
   }
 
+  /// Keeps the PDA buffers of the device when the channel is closed, since the card keeps writing into them for the
+  /// successor the DMA was handed over to
+  void setHandedOver()
+  {
+    mHandedOver = true;
+  }
+
  private:
   /// Check if the channel number is valid
   void checkChannelNumber(const AllowedChannels& allowedChannels);
@@ -143,6 +174,9 @@ class DmaChannelBase : public DmaChannelInterface
 
   /// Current log level
   InfoLogger::InfoLogger::Severity mLogLevel;
+
+  /// The DMA was handed over to a successor
+  bool mHandedOver = false;
 };
 
 } // namespace roc
@@ -14,7 +14,12 @@
 /// \author Pascal Boeschoten (pascal.boeschoten@cern.ch)
 
 #include "DmaChannelPdaBase.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
 #include <boost/filesystem/path.hpp>
+#include <boost/format.hpp>
 #include "Common/Iommu.h"
 #include "Utilities/MemoryMaps.h"
 #include "Utilities/Numa.h"
@@ -23,6 +28,10 @@
 #include "DmaBufferProvider/PdaDmaBufferProvider.h"
 #include "DmaBufferProvider/FilePdaDmaBufferProvider.h"
 #include "DmaBufferProvider/NullDmaBufferProvider.h"
+#include "DmaBufferProvider/VfioDmaBufferProvider.h"
+#include "DmaBufferProvider/FileVfioDmaBufferProvider.h"
+#include "DmaBufferProvider/PartitionDmaBufferProvider.h"
+#include "Factory/ChannelFactoryUtils.h"
 #include "Visitor.h"
 
 namespace AliceO2
@@ -34,40 +43,88 @@ namespace
 
 CardDescriptor createCardDescriptor(const Parameters& parameters)
 {
+  if (parameters.getVfioEnabled().get_value_or(false)) {
+    return ChannelFactoryUtils::findVfioCard(parameters.getCardIdRequired());
+  }
   return Visitor::apply<CardDescriptor>(parameters.getCardIdRequired(),
                                         [&](int serial) { return RocPciDevice(serial).getCardDescriptor(); },
                                         [&](const PciAddress& address) { return RocPciDevice(address).getCardDescriptor(); },
                                         [&](const PciSequenceNumber& sequenceNumber) { return RocPciDevice(sequenceNumber).getCardDescriptor(); });
 }
 
+/// Identifies a buffer shared by the channels of a PCI function
+std::string getSharedBufferKey(const PciAddress& pciAddress, const Parameters::BufferParametersType& bufferParameters)
+{
+  return pciAddress.toString() + "_" +
+         Visitor::apply<std::string>(bufferParameters,
+                                     [&](buffer_parameters::Memory parameters) {
+                                       return (boost::format("memory_%1%_%2%") % parameters.address % parameters.size).str();
+                                     },
+                                     [&](buffer_parameters::File parameters) {
+                                       return (boost::format("file_%1%_%2%") % parameters.path % parameters.size).str();
+                                     },
+                                     [&](buffer_parameters::Null) -> std::string {
+                                       BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Buffer partition not supported with the null buffer"));
+                                     });
+}
+
 } // namespace
 
 DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
                                      const AllowedChannels& allowedChannels)
-  : DmaChannelBase(createCardDescriptor(parameters), const_cast<Parameters&>(parameters), allowedChannels), mDmaState(DmaState::STOPPED)
+  : DmaChannelBase(createCardDescriptor(parameters), const_cast<Parameters&>(parameters), allowedChannels),
+    mDmaState(DmaState::STOPPED),
+    mAdoptDma(parameters.getAdoptDmaEnabled().get_value_or(false))
 {
-  // Initialize PDA & DMA objects
-  Utilities::resetSmartPtr(mRocPciDevice, getCardDescriptor().pciAddress);
+  // Initialize PDA & DMA objects, or the VFIO device in their place
+  if (parameters.getVfioEnabled().get_value_or(false)) {
+    mVfioDevice = Vfio::VfioDevice::get(getCardDescriptor().pciAddress);
+  } else {
+    Utilities::resetSmartPtr(mRocPciDevice, getCardDescriptor().pciAddress);
+  }
 
   // Create/register buffer
   if (auto bufferParameters = parameters.getBufferParameters()) {
+    auto partition = parameters.getBufferPartition();
+    mBufferParameters = *bufferParameters;
+    mBufferPartitioned = bool(partition);
     // Create appropriate BufferProvider subclass
-    auto bufferId = getPdaDmaBufferIndexPages(getChannelNumber(), 0);
-    mBufferProvider = Visitor::apply<std::unique_ptr<DmaBufferProviderInterface>>(*bufferParameters,
-                                                                                  [&](buffer_parameters::Memory parameters) {
+    auto bufferId = partition ? getPdaDmaBufferIndexShared() : getPdaDmaBufferIndexPages(getChannelNumber(), 0);
+    auto createBufferProvider = [&] { return Visitor::apply<std::unique_ptr<DmaBufferProviderInterface>>(*bufferParameters,
+                                                                                  [&](buffer_parameters::Memory parameters) -> std::unique_ptr<DmaBufferProviderInterface> {
                                                                                     log("Initializing with DMA buffer from memory region", InfoLogger::InfoLogger::Debug);
+                                                                                    if (mVfioDevice) {
+                                                                                      return std::make_unique<VfioDmaBufferProvider>(mVfioDevice, parameters.address, parameters.size);
+                                                                                    }
                                                                                     return std::make_unique<PdaDmaBufferProvider>(mRocPciDevice->getPciDevice(), parameters.address,
                                                                                                                                   parameters.size, bufferId, true);
                                                                                   },
-                                                                                  [&](buffer_parameters::File parameters) {
+                                                                                  [&](buffer_parameters::File parameters) -> std::unique_ptr<DmaBufferProviderInterface> {
                                                                                     log("Initializing with DMA buffer from memory-mapped file", InfoLogger::InfoLogger::Debug);
+                                                                                    if (mVfioDevice) {
+                                                                                      return std::make_unique<FileVfioDmaBufferProvider>(mVfioDevice, parameters.path, parameters.size);
+                                                                                    }
                                                                                     return std::make_unique<FilePdaDmaBufferProvider>(mRocPciDevice->getPciDevice(), parameters.path,
                                                                                                                                       parameters.size, bufferId, true);
                                                                                   },
                                                                                   [&](buffer_parameters::Null) {
                                                                                     log("Initializing with null DMA buffer", InfoLogger::InfoLogger::Debug);
                                                                                     return std::make_unique<NullDmaBufferProvider>();
-                                                                                  });
+                                                                                  }); };
+
+    if (partition) {
+      const size_t hugePageMinSize = 1024 * 1024 * 2; // 2 MiB, the smallest hugepage size
+      if (!Utilities::isMultiple(partition->offset, hugePageMinSize) || !Utilities::isMultiple(partition->size, hugePageMinSize)) {
+        BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("Buffer partition offset and size must be multiples of 2 MiB"));
+      }
+      // The first channel of this process to use the buffer registers it, the others reuse the registration
+      mBufferProvider = PartitionDmaBufferProvider::makeShared(getSharedBufferKey(getCardDescriptor().pciAddress, *bufferParameters),
+                                                               createBufferProvider, partition->offset, partition->size);
+      log((boost::format("Using partition at offset %1% MiB of %2% MiB of shared DMA buffer") % (partition->offset / (1024 * 1024))
+           % (partition->size / (1024 * 1024))).str());
+    } else {
+      mBufferProvider = createBufferProvider();
+    }
   } else {
     BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DmaChannel requires buffer_parameters"));
   }
@@ -85,6 +142,10 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
       log(message, InfoLogger::InfoLogger::Error);
       BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(message));
     }
+
+    mScatterGatherLayout = std::make_unique<ScatterGatherLayout>(getBufferProvider());
+    log(std::string("Bus-contiguous segments: ") + std::to_string(mScatterGatherLayout->getSegments().size()) +
+        ", largest " + std::to_string(mScatterGatherLayout->getLargestSegmentSize() / 1024) + " KiB");
   }
 
   // Check memory mappings if it's hugepage
@@ -94,7 +155,8 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
     const auto maps = Utilities::getMemoryMaps();
     for (const auto& map : maps) {
       const auto bufferAddress = reinterpret_cast<uintptr_t>(getBufferProvider().getAddress());
-      if (map.addressStart == bufferAddress) {
+      // A partition of a shared buffer starts inside the mapping
+      if (map.addressStart <= bufferAddress && bufferAddress < map.addressEnd) {
         if (map.pageSizeKiB > 4) {
           log("Buffer is hugepage-backed", InfoLogger::InfoLogger::Info);
         } else {
@@ -117,19 +179,47 @@ DmaChannelPdaBase::DmaChannelPdaBase(const Parameters& parameters,
       log("Failed to check if buffer is hugepage-backed", InfoLogger::InfoLogger::Warning);
     }
   }
+
+  if (mAdoptDma) {
+    log("Channel will adopt the running DMA handed over by its previous owner, and will not be reset");
+  }
+
+  if (parameters.getArrivalNotificationEnabled().get_value_or(false)) {
+    if (mVfioDevice) {
+      auto notifier = std::make_unique<EventFdNotifier>();
+      mVfioDevice->setMsiTrigger(notifier->getFd());
+      mArrivalNotifier = std::move(notifier);
+      log("Arrival notification through the MSI", InfoLogger::InfoLogger::Debug);
+    } else {
+      mArrivalNotifier = std::make_unique<UioNotifier>(getCardDescriptor().pciAddress);
+      log("Arrival notification through the UIO device", InfoLogger::InfoLogger::Debug);
+    }
+  }
 }
 
 DmaChannelPdaBase::~DmaChannelPdaBase()
 {
+  if (mVfioDevice && mArrivalNotifier) {
+    // The kernel must not signal the eventfd once it is closed
+    mVfioDevice->setMsiTrigger(-1);
+  }
 }
 
 // Checks DMA state and forwards call to subclass if necessary
 void DmaChannelPdaBase::startDma()
 {
+  if (mDmaState == DmaState::HANDED_OVER) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Start DMA failed: DMA was handed over"));
+  }
+
   if (mDmaState == DmaState::UNKNOWN) {
     log("Unknown DMA state");
   } else if (mDmaState == DmaState::STARTED) {
     log("DMA already started. Ignoring startDma() call");
+  } else if (mAdoptDma) {
+    log("Adopting running DMA", InfoLogger::InfoLogger::Debug);
+    adoptDma();
+    mAdoptDma = false;
   } else {
     log("Starting DMA", InfoLogger::InfoLogger::Debug);
     deviceStartDma();
@@ -140,6 +230,11 @@ void DmaChannelPdaBase::startDma()
 // Checks DMA state and forwards call to subclass if necessary
 void DmaChannelPdaBase::stopDma()
 {
+  if (mDmaState == DmaState::HANDED_OVER) {
+    log("DMA was handed over. Ignoring stopDma() call");
+    return;
+  }
+
   if (mDmaState == DmaState::UNKNOWN) {
     log("Unknown DMA state");
   } else if (mDmaState == DmaState::STOPPED) {
@@ -153,6 +248,10 @@ void DmaChannelPdaBase::stopDma()
 
 void DmaChannelPdaBase::resetChannel(ResetLevel::type resetLevel)
 {
+  if (mAdoptDma) {
+    log("Adopting running DMA. Ignoring resetChannel() call");
+    return;
+  }
   if (mDmaState == DmaState::UNKNOWN) {
     BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Reset channel failed: DMA in unknown state"));
   }
@@ -164,6 +263,76 @@ void DmaChannelPdaBase::resetChannel(ResetLevel::type resetLevel)
   deviceResetChannel(resetLevel);
 }
 
+boost::optional<int> DmaChannelPdaBase::getArrivalNotificationFd()
+{
+  if (!mArrivalNotifier) {
+    return {};
+  }
+  return mArrivalNotifier->getFd();
+}
+
+boost::optional<std::string> DmaChannelPdaBase::handOverDma()
+{
+  if (mDmaState != DmaState::STARTED) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Hand over failed: DMA was not started"));
+  }
+  if (Common::Iommu::isEnabled()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(
+                            "Hand over failed: with the IOMMU enabled, the successor would map the buffer to other bus addresses than the ones the card is using"));
+  }
+  DmaHandover::checkBuffer(mBufferParameters, mBufferPartitioned);
+  // The card keeps writing to the buffer, so it must stay registered when this process closes the channel
+  if (!mBufferProvider->keepRegistered()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Hand over failed: the DMA buffer cannot stay registered after the channel is closed"));
+  }
+
+  DmaHandover handover;
+  handover.cardType = getCardType();
+  handover.channel = getChannelNumber();
+  handover.pciAddress = getPciAddress().toString();
+  handover.bufferSize = getBufferProvider().getSize();
+  handover.busFingerprint = DmaHandover::fingerprint(getBufferProvider());
+  deviceExportDma(handover);
+
+  auto path = getPaths().handover();
+  handover.write(path);
+  mDmaState = DmaState::HANDED_OVER;
+  setHandedOver();
+  log((boost::format("Handed over running DMA with %1% superpage(s) to '%2%'") % handover.superpages.size() % path).str());
+  return path;
+}
+
+void DmaChannelPdaBase::adoptDma()
+{
+  auto path = getPaths().handover();
+  auto handover = DmaHandover::read(path);
+
+  if (handover.cardType != getCardType() || handover.channel != getChannelNumber() ||
+      handover.pciAddress != getPciAddress().toString()) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Adopt DMA failed: handed over state belongs to another channel")
+                                      << ErrorInfo::FileName(path));
+  }
+  if (handover.bufferSize != getBufferProvider().getSize() ||
+      handover.busFingerprint != DmaHandover::fingerprint(getBufferProvider())) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Adopt DMA failed: DMA buffer differs from the handed over one")
+                                      << ErrorInfo::FileName(path)
+                                      << ErrorInfo::PossibleCauses({ "Different buffer file or size than the previous owner",
+                                                                     "Buffer pages were remapped (IOMMU enabled, buffer file deleted)" }));
+  }
+
+  deviceAdoptDma(handover);
+  std::remove(path.c_str());
+  log((boost::format("Adopted running DMA with %1% superpage(s)") % handover.superpages.size()).str());
+}
+
+int DmaChannelPdaBase::getPdaDmaBufferIndexShared()
+{
+  // The PID is at most 2^22, which keeps the range clear of the top of int
+  static std::atomic<int> bufferNumber{ 0 };
+  return DMA_BUFFER_INDEX_SHARED_OFFSET + (getpid() * DMA_BUFFER_INDEX_SHARED_PROCESS_MAX) +
+         (bufferNumber++ % DMA_BUFFER_INDEX_SHARED_PROCESS_MAX);
+}
+
 uintptr_t DmaChannelPdaBase::getBusOffsetAddress(size_t offset)
 {
   return getBufferProvider().getBusOffsetAddress(offset);
@@ -189,6 +358,24 @@ void DmaChannelPdaBase::checkSuperpage(const Superpage& superpage)
     BOOST_THROW_EXCEPTION(Exception()
                           << ErrorInfo::Message("Superpage offset not 32-bit aligned"));
   }
+
+  // The card gets one bus address per superpage, so it must not cross a scatter-gather segment boundary
+  const auto& layout = getScatterGatherLayout();
+  if (!layout.getSegments().empty() && !layout.isContiguous(superpage.getOffset(), superpage.getSize())) {
+    // Tell the user where superpages of this size do fit
+    const auto plan = layout.plan(superpage.getSize(), 4);
+    auto next = std::lower_bound(plan.offsets.begin(), plan.offsets.end(), superpage.getOffset());
+    std::string message = "Superpage crosses a scatter-gather segment boundary; the buffer fits " +
+                          std::to_string(plan.offsets.size()) + " superpages of this size, losing " +
+                          std::to_string(plan.lostSize / 1024) + " KiB";
+    if (next != plan.offsets.end()) {
+      message += ", the next valid offset is " + std::to_string(*next);
+    }
+    BOOST_THROW_EXCEPTION(Exception()
+                          << ErrorInfo::Message(message)
+                          << ErrorInfo::Offset(superpage.getOffset())
+                          << ErrorInfo::DmaPageSize(superpage.getSize()));
+  }
 }
 
 PciAddress DmaChannelPdaBase::getPciAddress()
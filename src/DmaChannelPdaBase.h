@@ -17,8 +17,11 @@
 #define ALICEO2_SRC_READOUTCARD_DMACHANNELPDABASE_H_
 
 #include <boost/scoped_ptr.hpp>
+#include "ArrivalNotifier.h"
 #include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include "DmaBufferProvider/ScatterGatherLayout.h"
 #include "DmaChannelBase.h"
+#include "DmaHandover.h"
 #include "Pda/PdaBar.h"
 #include "Pda/PdaDmaBuffer.h"
 #include "ReadoutCard/DmaChannelInterface.h"
@@ -26,6 +29,7 @@
 #include "ReadoutCard/MemoryMappedFile.h"
 #include "ReadoutCard/Parameters.h"
 #include "RocPciDevice.h"
+#include "Vfio/VfioDevice.h"
 
 namespace AliceO2
 {
@@ -51,6 +55,8 @@ class DmaChannelPdaBase : public DmaChannelBase
   void resetChannel(ResetLevel::type resetLevel) final override;
   virtual PciAddress getPciAddress() final override;
   virtual int getNumaNode() final override;
+  virtual boost::optional<std::string> handOverDma() final override;
+  virtual boost::optional<int> getArrivalNotificationFd() final override;
 
  protected:
   /// Maximum amount of PDA DMA buffers for channel FIFOs (1 per channel, so this also represents the max amount of
@@ -73,6 +79,14 @@ class DmaChannelPdaBase : public DmaChannelBase
     return DMA_BUFFER_INDEX_PAGES_OFFSET + (channel * DMA_BUFFER_INDEX_PAGES_CHANNEL_MAX) + bufferNumber;
   }
 
+  /// Start of integer range for PDA DMA buffers shared by channels
+  static constexpr int DMA_BUFFER_INDEX_SHARED_OFFSET = 1100000000;
+  /// Maximum amount of shared PDA DMA buffers per process
+  static constexpr int DMA_BUFFER_INDEX_SHARED_PROCESS_MAX = 200;
+
+  /// Gets an index for a shared buffer. No channel owns it, so it is made unique by the process ID.
+  static int getPdaDmaBufferIndexShared();
+
   static int pdaBufferIndexToChannelBufferIndex(int channel, int pdaIndex)
   {
     return (pdaIndex - DMA_BUFFER_INDEX_PAGES_OFFSET) - (channel * DMA_BUFFER_INDEX_PAGES_CHANNEL_MAX);
@@ -84,7 +98,8 @@ class DmaChannelPdaBase : public DmaChannelBase
     enum type {
       UNKNOWN = 0,
       STOPPED = 1,
-      STARTED = 2
+      STARTED = 2,
+      HANDED_OVER = 3 ///< Running, but owned by a successor process
     };
   };
 
@@ -100,6 +115,33 @@ class DmaChannelPdaBase : public DmaChannelBase
   /// Template method called by resetChannel() to do device-specific (CRORC, RCU...) actions
   virtual void deviceResetChannel(ResetLevel::type resetLevel) = 0;
 
+  /// Template method called by handOverDma() to export the device-specific state of the running DMA
+  virtual void deviceExportDma(DmaHandover& handover) = 0;
+
+  /// Template method called by startDma() to take over the running DMA from the handed over state, instead of
+  /// deviceStartDma()
+  virtual void deviceAdoptDma(const DmaHandover& handover) = 0;
+
+  /// Will startDma() adopt a running DMA, in which case the channel must not be reset
+  bool isAdoptingDma() const
+  {
+    return mAdoptDma;
+  }
+
+  /// Was the DMA handed over to a successor, in which case it must be left running
+  bool isHandedOver() const
+  {
+    return mDmaState == DmaState::HANDED_OVER;
+  }
+
+  /// Acknowledges the arrival notification, if enabled. Called by fillSuperpages() before it looks for arrivals.
+  void acknowledgeArrivals()
+  {
+    if (mArrivalNotifier) {
+      mArrivalNotifier->acknowledge();
+    }
+  }
+
   /// Function for getting the bus address that corresponds to the user address + given offset
   uintptr_t getBusOffsetAddress(size_t offset);
 
@@ -108,6 +150,11 @@ class DmaChannelPdaBase : public DmaChannelBase
     return *(mBufferProvider.get());
   }
 
+  const ScatterGatherLayout& getScatterGatherLayout() const
+  {
+    return *(mScatterGatherLayout.get());
+  }
+
   const RocPciDevice& getRocPciDevice() const
   {
     return *(mRocPciDevice.get());
@@ -117,11 +164,32 @@ class DmaChannelPdaBase : public DmaChannelBase
   /// Contains addresses & size of the buffer
   std::unique_ptr<DmaBufferProviderInterface> mBufferProvider;
 
+  /// Bus-contiguous segments of the buffer
+  std::unique_ptr<ScatterGatherLayout> mScatterGatherLayout;
+
+  /// Parameters of the buffer, to check if it can be handed over
+  Parameters::BufferParametersType mBufferParameters;
+
+  /// The buffer is a partition of a buffer shared by several channels
+  bool mBufferPartitioned;
+
+  /// Takes over the DMA handed over by the previous owner of the channel
+  void adoptDma();
+
   /// Current state of the DMA
   DmaState::type mDmaState;
 
+  /// startDma() adopts the running DMA handed over by the previous owner
+  bool mAdoptDma;
+
   /// PDA device objects
   boost::scoped_ptr<RocPciDevice> mRocPciDevice;
+
+  /// VFIO device, instead of the PDA device objects if VFIO is enabled
+  std::shared_ptr<Vfio::VfioDevice> mVfioDevice;
+
+  /// Notifies the consumer of arrivals, if the ArrivalNotificationEnabled parameter is set
+  std::unique_ptr<ArrivalNotifier> mArrivalNotifier;
 };
 
 } // namespace roc
@@ -0,0 +1,157 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DmaHandover.cxx
+/// \brief Implementation of the DmaHandover struct.
+
+#include "DmaHandover.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace
+{
+
+constexpr char MAGIC[8] = { 'R', 'O', 'C', 'H', 'N', 'D', '0', '1' };
+
+/// Fixed-size part of the binary state
+struct Header {
+  char magic[8];
+  int32_t cardType;
+  int32_t channel;
+  char pciAddress[16];
+  uint64_t bufferSize;
+  uint64_t busFingerprint;
+  uint64_t fifoBusAddress;
+  uint32_t links;
+  uint32_t superpages;
+  int32_t fifoFront;
+  int32_t fifoBack;
+  int32_t fifoSize;
+  uint32_t pendingDmaStart;
+};
+
+} // Anonymous namespace
+
+void DmaHandover::write(const std::string& path) const
+{
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.cardType = cardType;
+  header.channel = channel;
+  pciAddress.copy(header.pciAddress, sizeof(header.pciAddress) - 1);
+  header.bufferSize = bufferSize;
+  header.busFingerprint = busFingerprint;
+  header.fifoBusAddress = fifoBusAddress;
+  header.links = links.size();
+  header.superpages = superpages.size();
+  header.fifoFront = fifoFront;
+  header.fifoBack = fifoBack;
+  header.fifoSize = fifoSize;
+  header.pendingDmaStart = pendingDmaStart;
+
+  auto temporaryPath = path + ".tmp";
+  {
+    std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(links.data()), links.size() * sizeof(LinkEntry));
+    stream.write(reinterpret_cast<const char*>(superpages.data()), superpages.size() * sizeof(SuperpageEntry));
+    if (!stream.flush()) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to write DMA handover state")
+                                        << ErrorInfo::FileName(temporaryPath));
+    }
+  }
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to rename DMA handover state")
+                                      << ErrorInfo::FileName(path));
+  }
+}
+
+DmaHandover DmaHandover::read(const std::string& path)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("No DMA handover state to adopt")
+                                      << ErrorInfo::FileName(path));
+  }
+
+  Header header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Invalid DMA handover state")
+                                      << ErrorInfo::FileName(path));
+  }
+
+  DmaHandover handover;
+  handover.cardType = header.cardType;
+  handover.channel = header.channel;
+  handover.pciAddress = std::string(header.pciAddress, strnlen(header.pciAddress, sizeof(header.pciAddress)));
+  handover.bufferSize = header.bufferSize;
+  handover.busFingerprint = header.busFingerprint;
+  handover.fifoBusAddress = header.fifoBusAddress;
+  handover.fifoFront = header.fifoFront;
+  handover.fifoBack = header.fifoBack;
+  handover.fifoSize = header.fifoSize;
+  handover.pendingDmaStart = header.pendingDmaStart;
+  handover.links.resize(header.links);
+  handover.superpages.resize(header.superpages);
+  stream.read(reinterpret_cast<char*>(handover.links.data()), handover.links.size() * sizeof(LinkEntry));
+  stream.read(reinterpret_cast<char*>(handover.superpages.data()), handover.superpages.size() * sizeof(SuperpageEntry));
+  if (!stream) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Truncated DMA handover state")
+                                      << ErrorInfo::FileName(path));
+  }
+  return handover;
+}
+
+uint64_t DmaHandover::fingerprint(const DmaBufferProviderInterface& provider)
+{
+  // FNV-1a
+  uint64_t hash = 0xcbf29ce484222325;
+  auto add = [&](uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash ^= (value >> (i * 8)) & 0xff;
+      hash *= 0x100000001b3;
+    }
+  };
+  add(provider.getSize());
+  for (size_t i = 0; i < provider.getScatterGatherListSize(); ++i) {
+    add(provider.getScatterGatherEntryBusAddress(i));
+    add(provider.getScatterGatherEntrySize(i));
+  }
+  return hash;
+}
+
+void DmaHandover::checkBuffer(const Parameters::BufferParametersType& bufferParameters, bool partitioned)
+{
+  auto file = boost::get<buffer_parameters::File>(&bufferParameters);
+  if (!file) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(
+                            "Hand over failed: the DMA buffer is not a file, so it would be freed with this process while the card is writing to it"));
+  }
+  if (partitioned) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(
+                            "Hand over failed: the DMA buffer is a partition of a buffer shared with other channels")
+                                      << ErrorInfo::FileName(file->path));
+  }
+  if (!boost::filesystem::exists(file->path)) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Hand over failed: the DMA buffer file does not exist anymore")
+                                      << ErrorInfo::FileName(file->path));
+  }
+}
+
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,99 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file DmaHandover.h
+/// \brief Definition of the DmaHandover struct.
+
+#ifndef ALICEO2_SRC_READOUTCARD_DMAHANDOVER_H_
+#define ALICEO2_SRC_READOUTCARD_DMAHANDOVER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+#include "ReadoutCard/Parameters.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// State of a running DMA channel, handed over by the process that owns the channel to its successor, so that the
+/// successor can adopt the running DMA instead of stopping, resetting and restarting it.
+/// It is written as a binary blob to shared memory.
+struct DmaHandover {
+  /// A superpage the old owner had pushed and not yet popped
+  struct SuperpageEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t received;
+    uint32_t link;  ///< Index of the link (CRU), or 0
+    uint32_t ready; ///< Already in the ready queue, rather than in flight on the card
+  };
+
+  /// Per-link counters of the old owner
+  struct LinkEntry {
+    uint32_t id;
+    uint32_t superpageCounter; ///< Superpages moved to the ready queue, to compare with the card's counter
+  };
+
+  // Identity of the channel and its buffer. Adoption is refused if they don't match.
+  int32_t cardType = 0;
+  int32_t channel = 0;
+  std::string pciAddress;
+  uint64_t bufferSize = 0;
+  uint64_t busFingerprint = 0; ///< Hash of the bus addresses the card was given, see fingerprint()
+
+  /// Links, in the order of the old owner
+  std::vector<LinkEntry> links;
+
+  /// Superpages in flight per link, in queue order, followed by the ready superpages in queue order
+  std::vector<SuperpageEntry> superpages;
+
+  // C-RORC ReadyFifo bus address and Free FIFO indices
+  uint64_t fifoBusAddress = 0;
+  int32_t fifoFront = 0;
+  int32_t fifoBack = 0;
+  int32_t fifoSize = 0;
+  bool pendingDmaStart = false;
+
+  /// Writes the state to the given path. The file is written under a temporary name first and then renamed, so a
+  /// successor never reads a partial state.
+  void write(const std::string& path) const;
+
+  /// Reads the state from the given path
+  /// \exception Exception The file does not exist, or is not a valid handover state
+  static DmaHandover read(const std::string& path);
+
+  /// Hash of the scatter-gather list's bus addresses and sizes. If it differs, the successor's registration of the
+  /// buffer gave it different bus addresses than the ones the card is writing to.
+  static uint64_t fingerprint(const DmaBufferProviderInterface& provider);
+
+  /// Checks that a buffer outlives the process that hands over the DMA, since the card keeps writing to it. That is
+  /// only the case for a file mapping, e.g. in a hugetlbfs mount. A buffer in process memory is freed with the process,
+  /// and a partition of a shared buffer is registered by the process for all its channels.
+  /// \exception Exception The buffer does not outlive the process
+  static void checkBuffer(const Parameters::BufferParametersType& bufferParameters, bool partitioned);
+
+  /// Whether a channel may free the unused PDA buffers of its device, which it does when it is opened and closed to
+  /// clean up after crashed processes. The card keeps writing into the buffers of a handed over DMA, so neither the old
+  /// owner when it closes the channel nor the successor when it opens it may free them.
+  /// \param adoptDma The channel adopts a handed over DMA
+  /// \param handedOver The channel handed its DMA over
+  static bool mayFreeChannelBuffers(bool adoptDma, bool handedOver)
+  {
+    return !adoptDma && !handedOver;
+  }
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_DMAHANDOVER_H_
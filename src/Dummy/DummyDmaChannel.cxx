@@ -53,6 +53,10 @@ DummyDmaChannel::DummyDmaChannel(const Parameters& params)
   } else {
     BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("DmaChannel requires buffer_parameters"));
   }
+
+  if (params.getArrivalNotificationEnabled().get_value_or(false)) {
+    mArrivalNotifier = std::make_unique<EventFdNotifier>();
+  }
 }
 
 DummyDmaChannel::~DummyDmaChannel()
@@ -124,6 +128,9 @@ void DummyDmaChannel::pushSuperpage(Superpage superpage)
   }
 
   mTransferQueue.push_back(superpage);
+  if (mArrivalNotifier) {
+    mArrivalNotifier->signal();
+  }
 }
 
 Superpage DummyDmaChannel::getSuperpage()
@@ -144,6 +151,9 @@ Superpage DummyDmaChannel::popSuperpage()
 
 void DummyDmaChannel::fillSuperpages()
 {
+  if (mArrivalNotifier) {
+    mArrivalNotifier->acknowledge();
+  }
   size_t pushQueueSize = mTransferQueue.size();
   for (size_t i = 0; i < pushQueueSize; ++i) {
     if (mReadyQueue.full()) {
@@ -196,5 +206,13 @@ int DummyDmaChannel::getNumaNode()
   return 0;
 }
 
+boost::optional<int> DummyDmaChannel::getArrivalNotificationFd()
+{
+  if (!mArrivalNotifier) {
+    return {};
+  }
+  return mArrivalNotifier->getFd();
+}
+
 } // namespace roc
 } // namespace AliceO2
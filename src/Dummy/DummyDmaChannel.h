@@ -20,6 +20,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/circular_buffer_fwd.hpp>
 #include <boost/circular_buffer.hpp>
+#include "ArrivalNotifier.h"
 #include "DmaChannelBase.h"
 
 namespace AliceO2
@@ -60,6 +61,7 @@ class DummyDmaChannel final : public DmaChannelBase
   virtual CardType::type getCardType() override;
   virtual PciAddress getPciAddress() override;
   virtual int getNumaNode() override;
+  virtual boost::optional<int> getArrivalNotificationFd() override;
 
  private:
   using Queue = boost::circular_buffer<Superpage>;
@@ -67,6 +69,9 @@ class DummyDmaChannel final : public DmaChannelBase
   Queue mTransferQueue;
   Queue mReadyQueue;
   size_t mBufferSize;
+
+  /// Signalled when a pushed superpage is done, which on the dummy is right away
+  std::unique_ptr<EventFdNotifier> mArrivalNotifier;
 };
 
 } // namespace roc
@@ -68,6 +68,7 @@ DEFINE_ERRINFO(Index, size_t);
 DEFINE_ERRINFO(LinkId, uint32_t);
 DEFINE_ERRINFO(DataSource, ::AliceO2::roc::DataSource::type);
 DEFINE_ERRINFO(NamedMutexName, std::string);
+DEFINE_ERRINFO(NumaNode, int);
 DEFINE_ERRINFO(Offset, size_t);
 DEFINE_ERRINFO(PageIndex, int);
 DEFINE_ERRINFO(Pages, size_t);
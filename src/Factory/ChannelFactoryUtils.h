@@ -21,6 +21,7 @@
 #include "ReadoutCard/Parameters.h"
 #ifdef ALICEO2_READOUTCARD_PDA_ENABLED
 #include "RocPciDevice.h"
+#include "Vfio/VfioDevice.h"
 #endif
 
 namespace AliceO2
@@ -119,6 +120,16 @@ inline CardDescriptor findCard(const Parameters::CardIdType& id)
   }
 }
 
+/// Finds a card bound to vfio-pci, which the PDA functions above do not see
+inline CardDescriptor findVfioCard(const Parameters::CardIdType& id)
+{
+  if (auto address = boost::get<PciAddress>(&id)) {
+    return Vfio::VfioDevice::getCardDescriptor(*address);
+  }
+  BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message("VFIO requires the card to be identified by its PCI address")
+                                             << ErrorInfo::CardId(id));
+}
+
 /// Helper template method for the channel factories.
 /// \param serialNumber Serial number of the card
 /// \param dummySerial Serial number that indicates a dummy object should be instantiated
@@ -153,7 +164,7 @@ std::unique_ptr<Interface> channelFactoryHelper(const Parameters& params, int du
   }
 
   // Else, find the card with the given ID, and execute the instantiation function corresponding to the card's type.
-  auto cardDescriptor = findCard(id);
+  auto cardDescriptor = params.getVfioEnabled().get_value_or(false) ? findVfioCard(id) : findCard(id);
 
   auto iter = map.find(cardDescriptor.cardType);
   if (iter != map.end()) {
@@ -0,0 +1,309 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FlightRecorder.h
+/// \brief Definition of the FlightRecorder class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_FLIGHTRECORDER_H_
+#define ALICEO2_READOUTCARD_SRC_FLIGHTRECORDER_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <boost/circular_buffer.hpp>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Always-on recorder of the DMA queue state, used to find out why the firmware dropped packets.
+/// Polls are aggregated into samples of SAMPLE_INTERVAL, kept in a ring of CAPACITY samples. When the drop counter
+/// increases, the recorder keeps going for POST_TRIGGER_SAMPLES more samples and then freezes, so the window around the
+/// event can be dumped. Recording resumes after rearm().
+template <size_t MAX_LINKS>
+class FlightRecorder
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Amount of samples kept in the ring
+  static constexpr size_t CAPACITY = 4096;
+
+  /// Samples recorded after a drop before freezing
+  static constexpr size_t POST_TRIGGER_SAMPLES = CAPACITY / 4;
+
+  /// Minimum time covered by one sample
+  static constexpr std::chrono::microseconds SAMPLE_INTERVAL{ 100 };
+
+  /// Minimum time between two reads of the drop counter, which costs a BAR access
+  static constexpr std::chrono::microseconds DROP_CHECK_INTERVAL{ 1000 };
+
+  struct Sample {
+    Clock::time_point time;
+    uint32_t polls = 0;                               ///< Polls aggregated in this sample
+    uint32_t maxPollInterval = 0;                     ///< Longest time between two polls in ns
+    uint32_t pushes = 0;                              ///< Superpages pushed during this sample
+    uint32_t arrivals = 0;                            ///< Superpages moved to the ready queue during this sample
+    uint32_t pops = 0;                                ///< Superpages popped during this sample
+    uint32_t readyQueueSize = 0;                      ///< Ready queue depth at the end of the sample
+    uint32_t droppedPackets = 0;                      ///< Last read value of the firmware drop counter
+    std::array<uint16_t, MAX_LINKS> linkQueueSizes{}; ///< Transfer queue depth per link at the end of the sample
+  };
+
+  /// The recorded samples, taken out of the recorder to be dumped
+  struct Snapshot {
+    std::string reason;
+    size_t links = 0;
+    bool triggered = false;
+    Clock::time_point triggerTime;
+    boost::circular_buffer<Sample> samples;
+
+    /// Writes the samples as CSV. Times are in µs relative to the trigger, or to the last sample if there was no
+    /// trigger.
+    void dump(std::ostream& stream) const
+    {
+      if (samples.empty()) {
+        stream << "# Flight recorder: no samples recorded\n";
+        return;
+      }
+
+      auto reference = triggered ? triggerTime : samples.back().time;
+      stream << "# Flight recorder: " << reason << ", " << samples.size() << " samples\n";
+      stream << "time_us,polls,max_poll_interval_ns,pushes,arrivals,pops,ready_queue,dropped";
+      for (size_t i = 0; i < links; ++i) {
+        stream << ",link_queue_" << i;
+      }
+      stream << "\n";
+
+      for (const auto& sample : samples) {
+        stream << std::chrono::duration_cast<std::chrono::microseconds>(sample.time - reference).count() << ","
+               << sample.polls << "," << sample.maxPollInterval << "," << sample.pushes << "," << sample.arrivals << ","
+               << sample.pops << "," << sample.readyQueueSize << "," << sample.droppedPackets;
+        for (size_t i = 0; i < links; ++i) {
+          stream << "," << sample.linkQueueSizes[i];
+        }
+        stream << "\n";
+      }
+    }
+  };
+
+  FlightRecorder(size_t links = 0) : mLinks(std::min(links, MAX_LINKS)), mSamples(CAPACITY)
+  {
+  }
+
+  void countPush()
+  {
+    mCurrent.pushes++;
+  }
+
+  void countArrival()
+  {
+    mCurrent.arrivals++;
+  }
+
+  void countPop()
+  {
+    mCurrent.pops++;
+  }
+
+  /// Registers a poll. Returns true if the current sample is due and the caller should fill in the queue state and
+  /// commit() it.
+  bool poll(Clock::time_point now)
+  {
+    if (mPreviousPoll != Clock::time_point()) {
+      auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - mPreviousPoll).count();
+      mCurrent.maxPollInterval = std::max<uint32_t>(mCurrent.maxPollInterval, std::min<int64_t>(interval, UINT32_MAX));
+    }
+    mPreviousPoll = now;
+    mCurrent.polls++;
+
+    if (mFrozen || (now - mSampleStart) < SAMPLE_INTERVAL) {
+      return false;
+    }
+    mCurrent.time = now;
+    return true;
+  }
+
+  /// Is it time to read the drop counter again
+  bool isDropCheckDue(Clock::time_point now)
+  {
+    if ((now - mLastDropCheck) < DROP_CHECK_INTERVAL) {
+      return false;
+    }
+    mLastDropCheck = now;
+    return true;
+  }
+
+  /// Updates the drop counter. An increase triggers the capture of the surrounding window.
+  void setDroppedPackets(uint32_t dropped)
+  {
+    if (mDroppedValid && dropped != mCurrent.droppedPackets && !mTriggered) {
+      mTriggered = true;
+      mTriggerTime = mCurrent.time;
+      mPostTriggerRemaining = POST_TRIGGER_SAMPLES;
+    }
+    mCurrent.droppedPackets = dropped;
+    mDroppedValid = true;
+  }
+
+  void setReadyQueueSize(size_t size)
+  {
+    mCurrent.readyQueueSize = size;
+  }
+
+  void setLinkQueueSize(size_t link, size_t size)
+  {
+    if (link < MAX_LINKS) {
+      mCurrent.linkQueueSizes[link] = size;
+    }
+  }
+
+  /// Stores the current sample in the ring and starts a new one
+  void commit()
+  {
+    mSamples.push_back(mCurrent);
+    mSampleStart = mCurrent.time;
+
+    auto dropped = mCurrent.droppedPackets;
+    mCurrent = Sample();
+    mCurrent.droppedPackets = dropped;
+
+    if (mTriggered && (mPostTriggerRemaining == 0 || --mPostTriggerRemaining == 0)) {
+      mFrozen = true;
+    }
+  }
+
+  /// Has a drop been captured and is waiting to be dumped
+  bool isFrozen() const
+  {
+    return mFrozen;
+  }
+
+  /// Resumes recording after a captured event was dumped
+  void rearm()
+  {
+    mFrozen = false;
+    mTriggered = false;
+    mSamples.clear();
+  }
+
+  /// Copies the recorded samples, recording goes on
+  Snapshot snapshot(const std::string& reason) const
+  {
+    return { reason, mLinks, mTriggered, mTriggerTime, mSamples };
+  }
+
+  /// Moves the recorded samples out, without copying them, and rearms the recorder
+  Snapshot take(const std::string& reason)
+  {
+    Snapshot snapshot{ reason, mLinks, mTriggered, mTriggerTime, boost::circular_buffer<Sample>(CAPACITY) };
+    std::swap(snapshot.samples, mSamples);
+    rearm();
+    return snapshot;
+  }
+
+  /// Writes the recorded samples as CSV, see Snapshot::dump()
+  void dump(std::ostream& stream, const std::string& reason) const
+  {
+    snapshot(reason).dump(stream);
+  }
+
+ private:
+  size_t mLinks;
+  boost::circular_buffer<Sample> mSamples;
+  Sample mCurrent;
+  Clock::time_point mSampleStart;
+  Clock::time_point mPreviousPoll;
+  Clock::time_point mLastDropCheck;
+  Clock::time_point mTriggerTime;
+  bool mDroppedValid = false;
+  bool mTriggered = false;
+  bool mFrozen = false;
+  size_t mPostTriggerRemaining = 0;
+};
+
+template <size_t MAX_LINKS>
+constexpr std::chrono::microseconds FlightRecorder<MAX_LINKS>::SAMPLE_INTERVAL;
+
+template <size_t MAX_LINKS>
+constexpr std::chrono::microseconds FlightRecorder<MAX_LINKS>::DROP_CHECK_INTERVAL;
+
+/// Runs the writes of flight recorder dumps on a thread of its own, started on the first write, so that a dump
+/// triggered in the polling loop does not stall it. The pending writes are finished on destruction.
+class FlightRecorderWriter
+{
+ public:
+  FlightRecorderWriter() = default;
+
+  ~FlightRecorderWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCondition.notify_all();
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
+
+  FlightRecorderWriter(const FlightRecorderWriter&) = delete;
+  FlightRecorderWriter& operator=(const FlightRecorderWriter&) = delete;
+
+  void post(std::function<void()> write)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWrites.push_back(std::move(write));
+    }
+    mCondition.notify_all();
+    if (!mThread.joinable()) {
+      mThread = std::thread([this] { run(); });
+    }
+  }
+
+ private:
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+      mCondition.wait(lock, [&] { return mStop || !mWrites.empty(); });
+      if (mWrites.empty()) {
+        return;
+      }
+      auto write = std::move(mWrites.front());
+      mWrites.pop_front();
+      lock.unlock();
+      write();
+      lock.lock();
+    }
+  }
+
+  std::thread mThread;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::function<void()>> mWrites;
+  bool mStop = false;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_FLIGHTRECORDER_H_
@@ -0,0 +1,216 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FlowControlAdvisor.h
+/// \brief Definition of the FlowControlModel and FlowControlAdvisor classes.
+
+#ifndef ALICEO2_READOUTCARD_SRC_FLOWCONTROLADVISOR_H_
+#define ALICEO2_READOUTCARD_SRC_FLOWCONTROLADVISOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+#include <boost/optional.hpp>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Flow control setting of the datapath wrappers, see DatapathWrapper::setFlowControl() and setTriggerWindowSize()
+struct FlowControlSetting {
+  bool allowRejection = false;
+  uint32_t triggerWindowSize = 1000; ///< In GBT words
+};
+
+/// Packet counters of the links and wrappers over a measurement
+struct FlowControlCounts {
+  uint64_t accepted = 0;
+  uint64_t rejected = 0;
+  uint64_t forced = 0;
+  uint64_t dropped = 0;
+};
+
+/// Simple model of a datapath wrapper under overload, standing in for a card.
+/// Triggers arrive from the links at random times and with random sizes, and are cut into packets of at most a DMA
+/// page. The packets wait in the buffer of the wrapper until there is a free DMA page in the superpages the host
+/// supplied, which arrive at the supply rate. The transfer queue holds a limited amount of superpages.
+///  * Without rejection, every packet that finds no space in the buffer is dropped, which truncates its trigger.
+///  * With rejection, a trigger is accepted only if the buffer has a trigger window of free space. Otherwise it is
+///    rejected, except its first packet, which is forced through so that the readout still sees the trigger. Packets
+///    beyond the window of an accepted trigger, and forced packets, are dropped if they find no space.
+class FlowControlModel
+{
+ public:
+  struct Configuration {
+    int links = 12;
+    double triggerRate = 11245.0; ///< Per link, in triggers per second
+    uint32_t triggerWordsMin = 400;
+    uint32_t triggerWordsMax = 1200;
+    uint32_t packetWords = 508;    ///< Payload of a packet, a DMA page minus its RDH
+    uint32_t bufferWords = 16384;  ///< Buffer of the wrapper
+    uint32_t pagesPerSuperpage = 128;
+    uint32_t transferQueueSuperpages = 32;
+    double seconds = 1.0;          ///< Simulated time of a run
+    uint32_t seed = 1;
+  };
+
+  explicit FlowControlModel(const Configuration& configuration) : mConfiguration(configuration)
+  {
+  }
+
+  /// Simulates the wrapper with a setting and a supply rate in superpages per second
+  FlowControlCounts run(const FlowControlSetting& setting, double supplyRate) const
+  {
+    const auto& c = mConfiguration;
+    std::mt19937 generator(c.seed);
+    std::exponential_distribution<double> interval(c.links * c.triggerRate);
+    std::uniform_int_distribution<uint32_t> size(c.triggerWordsMin, std::max(c.triggerWordsMin, c.triggerWordsMax));
+
+    FlowControlCounts counts;
+    std::deque<uint32_t> buffer; // Words of the packets waiting in the buffer
+    uint64_t used = 0;
+    const double creditLimit = double(c.transferQueueSuperpages) * c.pagesPerSuperpage;
+    const double pageRate = supplyRate * c.pagesPerSuperpage;
+    double credit = creditLimit; // Free DMA pages in the transfer queue, which starts full
+    double time = 0;
+
+    auto push = [&](uint32_t words) {
+      if (used + words > c.bufferWords) {
+        return false;
+      }
+      buffer.push_back(words);
+      used += words;
+      return true;
+    };
+
+    while (true) {
+      double next = time + interval(generator);
+      if (next > c.seconds) {
+        break;
+      }
+      // DMA of the buffered packets into the pages supplied since the last trigger
+      credit = std::min(creditLimit, credit + (next - time) * pageRate);
+      while (!buffer.empty() && credit >= 1.0) {
+        used -= buffer.front();
+        buffer.pop_front();
+        credit -= 1.0;
+      }
+      time = next;
+
+      uint32_t words = size(generator);
+      uint32_t packets = (words + c.packetWords - 1) / c.packetWords;
+      bool accepted = !setting.allowRejection || (c.bufferWords - used) >= setting.triggerWindowSize;
+      for (uint32_t packet = 0; packet < packets; ++packet) {
+        uint32_t start = packet * c.packetWords;
+        uint32_t packetWords = std::min(c.packetWords, words - start);
+        if (!accepted && packet > 0) {
+          counts.rejected++;
+        } else if (!push(packetWords)) {
+          counts.dropped++;
+        } else if (!accepted || (setting.allowRejection && start + packetWords > setting.triggerWindowSize)) {
+          counts.forced++;
+        } else {
+          counts.accepted++;
+        }
+      }
+    }
+    return counts;
+  }
+
+  const Configuration& getConfiguration() const
+  {
+    return mConfiguration;
+  }
+
+ private:
+  Configuration mConfiguration;
+};
+
+/// Collects the packet counters of flow control settings against superpage supply rates, and recommends a setting.
+class FlowControlAdvisor
+{
+ public:
+  struct Measurement {
+    FlowControlSetting setting;
+    double supplyRate = 0; ///< Superpages per second
+    double seconds = 0;
+    FlowControlCounts counts;
+
+    double getAcceptedRate() const
+    {
+      return seconds > 0 ? counts.accepted / seconds : 0;
+    }
+
+    double getDroppedRate() const
+    {
+      return seconds > 0 ? counts.dropped / seconds : 0;
+    }
+  };
+
+  void add(const Measurement& measurement)
+  {
+    mMeasurements.push_back(measurement);
+  }
+
+  const std::vector<Measurement>& getMeasurements() const
+  {
+    return mMeasurements;
+  }
+
+  /// Recommends the setting with the highest accepted throughput at the highest supply rate within the consumer
+  /// budget. Dropped packets truncate triggers, so the settings dropping more than the given rate only count if all do,
+  /// in which case the one dropping the least is recommended.
+  /// \param budget Superpages per second the consumer can supply, or 0 for the highest supply rate measured
+  /// \param maxDroppedRate Dropped packets per second still acceptable
+  /// \return The measurement of the recommended setting, or none if no supply rate is within the budget
+  boost::optional<Measurement> recommend(double budget = 0, double maxDroppedRate = 0) const
+  {
+    boost::optional<double> rate;
+    for (const auto& measurement : mMeasurements) {
+      if ((budget <= 0 || measurement.supplyRate <= budget) && (!rate || measurement.supplyRate > *rate)) {
+        rate = measurement.supplyRate;
+      }
+    }
+    if (!rate) {
+      return {};
+    }
+
+    boost::optional<Measurement> best;
+    auto better = [&](const Measurement& a, const Measurement& b) {
+      bool aDrops = a.getDroppedRate() > maxDroppedRate;
+      bool bDrops = b.getDroppedRate() > maxDroppedRate;
+      if (aDrops != bDrops) {
+        return !aDrops;
+      }
+      if (aDrops && a.getDroppedRate() != b.getDroppedRate()) {
+        return a.getDroppedRate() < b.getDroppedRate();
+      }
+      return a.getAcceptedRate() > b.getAcceptedRate();
+    };
+    for (const auto& measurement : mMeasurements) {
+      if (measurement.supplyRate == *rate && (!best || better(measurement, *best))) {
+        best = measurement;
+      }
+    }
+    return best;
+  }
+
+ private:
+  std::vector<Measurement> mMeasurements;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_FLOWCONTROLADVISOR_H_
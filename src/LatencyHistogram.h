@@ -0,0 +1,81 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file LatencyHistogram.h
+/// \brief Definition of the LatencyHistogram struct.
+
+#ifndef ALICEO2_READOUTCARD_SRC_LATENCYHISTOGRAM_H_
+#define ALICEO2_READOUTCARD_SRC_LATENCYHISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Histogram of times with power-of-two buckets: bucket i counts times in [2^i, 2^(i+1)) µs, bucket 0 also counts
+/// times below 1 µs.
+struct LatencyHistogram {
+  static constexpr size_t BUCKETS = 32;
+  std::array<uint64_t, BUCKETS> buckets{};
+  uint64_t count = 0;
+  uint64_t sumUs = 0;
+  uint64_t maxUs = 0;
+
+  void add(uint64_t us)
+  {
+    size_t bucket = 0;
+    while ((bucket + 1) < BUCKETS && (us >> (bucket + 1)) != 0) {
+      bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    sumUs += us;
+    maxUs = std::max(maxUs, us);
+  }
+
+  void merge(const LatencyHistogram& other)
+  {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumUs += other.sumUs;
+    maxUs = std::max(maxUs, other.maxUs);
+  }
+
+  /// Upper bound in µs of the bucket containing the given quantile
+  uint64_t getQuantile(double quantile) const
+  {
+    uint64_t target = static_cast<uint64_t>(quantile * count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen > target) {
+        return std::min(maxUs, (uint64_t(1) << (i + 1)) - 1);
+      }
+    }
+    return maxUs;
+  }
+
+  double getMean() const
+  {
+    return count ? double(sumUs) / count : 0.0;
+  }
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_LATENCYHISTOGRAM_H_
@@ -0,0 +1,176 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file LinkLiveness.h
+/// \brief Definition of the LinkLiveness class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_LINKLIVENESS_H_
+#define ALICEO2_READOUTCARD_SRC_LINKLIVENESS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Liveness of a link
+struct LinkState {
+  enum type {
+    Alive, ///< Completing superpages
+    Idle,  ///< Up, but not completing the superpages it has, e.g. a front-end that stopped sending
+    Dead,  ///< Down
+  };
+
+  static const char* toString(type state)
+  {
+    switch (state) {
+      case Alive:
+        return "alive";
+      case Idle:
+        return "idle";
+      case Dead:
+        return "dead";
+    }
+    return "unknown";
+  }
+};
+
+/// Decides which links are alive from their superpage completions and their physical status, so that superpages are
+/// only scheduled to links that will fill them:
+///  * A link that is down is dead, and gets no superpages.
+///  * A link that is up, but did not complete a superpage within the timeout while it had some, is idle, and gets at
+///    most IDLE_QUEUE_DEPTH superpages, so it can show that it came back without stranding more of the buffer.
+///  * A dead link that comes back up is idle, and a link that completes a superpage is alive.
+class LinkLiveness
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Superpages an idle link may hold
+  static constexpr size_t IDLE_QUEUE_DEPTH = 1;
+
+  /// Per-link history, for the report
+  struct Statistics {
+    uint64_t idleTransitions = 0; ///< Times the link went idle
+    uint64_t deadTransitions = 0; ///< Times the link went dead
+    uint64_t recoveries = 0;      ///< Times the link came back alive
+    uint64_t flaps = 0;           ///< Times the link was seen up, but had been down since the last check
+  };
+
+  /// \param links Amount of links
+  /// \param timeout Time without a completion after which a link with superpages is idle
+  explicit LinkLiveness(size_t links = 0, Clock::duration timeout = std::chrono::seconds(1))
+    : mTimeout(timeout), mLinks(links)
+  {
+  }
+
+  /// Makes all links alive
+  void reset(Clock::time_point now)
+  {
+    for (auto& link : mLinks) {
+      link.state = LinkState::Alive;
+      link.lastActivity = now;
+      link.statistics = {};
+    }
+  }
+
+  /// Called when a link completed a superpage
+  /// \return The state of the link before the completion
+  LinkState::type complete(size_t index, Clock::time_point now)
+  {
+    auto& link = mLinks[index];
+    auto previous = link.state;
+    link.lastActivity = now;
+    if (previous != LinkState::Alive) {
+      link.state = LinkState::Alive;
+      link.statistics.recoveries++;
+    }
+    return previous;
+  }
+
+  /// Updates the state of a link from its physical status
+  /// \param up The link is up
+  /// \param wasDown The link went down since the last update, even if it is up now
+  /// \param queued Superpages queued on the link
+  /// \return The state of the link before the update
+  LinkState::type update(size_t index, bool up, bool wasDown, size_t queued, Clock::time_point now)
+  {
+    auto& link = mLinks[index];
+    auto previous = link.state;
+
+    if (queued == 0) {
+      // A link without superpages can not complete any
+      link.lastActivity = now;
+    }
+
+    if (!up) {
+      if (previous != LinkState::Dead) {
+        link.state = LinkState::Dead;
+        link.statistics.deadTransitions++;
+      }
+    } else if (previous == LinkState::Dead) {
+      link.state = LinkState::Idle;
+      link.lastActivity = now;
+    } else if (previous == LinkState::Alive && (now - link.lastActivity) > mTimeout) {
+      link.state = LinkState::Idle;
+      link.statistics.idleTransitions++;
+    }
+
+    if (up && wasDown) {
+      link.statistics.flaps++;
+    }
+    return previous;
+  }
+
+  LinkState::type getState(size_t index) const
+  {
+    return mLinks[index].state;
+  }
+
+  /// Amount of superpages the link may hold in its state
+  /// \param capacity Capacity of the link's queue
+  size_t getAllowedDepth(size_t index, size_t capacity) const
+  {
+    switch (mLinks[index].state) {
+      case LinkState::Alive:
+        return capacity;
+      case LinkState::Idle:
+        return std::min(capacity, IDLE_QUEUE_DEPTH);
+      case LinkState::Dead:
+        return 0;
+    }
+    return 0;
+  }
+
+  const Statistics& getStatistics(size_t index) const
+  {
+    return mLinks[index].statistics;
+  }
+
+ private:
+  struct Link {
+    LinkState::type state = LinkState::Alive;
+    Clock::time_point lastActivity;
+    Statistics statistics;
+  };
+
+  Clock::duration mTimeout;
+  std::vector<Link> mLinks;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_LINKLIVENESS_H_
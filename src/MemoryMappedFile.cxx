@@ -89,6 +89,11 @@ std::string MemoryMappedFile::getFileName() const
   return mInternal->fileName;
 }
 
+void MemoryMappedFile::setDeleteFileOnDestruction(bool deleteFileOnDestruction)
+{
+  mInternal->deleteFileOnDestruction = deleteFileOnDestruction;
+}
+
 bool MemoryMappedFile::map(const std::string& fileName, size_t fileSize)
 {
   try {
@@ -0,0 +1,149 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file OrbitOrderedQueue.h
+/// \brief Definition of the OrbitOrderedQueue class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_ORBITORDEREDQUEUE_H_
+#define ALICEO2_READOUTCARD_SRC_ORBITORDEREDQUEUE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Merges per-link streams, each already ordered by orbit, into a single stream ordered by orbit.
+/// An item is released when every link either has an item waiting (so nothing older can still come from it) or has
+/// been silent for longer than the timeout. When the amount of waiting items reaches the reorder window, the oldest item
+/// is released regardless, so a slow link can delay the stream but never stall it.
+template <typename T>
+class OrbitOrderedQueue
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// \param links Amount of links to merge
+  /// \param window Maximum amount of items held back for reordering
+  /// \param timeout Time after which a link without data is no longer waited for
+  OrbitOrderedQueue(size_t links = 0, size_t window = 1, Clock::duration timeout = Clock::duration::zero())
+    : mLinks(links), mWindow(window), mTimeout(timeout)
+  {
+  }
+
+  /// Clears the queue. Links are considered active as of the given time.
+  void reset(Clock::time_point now)
+  {
+    for (auto& link : mLinks) {
+      link.items.clear();
+      link.lastArrival = now;
+    }
+    mSize = 0;
+    mHasReleased = false;
+    mOutOfOrder = 0;
+  }
+
+  /// Adds an item from a link
+  void push(size_t linkIndex, uint32_t orbit, const T& item, Clock::time_point now)
+  {
+    auto& link = mLinks.at(linkIndex);
+    link.items.push_back({ orbit, item });
+    link.lastArrival = now;
+    mSize++;
+  }
+
+  /// Pops the item with the lowest orbit, if it can be released
+  /// \param item Output for the released item
+  /// \param now Current time, to determine silent links
+  /// \param flush Release regardless of the other links, e.g. when stopping the DMA
+  /// \return True if an item was released
+  bool pop(T& item, Clock::time_point now, bool flush = false)
+  {
+    Link* lowest = nullptr;
+    bool complete = true;
+
+    for (auto& link : mLinks) {
+      if (link.items.empty()) {
+        if ((now - link.lastArrival) < mTimeout) {
+          complete = false; // The link may still deliver an older orbit
+        }
+      } else if (!lowest || isBefore(link.items.front().orbit, lowest->items.front().orbit)) {
+        lowest = &link;
+      }
+    }
+
+    if (!lowest || !(complete || flush || mSize >= mWindow)) {
+      return false;
+    }
+
+    auto orbit = lowest->items.front().orbit;
+    if (mHasReleased && isBefore(orbit, mLastReleasedOrbit)) {
+      mOutOfOrder++; // A late link delivered after its orbit was already passed
+    } else {
+      mLastReleasedOrbit = orbit;
+      mHasReleased = true;
+    }
+    item = lowest->items.front().item;
+    lowest->items.pop_front();
+    mSize--;
+    return true;
+  }
+
+  /// Amount of items waiting for release
+  size_t size() const
+  {
+    return mSize;
+  }
+
+  bool empty() const
+  {
+    return mSize == 0;
+  }
+
+  /// Amount of items released after a higher orbit had already been released
+  uint64_t getOutOfOrderCount() const
+  {
+    return mOutOfOrder;
+  }
+
+  /// Orbit comparison that is safe across the 32-bit orbit counter wrap
+  static bool isBefore(uint32_t a, uint32_t b)
+  {
+    return static_cast<int32_t>(a - b) < 0;
+  }
+
+ private:
+  struct Entry {
+    uint32_t orbit;
+    T item;
+  };
+
+  struct Link {
+    std::deque<Entry> items;
+    Clock::time_point lastArrival;
+  };
+
+  std::vector<Link> mLinks;
+  size_t mWindow;
+  Clock::duration mTimeout;
+  size_t mSize = 0;
+  bool mHasReleased = false;
+  uint32_t mLastReleasedOrbit = 0;
+  uint64_t mOutOfOrder = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_ORBITORDEREDQUEUE_H_
@@ -31,11 +31,12 @@ namespace roc
 {
 
 /// Variant used for internal storage of parameters
+/// Parameter types that alias a type already in it (e.g. bool) are left out, since it can hold 20 types at most
 using Variant = boost::variant<size_t, uint32_t, int32_t, bool, Parameters::BufferParametersType, Parameters::CardIdType,
-                               Parameters::DataSourceType, Parameters::LinkMaskType, Parameters::AllowRejectionType,
-                               Parameters::ClockType, Parameters::CruIdType, Parameters::DatapathModeType, Parameters::DownstreamDataType,
-                               Parameters::GbtModeType, Parameters::GbtMuxType, Parameters::GbtMuxMapType, Parameters::PonUpstreamEnabledType,
-                               Parameters::OnuAddressType, Parameters::DynamicOffsetEnabledType>;
+                               Parameters::DataSourceType, Parameters::LinkMaskType, Parameters::ClockType,
+                               Parameters::DatapathModeType, Parameters::DownstreamDataType, Parameters::GbtModeType,
+                               Parameters::GbtMuxType, Parameters::GbtMuxMapType, Parameters::BufferPartitionType,
+                               Parameters::ConfigurationProgramType>;
 
 using KeyType = const char*;
 
@@ -134,6 +135,20 @@ _PARAMETER_FUNCTIONS(DynamicOffsetEnabled, "dynamic_offset_enabled")
 _PARAMETER_FUNCTIONS(OnuAddress, "onu_address")
 _PARAMETER_FUNCTIONS(StbrdEnabled, "stbrd_enabled")
 _PARAMETER_FUNCTIONS(TriggerWindowSize, "trigger_window_size")
+_PARAMETER_FUNCTIONS(OrderedDeliveryEnabled, "ordered_delivery_enabled")
+_PARAMETER_FUNCTIONS(OrderedDeliveryWindow, "ordered_delivery_window")
+_PARAMETER_FUNCTIONS(OrderedDeliveryTimeout, "ordered_delivery_timeout")
+_PARAMETER_FUNCTIONS(SuperpageTrackingEnabled, "superpage_tracking_enabled")
+_PARAMETER_FUNCTIONS(SuperpageTrackingThreshold, "superpage_tracking_threshold")
+_PARAMETER_FUNCTIONS(LatencyMeasurementEnabled, "latency_measurement_enabled")
+_PARAMETER_FUNCTIONS(AdoptDmaEnabled, "adopt_dma_enabled")
+_PARAMETER_FUNCTIONS(LinkLivenessEnabled, "link_liveness_enabled")
+_PARAMETER_FUNCTIONS(LinkLivenessTimeout, "link_liveness_timeout")
+_PARAMETER_FUNCTIONS(RateWeightedDistributionEnabled, "rate_weighted_distribution_enabled")
+_PARAMETER_FUNCTIONS(VfioEnabled, "vfio_enabled")
+_PARAMETER_FUNCTIONS(BufferPartition, "buffer_partition")
+_PARAMETER_FUNCTIONS(ConfigurationProgram, "configuration_program")
+_PARAMETER_FUNCTIONS(ArrivalNotificationEnabled, "arrival_notification_enabled")
 #undef _PARAMETER_FUNCTIONS
 
 Parameters::Parameters() : mPimpl(std::make_unique<ParametersPimpl>())
@@ -57,6 +57,22 @@ PdaBar::PdaBar(PdaDevice::PdaPciDevice pciDevice, int barNumberInt) : mBarNumber
                           << ErrorInfo::ChannelNumber(barNumber));
   }
   mUserspaceAddress = reinterpret_cast<uintptr_t>(address);
+
+  uint8_t busId;
+  uint8_t deviceId;
+  uint8_t functionId;
+  if (PciDevice_getBusID(pciDevice.get(), &busId) == PDA_SUCCESS &&
+      PciDevice_getDeviceID(pciDevice.get(), &deviceId) == PDA_SUCCESS &&
+      PciDevice_getFunctionID(pciDevice.get(), &functionId) == PDA_SUCCESS) {
+    mPciAddress = PciAddress(busId, deviceId, functionId);
+  }
+}
+
+PdaBar::PdaBar(std::shared_ptr<Vfio::VfioDevice> vfioDevice, int barNumber)
+  : mPdaBar(nullptr), mVfioDevice(std::move(vfioDevice)), mPciAddress(mVfioDevice->getPciAddress()), mBarNumber(barNumber)
+{
+  void* address = mVfioDevice->mapBar(barNumber, mBarLength);
+  mUserspaceAddress = reinterpret_cast<uintptr_t>(address);
 }
 
 } // namespace Pda
@@ -20,10 +20,13 @@
 #include <pda.h>
 #include "PdaDevice.h"
 #include "ExceptionInternal.h"
+#include "RegisterProgram.h"
 #ifndef NDEBUG
 #include <boost/type_index.hpp>
 #endif
+#include "Utilities/PcieHealth.h"
 #include "Utilities/Util.h"
+#include "Vfio/VfioDevice.h"
 
 namespace AliceO2
 {
@@ -32,7 +35,8 @@ namespace roc
 namespace Pda
 {
 
-/// A simple wrapper around the PDA BAR object, providing some convenience functions
+/// A simple wrapper around the PDA BAR object, providing some convenience functions.
+/// The BAR may also be mapped through a VFIO device, for cards that are not bound to the PDA driver.
 class PdaBar : public BarInterface
 {
  public:
@@ -40,6 +44,8 @@ class PdaBar : public BarInterface
 
   PdaBar(PdaDevice::PdaPciDevice pciDevice, int barNumber);
 
+  PdaBar(std::shared_ptr<Vfio::VfioDevice> vfioDevice, int barNumber);
+
   virtual uint32_t readRegister(int index)
   {
     return barRead<uint32_t>(index * sizeof(uint32_t));
@@ -48,6 +54,9 @@ class PdaBar : public BarInterface
   virtual void writeRegister(int index, uint32_t value)
   {
     barWrite<uint32_t>(index * sizeof(uint32_t), value);
+    if (mRecorder) {
+      mRecorder->recordWrite(index, value);
+    }
   }
 
   virtual void modifyRegister(int index, int position, int width, uint32_t value)
@@ -55,6 +64,20 @@ class PdaBar : public BarInterface
     uint32_t regValue = barRead<uint32_t>(index * sizeof(uint32_t));
     Utilities::setBits(regValue, position, width, value);
     barWrite<uint32_t>(index * sizeof(uint32_t), regValue);
+    if (mRecorder) {
+      mRecorder->recordModify(index, position, width, regValue);
+    }
+  }
+
+  /// Sets the recorder the register writes are reported to, or none with nullptr
+  void setRecorder(RegisterProgramRecorder* recorder)
+  {
+    mRecorder = recorder;
+  }
+
+  RegisterProgramRecorder* getRecorder() const
+  {
+    return mRecorder;
   }
 
   virtual int getIndex() const override
@@ -113,6 +136,16 @@ class PdaBar : public BarInterface
     return mBarLength;
   }
 
+  /// Called when a read returned all ones, to tell a lost card from a register that legitimately reads all ones
+  /// \param context What was being done, for the error message
+  /// \exception DeviceLostException The card does not respond
+  void checkDeviceLost(const std::string& context) const
+  {
+    if (mPciAddress && !Utilities::isDeviceResponding(*mPciAddress)) {
+      Utilities::throwDeviceLost(*mPciAddress, context);
+    }
+  }
+
   virtual boost::optional<int32_t> getSerial() override
   {
     return {};
@@ -201,9 +234,15 @@ class PdaBar : public BarInterface
     return reinterpret_cast<void*>(mUserspaceAddress + byteOffset);
   }
 
-  /// PDA object for the PCI BAR
+  /// PDA object for the PCI BAR, or nullptr if mapped through VFIO
   Bar* mPdaBar;
 
+  /// VFIO device owning the mapping, if mapped through VFIO
+  std::shared_ptr<Vfio::VfioDevice> mVfioDevice;
+
+  /// Address of the card, to check its health, if known
+  boost::optional<PciAddress> mPciAddress;
+
   /// Length of the BAR
   size_t mBarLength;
 
@@ -212,6 +251,9 @@ class PdaBar : public BarInterface
 
   /// Userspace addresses of the mapped BARs
   uintptr_t mUserspaceAddress;
+
+  /// Recorder of the configuration being compiled, if any
+  RegisterProgramRecorder* mRecorder = nullptr;
 };
 
 } // namespace Pda
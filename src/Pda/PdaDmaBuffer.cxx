@@ -114,6 +114,10 @@ PdaDmaBuffer::PdaDmaBuffer(PdaDevice::PdaPciDevice pciDevice, void* userBufferAd
 
 PdaDmaBuffer::~PdaDmaBuffer()
 {
+  if (mKeepRegistered) {
+    return;
+  }
+
   // Safeguard against PDA kernel module deadlocks, since it does not like parallel buffer registration
   // NOTE: not sure if necessary for deregistration as well
   try {
@@ -59,8 +59,15 @@ class PdaDmaBuffer
   /// Function for getting the bus address that corresponds to the user address + given offset
   uintptr_t getBusOffsetAddress(size_t offset) const;
 
+  /// Skips the deregistration of the buffer on destruction, since the card keeps writing to it after a DMA handover
+  void keepRegistered()
+  {
+    mKeepRegistered = true;
+  }
+
  private:
   DMABuffer* mDmaBuffer;
+  bool mKeepRegistered = false;
   PdaDevice::PdaPciDevice mPciDevice;
   ScatterGatherVector mScatterGatherVector;
 };
@@ -0,0 +1,144 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file RateWeightedDistribution.h
+/// \brief Definition of the RateWeightedDistribution class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_RATEWEIGHTEDDISTRIBUTION_H_
+#define ALICEO2_READOUTCARD_SRC_RATEWEIGHTEDDISTRIBUTION_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Distributes superpages over links in proportion to the rate at which the links complete them, so that the buffer
+/// is held by the busy links, which need it to absorb bursts, rather than spread evenly over quiet ones.
+/// The completion rate of every link is smoothed over UPDATE_INTERVAL windows. A superpage goes to the link whose
+/// queue is lowest relative to its share of the completions, but every link is kept at a floor depth first, so a quiet
+/// link that starts sending has superpages to fill while its rate catches up.
+class RateWeightedDistribution
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Window over which the completions are counted
+  static constexpr std::chrono::milliseconds UPDATE_INTERVAL{ 100 };
+
+  /// Weight of a new window in the smoothed rate
+  static constexpr double SMOOTHING = 0.3;
+
+  /// Returned by pick() if no link can take a superpage
+  static constexpr size_t NO_LINK = std::numeric_limits<size_t>::max();
+
+  /// \param links Amount of links
+  /// \param floor Queue depth every link is kept at, regardless of its rate
+  explicit RateWeightedDistribution(size_t links = 0, size_t floor = 1) : mFloor(floor), mLinks(links)
+  {
+  }
+
+  /// Forgets the rates
+  void reset(Clock::time_point now)
+  {
+    for (auto& link : mLinks) {
+      link = {};
+    }
+    mTotalRate = 0;
+    mWindowStart = now;
+  }
+
+  /// Called when a link completed a superpage
+  void countArrival(size_t link)
+  {
+    mLinks[link].arrivals++;
+  }
+
+  /// Closes the window if it is over, and updates the rates
+  void update(Clock::time_point now)
+  {
+    const double seconds = std::chrono::duration<double>(now - mWindowStart).count();
+    if (now - mWindowStart < UPDATE_INTERVAL) {
+      return;
+    }
+    mTotalRate = 0;
+    for (auto& link : mLinks) {
+      const double rate = link.arrivals / seconds;
+      link.rate = link.hasRate ? (SMOOTHING * rate + (1 - SMOOTHING) * link.rate) : rate;
+      link.hasRate = true;
+      link.arrivals = 0;
+      mTotalRate += link.rate;
+    }
+    mWindowStart = now;
+  }
+
+  /// Share of the completions of a link. The links share evenly while nothing completed.
+  double getShare(size_t link) const
+  {
+    return mTotalRate > 0 ? mLinks[link].rate / mTotalRate : 1.0 / mLinks.size();
+  }
+
+  /// Smoothed completion rate of a link, in superpages per second
+  double getRate(size_t link) const
+  {
+    return mLinks[link].rate;
+  }
+
+  /// Picks the link for the next superpage
+  /// \param depth Function returning the queue depth of a link
+  /// \param limit Function returning the maximum queue depth of a link
+  /// \return The index of the link, or NO_LINK if all are at their limit
+  template <typename Depth, typename Limit>
+  size_t pick(Depth depth, Limit limit) const
+  {
+    size_t best = NO_LINK;
+    double bestLoad = std::numeric_limits<double>::max();
+    for (size_t i = 0; i < mLinks.size(); ++i) {
+      const size_t queued = depth(i);
+      if (queued >= limit(i)) {
+        continue;
+      }
+      // Links below the floor come first, the emptiest one first. Links without completions come last, but still
+      // take superpages when the busy links are full.
+      const double load = (queued < mFloor) ? -1.0 / (queued + 1) : (queued + 1) / std::max(getShare(i), MIN_SHARE);
+      if (load < bestLoad) {
+        best = i;
+        bestLoad = load;
+      }
+    }
+    return best;
+  }
+
+ private:
+  /// Share of a link without completions, so it is picked last rather than never
+  static constexpr double MIN_SHARE = 1e-6;
+
+  struct Link {
+    uint64_t arrivals = 0;
+    double rate = 0;
+    bool hasRate = false;
+  };
+
+  size_t mFloor;
+  std::vector<Link> mLinks;
+  double mTotalRate = 0;
+  Clock::time_point mWindowStart;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_RATEWEIGHTEDDISTRIBUTION_H_
@@ -0,0 +1,222 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file RegisterProgram.cxx
+/// \brief Implementation of the RegisterProgram class.
+
+#include "RegisterProgram.h"
+#include <sstream>
+#include <boost/algorithm/string/predicate.hpp>
+#include "ExceptionInternal.h"
+#include "Utilities/IdleStrategy.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+namespace
+{
+const std::string FORMAT_HEADER = "# roc-register-program ";
+const std::string FIRMWARE_KEY = "firmware ";
+const std::string PARAMETERS_KEY = "parameters ";
+
+/// Reads a header line, "<key><value>"
+std::string readHeader(std::istream& stream, const std::string& key)
+{
+  std::string line;
+  if (!std::getline(stream, line) || !boost::starts_with(line, key)) {
+    BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Register program header is missing '" + key + "'"));
+  }
+  return line.substr(key.size());
+}
+} // Anonymous namespace
+
+constexpr int RegisterProgram::VERSION;
+
+RegisterProgram::RegisterProgram(const std::string& firmware, const std::string& parametersKey)
+  : mFirmware(firmware), mParametersKey(parametersKey)
+{
+}
+
+void RegisterProgram::write(uint32_t index, uint32_t value)
+{
+  Operation operation;
+  operation.type = Operation::Write;
+  operation.index = index;
+  operation.value = value;
+  mOperations.push_back(operation);
+}
+
+void RegisterProgram::modify(uint32_t index, uint32_t mask, uint32_t value)
+{
+  if (!mOperations.empty()) {
+    auto& last = mOperations.back();
+    if (last.type == Operation::Write && last.index == index && last.mask != 0 && (last.mask & mask) == 0) {
+      // The value read by this modification already held the previous one
+      last.value = value;
+      last.mask |= mask;
+      return;
+    }
+  }
+  Operation operation;
+  operation.type = Operation::Write;
+  operation.index = index;
+  operation.value = value;
+  operation.mask = mask;
+  mOperations.push_back(operation);
+}
+
+void RegisterProgram::wait(std::chrono::nanoseconds duration)
+{
+  if (duration.count() <= 0) {
+    return;
+  }
+  if (!mOperations.empty() && mOperations.back().type == Operation::Wait) {
+    mOperations.back().duration += duration;
+    return;
+  }
+  Operation operation;
+  operation.type = Operation::Wait;
+  operation.duration = duration;
+  mOperations.push_back(operation);
+}
+
+void RegisterProgram::poll(uint32_t index, uint32_t mask, uint32_t value, std::chrono::nanoseconds timeout)
+{
+  Operation operation;
+  operation.type = Operation::Poll;
+  operation.index = index;
+  operation.mask = mask;
+  operation.value = value & mask;
+  operation.duration = timeout;
+  mOperations.push_back(operation);
+}
+
+void RegisterProgram::live(uint32_t section)
+{
+  Operation operation;
+  operation.type = Operation::Live;
+  operation.index = section;
+  mOperations.push_back(operation);
+}
+
+bool RegisterProgram::replay(RegisterReadWriteInterface& registers, const LiveSection& liveSection) const
+{
+  auto& timeSource = TimeSource::get();
+  for (const auto& operation : mOperations) {
+    switch (operation.type) {
+      case Operation::Write:
+        registers.writeRegister(operation.index, operation.value);
+        break;
+      case Operation::Wait:
+        timeSource.sleepFor(operation.duration);
+        break;
+      case Operation::Poll: {
+        // The replay is there to make the configuration fast, so spin with the pause hint, without the latency of
+        // a backoff to sleeping
+        Utilities::IdleStrategy idleStrategy(Utilities::IdleStrategy::Policy::Pause);
+        auto start = timeSource.now();
+        while ((registers.readRegister(operation.index) & operation.mask) != operation.value) {
+          if (timeSource.now() - start > operation.duration) {
+            return false;
+          }
+          idleStrategy.idle();
+        }
+        break;
+      }
+      case Operation::Live:
+        if (!liveSection) {
+          BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Register program has a live section, but nothing to run it"));
+        }
+        liveSection(operation.index);
+        break;
+    }
+  }
+  return true;
+}
+
+void RegisterProgram::save(std::ostream& stream) const
+{
+  stream << FORMAT_HEADER << mVersion << '\n'
+         << FIRMWARE_KEY << mFirmware << '\n'
+         << PARAMETERS_KEY << mParametersKey << '\n'
+         << std::hex;
+  for (const auto& operation : mOperations) {
+    switch (operation.type) {
+      case Operation::Write:
+        stream << "W " << operation.index << ' ' << operation.value << ' ' << operation.mask << '\n';
+        break;
+      case Operation::Wait:
+        stream << "S " << operation.duration.count() << '\n';
+        break;
+      case Operation::Poll:
+        stream << "P " << operation.index << ' ' << operation.mask << ' ' << operation.value << ' '
+               << operation.duration.count() << '\n';
+        break;
+      case Operation::Live:
+        stream << "L " << operation.index << '\n';
+        break;
+    }
+  }
+  stream << std::dec;
+}
+
+RegisterProgram RegisterProgram::load(std::istream& stream)
+{
+  RegisterProgram program;
+  auto version = readHeader(stream, FORMAT_HEADER);
+  std::istringstream versionStream(version);
+  if (!(versionStream >> program.mVersion)) {
+    BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Malformed register program version '" + version + "'"));
+  }
+  program.mFirmware = readHeader(stream, FIRMWARE_KEY);
+  program.mParametersKey = readHeader(stream, PARAMETERS_KEY);
+  if (program.mVersion != VERSION) {
+    return program;
+  }
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream lineStream(line);
+    lineStream >> std::hex;
+    char type;
+    Operation operation;
+    int64_t duration = 0;
+    lineStream >> type;
+    if (type == 'W') {
+      operation.type = Operation::Write;
+      lineStream >> operation.index >> operation.value >> operation.mask;
+    } else if (type == 'S') {
+      operation.type = Operation::Wait;
+      lineStream >> duration;
+    } else if (type == 'P') {
+      operation.type = Operation::Poll;
+      lineStream >> operation.index >> operation.mask >> operation.value >> duration;
+    } else if (type == 'L') {
+      operation.type = Operation::Live;
+      lineStream >> operation.index;
+    } else {
+      lineStream.setstate(std::ios::failbit);
+    }
+    if (lineStream.fail() || !(lineStream >> std::ws).eof()) {
+      BOOST_THROW_EXCEPTION(ParseException() << ErrorInfo::Message("Malformed register program line '" + line + "'"));
+    }
+    operation.duration = std::chrono::nanoseconds(duration);
+    program.mOperations.push_back(operation);
+  }
+  return program;
+}
+
+} // namespace roc
+} // namespace AliceO2
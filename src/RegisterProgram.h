@@ -0,0 +1,254 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file RegisterProgram.h
+/// \brief Definition of the RegisterProgram and RegisterProgramRecorder classes.
+
+#ifndef ALICEO2_READOUTCARD_SRC_REGISTERPROGRAM_H_
+#define ALICEO2_READOUTCARD_SRC_REGISTERPROGRAM_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ReadoutCard/RegisterReadWriteInterface.h"
+#include "ReadoutCard/TimeSource.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// A compiled configuration: the flat sequence of register writes, waits and polled conditions a configuration
+/// produced, for a given firmware and set of configuration parameters.
+/// Replaying it reaches the same register state without the logic and the reads of the configuration: the writes of
+/// read-modify-writes hold the whole register value, and the writes of consecutive read-modify-writes to different
+/// fields of a register are coalesced into one.
+/// Decisions the configuration took on values it read are frozen in the program, so it is only valid for identical
+/// cards, which the firmware and the parameters key stand for. Sequences whose writes depend on what they read, like a
+/// phase scan, are recorded as live sections instead, which the replay hands back to the configuration to run.
+class RegisterProgram
+{
+ public:
+  /// Version of the format, programs of other versions are not replayed
+  static constexpr int VERSION = 2;
+
+  struct Operation {
+    enum Type { Write, Wait, Poll, Live };
+
+    Type type;
+    uint32_t index = 0; ///< Register, or the ID of a live section
+    uint32_t value = 0; ///< Value written, or the masked value polled for
+    uint32_t mask = 0;  ///< Bits changed by the read-modify-writes of a write (0 for a plain write), or the bits polled
+    std::chrono::nanoseconds duration{ 0 }; ///< Time waited, or the timeout of the poll
+  };
+
+  RegisterProgram(const std::string& firmware = "", const std::string& parametersKey = "");
+
+  /// Appends a plain write. It is never coalesced, since writing the same value twice may be a command.
+  void write(uint32_t index, uint32_t value);
+
+  /// Appends a read-modify-write, as the whole value of the register after it, merged into the previous write if that
+  /// was a read-modify-write of another field of the same register. Writes to a field already changed, like the two
+  /// halves of a pulse, are kept.
+  /// \param mask Bits of the field changed
+  void modify(uint32_t index, uint32_t mask, uint32_t value);
+
+  /// Appends a wait, merged into the previous one if there is one
+  void wait(std::chrono::nanoseconds duration);
+
+  /// Appends a wait until (register & mask) == value
+  void poll(uint32_t index, uint32_t mask, uint32_t value, std::chrono::nanoseconds timeout);
+
+  /// Appends a section the replay does not replay, but runs live
+  /// \param section ID of the section, given to the replay's LiveSection
+  void live(uint32_t section);
+
+  /// Runs a live section on replay, given its ID
+  using LiveSection = std::function<void(uint32_t section)>;
+
+  /// Replays the program through the given registers, with the waits and poll timeouts of the current time source.
+  /// A poll that times out means the card is not in the state the program was compiled for, so the replay stops there.
+  /// \param liveSection Runs the live sections
+  /// \return False if a poll timed out
+  /// \exception Exception The program has a live section, and there is no liveSection
+  bool replay(RegisterReadWriteInterface& registers, const LiveSection& liveSection = nullptr) const;
+
+  /// Writes the program in its text format
+  void save(std::ostream& stream) const;
+
+  /// Reads a program in its text format. Only the header of a program of another version is read.
+  /// \exception ParseException The program is malformed
+  static RegisterProgram load(std::istream& stream);
+
+  /// The program can be replayed for the given firmware and parameters key
+  bool matches(const std::string& firmware, const std::string& parametersKey) const
+  {
+    return mVersion == VERSION && mFirmware == firmware && mParametersKey == parametersKey;
+  }
+
+  int getVersion() const
+  {
+    return mVersion;
+  }
+
+  const std::string& getFirmware() const
+  {
+    return mFirmware;
+  }
+
+  const std::string& getParametersKey() const
+  {
+    return mParametersKey;
+  }
+
+  const std::vector<Operation>& getOperations() const
+  {
+    return mOperations;
+  }
+
+ private:
+  int mVersion = VERSION;
+  std::string mFirmware;
+  std::string mParametersKey;
+  std::vector<Operation> mOperations;
+};
+
+/// Records the register accesses of a configuration into a RegisterProgram.
+/// The BAR reports its writes to the recorder set on it (see Pda::PdaBar::setRecorder()), and the recorder is the time
+/// source of the configuration, installed with a ScopedThreadTimeSource, so its sleeps become waits. The loops polling a
+/// register declare it with a PollScope, which records the poll and drops the reads and sleeps in it. The sequences to run
+/// live on replay declare it with a LiveScope, which records the section and drops everything in it.
+class RegisterProgramRecorder : public TimeSource
+{
+ public:
+  /// \param timeSource Time source actually waiting, the one installed when the recording starts by default
+  RegisterProgramRecorder(RegisterProgram& program, TimeSource& timeSource = TimeSource::get())
+    : mProgram(program), mTimeSource(timeSource)
+  {
+  }
+
+  void recordWrite(int index, uint32_t value)
+  {
+    if (mLive > 0) {
+      return;
+    }
+    mWrites++;
+    mProgram.write(index, value);
+  }
+
+  /// \param value Whole value of the register after the modification
+  void recordModify(int index, int position, int width, uint32_t value)
+  {
+    if (mLive > 0) {
+      return;
+    }
+    mWrites++;
+    uint32_t field = (width >= 32) ? 0xffffffff : ((uint32_t(1) << width) - 1);
+    mProgram.modify(index, field << position, value);
+  }
+
+  virtual TimePoint now() override
+  {
+    return mTimeSource.now();
+  }
+
+  virtual void sleepFor(std::chrono::nanoseconds duration) override
+  {
+    if (isRecording()) {
+      mProgram.wait(duration);
+    }
+    mTimeSource.sleepFor(duration);
+  }
+
+  /// Writes recorded, before the coalescing
+  uint64_t getWrites() const
+  {
+    return mWrites;
+  }
+
+  /// Declares a loop polling a register for the lifetime of the object. Does nothing without a recorder.
+  class PollScope
+  {
+   public:
+    PollScope(RegisterProgramRecorder* recorder, uint32_t index, uint32_t mask, uint32_t value,
+              std::chrono::nanoseconds timeout)
+      : mRecorder(recorder)
+    {
+      if (mRecorder) {
+        if (mRecorder->isRecording()) {
+          mRecorder->mProgram.poll(index, mask, value, timeout);
+        }
+        mRecorder->mPolls++;
+      }
+    }
+
+    ~PollScope()
+    {
+      if (mRecorder) {
+        mRecorder->mPolls--;
+      }
+    }
+
+    PollScope(const PollScope&) = delete;
+    PollScope& operator=(const PollScope&) = delete;
+
+   private:
+    RegisterProgramRecorder* mRecorder;
+  };
+
+  /// Declares a sequence to run live on replay for the lifetime of the object. Does nothing without a recorder.
+  class LiveScope
+  {
+   public:
+    LiveScope(RegisterProgramRecorder* recorder, uint32_t section) : mRecorder(recorder)
+    {
+      if (mRecorder) {
+        if (mRecorder->isRecording()) {
+          mRecorder->mProgram.live(section);
+        }
+        mRecorder->mLive++;
+      }
+    }
+
+    ~LiveScope()
+    {
+      if (mRecorder) {
+        mRecorder->mLive--;
+      }
+    }
+
+    LiveScope(const LiveScope&) = delete;
+    LiveScope& operator=(const LiveScope&) = delete;
+
+   private:
+    RegisterProgramRecorder* mRecorder;
+  };
+
+ private:
+  bool isRecording() const
+  {
+    return mPolls == 0 && mLive == 0;
+  }
+
+  RegisterProgram& mProgram;
+  TimeSource& mTimeSource;
+  int mPolls = 0;
+  int mLive = 0;
+  uint64_t mWrites = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_REGISTERPROGRAM_H_
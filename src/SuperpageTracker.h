@@ -0,0 +1,254 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file SuperpageTracker.h
+/// \brief Definition of the SuperpageTracker class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_SUPERPAGETRACKER_H_
+#define ALICEO2_READOUTCARD_SRC_SUPERPAGETRACKER_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include <boost/circular_buffer.hpp>
+#include <boost/format.hpp>
+#include "LatencyHistogram.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Stages of a superpage's lifecycle
+struct SuperpageStage {
+  enum type {
+    Transfer, ///< Pushed, waiting for the firmware to fill it
+    Ready,    ///< Filled, waiting in the ready queue
+    Held,     ///< Popped, held by the consumer
+  };
+
+  static const char* toString(type stage)
+  {
+    switch (stage) {
+      case Transfer:
+        return "transfer";
+      case Ready:
+        return "ready";
+      case Held:
+        return "held";
+    }
+    return "unknown";
+  }
+};
+
+/// Tracks the lifecycle of superpages, keyed by their offset in the DMA buffer:
+///   push -> (Transfer) -> firmware completion -> (Ready) -> pop -> (Held) -> re-push
+/// It keeps residence-time histograms per stage and per link, flags superpages that stay in a stage longer than a
+/// threshold (e.g. a consumer that never returns a superpage), and exports the recent stages as a trace.
+template <size_t MAX_LINKS>
+class SuperpageTracker
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  using Stage = SuperpageStage;
+
+  static constexpr size_t STAGES = 3;
+
+  /// Amount of finished stages kept for the trace export
+  static constexpr size_t TRACE_CAPACITY = 64 * 1024;
+
+  /// Histogram of residence times
+  using Histogram = LatencyHistogram;
+
+  /// A superpage that stayed in a stage for longer than the threshold
+  struct Overdue {
+    size_t offset;
+    uint32_t link;
+    Stage::type stage;
+    Clock::duration age;
+  };
+
+  SuperpageTracker() : mTrace(TRACE_CAPACITY)
+  {
+  }
+
+  /// Forgets all superpages, histograms and trace
+  void reset(Clock::time_point now)
+  {
+    mEntries.clear();
+    mTrace.clear();
+    mHistograms = {};
+    mStart = now;
+    mOverdueTotal = 0;
+  }
+
+  /// Superpage pushed to a link. A superpage pushed again after a pop ends its Held stage.
+  void push(size_t offset, uint32_t link, Clock::time_point now)
+  {
+    auto& entry = mEntries[offset];
+    if (entry.active && entry.stage == Stage::Held) {
+      finishStage(offset, entry, now);
+    }
+    entry = Entry();
+    entry.active = true;
+    entry.link = std::min<uint32_t>(link, MAX_LINKS - 1);
+    entry.stage = Stage::Transfer;
+    entry.since = now;
+  }
+
+  /// Superpage filled by the firmware and moved to the ready queue
+  void complete(size_t offset, Clock::time_point now)
+  {
+    advance(offset, Stage::Transfer, Stage::Ready, now);
+  }
+
+  /// Superpage popped by the consumer
+  void pop(size_t offset, Clock::time_point now)
+  {
+    advance(offset, Stage::Ready, Stage::Held, now);
+  }
+
+  /// Returns the superpages that newly exceeded the threshold in their current stage. Each is reported once per stage.
+  std::vector<Overdue> checkOverdue(Clock::time_point now, Clock::duration threshold)
+  {
+    std::vector<Overdue> overdue;
+    for (auto& pair : mEntries) {
+      auto& entry = pair.second;
+      if (entry.active && !entry.flagged && (now - entry.since) >= threshold) {
+        entry.flagged = true;
+        mOverdueTotal++;
+        overdue.push_back({ pair.first, entry.link, entry.stage, now - entry.since });
+      }
+    }
+    return overdue;
+  }
+
+  /// Total amount of overdue superpages found
+  uint64_t getOverdueTotal() const
+  {
+    return mOverdueTotal;
+  }
+
+  const Histogram& getHistogram(Stage::type stage, uint32_t link) const
+  {
+    return mHistograms.at(stage).at(link);
+  }
+
+  /// Writes a table of the residence times per stage, for all links together and for every link that was used
+  void writeReport(std::ostream& stream) const
+  {
+    auto format = boost::format("  %-9s %-5s %10s %10s %10s %10s %10s\n");
+    stream << "Superpage residence times in µs\n";
+    stream << format % "stage" % "link" % "count" % "mean" % "p50" % "p99" % "max";
+    for (size_t stage = 0; stage < STAGES; ++stage) {
+      Histogram total;
+      for (const auto& histogram : mHistograms[stage]) {
+        total.merge(histogram);
+      }
+      auto writeRow = [&](const std::string& link, const Histogram& histogram) {
+        stream << format % Stage::toString(Stage::type(stage)) % link % histogram.count
+                    % boost::str(boost::format("%.1f") % histogram.getMean()) % histogram.getQuantile(0.5)
+                    % histogram.getQuantile(0.99) % histogram.maxUs;
+      };
+      writeRow("all", total);
+      for (size_t link = 0; link < MAX_LINKS; ++link) {
+        if (mHistograms[stage][link].count > 0) {
+          writeRow(std::to_string(link), mHistograms[stage][link]);
+        }
+      }
+    }
+  }
+
+  /// Writes the recent stages in the Chrome trace event format, which can be loaded in chrome://tracing or Perfetto.
+  /// Every link is a thread and every stage a duration event. Stages still in progress end at 'now' and are marked as
+  /// open, so a superpage that never comes back shows up as a long open bar.
+  void writeTrace(std::ostream& stream, Clock::time_point now) const
+  {
+    auto toUs = [&](Clock::time_point time) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(time - mStart).count();
+    };
+    auto writeEvent = [&](size_t offset, uint32_t link, Stage::type stage, Clock::time_point start,
+                          Clock::time_point end, bool open) {
+      stream << (boost::format(",\n{\"name\":\"%s\",\"cat\":\"superpage\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                               "\"ts\":%d,\"dur\":%d,\"args\":{\"offset\":%d,\"open\":%s}}") %
+                 Stage::toString(stage) % link % toUs(start) % (toUs(end) - toUs(start)) % offset % (open ? "true" : "false"));
+    };
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"superpages\"}}";
+    for (size_t link = 0; link < MAX_LINKS; ++link) {
+      stream << (boost::format(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+                               "\"args\":{\"name\":\"link %d\"}}") %
+                 link % link);
+    }
+    for (const auto& event : mTrace) {
+      writeEvent(event.offset, event.link, event.stage, event.start, event.end, false);
+    }
+    for (const auto& pair : mEntries) {
+      if (pair.second.active) {
+        writeEvent(pair.first, pair.second.link, pair.second.stage, pair.second.since, now, true);
+      }
+    }
+    stream << "\n]}\n";
+  }
+
+ private:
+  struct Entry {
+    bool active = false;
+    bool flagged = false;
+    uint32_t link = 0;
+    Stage::type stage = Stage::Transfer;
+    Clock::time_point since;
+  };
+
+  struct TraceEvent {
+    size_t offset;
+    uint32_t link;
+    Stage::type stage;
+    Clock::time_point start;
+    Clock::time_point end;
+  };
+
+  void advance(size_t offset, Stage::type from, Stage::type to, Clock::time_point now)
+  {
+    auto iterator = mEntries.find(offset);
+    if (iterator == mEntries.end() || !iterator->second.active || iterator->second.stage != from) {
+      return; // Not tracked, e.g. pushed before the tracker was reset
+    }
+    auto& entry = iterator->second;
+    finishStage(offset, entry, now);
+    entry.stage = to;
+    entry.since = now;
+    entry.flagged = false;
+  }
+
+  void finishStage(size_t offset, const Entry& entry, Clock::time_point now)
+  {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - entry.since).count();
+    mHistograms[entry.stage][entry.link].add(std::max<int64_t>(us, 0));
+    mTrace.push_back({ offset, entry.link, entry.stage, entry.since, now });
+  }
+
+  std::unordered_map<size_t, Entry> mEntries;
+  std::array<std::array<Histogram, MAX_LINKS>, STAGES> mHistograms;
+  boost::circular_buffer<TraceEvent> mTrace;
+  Clock::time_point mStart = Clock::now();
+  uint64_t mOverdueTotal = 0;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_SUPERPAGETRACKER_H_
@@ -0,0 +1,175 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ThroughputModel.h
+/// \brief Definition of the ThroughputModel class.
+
+#ifndef ALICEO2_READOUTCARD_SRC_THROUGHPUTMODEL_H_
+#define ALICEO2_READOUTCARD_SRC_THROUGHPUTMODEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+#include "ReadoutCard/CardType.h"
+#include "ReadoutCard/ParameterTypes/DatapathMode.h"
+#include "ReadoutCard/ParameterTypes/GbtMode.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Theoretical throughput ceilings of a DMA channel, per layer of the data path, computed from the configuration.
+/// All ceilings are in bytes of the DMA buffer filled per second, i.e. counting whole DMA pages and the unusable tail
+/// of the superpages, which is what a reader of the superpages sees. getWrittenFraction() converts them to the bytes
+/// the card actually writes (RDH and payload).
+/// The layers are:
+///  * link: the GBT (CRU) or DDL (C-RORC) links. On the CRU, a GBT word carries 80 (GBT mode) or 112 (WB mode) bits
+///    of payload, and is written to the host padded to 128 bits.
+///  * PCIe: the link rate, minus line encoding and the TLP overhead of every max payload sized write.
+class ThroughputModel
+{
+ public:
+  /// LHC bunch crossing clock, at which every GBT link delivers one word
+  static constexpr double GBT_WORD_RATE = 40.079e6;
+
+  /// Size of a GBT word in the DMA buffer
+  static constexpr size_t GBT_WORD_HOST_BYTES = 16;
+
+  /// DDL line rate, 8b/10b encoded
+  static constexpr double DDL_LINE_RATE = 4.25e9;
+
+  /// Overhead of a PCIe memory write TLP: framing, sequence number, 4 DW header with 64-bit address, and LCRC
+  static constexpr size_t PCIE_TLP_OVERHEAD = 2 + 2 + 16 + 4;
+
+  struct Configuration {
+    CardType::type cardType = CardType::Cru;
+    GbtMode::type gbtMode = GbtMode::Gbt;
+    DatapathMode::type datapathMode = DatapathMode::Packet;
+
+    /// Links delivering data. 0 if the data is generated on the card, i.e. not limited by the links.
+    int links = 1;
+
+    size_t dmaPageSize = 8 * 1024;
+
+    /// Size of the RDH at the start of every DMA page (CRU), or 0 for raw data (C-RORC)
+    size_t rdhSize = 64;
+
+    /// Payload of a packet in packet mode, a multiple of the GBT word. 0 for packets that fill the DMA pages.
+    size_t packetSize = 0;
+
+    size_t superpageSize = 1024 * 1024;
+
+    double pcieGigatransfersPerSecond = 8.0;
+    int pcieLanes = 8;
+    size_t pcieMaxPayloadSize = 256;
+  };
+
+  /// Ceiling of one layer
+  struct Ceiling {
+    std::string layer;
+    double bytesPerSecond;
+  };
+
+  explicit ThroughputModel(const Configuration& configuration) : mConfiguration(configuration)
+  {
+    const auto& c = mConfiguration;
+    const double pagePayload = double(c.dmaPageSize - c.rdhSize);
+
+    // Per packet (or per page in continuous mode): bytes from the links, bytes written, DMA pages used
+    if (c.datapathMode == DatapathMode::Packet && c.packetSize > 0) {
+      const double pages = std::ceil(c.packetSize / pagePayload);
+      mLinkBytes = c.packetSize;
+      mWrittenBytes = c.packetSize + pages * c.rdhSize;
+      mBufferBytes = pages * c.dmaPageSize;
+    } else {
+      mLinkBytes = pagePayload;
+      mWrittenBytes = c.dmaPageSize;
+      mBufferBytes = c.dmaPageSize;
+    }
+
+    // The tail of a superpage that does not fit a DMA page is never filled
+    const double pagesPerSuperpage = std::floor(double(c.superpageSize) / c.dmaPageSize);
+    mSuperpageFactor = pagesPerSuperpage > 0 ? c.superpageSize / (pagesPerSuperpage * c.dmaPageSize) : 0;
+  }
+
+  /// Ceiling of the links, infinite if the data is generated on the card
+  double getLinkCeiling() const
+  {
+    const auto& c = mConfiguration;
+    if (c.links <= 0) {
+      return std::numeric_limits<double>::infinity();
+    }
+    const double perLink = (c.cardType == CardType::Crorc) ? DDL_LINE_RATE * 8 / 10 / 8 : GBT_WORD_RATE * GBT_WORD_HOST_BYTES;
+    return c.links * perLink * (mBufferBytes / mLinkBytes) * mSuperpageFactor;
+  }
+
+  /// Ceiling of the PCIe link
+  double getPcieCeiling() const
+  {
+    const auto& c = mConfiguration;
+    // Gen1 and Gen2 use 8b/10b encoding, Gen3 and later 128b/130b
+    const double encoding = (c.pcieGigatransfersPerSecond < 8.0) ? 8.0 / 10.0 : 128.0 / 130.0;
+    const double linkBytes = c.pcieGigatransfersPerSecond * 1e9 * c.pcieLanes * encoding / 8;
+    const double tlpEfficiency = double(c.pcieMaxPayloadSize) / (c.pcieMaxPayloadSize + PCIE_TLP_OVERHEAD);
+    return linkBytes * tlpEfficiency * (mBufferBytes / mWrittenBytes) * mSuperpageFactor;
+  }
+
+  /// Ceilings of all layers, in data path order
+  std::vector<Ceiling> getCeilings() const
+  {
+    return { { "link", getLinkCeiling() }, { "PCIe", getPcieCeiling() } };
+  }
+
+  /// The lowest ceiling, i.e. the throughput the configuration can achieve
+  Ceiling getLimit() const
+  {
+    auto ceilings = getCeilings();
+    return *std::min_element(ceilings.begin(), ceilings.end(),
+                             [](const Ceiling& a, const Ceiling& b) { return a.bytesPerSecond < b.bytesPerSecond; });
+  }
+
+  /// Fraction of the filled buffer that the card writes (RDH and payload)
+  double getWrittenFraction() const
+  {
+    return mWrittenBytes / (mBufferBytes * mSuperpageFactor);
+  }
+
+  /// Fraction of the filled buffer that is detector payload, i.e. without RDHs, GBT word padding and unused space
+  double getPayloadFraction() const
+  {
+    const auto& c = mConfiguration;
+    double wordEfficiency = 1.0;
+    if (c.cardType == CardType::Cru) {
+      wordEfficiency = (c.gbtMode == GbtMode::Wb ? 112.0 : 80.0) / (GBT_WORD_HOST_BYTES * 8);
+    }
+    return mLinkBytes * wordEfficiency / (mBufferBytes * mSuperpageFactor);
+  }
+
+  const Configuration& getConfiguration() const
+  {
+    return mConfiguration;
+  }
+
+ private:
+  Configuration mConfiguration;
+  double mLinkBytes;
+  double mWrittenBytes;
+  double mBufferBytes;
+  double mSuperpageFactor;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_SRC_THROUGHPUTMODEL_H_
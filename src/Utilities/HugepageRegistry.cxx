@@ -0,0 +1,331 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HugepageRegistry.cxx
+/// \brief Implementation of the HugepageRegistry and HugepageReservation classes.
+
+#include "HugepageRegistry.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/format.hpp>
+#include <boost/optional.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+namespace b = boost;
+namespace
+{
+
+constexpr const char* HEADER = "# id pid start_time page_size numa_node pages mapped name";
+
+/// Start time of a process in clock ticks after boot, field 22 of /proc/[pid]/stat
+boost::optional<uint64_t> getStartTime(pid_t pid)
+{
+  std::ifstream stream("/proc/" + std::to_string(pid) + "/stat");
+  std::string stat;
+  if (!std::getline(stream, stat)) {
+    return {};
+  }
+  // The command name in field 2 is in parentheses, and may contain spaces
+  auto commandEnd = stat.rfind(')');
+  if (commandEnd == std::string::npos) {
+    return {};
+  }
+  std::istringstream fields(stat.substr(commandEnd + 1));
+  std::string field;
+  for (int i = 3; i < 22; ++i) {
+    fields >> field;
+  }
+  uint64_t startTime;
+  if (!(fields >> startTime)) {
+    return {};
+  }
+  return startTime;
+}
+
+bool isAlive(const HugepageRegistry::Entry& entry)
+{
+  auto startTime = getStartTime(entry.pid);
+  return startTime && *startTime == entry.startTime;
+}
+
+size_t readCount(const std::string& path)
+{
+  std::ifstream stream(path);
+  size_t count = 0;
+  stream >> count;
+  return count;
+}
+
+std::string getPoolName(size_t pageSize)
+{
+  return (b::format("hugepages-%dkB") % (pageSize / 1024)).str();
+}
+
+size_t saturatingSubtract(size_t a, size_t b)
+{
+  return a > b ? a - b : 0;
+}
+
+} // Anonymous namespace
+
+class HugepageRegistry::Transaction
+{
+ public:
+  explicit Transaction(const std::string& path) : mPath(path)
+  {
+    // Registry errors are MemoryMapExceptions, like the failure to map a buffer they keep from being allocated
+    mFd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0660);
+    if (mFd < 0) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(std::string("Failed to open hugepage registry: ") + std::strerror(errno))
+                                                 << ErrorInfo::FileName(path));
+    }
+    // The readout processes sharing the registry run in one group, so it must stay group-writable regardless of the
+    // umask. Only its owner can change the mode, which it already did on creation.
+    (void)fchmod(mFd, 0660);
+    if (flock(mFd, LOCK_EX) != 0) {
+      close(mFd);
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(std::string("Failed to lock hugepage registry: ") + std::strerror(errno))
+                                                 << ErrorInfo::FileName(path));
+    }
+    read();
+  }
+
+  ~Transaction()
+  {
+    close(mFd); // Also releases the lock
+  }
+
+  std::vector<Entry>& getEntries()
+  {
+    return mEntries;
+  }
+
+  /// Writes the entries back
+  void commit()
+  {
+    std::ostringstream stream;
+    stream << HEADER << '\n';
+    for (const auto& entry : mEntries) {
+      stream << entry.id << ' ' << entry.pid << ' ' << entry.startTime << ' ' << entry.pageSize << ' ' << entry.numaNode
+             << ' ' << entry.pages << ' ' << entry.mapped << ' ' << entry.name << '\n';
+    }
+    auto contents = stream.str();
+    if (ftruncate(mFd, 0) != 0 || pwrite(mFd, contents.data(), contents.size(), 0) != ssize_t(contents.size())) {
+      BOOST_THROW_EXCEPTION(MemoryMapException() << ErrorInfo::Message(std::string("Failed to write hugepage registry: ") + std::strerror(errno))
+                                                 << ErrorInfo::FileName(mPath));
+    }
+  }
+
+ private:
+  void read()
+  {
+    std::string contents;
+    char buffer[4096];
+    ssize_t count;
+    off_t offset = 0;
+    while ((count = pread(mFd, buffer, sizeof(buffer), offset)) > 0) {
+      contents.append(buffer, count);
+      offset += count;
+    }
+
+    std::istringstream stream(contents);
+    std::string line;
+    bool dropped = false;
+    while (std::getline(stream, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::istringstream fields(line);
+      Entry entry;
+      if (!(fields >> entry.id >> entry.pid >> entry.startTime >> entry.pageSize >> entry.numaNode >> entry.pages >> entry.mapped)) {
+        dropped = true; // Corrupt line, e.g. from a write cut short
+        continue;
+      }
+      fields >> std::ws;
+      std::getline(fields, entry.name);
+      if (!isAlive(entry)) {
+        dropped = true;
+        continue;
+      }
+      mEntries.push_back(entry);
+    }
+    if (dropped) {
+      commit();
+    }
+  }
+
+  std::string mPath;
+  int mFd;
+  std::vector<Entry> mEntries;
+};
+
+HugepageRegistry::HugepageRegistry(std::string path, std::string sysfsPath)
+  : mPath(std::move(path)), mSysfsPath(std::move(sysfsPath))
+{
+}
+
+auto HugepageRegistry::getAvailability(const std::vector<Entry>& entries, size_t pageSize, int numaNode) const
+  -> Availability
+{
+  const auto pool = getPoolName(pageSize);
+
+  // The kernel's reservations for mappings not faulted in yet are only counted system-wide
+  const auto systemDirectory = mSysfsPath + "/kernel/mm/hugepages/" + pool;
+  Availability system;
+  system.total = readCount(systemDirectory + "/nr_hugepages");
+  system.free = saturatingSubtract(readCount(systemDirectory + "/free_hugepages"),
+                                   readCount(systemDirectory + "/resv_hugepages"));
+  for (const auto& entry : entries) {
+    if (entry.pageSize == pageSize && !entry.mapped) {
+      system.pending += entry.pages;
+    }
+  }
+  system.available = saturatingSubtract(system.free, system.pending);
+  if (numaNode < 0) {
+    return system;
+  }
+
+  // A reservation without a node may end up on any node, so it counts against all of them
+  const auto nodeDirectory = (b::format("%s/devices/system/node/node%d/hugepages/%s") % mSysfsPath % numaNode % pool).str();
+  Availability node;
+  node.total = readCount(nodeDirectory + "/nr_hugepages");
+  node.free = readCount(nodeDirectory + "/free_hugepages");
+  for (const auto& entry : entries) {
+    if (entry.pageSize == pageSize && !entry.mapped && (entry.numaNode == numaNode || entry.numaNode < 0)) {
+      node.pending += entry.pages;
+    }
+  }
+  node.available = std::min(system.available, saturatingSubtract(node.free, node.pending));
+  return node;
+}
+
+auto HugepageRegistry::getAvailability(size_t pageSize, int numaNode) -> Availability
+{
+  Transaction transaction(mPath);
+  return getAvailability(transaction.getEntries(), pageSize, numaNode);
+}
+
+auto HugepageRegistry::getEntries() -> std::vector<Entry>
+{
+  Transaction transaction(mPath);
+  return transaction.getEntries();
+}
+
+size_t HugepageRegistry::getAllocatedPages(const std::string& filePath, size_t bufferSize, size_t pageSize)
+{
+  struct stat status;
+  if (stat(filePath.c_str(), &status) != 0 || size_t(status.st_size) != bufferSize) {
+    return 0;
+  }
+  // st_blocks is in units of 512 bytes, and the hugetlbfs adds a whole page's worth for every page it faults in
+  return std::min(size_t(status.st_blocks) * 512 / pageSize, bufferSize / pageSize);
+}
+
+std::unique_ptr<HugepageReservation> HugepageRegistry::reserve(size_t bufferSize, size_t pageSize, int numaNode,
+                                                                const std::string& name)
+{
+  const size_t pages = (bufferSize + pageSize - 1) / pageSize;
+
+  Transaction transaction(mPath);
+  auto& entries = transaction.getEntries();
+  auto availability = getAvailability(entries, pageSize, numaNode);
+  if (pages > availability.available) {
+    std::ostringstream holders;
+    for (const auto& entry : entries) {
+      if (entry.pageSize == pageSize && !entry.mapped) {
+        holders << (holders.tellp() > 0 ? ", " : "") << entry.name << " (PID " << entry.pid << ", " << entry.pages << ")";
+      }
+    }
+    BOOST_THROW_EXCEPTION(HugepageCapacityException()
+                          << ErrorInfo::Message((b::format("Not enough %d KiB hugepages%s for buffer '%s': %d needed, "
+                                                           "%d available (%d of %d free, %d reserved by other processes%s)")
+                                                 % (pageSize / 1024) % (numaNode < 0 ? "" : " on NUMA node " + std::to_string(numaNode))
+                                                 % name % pages % availability.available % availability.free
+                                                 % availability.total % availability.pending
+                                                 % (holders.tellp() > 0 ? ": " + holders.str() : ""))
+                                                  .str())
+                          << ErrorInfo::FileName(mPath)
+                          << ErrorInfo::PossibleCauses({ "Hugepage pool too small (check 'hugeadm --pool-list', see roc-setup-hugetlbfs)",
+                                                         "Other readout processes hold the hugepages",
+                                                         "Stale hugepage resources (run 'roc-cleanup')" }));
+  }
+
+  Entry entry;
+  entry.id = 1;
+  for (const auto& other : entries) {
+    entry.id = std::max(entry.id, other.id + 1);
+  }
+  entry.pid = getpid();
+  entry.startTime = getStartTime(entry.pid).value_or(0);
+  entry.pageSize = pageSize;
+  entry.numaNode = numaNode;
+  entry.pages = pages;
+  entry.mapped = false;
+  entry.name = name;
+  entries.push_back(entry);
+  transaction.commit();
+  return std::make_unique<HugepageReservation>(*this, entry.id, pages, pageSize);
+}
+
+void HugepageRegistry::setMapped(uint64_t id)
+{
+  Transaction transaction(mPath);
+  for (auto& entry : transaction.getEntries()) {
+    if (entry.id == id) {
+      entry.mapped = true;
+    }
+  }
+  transaction.commit();
+}
+
+void HugepageRegistry::release(uint64_t id)
+{
+  Transaction transaction(mPath);
+  auto& entries = transaction.getEntries();
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.id == id; }),
+                entries.end());
+  transaction.commit();
+}
+
+HugepageReservation::HugepageReservation(HugepageRegistry registry, uint64_t id, size_t pages, size_t pageSize)
+  : mRegistry(std::move(registry)), mId(id), mPages(pages), mPageSize(pageSize)
+{
+}
+
+HugepageReservation::~HugepageReservation()
+{
+  try {
+    mRegistry.release(mId);
+  } catch (const std::exception&) {
+    // The entry is dropped anyway once this process exits
+  }
+}
+
+void HugepageReservation::setMapped()
+{
+  mRegistry.setMapped(mId);
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
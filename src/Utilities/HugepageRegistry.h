@@ -0,0 +1,141 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HugepageRegistry.h
+/// \brief Definition of the HugepageRegistry and HugepageReservation classes.
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_HUGEPAGEREGISTRY_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_HUGEPAGEREGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+class HugepageReservation;
+
+/// Node-wide registry of the hugepages that readout processes reserved for their buffers, so that a process is refused
+/// up front when the hugepages it needs are already promised to another one, instead of failing when it maps them.
+///
+/// The registry is a small text file in shared memory, with a line per reservation, which is only accessed under an
+/// exclusive flock(2). A reservation counts against the free hugepages until its process maps the buffer, after which
+/// the kernel accounts for the pages itself. Reservations of processes that died are dropped on every access.
+/// The file is readable and writable by its owner and group only, so the readout processes must share a group.
+class HugepageRegistry
+{
+ public:
+  static constexpr const char* DEFAULT_PATH = "/dev/shm/AliceO2_RoC_hugepage_registry";
+
+  /// A reservation in the registry
+  struct Entry {
+    uint64_t id;
+    pid_t pid;
+    uint64_t startTime; ///< Start time of the process, to tell a recycled PID from the process that reserved
+    size_t pageSize;    ///< In bytes
+    int numaNode;       ///< -1 if any node
+    size_t pages;
+    bool mapped; ///< The buffer is mapped, so the kernel accounts for the pages
+    std::string name;
+  };
+
+  /// Hugepages of a size, on a NUMA node or the whole system
+  struct Availability {
+    size_t total = 0;     ///< Hugepages in the pool
+    size_t free = 0;      ///< Free hugepages, minus the ones the kernel reserved for mappings not faulted in yet
+    size_t pending = 0;   ///< Hugepages reserved in the registry, but not mapped yet
+    size_t available = 0; ///< Hugepages a new reservation can have
+  };
+
+  /// \param path Path of the registry file
+  /// \param sysfsPath Root of sysfs, where the hugepage pools are read from
+  explicit HugepageRegistry(std::string path = DEFAULT_PATH, std::string sysfsPath = "/sys");
+
+  /// Reserves hugepages for a buffer
+  /// \param bufferSize Size of the buffer, a multiple of the page size
+  /// \param pageSize Hugepage size in bytes
+  /// \param numaNode NUMA node the buffer will be on, or -1 if any
+  /// \param name Name of the buffer, to tell the reservations apart
+  /// \exception HugepageCapacityException Not enough hugepages are available
+  /// \exception MemoryMapException The registry could not be opened, locked or written
+  std::unique_ptr<HugepageReservation> reserve(size_t bufferSize, size_t pageSize, int numaNode, const std::string& name);
+
+  /// Hugepages of a size that are available for new reservations
+  /// \param numaNode NUMA node, or -1 for the whole system
+  Availability getAvailability(size_t pageSize, int numaNode = -1);
+
+  /// Reservations of the live processes
+  std::vector<Entry> getEntries();
+
+  /// Hugepages already allocated to an existing buffer file. MemoryMappedFile reuses a file of the buffer size, left
+  /// behind by a crash or by not removing it, and the kernel already accounts for its allocated pages.
+  /// \param filePath Path of the buffer file in the hugetlbfs
+  /// \param bufferSize Size of the buffer. A file of another size is not reused, so none of its pages count.
+  /// \param pageSize Hugepage size in bytes
+  static size_t getAllocatedPages(const std::string& filePath, size_t bufferSize, size_t pageSize);
+
+ private:
+  friend class HugepageReservation;
+
+  /// Holds the lock on the registry file, and its entries, with those of dead processes dropped
+  class Transaction;
+
+  Availability getAvailability(const std::vector<Entry>& entries, size_t pageSize, int numaNode) const;
+
+  void setMapped(uint64_t id);
+  void release(uint64_t id);
+
+  std::string mPath;
+  std::string mSysfsPath;
+};
+
+/// Hugepages reserved in the HugepageRegistry. The reservation is released when the object is destroyed.
+class HugepageReservation
+{
+ public:
+  HugepageReservation(HugepageRegistry registry, uint64_t id, size_t pages, size_t pageSize);
+  ~HugepageReservation();
+
+  HugepageReservation(const HugepageReservation&) = delete;
+  HugepageReservation& operator=(const HugepageReservation&) = delete;
+
+  /// Called once the buffer is mapped, from when the kernel accounts for the pages
+  void setMapped();
+
+  size_t getPages() const
+  {
+    return mPages;
+  }
+
+  size_t getPageSize() const
+  {
+    return mPageSize;
+  }
+
+ private:
+  HugepageRegistry mRegistry;
+  uint64_t mId;
+  size_t mPages;
+  size_t mPageSize;
+};
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_HUGEPAGEREGISTRY_H_
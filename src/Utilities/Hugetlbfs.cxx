@@ -41,7 +41,8 @@ std::string getDirectory(HugepageType hugepageType)
 }
 
 std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string bufferName, bool deleteOnDestruction,
-                                             HugepageType* allocatedHugepageType)
+                                             HugepageType* allocatedHugepageType,
+                                             std::unique_ptr<HugepageReservation>* reservation)
 {
   std::unique_ptr<MemoryMappedFile> memoryMappedFile;
   HugepageType attemptHugepageType;
@@ -59,10 +60,21 @@ std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string buff
   }
 
   auto createBuffer = [&](HugepageType hugepageType) {
+    std::string bufferFilePath = getDirectory(hugepageType) + bufferName;
+    const size_t pageSize = hugepageType == HugepageType::Size2MiB ? SIZE_2MiB : SIZE_1GiB;
+
+    // Reserve the hugepages first, so we are refused here rather than when mapping or touching them. A file left
+    // behind with the same size is reused, and its allocated pages are not free anymore, so they are not reserved.
+    const size_t allocatedPages = HugepageRegistry::getAllocatedPages(bufferFilePath, bufferSize, pageSize);
+    auto hugepageReservation = HugepageRegistry().reserve(bufferSize - allocatedPages * pageSize, pageSize, -1,
+                                                          bufferName);
+
     // Create buffer file
-    std::string bufferFilePath = b::str(
-      b::format("/var/lib/hugetlbfs/global/pagesize-%1%/%2%") % (hugepageType == HugepageType::Size2MiB ? "2MB" : "1GB") % bufferName);
     Utilities::resetSmartPtr(memoryMappedFile, bufferFilePath, bufferSize, deleteOnDestruction);
+    hugepageReservation->setMapped();
+    if (reservation) {
+      *reservation = std::move(hugepageReservation);
+    }
     if (allocatedHugepageType) {
       *allocatedHugepageType = hugepageType;
     }
@@ -72,7 +84,7 @@ std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string buff
     try {
       createBuffer(HugepageType::Size1GiB);
     } catch (const MemoryMapException&) {
-      // Failed to allocate buffer with 1GiB hugepages, falling back to 2MiB hugepages...
+      // Failed to reserve or allocate buffer with 1GiB hugepages, falling back to 2MiB hugepages...
     }
   }
   if (!memoryMappedFile) {
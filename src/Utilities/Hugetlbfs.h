@@ -19,6 +19,7 @@
 #include <memory>
 #include "ReadoutCard/ParameterTypes/PciAddress.h"
 #include "ReadoutCard/MemoryMappedFile.h"
+#include "Utilities/HugepageRegistry.h"
 
 namespace AliceO2
 {
@@ -41,14 +42,21 @@ std::string getDirectory(HugepageType hugepageType);
 ///
 /// Note that the file may end up in either the 2MiB or 1GiB hugetlbfs, depending on circumstances. You can get the full
 /// file path from the resulting MemoryMappedFile if you need to know it.
+/// The hugepages are reserved in the node-wide HugepageRegistry before the file is mapped, so the allocation fails up
+/// front with a HugepageCapacityException if other processes already hold them. The pages already allocated to an
+/// existing file of the buffer size, which is reused, are not reserved again.
 /// \param bufferSize The size of the buffer to allocate
 /// \param bufferName The name of the file
 /// \param deleteFileOnDesctruction Passed to MemoryMappedFile constructor, determines if the file is deleted on
 ///        destruction of the MemoryMappedFile.
 /// \param allocatedHugepageType Optional argument, set to a HugepageType if you must know what type of hugepage was
 ///        allocated.
+/// \param reservation Optional argument, set to the reservation of the hugepages, to keep the buffer listed in the
+///        registry while it is in use. If not given, the reservation is released once the file is mapped, from when
+///        the kernel accounts for the pages.
 std::unique_ptr<MemoryMappedFile> tryMapFile(size_t bufferSize, std::string bufferName, bool deleteFileOnDestruction,
-                                             HugepageType* allocatedHugepageType = nullptr);
+                                             HugepageType* allocatedHugepageType = nullptr,
+                                             std::unique_ptr<HugepageReservation>* reservation = nullptr);
 
 } // namespace Utilities
 } // namespace roc
@@ -0,0 +1,190 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file IdleStrategy.h
+/// \brief Definition of the IdleStrategy class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_IDLESTRATEGY_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_IDLESTRATEGY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+/// Decides what a polling loop does when a poll found no work.
+/// Policies trade wake-up latency for CPU use:
+///   - BusySpin: returns immediately, lowest latency, burns a full core
+///   - Pause: spins with the CPU's pause hint, which frees resources for the sibling hyper-thread and saves power
+///   - Yield: gives the core to other runnable threads
+///   - Backoff: spins, then pauses, then yields, then sleeps with a doubling time up to the sleep time
+///   - Sleep: sleeps for the sleep time
+/// Loops that call idle(workDone) only back off after empty polls, and start over from spinning as soon as they find
+/// work again.
+/// It is header-only so that idle(true) inlines to a counter reset, and a busy loop pays no call for its polls.
+class IdleStrategy
+{
+ public:
+  struct Policy {
+    enum type {
+      BusySpin,
+      Pause,
+      Yield,
+      Backoff,
+      Sleep
+    };
+  };
+
+  /// Backoff: amount of empty polls with busy spinning
+  static constexpr int BACKOFF_SPINS = 10;
+
+  /// Backoff: amount of empty polls with pause spinning, after the busy spins
+  static constexpr int BACKOFF_PAUSES = 100;
+
+  /// Backoff: amount of empty polls with a yield, after the pause spins
+  static constexpr int BACKOFF_YIELDS = 10;
+
+  /// Backoff: first sleep time, after the yields
+  static constexpr std::chrono::microseconds BACKOFF_MIN_SLEEP{ 1 };
+
+  /// \param policy What to do on an empty poll
+  /// \param sleepTime Sleep time for the Sleep policy, and maximum sleep time for the Backoff policy
+  IdleStrategy(Policy::type policy = Policy::Backoff, std::chrono::microseconds sleepTime = std::chrono::microseconds(100))
+    : mPolicy(policy), mSleepTime(sleepTime)
+  {
+    reset();
+  }
+
+  /// Progress-aware idle: does nothing and restarts the backoff if the poll found work, idles otherwise
+  void idle(bool workDone)
+  {
+    if (workDone) {
+      reset();
+    } else {
+      idle();
+    }
+  }
+
+  /// Idles after an empty poll
+  void idle()
+  {
+    switch (mPolicy) {
+      case Policy::BusySpin:
+        break;
+      case Policy::Pause:
+        cpuRelax();
+        break;
+      case Policy::Yield:
+        std::this_thread::yield();
+        break;
+      case Policy::Sleep:
+        std::this_thread::sleep_for(mSleepTime);
+        break;
+      case Policy::Backoff:
+        backoff();
+        break;
+    }
+  }
+
+  /// Restarts the backoff, after work was found
+  void reset()
+  {
+    mEmptyPolls = 0;
+    mBackoffSleep = std::min<std::chrono::microseconds>(BACKOFF_MIN_SLEEP, mSleepTime);
+  }
+
+  Policy::type getPolicy() const
+  {
+    return mPolicy;
+  }
+
+  /// Hints the CPU that we are in a spin loop
+  static void cpuRelax()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+  }
+
+  static Policy::type fromString(const std::string& string)
+  {
+    if (string == "busy-spin") {
+      return Policy::BusySpin;
+    } else if (string == "pause") {
+      return Policy::Pause;
+    } else if (string == "yield") {
+      return Policy::Yield;
+    } else if (string == "backoff") {
+      return Policy::Backoff;
+    } else if (string == "sleep") {
+      return Policy::Sleep;
+    }
+    BOOST_THROW_EXCEPTION(ParameterException() << ErrorInfo::Message(
+                            "Invalid idle strategy '" + string + "', must be busy-spin, pause, yield, backoff or sleep"));
+  }
+
+  static std::string toString(Policy::type policy)
+  {
+    switch (policy) {
+      case Policy::BusySpin:
+        return "busy-spin";
+      case Policy::Pause:
+        return "pause";
+      case Policy::Yield:
+        return "yield";
+      case Policy::Backoff:
+        return "backoff";
+      case Policy::Sleep:
+        return "sleep";
+    }
+    return "unknown";
+  }
+
+ private:
+  void backoff()
+  {
+    if (mEmptyPolls < BACKOFF_SPINS) {
+      mEmptyPolls++;
+    } else if (mEmptyPolls < (BACKOFF_SPINS + BACKOFF_PAUSES)) {
+      mEmptyPolls++;
+      cpuRelax();
+    } else if (mEmptyPolls < (BACKOFF_SPINS + BACKOFF_PAUSES + BACKOFF_YIELDS)) {
+      mEmptyPolls++;
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(mBackoffSleep);
+      mBackoffSleep = std::min(mBackoffSleep * 2, mSleepTime);
+    }
+  }
+
+  Policy::type mPolicy;
+  std::chrono::microseconds mSleepTime;
+  std::chrono::microseconds mBackoffSleep;
+  int mEmptyPolls;
+};
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_IDLESTRATEGY_H_
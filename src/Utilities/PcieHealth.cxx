@@ -0,0 +1,90 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PcieHealth.cxx
+/// \brief Implementation of functions to detect a lost PCIe device.
+
+#include "PcieHealth.h"
+#include <fstream>
+#include <boost/format.hpp>
+#include "ExceptionInternal.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+namespace b = boost;
+namespace
+{
+
+std::string getPciSysfsDirectory(const PciAddress& pciAddress)
+{
+  return (b::format("/sys/bus/pci/devices/0000:%s") % pciAddress.toString()).str();
+}
+
+/// Reads the total from an AER counter file. It has a line per error type, e.g. "BadTLP 0", and a total, e.g.
+/// "TOTAL_ERR_COR 2".
+boost::optional<uint64_t> readAerTotal(const std::string& path, const std::string& totalName)
+{
+  std::ifstream stream(path);
+  std::string name;
+  uint64_t value;
+  while (stream >> name >> value) {
+    if (name == totalName) {
+      return value;
+    }
+  }
+  return {};
+}
+
+} // Anonymous namespace
+
+boost::optional<AerCounters> getAerCounters(const PciAddress& pciAddress)
+{
+  auto directory = getPciSysfsDirectory(pciAddress);
+  auto correctable = readAerTotal(directory + "/aer_dev_correctable", "TOTAL_ERR_COR");
+  auto nonFatal = readAerTotal(directory + "/aer_dev_nonfatal", "TOTAL_ERR_NONFATAL");
+  auto fatal = readAerTotal(directory + "/aer_dev_fatal", "TOTAL_ERR_FATAL");
+  if (!correctable || !nonFatal || !fatal) {
+    return {};
+  }
+  return AerCounters{ *correctable, *nonFatal, *fatal };
+}
+
+bool isDeviceResponding(const PciAddress& pciAddress)
+{
+  // The vendor ID, the first two bytes of the configuration space, which any user may read
+  std::ifstream stream(getPciSysfsDirectory(pciAddress) + "/config", std::ios::binary);
+  uint16_t vendorId = 0;
+  if (!stream.read(reinterpret_cast<char*>(&vendorId), sizeof(vendorId))) {
+    return false;
+  }
+  return vendorId != 0xffff;
+}
+
+void throwDeviceLost(const PciAddress& pciAddress, const std::string& context)
+{
+  std::string message = "Device lost while " + context + ": MMIO reads return all ones";
+  if (auto aer = getAerCounters(pciAddress)) {
+    message += (b::format("; AER errors: %d fatal, %d non-fatal, %d correctable") % aer->fatal % aer->nonFatal % aer->correctable).str();
+  }
+  BOOST_THROW_EXCEPTION(DeviceLostException() << ErrorInfo::Message(message)
+                                              << ErrorInfo::PciAddress(pciAddress)
+                                              << ErrorInfo::PossibleCauses({ "Card was removed or powered off",
+                                                                             "PCIe link went down",
+                                                                             "Uncorrectable PCIe error, see the kernel log (dmesg) for AER reports",
+                                                                             "Firmware was reloaded without rescanning the PCI bus" }));
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
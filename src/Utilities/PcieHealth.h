@@ -0,0 +1,61 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PcieHealth.h
+/// \brief Definition of functions to detect a lost PCIe device.
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_PCIEHEALTH_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_PCIEHEALTH_H_
+
+#include <cstdint>
+#include <string>
+#include <boost/optional.hpp>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+/// Value of an MMIO read from a device that dropped off the bus, or is in an uncorrectable error state. The root
+/// complex completes the read with all ones.
+constexpr uint32_t PCIE_ALL_ONES = 0xffffffff;
+
+inline bool isAllOnes(uint32_t value)
+{
+  return value == PCIE_ALL_ONES;
+}
+
+/// AER error counters of a device, from sysfs
+struct AerCounters {
+  uint64_t correctable = 0;
+  uint64_t nonFatal = 0;
+  uint64_t fatal = 0;
+};
+
+/// Reads the AER error counters of the device
+/// \return The counters, or none if the kernel does not report them (no AER support, or kernel older than 4.17)
+boost::optional<AerCounters> getAerCounters(const PciAddress& pciAddress);
+
+/// Checks if the device still responds to configuration reads. An all-ones MMIO read can be a legitimate register
+/// value, so this confirms it: the configuration space of a lost device is gone from sysfs, or reads all ones too.
+bool isDeviceResponding(const PciAddress& pciAddress);
+
+/// Throws a DeviceLostException for the device, with the AER counters in the message
+/// \param context What was being done when the device was found lost
+[[noreturn]] void throwDeviceLost(const PciAddress& pciAddress, const std::string& context);
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_PCIEHEALTH_H_
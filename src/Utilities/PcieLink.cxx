@@ -0,0 +1,42 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PcieLink.cxx
+/// \brief Implementation of functions for inspecting the PCIe link of a device
+
+#include "PcieLink.h"
+#include <fstream>
+#include <boost/format.hpp>
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+namespace b = boost;
+
+boost::optional<PcieLink> getPcieLink(const PciAddress& pciAddress)
+{
+  auto directory = (b::format("/sys/bus/pci/devices/0000:%s") % pciAddress.toString()).str();
+
+  // The speed reads e.g. "8.0 GT/s PCIe", or "8 GT/s" on older kernels
+  std::ifstream speedFile(directory + "/current_link_speed");
+  std::ifstream widthFile(directory + "/current_link_width");
+  PcieLink link;
+  if (!(speedFile >> link.gigatransfersPerSecond) || !(widthFile >> link.lanes) || link.lanes <= 0) {
+    return {};
+  }
+  return link;
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
@@ -0,0 +1,41 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PcieLink.h
+/// \brief Definition of functions for inspecting the PCIe link of a device
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_PCIELINK_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_PCIELINK_H_
+
+#include <boost/optional.hpp>
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+/// Negotiated PCIe link of a device
+struct PcieLink {
+  double gigatransfersPerSecond;
+  int lanes;
+};
+
+/// Reads the negotiated PCIe link of the device from sysfs
+/// \return The link, or none if the kernel does not report it
+boost::optional<PcieLink> getPcieLink(const PciAddress& pciAddress);
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_PCIELINK_H_
@@ -0,0 +1,131 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PerfCounters.cxx
+/// \brief Implementation of the PerfCounters class.
+
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+namespace
+{
+
+/// Layout of a read of a group with PERF_FORMAT_GROUP and the total times
+struct GroupReading {
+  uint64_t count;
+  uint64_t timeEnabled;
+  uint64_t timeRunning;
+  uint64_t values[PerfEvent::COUNT];
+};
+
+void setEventConfig(PerfEvent::type event, perf_event_attr& attr)
+{
+  attr.type = PERF_TYPE_HARDWARE;
+  switch (event) {
+    case PerfEvent::Cycles:
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PerfEvent::Instructions:
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PerfEvent::LlcMisses:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfEvent::StalledCycles:
+      attr.config = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+      break;
+  }
+}
+
+int openEvent(PerfEvent::type event, int groupFd)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  setEventConfig(event, attr);
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.disabled = (groupFd < 0) ? 1 : 0; // The leader starts the group
+  return int(syscall(__NR_perf_event_open, &attr, 0 /* calling thread */, -1 /* any CPU */, groupFd, 0));
+}
+
+} // Anonymous namespace
+
+PerfCounters::PerfCounters()
+{
+  mFds.fill(-1);
+  mSlots.fill(-1);
+
+  int slot = 0;
+  for (int i = 0; i < PerfEvent::COUNT; ++i) {
+    auto event = PerfEvent::type(i);
+    int fd = openEvent(event, mLeader);
+    if (fd < 0) {
+      mError += std::string(mError.empty() ? "" : "; ") + PerfEvent::toString(event) + ": " + std::strerror(errno);
+      continue;
+    }
+    if (mLeader < 0) {
+      mLeader = fd;
+    }
+    mFds[i] = fd;
+    mSlots[i] = slot++;
+  }
+
+  if (mLeader >= 0) {
+    ioctl(mLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+PerfCounters::~PerfCounters()
+{
+  for (int fd : mFds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+auto PerfCounters::read() const -> Counts
+{
+  Counts counts;
+  if (mLeader < 0) {
+    return counts;
+  }
+  GroupReading reading;
+  if (::read(mLeader, &reading, sizeof(reading)) <= 0) {
+    return counts;
+  }
+  counts.timeEnabled = reading.timeEnabled;
+  counts.timeRunning = reading.timeRunning;
+  for (int i = 0; i < PerfEvent::COUNT; ++i) {
+    if (mSlots[i] >= 0 && uint64_t(mSlots[i]) < reading.count) {
+      counts.values[i] = reading.values[mSlots[i]];
+    }
+  }
+  return counts;
+}
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
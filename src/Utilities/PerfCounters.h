@@ -0,0 +1,184 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PerfCounters.h
+/// \brief Definition of the PerfCounters class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_UTILITIES_PERFCOUNTERS_H_
+#define ALICEO2_SRC_READOUTCARD_UTILITIES_PERFCOUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Utilities
+{
+
+/// CPU event counted by the PerfCounters
+struct PerfEvent {
+  enum type {
+    Cycles,
+    Instructions,
+    LlcMisses,     ///< Last level cache misses, e.g. on data the card just wrote
+    StalledCycles, ///< Cycles the back-end was stalled, e.g. on MMIO reads or memory
+  };
+
+  static constexpr int COUNT = 4;
+
+  static const char* toString(type event)
+  {
+    switch (event) {
+      case Cycles:
+        return "cycles";
+      case Instructions:
+        return "instructions";
+      case LlcMisses:
+        return "LLC misses";
+      case StalledCycles:
+        return "stalled cycles";
+    }
+    return "unknown";
+  }
+};
+
+/// Hardware performance counters of the calling thread, through perf_event_open(2). Only user space is counted, so it
+/// works with the default perf_event_paranoid setting.
+/// Counters the CPU, kernel or virtual machine does not provide are left out, and isAvailable() tells which ones
+/// are counted. If none are, read() returns zeroes, so callers need not check.
+/// The counters belong to the thread that constructed the object, and must only be read from that thread.
+class PerfCounters
+{
+ public:
+  /// Counts since the counters were opened
+  struct Counts {
+    std::array<uint64_t, PerfEvent::COUNT> values{};
+    uint64_t timeEnabled = 0; ///< Nanoseconds the counters were enabled
+    uint64_t timeRunning = 0; ///< Nanoseconds the counters were on the CPU, less than enabled if multiplexed
+
+    uint64_t operator[](PerfEvent::type event) const
+    {
+      return values[event];
+    }
+
+    /// Counts between an earlier reading and this one, scaled up if the counters were multiplexed in between
+    Counts operator-(const Counts& earlier) const
+    {
+      Counts delta;
+      delta.timeEnabled = timeEnabled - earlier.timeEnabled;
+      delta.timeRunning = timeRunning - earlier.timeRunning;
+      const double scale = (delta.timeRunning > 0 && delta.timeRunning < delta.timeEnabled)
+                             ? double(delta.timeEnabled) / delta.timeRunning
+                             : 1.0;
+      for (size_t i = 0; i < values.size(); ++i) {
+        delta.values[i] = uint64_t((values[i] - earlier.values[i]) * scale);
+      }
+      return delta;
+    }
+
+    Counts& operator+=(const Counts& other)
+    {
+      for (size_t i = 0; i < values.size(); ++i) {
+        values[i] += other.values[i];
+      }
+      timeEnabled += other.timeEnabled;
+      timeRunning += other.timeRunning;
+      return *this;
+    }
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool isAvailable(PerfEvent::type event) const
+  {
+    return mSlots[event] >= 0;
+  }
+
+  /// Is any of the counters available
+  bool isAvailable() const
+  {
+    return mLeader >= 0;
+  }
+
+  /// Why the counters that are not available failed to open, empty if all are available
+  const std::string& getError() const
+  {
+    return mError;
+  }
+
+  Counts read() const;
+
+ private:
+  /// File descriptor of the group leader, or -1
+  int mLeader = -1;
+
+  /// File descriptors of all opened counters
+  std::array<int, PerfEvent::COUNT> mFds;
+
+  /// Position of each event's value in a read of the group, or -1 if not available
+  std::array<int, PerfEvent::COUNT> mSlots;
+
+  std::string mError;
+};
+
+/// Accumulates the counts of a code region over all the times it runs, e.g. every call of a poll function.
+/// Every begin() and end() reads the counters, i.e. costs a system call.
+class PerfRegion
+{
+ public:
+  /// \param counters Counters of the thread that runs the region, or nullptr to count nothing
+  explicit PerfRegion(const PerfCounters* counters = nullptr) : mCounters(counters)
+  {
+  }
+
+  void begin()
+  {
+    if (mCounters) {
+      mStart = mCounters->read();
+    }
+  }
+
+  void end()
+  {
+    if (mCounters) {
+      mTotal += mCounters->read() - mStart;
+      mCalls++;
+    }
+  }
+
+  const PerfCounters::Counts& getTotal() const
+  {
+    return mTotal;
+  }
+
+  uint64_t getCalls() const
+  {
+    return mCalls;
+  }
+
+ private:
+  const PerfCounters* mCounters;
+  PerfCounters::Counts mStart;
+  PerfCounters::Counts mTotal;
+  uint64_t mCalls = 0;
+};
+
+} // namespace Utilities
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_UTILITIES_PERFCOUNTERS_H_
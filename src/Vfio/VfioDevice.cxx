@@ -0,0 +1,306 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file VfioDevice.cxx
+/// \brief Implementation of the VfioDevice class.
+
+#include "VfioDevice.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <linux/pci_regs.h>
+#include <linux/vfio.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include "ExceptionInternal.h"
+#include "Utilities/Numa.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Vfio
+{
+namespace bfs = boost::filesystem;
+namespace
+{
+
+struct DeviceType {
+  CardType::type cardType;
+  PciId pciId;
+};
+
+// Same IDs as in RocPciDevice, which only sees the devices bound to the PDA driver
+const std::vector<DeviceType> deviceTypes = {
+  { CardType::Crorc, { "0033", "10dc" } }, // C-RORC
+  { CardType::Cru, { "e001", "1172" } },   // Altera dev board CRU
+};
+
+std::string getSysfsName(const PciAddress& address)
+{
+  return "0000:" + address.toString();
+}
+
+bfs::path getSysfsDirectory(const PciAddress& address)
+{
+  return bfs::path("/sys/bus/pci/devices") / getSysfsName(address);
+}
+
+/// Reads an ID like "0x10dc" from sysfs, and returns it without the prefix
+std::string readId(const bfs::path& path)
+{
+  std::ifstream stream(path.string());
+  std::string id;
+  stream >> id;
+  return (id.compare(0, 2, "0x") == 0) ? id.substr(2) : id;
+}
+
+std::string errorString(const std::string& message)
+{
+  return message + ": " + std::strerror(errno);
+}
+
+} // Anonymous namespace
+
+std::shared_ptr<VfioDevice> VfioDevice::get(const PciAddress& address)
+{
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<VfioDevice>> devices;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& entry = devices[address.toString()];
+  if (auto device = entry.lock()) {
+    return device;
+  }
+  auto device = std::make_shared<VfioDevice>(address);
+  entry = device;
+  return device;
+}
+
+CardDescriptor VfioDevice::getCardDescriptor(const PciAddress& address)
+{
+  auto directory = getSysfsDirectory(address);
+  boost::system::error_code error;
+  auto driver = bfs::read_symlink(directory / "driver", error);
+  if (error || driver.filename() != "vfio-pci") {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Device is not bound to the vfio-pci driver")
+                                      << ErrorInfo::PciAddress(address)
+                                      << ErrorInfo::PossibleCauses({ "Device was not unbound from uio_pci_dma and bound to vfio-pci" }));
+  }
+
+  PciId pciId{ readId(directory / "device"), readId(directory / "vendor") };
+  for (const auto& type : deviceTypes) {
+    if (type.pciId.device == pciId.device && type.pciId.vendor == pciId.vendor) {
+      // The serial number is read from the card's BAR, which is not opened here
+      return CardDescriptor{ type.cardType, {}, type.pciId, address, Utilities::getNumaNode(address) };
+    }
+  }
+  BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Device is not a ReadoutCard")
+                                    << ErrorInfo::PciAddress(address)
+                                    << ErrorInfo::PciId(pciId));
+}
+
+VfioDevice::VfioDevice(const PciAddress& address) : mPciAddress(address)
+{
+  try {
+    // The IOMMU group of the device, which is the unit VFIO gives to userspace
+    auto directory = getSysfsDirectory(address);
+    boost::system::error_code error;
+    auto groupLink = bfs::read_symlink(directory / "iommu_group", error);
+    if (error) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Device has no IOMMU group")
+                                        << ErrorInfo::PossibleCauses({ "IOMMU is disabled (intel_iommu=on / amd_iommu=on)" }));
+    }
+    auto groupPath = "/dev/vfio/" + groupLink.filename().string();
+
+    mContainer = open("/dev/vfio/vfio", O_RDWR);
+    if (mContainer < 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to open VFIO container"))
+                                        << ErrorInfo::PossibleCauses({ "vfio-pci module not loaded" }));
+    }
+    if (ioctl(mContainer, VFIO_GET_API_VERSION) != VFIO_API_VERSION) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Unknown VFIO API version"));
+    }
+    if (!ioctl(mContainer, VFIO_CHECK_EXTENSION, VFIO_TYPE1v2_IOMMU)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("VFIO does not support the type 1 IOMMU"));
+    }
+
+    mGroup = open(groupPath.c_str(), O_RDWR);
+    if (mGroup < 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to open VFIO group"))
+                                        << ErrorInfo::FileName(groupPath)
+                                        << ErrorInfo::PossibleCauses({ "Device is open in another process",
+                                                                       "No permission on the group's device file" }));
+    }
+    vfio_group_status groupStatus = {};
+    groupStatus.argsz = sizeof(groupStatus);
+    ioctl(mGroup, VFIO_GROUP_GET_STATUS, &groupStatus);
+    if (!(groupStatus.flags & VFIO_GROUP_FLAGS_VIABLE)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("VFIO group is not viable")
+                                        << ErrorInfo::FileName(groupPath)
+                                        << ErrorInfo::PossibleCauses({ "Other devices in the IOMMU group are not bound to vfio-pci" }));
+    }
+    if (ioctl(mGroup, VFIO_GROUP_SET_CONTAINER, &mContainer) != 0 ||
+        ioctl(mContainer, VFIO_SET_IOMMU, VFIO_TYPE1v2_IOMMU) != 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to set up VFIO container")));
+    }
+
+    mDevice = ioctl(mGroup, VFIO_GROUP_GET_DEVICE_FD, getSysfsName(address).c_str());
+    if (mDevice < 0) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to get VFIO device")));
+    }
+
+    // vfio-pci enables the device, but not its bus mastering, which the card needs to do DMA
+    vfio_region_info config = {};
+    config.argsz = sizeof(config);
+    config.index = VFIO_PCI_CONFIG_REGION_INDEX;
+    uint16_t command = 0;
+    if (ioctl(mDevice, VFIO_DEVICE_GET_REGION_INFO, &config) != 0 ||
+        pread(mDevice, &command, sizeof(command), config.offset + PCI_COMMAND) != sizeof(command)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to read PCI command register")));
+    }
+    command |= PCI_COMMAND_MEMORY | PCI_COMMAND_MASTER;
+    if (pwrite(mDevice, &command, sizeof(command), config.offset + PCI_COMMAND) != sizeof(command)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to enable bus mastering")));
+    }
+  } catch (boost::exception& e) {
+    e << ErrorInfo::PciAddress(address);
+    closeFileDescriptors();
+    throw;
+  }
+}
+
+VfioDevice::~VfioDevice()
+{
+  for (const auto& bar : mBars) {
+    munmap(bar.second.address, bar.second.length);
+  }
+  // Closing the container also unmaps what is left of the DMA buffers
+  closeFileDescriptors();
+}
+
+void VfioDevice::closeFileDescriptors()
+{
+  for (int* fd : { &mDevice, &mGroup, &mContainer }) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+void* VfioDevice::mapBar(int barNumber, size_t& length)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto iter = mBars.find(barNumber);
+  if (iter == mBars.end()) {
+    if (barNumber < 0 || barNumber > VFIO_PCI_BAR5_REGION_INDEX) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("BAR number out of range")
+                                        << ErrorInfo::BarIndex(barNumber));
+    }
+    vfio_region_info region = {};
+    region.argsz = sizeof(region);
+    region.index = VFIO_PCI_BAR0_REGION_INDEX + barNumber;
+    if (ioctl(mDevice, VFIO_DEVICE_GET_REGION_INFO, &region) != 0 || region.size == 0 ||
+        !(region.flags & VFIO_REGION_INFO_FLAG_MMAP)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Failed to get mappable BAR")
+                                        << ErrorInfo::BarIndex(barNumber)
+                                        << ErrorInfo::PciAddress(mPciAddress));
+    }
+    void* address = mmap(nullptr, region.size, PROT_READ | PROT_WRITE, MAP_SHARED, mDevice, region.offset);
+    if (address == MAP_FAILED) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to map BAR"))
+                                        << ErrorInfo::BarIndex(barNumber)
+                                        << ErrorInfo::PciAddress(mPciAddress));
+    }
+    iter = mBars.emplace(barNumber, BarMapping{ address, size_t(region.size) }).first;
+  }
+  length = iter->second.length;
+  return iter->second.address;
+}
+
+uint64_t VfioDevice::mapDma(void* address, size_t size)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  // The IOVA space is 64-bit, so the ranges of unmapped buffers are not reused
+  const uint64_t iova = (mNextIova + IOVA_ALIGNMENT - 1) & ~(IOVA_ALIGNMENT - 1);
+
+  vfio_iommu_type1_dma_map map = {};
+  map.argsz = sizeof(map);
+  map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+  map.vaddr = reinterpret_cast<uintptr_t>(address);
+  map.iova = iova;
+  map.size = size;
+  if (ioctl(mContainer, VFIO_IOMMU_MAP_DMA, &map) != 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to map DMA buffer"))
+                                      << ErrorInfo::Address(map.vaddr)
+                                      << ErrorInfo::DmaBufferSize(size)
+                                      << ErrorInfo::PciAddress(mPciAddress)
+                                      << ErrorInfo::PossibleCauses({ "Buffer is not page-aligned",
+                                                                     "Locked memory limit (ulimit -l) is lower than the buffer size" }));
+  }
+  mNextIova = iova + size;
+  return iova;
+}
+
+void VfioDevice::unmapDma(uint64_t iova, size_t size)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  vfio_iommu_type1_dma_unmap unmap = {};
+  unmap.argsz = sizeof(unmap);
+  unmap.iova = iova;
+  unmap.size = size;
+  ioctl(mContainer, VFIO_IOMMU_UNMAP_DMA, &unmap);
+}
+
+void VfioDevice::setMsiTrigger(int eventFd)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (eventFd >= 0) {
+    vfio_irq_info info = {};
+    info.argsz = sizeof(info);
+    info.index = VFIO_PCI_MSI_IRQ_INDEX;
+    if (ioctl(mDevice, VFIO_DEVICE_GET_IRQ_INFO, &info) != 0 || info.count == 0 ||
+        !(info.flags & VFIO_IRQ_INFO_EVENTFD)) {
+      BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message("Device has no MSI")
+                                        << ErrorInfo::PciAddress(mPciAddress)
+                                        << ErrorInfo::PossibleCauses({ "Firmware does not expose the MSI capability" }));
+    }
+  }
+
+  // The eventfd follows the header as its data
+  std::vector<char> buffer(sizeof(vfio_irq_set) + sizeof(int32_t));
+  auto irqSet = reinterpret_cast<vfio_irq_set*>(buffer.data());
+  irqSet->argsz = buffer.size();
+  irqSet->index = VFIO_PCI_MSI_IRQ_INDEX;
+  irqSet->start = 0;
+  if (eventFd >= 0) {
+    irqSet->flags = VFIO_IRQ_SET_DATA_EVENTFD | VFIO_IRQ_SET_ACTION_TRIGGER;
+    irqSet->count = 1;
+    int32_t fd = eventFd;
+    std::memcpy(irqSet->data, &fd, sizeof(fd));
+  } else {
+    irqSet->argsz = sizeof(vfio_irq_set);
+    irqSet->flags = VFIO_IRQ_SET_DATA_NONE | VFIO_IRQ_SET_ACTION_TRIGGER;
+    irqSet->count = 0;
+  }
+  if (ioctl(mDevice, VFIO_DEVICE_SET_IRQS, irqSet) != 0 && eventFd >= 0) {
+    BOOST_THROW_EXCEPTION(Exception() << ErrorInfo::Message(errorString("Failed to route MSI to eventfd"))
+                                      << ErrorInfo::PciAddress(mPciAddress));
+  }
+}
+
+} // namespace Vfio
+} // namespace roc
+} // namespace AliceO2
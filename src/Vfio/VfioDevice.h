@@ -0,0 +1,104 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file VfioDevice.h
+/// \brief Definition of the VfioDevice class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_VFIO_VFIODEVICE_H_
+#define ALICEO2_SRC_READOUTCARD_VFIO_VFIODEVICE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "ReadoutCard/CardDescriptor.h"
+#include "ReadoutCard/ParameterTypes/PciAddress.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Vfio
+{
+
+/// A PCI device bound to the vfio-pci driver. It owns the VFIO container, group and device file descriptors, the
+/// memory-mapped BARs, and the IOVA space of the container, from which DMA buffers are mapped.
+/// A VFIO group can only be opened once, so there is one object per device and process, see get().
+class VfioDevice
+{
+ public:
+  /// Start of the IOVA range given to DMA buffers. It is above 4 GiB to stay clear of the ranges the IOMMU reserves
+  /// below it, like the MSI window.
+  static constexpr uint64_t IOVA_BASE = 1ull << 32;
+
+  /// Alignment of the IOVA of a DMA buffer, so that hugepages can be mapped with the IOMMU's large pages
+  static constexpr uint64_t IOVA_ALIGNMENT = 1ull << 30;
+
+  /// Gets the device with the given address, opening it if this process does not have it open yet
+  static std::shared_ptr<VfioDevice> get(const PciAddress& address);
+
+  /// Describes the device with the given address from sysfs, without opening it
+  /// \exception Exception The device is not a ReadoutCard, or is not bound to vfio-pci
+  static CardDescriptor getCardDescriptor(const PciAddress& address);
+
+  explicit VfioDevice(const PciAddress& address);
+  ~VfioDevice();
+
+  VfioDevice(const VfioDevice&) = delete;
+  VfioDevice& operator=(const VfioDevice&) = delete;
+
+  const PciAddress& getPciAddress() const
+  {
+    return mPciAddress;
+  }
+
+  /// Memory-maps a BAR through the device file descriptor. The mapping lives as long as the device.
+  /// \param barNumber Index of the BAR
+  /// \param[out] length Length of the BAR
+  /// \return Userspace address of the BAR
+  void* mapBar(int barNumber, size_t& length);
+
+  /// Maps a buffer into the IOMMU at a contiguous IOVA range, which the card uses as bus addresses
+  /// \return The IOVA of the start of the buffer
+  uint64_t mapDma(void* address, size_t size);
+
+  /// Unmaps a buffer mapped with mapDma()
+  void unmapDma(uint64_t iova, size_t size);
+
+  /// Routes the MSI of the card to an eventfd, which the kernel then signals on every interrupt
+  /// \param eventFd The eventfd, or -1 to stop the routing and disable the MSI
+  void setMsiTrigger(int eventFd);
+
+ private:
+  struct BarMapping {
+    void* address;
+    size_t length;
+  };
+
+  void closeFileDescriptors();
+
+  PciAddress mPciAddress;
+  int mContainer = -1;
+  int mGroup = -1;
+  int mDevice = -1;
+
+  /// Next free IOVA of the container
+  uint64_t mNextIova = IOVA_BASE;
+
+  std::map<int, BarMapping> mBars;
+  std::mutex mMutex;
+};
+
+} // namespace Vfio
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_VFIO_VFIODEVICE_H_
@@ -0,0 +1,79 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file VfioDmaBuffer.h
+/// \brief Definition of the VfioDmaBuffer class.
+
+#ifndef ALICEO2_SRC_READOUTCARD_VFIO_VFIODMABUFFER_H_
+#define ALICEO2_SRC_READOUTCARD_VFIO_VFIODMABUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ExceptionInternal.h"
+#include "Vfio/VfioDevice.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+namespace Vfio
+{
+
+/// Maps a user-allocated buffer into the IOMMU of a VFIO device for the lifetime of the object.
+/// The buffer is mapped at a single contiguous IOVA range, so the bus address of any offset is the IOVA of the start
+/// of the buffer plus the offset, however the buffer is laid out in physical memory.
+class VfioDmaBuffer
+{
+ public:
+  /// \param device
+  /// \param userBufferAddress Address of the user-allocated buffer, page-aligned
+  /// \param userBufferSize Size of the user-allocated buffer, a multiple of the page size
+  VfioDmaBuffer(std::shared_ptr<VfioDevice> device, void* userBufferAddress, size_t userBufferSize)
+    : mDevice(std::move(device)), mSize(userBufferSize), mIova(mDevice->mapDma(userBufferAddress, userBufferSize))
+  {
+  }
+
+  ~VfioDmaBuffer()
+  {
+    mDevice->unmapDma(mIova, mSize);
+  }
+
+  VfioDmaBuffer(const VfioDmaBuffer&) = delete;
+  VfioDmaBuffer& operator=(const VfioDmaBuffer&) = delete;
+
+  /// IOVA of the start of the buffer
+  uintptr_t getIova() const
+  {
+    return mIova;
+  }
+
+  /// Function for getting the bus address that corresponds to the user address + given offset
+  uintptr_t getBusOffsetAddress(size_t offset) const
+  {
+    if (offset >= mSize) {
+      BOOST_THROW_EXCEPTION(Exception()
+                            << ErrorInfo::Message("Physical offset address out of range")
+                            << ErrorInfo::Offset(offset));
+    }
+    return mIova + offset;
+  }
+
+ private:
+  std::shared_ptr<VfioDevice> mDevice;
+  size_t mSize;
+  uintptr_t mIova;
+};
+
+} // namespace Vfio
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_SRC_READOUTCARD_VFIO_VFIODMABUFFER_H_
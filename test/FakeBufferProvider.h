@@ -0,0 +1,118 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FakeBufferProvider.h
+/// \brief Definition of the FakeBufferProvider class, a DMA buffer provider for the tests.
+
+#ifndef ALICEO2_READOUTCARD_TEST_FAKEBUFFERPROVIDER_H_
+#define ALICEO2_READOUTCARD_TEST_FAKEBUFFERPROVIDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "DmaBufferProvider/DmaBufferProviderInterface.h"
+
+namespace AliceO2
+{
+namespace roc
+{
+
+/// Buffer provider with a made-up scatter-gather list, which does not touch any memory or device. The entries are
+/// back-to-back in userspace from USER_BASE, at the bus addresses they are given.
+class FakeBufferProvider : public DmaBufferProviderInterface
+{
+ public:
+  static constexpr uintptr_t USER_BASE = 0x7f0000000000;
+  static constexpr size_t PAGE_SIZE = 2 * 1024 * 1024;
+
+  struct Entry {
+    size_t size;
+    uintptr_t addressBus;
+  };
+
+  /// Entries of any size
+  FakeBufferProvider(std::vector<Entry> entries) : mEntries(entries)
+  {
+  }
+
+  /// 2 MiB hugepages at the given bus addresses
+  FakeBufferProvider(std::vector<uintptr_t> busAddresses)
+  {
+    for (auto busAddress : busAddresses) {
+      mEntries.push_back({ PAGE_SIZE, busAddress });
+    }
+  }
+
+  /// 2 MiB hugepages that are contiguous on the bus, from the given bus address
+  FakeBufferProvider(uintptr_t busAddress, size_t pages)
+  {
+    for (size_t i = 0; i < pages; ++i) {
+      mEntries.push_back({ PAGE_SIZE, busAddress + i * PAGE_SIZE });
+    }
+  }
+
+  virtual uintptr_t getAddress() const override
+  {
+    return USER_BASE;
+  }
+
+  virtual size_t getSize() const override
+  {
+    size_t size = 0;
+    for (const auto& entry : mEntries) {
+      size += entry.size;
+    }
+    return size;
+  }
+
+  virtual size_t getScatterGatherListSize() const override
+  {
+    return mEntries.size();
+  }
+
+  virtual size_t getScatterGatherEntrySize(int index) const override
+  {
+    return mEntries.at(index).size;
+  }
+
+  virtual uintptr_t getScatterGatherEntryAddress(int index) const override
+  {
+    uintptr_t address = USER_BASE;
+    for (int i = 0; i < index; ++i) {
+      address += mEntries.at(i).size;
+    }
+    return address;
+  }
+
+  virtual uintptr_t getScatterGatherEntryBusAddress(int index) const override
+  {
+    return mEntries.at(index).addressBus;
+  }
+
+  virtual uintptr_t getBusOffsetAddress(size_t offset) const override
+  {
+    for (const auto& entry : mEntries) {
+      if (offset < entry.size) {
+        return entry.addressBus + offset;
+      }
+      offset -= entry.size;
+    }
+    throw std::out_of_range("Offset out of range of the fake buffer");
+  }
+
+ private:
+  std::vector<Entry> mEntries;
+};
+
+} // namespace roc
+} // namespace AliceO2
+
+#endif // ALICEO2_READOUTCARD_TEST_FAKEBUFFERPROVIDER_H_
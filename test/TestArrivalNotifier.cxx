@@ -0,0 +1,86 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestArrivalNotifier.cxx
+/// \brief Test of the ArrivalNotifier classes and of the arrival notification of the Dummy channel
+
+#define BOOST_TEST_MODULE RORC_TestArrivalNotifier
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "ArrivalNotifier.h"
+#include "ReadoutCard/ChannelFactory.h"
+#include "ReadoutCard/DmaChannelInterface.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+bool isReadable(int fd)
+{
+  pollfd pfd{ fd, POLLIN, 0 };
+  return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+BOOST_AUTO_TEST_CASE(EventFd)
+{
+  EventFdNotifier notifier;
+  BOOST_CHECK(!isReadable(notifier.getFd()));
+  BOOST_CHECK_EQUAL(notifier.acknowledge(), 0);
+
+  notifier.signal();
+  notifier.signal();
+  BOOST_CHECK(isReadable(notifier.getFd()));
+  BOOST_CHECK(isReadable(notifier.getFd())); // Until acknowledged
+  BOOST_CHECK_EQUAL(notifier.acknowledge(), 2);
+  BOOST_CHECK(!isReadable(notifier.getFd()));
+
+  // Usable with epoll
+  int epoll = epoll_create1(0);
+  BOOST_REQUIRE(epoll >= 0);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  BOOST_REQUIRE_EQUAL(epoll_ctl(epoll, EPOLL_CTL_ADD, notifier.getFd(), &event), 0);
+  BOOST_CHECK_EQUAL(epoll_wait(epoll, &event, 1, 0), 0);
+  notifier.signal();
+  BOOST_CHECK_EQUAL(epoll_wait(epoll, &event, 1, 1000), 1);
+  close(epoll);
+}
+
+BOOST_AUTO_TEST_CASE(DummyChannel)
+{
+  std::vector<char> buffer(1024 * 1024);
+  auto parameters = Parameters::makeParameters(ChannelFactory::getDummySerialNumber(), 0)
+                      .setBufferParameters(buffer_parameters::Memory{ buffer.data(), buffer.size() });
+  // Polling is the default
+  BOOST_CHECK(!ChannelFactory().getDmaChannel(parameters)->getArrivalNotificationFd());
+
+  parameters.setArrivalNotificationEnabled(true);
+  auto channel = ChannelFactory().getDmaChannel(parameters);
+  auto fd = channel->getArrivalNotificationFd();
+  BOOST_REQUIRE(fd);
+  channel->startDma();
+  BOOST_CHECK(!isReadable(*fd));
+
+  channel->pushSuperpage({ 0, 32 * 1024 });
+  channel->pushSuperpage({ 32 * 1024, 32 * 1024 });
+  BOOST_CHECK(isReadable(*fd));
+  channel->fillSuperpages();
+  BOOST_CHECK(!isReadable(*fd));
+  BOOST_CHECK_EQUAL(channel->getReadyQueueSize(), 2);
+  channel->stopDma();
+}
+
+} // Anonymous namespace
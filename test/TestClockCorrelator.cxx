@@ -0,0 +1,105 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestClockCorrelator.cxx
+/// \brief Test of the ClockCorrelator class
+
+#define BOOST_TEST_MODULE RORC_TestClockCorrelator
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+#include "ClockCorrelator.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+constexpr double ORBIT_NS = ClockCorrelator::BCS_PER_ORBIT * ClockCorrelator::BC_NS;
+
+/// Simulates a card whose clock runs at (1 + drift) of the host clock, with a host offset. Every sample is seen on the
+/// host 'latency' ns after it was generated.
+struct Card {
+  double drift;
+  double offsetNs;
+
+  /// Generates a sample at the given card time, returns the latency measured by the correlator
+  int64_t sample(ClockCorrelator& correlator, uint64_t bcs, double latencyNs, uint32_t orbitBase = 0)
+  {
+    double cardNs = bcs * ClockCorrelator::BC_NS;
+    double hostNs = offsetNs + cardNs * (1.0 + drift) + latencyNs;
+    uint32_t orbit = orbitBase + static_cast<uint32_t>(bcs / ClockCorrelator::BCS_PER_ORBIT);
+    uint32_t bc = bcs % ClockCorrelator::BCS_PER_ORBIT;
+    return correlator.addSample(orbit, bc, static_cast<int64_t>(hostNs)).count();
+  }
+};
+
+BOOST_AUTO_TEST_CASE(ConstantLatency)
+{
+  ClockCorrelator correlator(std::chrono::milliseconds(100));
+  Card card{ 0.0, 1e12 };
+  // One sample per orbit for 0.5 s, with a 20 µs latency and every 10th sample 500 µs late
+  int64_t lastLate = 0;
+  for (uint64_t i = 0; i < 5600; ++i) {
+    bool late = (i % 10) == 5;
+    auto latency = card.sample(correlator, i * ClockCorrelator::BCS_PER_ORBIT, late ? 520e3 : 20e3);
+    if (i > 2000) {
+      if (late) {
+        lastLate = latency;
+      } else {
+        BOOST_CHECK_LE(latency, 10);
+      }
+    }
+  }
+  BOOST_CHECK(correlator.isSynchronized());
+  BOOST_CHECK_CLOSE(double(lastLate), 500e3, 0.1);
+}
+
+BOOST_AUTO_TEST_CASE(Drift)
+{
+  // 50 ppm: the card clock loses 50 µs per second, which the correlator must not report as latency
+  ClockCorrelator correlator(std::chrono::milliseconds(200));
+  Card card{ 50e-6, 0 };
+  const uint64_t orbitsPerSecond = 1e9 / ORBIT_NS;
+  int64_t maxLatency = 0;
+  for (uint64_t i = 0; i < 5 * orbitsPerSecond; i += 5) {
+    auto latency = card.sample(correlator, i * ClockCorrelator::BCS_PER_ORBIT + (i % 3564), 10e3);
+    if (i > 2 * orbitsPerSecond) {
+      maxLatency = std::max(maxLatency, latency);
+    }
+  }
+  BOOST_CHECK_CLOSE(correlator.getDriftPpm(), 50.0, 5.0);
+  BOOST_CHECK_LE(maxLatency, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(OrbitWrapAndReset)
+{
+  ClockCorrelator correlator(std::chrono::milliseconds(10));
+  Card card{ 0.0, 0 };
+
+  // Wrap of the 32-bit orbit counter is not a jump
+  const uint32_t base = 0xffffff00;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    auto latency = card.sample(correlator, i * ClockCorrelator::BCS_PER_ORBIT, 5e3, base);
+    if (i > 200) {
+      BOOST_CHECK_LE(latency, 10);
+    }
+  }
+  BOOST_CHECK_EQUAL(correlator.getResyncCount(), 0);
+
+  // Orbit counter reset, e.g. a new run: the correlation restarts
+  Card restarted{ 0.0, 1000 * ORBIT_NS - 60e9 };
+  restarted.sample(correlator, 0, 5e3);
+  BOOST_CHECK_EQUAL(correlator.getResyncCount(), 1);
+  BOOST_CHECK(!correlator.isSynchronized());
+}
+
+} // Anonymous namespace
@@ -0,0 +1,97 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestConsumerLag.cxx
+/// \brief Test of the ConsumerLag class
+
+#define BOOST_TEST_MODULE RORC_TestConsumerLag
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/ConsumerLag.h"
+#include "ReadoutCard/TimeSource.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+BOOST_AUTO_TEST_CASE(ParseDelays)
+{
+  auto delays = ConsumerLag::parseDelays("0, 100,1000");
+  BOOST_REQUIRE_EQUAL(delays.size(), 3);
+  BOOST_CHECK(delays[0] == 0us);
+  BOOST_CHECK(delays[1] == 100us);
+  BOOST_CHECK(delays[2] == 1000us);
+
+  for (auto list : { "", "100,", ",100", "100;200", "1e3", "1.5", "-5", "100,x" }) {
+    BOOST_CHECK_THROW(ConsumerLag::parseDelays(list), ParameterException);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HoldAndRelease)
+{
+  VirtualTimeSource time;
+  std::vector<uint64_t> buffer(1024, 1);
+  const auto address = reinterpret_cast<uintptr_t>(buffer.data());
+  ConsumerLag lag({ 0us, 100us }, 2);
+  size_t offset = 0;
+  size_t size = 0;
+
+  // Nothing held
+  BOOST_CHECK(!lag.take(offset, size, time.now()));
+
+  // Without delay, a superpage is taken as soon as it arrives, oldest first
+  lag.hold(0, 1024, time.now());
+  lag.hold(1024, 2048, time.now());
+  BOOST_REQUIRE(lag.take(offset, size, time.now()));
+  BOOST_CHECK_EQUAL(offset, 0);
+  BOOST_CHECK_EQUAL(size, 1024);
+  lag.process(address, size);
+  BOOST_REQUIRE(lag.take(offset, size, time.now()));
+  BOOST_CHECK_EQUAL(offset, 1024);
+  lag.process(address, size);
+
+  // The second step holds superpages back until they are 100 us old
+  lag.hold(2048, 1024, time.now());
+  time.advance(60us);
+  lag.hold(3072, 1024, time.now());
+  BOOST_CHECK(!lag.take(offset, size, time.now()));
+  time.advance(50us);
+  BOOST_REQUIRE(lag.take(offset, size, time.now()));
+  BOOST_CHECK_EQUAL(offset, 2048);
+  lag.process(address, size);
+  BOOST_CHECK(!lag.take(offset, size, time.now()));
+  time.advance(60us);
+  BOOST_REQUIRE(lag.take(offset, size, time.now()));
+  BOOST_CHECK_EQUAL(offset, 3072);
+  lag.process(address, size);
+  BOOST_CHECK(lag.isDone());
+
+  // Done, so nothing more is taken
+  lag.hold(0, 1024, time.now());
+  time.advance(1s);
+  BOOST_CHECK(!lag.take(offset, size, time.now()));
+
+  const auto& steps = lag.getSteps();
+  BOOST_REQUIRE_EQUAL(steps.size(), 2);
+  BOOST_CHECK_EQUAL(steps[0].superpages, 2);
+  BOOST_CHECK_EQUAL(steps[0].bytes, 1024 + 2048);
+  BOOST_CHECK_EQUAL(steps[0].maxDepth, 2);
+  BOOST_CHECK_EQUAL(steps[0].depthSum, 2 + 1);
+  BOOST_CHECK_EQUAL(steps[1].superpages, 2);
+  BOOST_CHECK_EQUAL(steps[1].maxDepth, 2);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,93 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestCrorcFlash.cxx
+/// \brief Test of the C-RORC flash sequences against a simulated BAR, in virtual time
+
+#define BOOST_TEST_MODULE RORC_TestCrorcFlash
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "Crorc/Constants.h"
+#include "Crorc/Crorc.h"
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/TimeSource.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+/// Flash interface registers of a C-RORC, with a flash that is always ready, and whose status is settable
+class FlashBar : public RegisterReadWriteInterface
+{
+ public:
+  virtual uint32_t readRegister(int index) override
+  {
+    return (index == Rorc::Flash::IADR) ? status : (index == Rorc::Flash::LRD) ? 1 : 0;
+  }
+
+  virtual void writeRegister(int index, uint32_t) override
+  {
+    if (index == Rorc::Flash::IFDSR) {
+      writes++;
+    }
+  }
+
+  virtual void modifyRegister(int, int, int, uint32_t) override
+  {
+  }
+
+  uint32_t status = 0x80; ///< Ready
+  uint64_t writes = 0;
+};
+
+BOOST_AUTO_TEST_CASE(ReadRange)
+{
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  FlashBar bar;
+  std::ostringstream out;
+  auto start = std::chrono::steady_clock::now();
+
+  // Three writes of 50 us per word, 3 seconds in all
+  Crorc::readFlashRange(bar, 0, 20000, out);
+  BOOST_CHECK_EQUAL(bar.writes, 3 * 20000);
+  BOOST_CHECK(timeSource.getSlept() == 20000 * 150us);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < 1s);
+}
+
+BOOST_AUTO_TEST_CASE(ProgramTimeout)
+{
+  const std::string path = "/tmp/AliceO2_TestCrorcFlash_" + std::to_string(getpid()) + ".dat";
+  std::ofstream(path) << "0\n";
+
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  FlashBar bar;
+  bar.status = 0; // Never ready
+  std::ostringstream out;
+  auto start = std::chrono::steady_clock::now();
+
+  // Unlocking the first block waits 100 seconds for the status before giving up
+  BOOST_CHECK_THROW(Crorc::programFlash(bar, path, 0, out), TimeoutException);
+  BOOST_CHECK(timeSource.getSlept() >= 100s);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < 5s);
+  std::remove(path.c_str());
+}
+
+} // Anonymous namespace
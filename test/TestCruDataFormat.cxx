@@ -82,3 +82,12 @@ BOOST_AUTO_TEST_CASE(TestGetEventSize)
   BOOST_CHECK_EQUAL(getMemsize(reinterpret_cast<const char*>(link18Test2.data())), 256);
   BOOST_CHECK_EQUAL(getMemsize(reinterpret_cast<const char*>(link21Test1.data())), 256);
 }
+
+BOOST_AUTO_TEST_CASE(TestGetOrbit)
+{
+  std::vector<uint32_t> rdh(16, 0x0);
+  rdh[4] = 0x1234;
+  rdh[5] = 0xFfffFffe;
+  BOOST_CHECK_EQUAL(getTriggerOrbit(reinterpret_cast<const char*>(rdh.data())), 0x1234);
+  BOOST_CHECK_EQUAL(getHeartbeatOrbit(reinterpret_cast<const char*>(rdh.data())), 0xFfffFffe);
+}
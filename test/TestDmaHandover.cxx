@@ -0,0 +1,108 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestDmaHandover.cxx
+/// \brief Test of the DmaHandover struct
+
+#define BOOST_TEST_MODULE RORC_TestDmaHandover
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cstdio>
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+#include "DmaHandover.h"
+#include "FakeBufferProvider.h"
+#include "ReadoutCard/Exception.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+const std::string PATH = "/tmp/TestDmaHandover";
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  DmaHandover handover;
+  handover.cardType = 2;
+  handover.channel = 0;
+  handover.pciAddress = "3b:00.0";
+  handover.bufferSize = 8 * 1024 * 1024;
+  handover.busFingerprint = 0x1234;
+  handover.links = { { 0, 10 }, { 5, 12 } };
+  handover.superpages = { { 0, 1024, 0, 0, 0 }, { 1024, 1024, 512, 1, 0 }, { 2048, 1024, 1024, 0, 1 } };
+  handover.fifoFront = 3;
+  handover.fifoBack = 1;
+  handover.fifoSize = 2;
+  handover.pendingDmaStart = true;
+  handover.write(PATH);
+
+  auto read = DmaHandover::read(PATH);
+  std::remove(PATH.c_str());
+  BOOST_CHECK_EQUAL(read.cardType, 2);
+  BOOST_CHECK_EQUAL(read.pciAddress, "3b:00.0");
+  BOOST_CHECK_EQUAL(read.bufferSize, handover.bufferSize);
+  BOOST_CHECK_EQUAL(read.busFingerprint, 0x1234);
+  BOOST_REQUIRE_EQUAL(read.links.size(), 2);
+  BOOST_CHECK_EQUAL(read.links[1].id, 5);
+  BOOST_CHECK_EQUAL(read.links[1].superpageCounter, 12);
+  BOOST_REQUIRE_EQUAL(read.superpages.size(), 3);
+  BOOST_CHECK_EQUAL(read.superpages[1].received, 512);
+  BOOST_CHECK_EQUAL(read.superpages[1].link, 1);
+  BOOST_CHECK_EQUAL(read.superpages[2].ready, 1);
+  BOOST_CHECK_EQUAL(read.fifoFront, 3);
+  BOOST_CHECK(read.pendingDmaStart);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidState)
+{
+  BOOST_CHECK_THROW(DmaHandover::read(PATH), Exception);
+
+  {
+    std::ofstream stream(PATH);
+    stream << "not a handover state, but long enough to fill the header of one";
+  }
+  BOOST_CHECK_THROW(DmaHandover::read(PATH), Exception);
+  std::remove(PATH.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(Fingerprint)
+{
+  FakeBufferProvider provider(0x100000000, 4);
+  BOOST_CHECK_EQUAL(DmaHandover::fingerprint(provider), DmaHandover::fingerprint(FakeBufferProvider(0x100000000, 4)));
+  BOOST_CHECK_NE(DmaHandover::fingerprint(provider), DmaHandover::fingerprint(FakeBufferProvider(0x200000000, 4)));
+}
+
+BOOST_AUTO_TEST_CASE(PersistentBuffer)
+{
+  // Process memory is freed with the old process, while the card is still writing to it
+  char memory[1024];
+  BOOST_CHECK_THROW(DmaHandover::checkBuffer(buffer_parameters::Memory{ memory, sizeof(memory) }, false), Exception);
+  BOOST_CHECK_THROW(DmaHandover::checkBuffer(buffer_parameters::Null{}, false), Exception);
+
+  {
+    std::ofstream stream(PATH);
+  }
+  BOOST_CHECK_NO_THROW(DmaHandover::checkBuffer(buffer_parameters::File{ PATH, 0 }, false));
+  BOOST_CHECK_THROW(DmaHandover::checkBuffer(buffer_parameters::File{ PATH, 0 }, true), Exception);
+  std::remove(PATH.c_str());
+  BOOST_CHECK_THROW(DmaHandover::checkBuffer(buffer_parameters::File{ PATH, 0 }, false), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelBuffers)
+{
+  // A channel cleans up the buffers of crashed processes when it is opened and closed
+  BOOST_CHECK(DmaHandover::mayFreeChannelBuffers(false, false));
+  // but not the ones the card keeps writing into after a handover
+  BOOST_CHECK(!DmaHandover::mayFreeChannelBuffers(true, false));
+  BOOST_CHECK(!DmaHandover::mayFreeChannelBuffers(false, true));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,114 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestErrorRecorder.cxx
+/// \brief Test of the ErrorRecorder class
+
+#define BOOST_TEST_MODULE RORC_TestErrorRecorder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/ErrorRecorder.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+
+namespace
+{
+
+ErrorRecord makeRecord(ErrorType::type type, int64_t event, uint16_t link)
+{
+  ErrorRecord record;
+  record.type = type;
+  record.event = event;
+  record.link = link;
+  record.expected = 0x10;
+  record.actual = 0x20;
+  return record;
+}
+
+BOOST_AUTO_TEST_CASE(FoldRepeatsInPage)
+{
+  ErrorRecorder recorder(100);
+  auto now = ErrorRecorder::Clock::now();
+  for (int i = 0; i < 50; ++i) {
+    recorder.record(makeRecord(ErrorType::DataMismatch, 1, 3), now);
+  }
+  recorder.record(makeRecord(ErrorType::ResyncData, 1, 3), now);
+  recorder.record(makeRecord(ErrorType::DataMismatch, 2, 3), now);
+
+  BOOST_REQUIRE_EQUAL(recorder.getRecords().size(), 3);
+  BOOST_CHECK_EQUAL(recorder.getRecords()[0].repeats, 49);
+  BOOST_CHECK_EQUAL(recorder.getRecords()[2].repeats, 0);
+  BOOST_CHECK_EQUAL(recorder.getCount(ErrorType::DataMismatch, 3), 51);
+  BOOST_CHECK_EQUAL(recorder.getCount(ErrorType::ResyncData, 3), 1);
+  BOOST_CHECK_EQUAL(recorder.getCount(ErrorType::DataMismatch, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Capacity)
+{
+  ErrorRecorder recorder(10);
+  auto now = ErrorRecorder::Clock::now();
+  for (int i = 0; i < 25; ++i) {
+    recorder.record(makeRecord(ErrorType::PacketCounter, i, 0), now);
+  }
+  BOOST_CHECK_EQUAL(recorder.getRecords().size(), 10);
+  BOOST_CHECK_EQUAL(recorder.getDroppedCount(), 15);
+  BOOST_CHECK_EQUAL(recorder.getCount(ErrorType::PacketCounter, 0), 25);
+}
+
+BOOST_AUTO_TEST_CASE(RateLimit)
+{
+  ErrorRecorder recorder(100, 5);
+  auto now = ErrorRecorder::Clock::now();
+  for (int i = 0; i < 8; ++i) {
+    recorder.record(makeRecord(ErrorType::RdhSizeRange, i, 1), now);
+  }
+  BOOST_CHECK_EQUAL(recorder.getRecords().size(), 5);
+  BOOST_CHECK_EQUAL(recorder.getRateLimitedCount(), 3);
+
+  // A new second allows new records
+  now += std::chrono::seconds(1);
+  for (int i = 8; i < 10; ++i) {
+    recorder.record(makeRecord(ErrorType::RdhSizeRange, i, 1), now);
+  }
+  BOOST_CHECK_EQUAL(recorder.getRecords().size(), 7);
+  BOOST_CHECK_EQUAL(recorder.getCount(ErrorType::RdhSizeRange, 1), 10);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip)
+{
+  ErrorRecorder recorder(2);
+  auto now = ErrorRecorder::Clock::now();
+  recorder.record(makeRecord(ErrorType::DataMismatch, 7, 2), now);
+  recorder.record(makeRecord(ErrorType::DataMismatch, 7, 2), now);
+  recorder.record(makeRecord(ErrorType::TfUnaligned, 8, 5), now);
+  recorder.record(makeRecord(ErrorType::TfUnaligned, 9, 5), now);
+
+  std::ostringstream text;
+  recorder.decode(text);
+  BOOST_CHECK(text.str().find("event:7 link:2") != std::string::npos);
+  BOOST_CHECK(text.str().find("(+1 more in this page)") != std::string::npos);
+  BOOST_CHECK(text.str().find("1 not recorded because the buffer was full") != std::string::npos);
+
+  std::stringstream binary;
+  recorder.writeBinary(binary);
+  std::ostringstream decoded;
+  ErrorRecorder::decodeBinary(binary, decoded);
+  BOOST_CHECK_EQUAL(decoded.str(), text.str());
+
+  std::istringstream garbage("not an error file at all, just some text to fill the header");
+  std::ostringstream ignored;
+  BOOST_CHECK_THROW(ErrorRecorder::decodeBinary(garbage, ignored), Exception);
+}
+
+} // Anonymous namespace
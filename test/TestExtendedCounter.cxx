@@ -0,0 +1,79 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestExtendedCounter.cxx
+/// \brief Test of the ExtendedCounter class
+
+#define BOOST_TEST_MODULE RORC_TestExtendedCounter
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/ExtendedCounter.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+BOOST_AUTO_TEST_CASE(Baseline)
+{
+  ExtendedCounter counter;
+  BOOST_CHECK(!counter.isValid());
+
+  counter.update(1234, 0.0);
+  BOOST_CHECK(counter.isValid());
+  BOOST_CHECK_EQUAL(counter.getValue(), 1234);
+  BOOST_CHECK_EQUAL(counter.getDelta(), 0);
+  BOOST_CHECK_EQUAL(counter.getWraps(), 0);
+  BOOST_CHECK_EQUAL(counter.getRate(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(Increment)
+{
+  ExtendedCounter counter;
+  counter.update(100, 0.0);
+  counter.update(300, 2.0);
+  BOOST_CHECK_EQUAL(counter.getValue(), 300);
+  BOOST_CHECK_EQUAL(counter.getDelta(), 200);
+  BOOST_CHECK_EQUAL(counter.getRate(), 100.0);
+}
+
+BOOST_AUTO_TEST_CASE(Wrap)
+{
+  ExtendedCounter counter;
+  counter.update(0xFfffFff0, 0.0);
+  counter.update(0x10, 1.0);
+  BOOST_CHECK_EQUAL(counter.getWraps(), 1);
+  BOOST_CHECK_EQUAL(counter.getValue(), 0x100000010ull);
+  BOOST_CHECK_EQUAL(counter.getDelta(), 0x20);
+  BOOST_CHECK_EQUAL(counter.getRate(), 32.0);
+
+  // Several wraps, each sampled within the wrap period
+  for (int i = 0; i < 4; ++i) {
+    counter.update(0x80000010, 1.0);
+    counter.update(0x10, 1.0);
+  }
+  BOOST_CHECK_EQUAL(counter.getWraps(), 5);
+  BOOST_CHECK_EQUAL(counter.getValue(), 0x500000010ull);
+}
+
+BOOST_AUTO_TEST_CASE(Reset)
+{
+  ExtendedCounter counter;
+  counter.update(0xFfffFfff, 0.0);
+  counter.update(0x1, 1.0);
+  counter.reset();
+  BOOST_CHECK(!counter.isValid());
+  counter.update(5, 0.0);
+  BOOST_CHECK_EQUAL(counter.getValue(), 5);
+  BOOST_CHECK_EQUAL(counter.getWraps(), 0);
+}
+
+} // Anonymous namespace
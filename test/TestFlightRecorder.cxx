@@ -0,0 +1,128 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestFlightRecorder.cxx
+/// \brief Test of the FlightRecorder class
+
+#define BOOST_TEST_MODULE RORC_TestFlightRecorder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "FlightRecorder.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+using Recorder = FlightRecorder<4>;
+
+/// Runs one poll of a fake channel, committing a sample when due
+void poll(Recorder& recorder, Recorder::Clock::time_point now, uint32_t dropped)
+{
+  if (recorder.poll(now)) {
+    recorder.setReadyQueueSize(1);
+    recorder.setLinkQueueSize(0, 2);
+    if (recorder.isDropCheckDue(now)) {
+      recorder.setDroppedPackets(dropped);
+    }
+    recorder.commit();
+  }
+}
+
+int countLines(const std::string& string)
+{
+  return std::count(string.begin(), string.end(), '\n');
+}
+
+BOOST_AUTO_TEST_CASE(Aggregation)
+{
+  Recorder recorder(2);
+  auto time = Recorder::Clock::now();
+
+  // Polls closer than the sample interval are aggregated: 20 polls over two intervals give two samples
+  for (int i = 0; i < 20; ++i) {
+    recorder.countPush();
+    poll(recorder, time, 0);
+    time += Recorder::SAMPLE_INTERVAL / 10;
+  }
+
+  std::ostringstream stream;
+  recorder.dump(stream, "test");
+  auto dump = stream.str();
+  BOOST_CHECK_NE(dump.find("link_queue_1"), std::string::npos);
+  BOOST_CHECK_EQUAL(countLines(dump), 2 + 2);
+}
+
+BOOST_AUTO_TEST_CASE(FreezeOnDrop)
+{
+  Recorder recorder(1);
+  auto time = Recorder::Clock::now();
+
+  for (int i = 0; i < 100; ++i) {
+    poll(recorder, time, 0);
+    time += Recorder::DROP_CHECK_INTERVAL;
+  }
+  BOOST_CHECK(!recorder.isFrozen());
+
+  // The drop counter increases: the recorder keeps the post-trigger window, then freezes
+  size_t samples = 0;
+  while (!recorder.isFrozen()) {
+    poll(recorder, time, 5);
+    time += Recorder::DROP_CHECK_INTERVAL;
+    samples++;
+    BOOST_REQUIRE(samples <= Recorder::POST_TRIGGER_SAMPLES + 1);
+  }
+  BOOST_CHECK_EQUAL(samples, Recorder::POST_TRIGGER_SAMPLES);
+
+  // Frozen recorders don't take new samples
+  std::ostringstream before;
+  recorder.dump(before, "test");
+  poll(recorder, time, 10);
+  std::ostringstream after;
+  recorder.dump(after, "test");
+  BOOST_CHECK_EQUAL(before.str(), after.str());
+
+  recorder.rearm();
+  BOOST_CHECK(!recorder.isFrozen());
+}
+
+BOOST_AUTO_TEST_CASE(TakeAndWrite)
+{
+  Recorder recorder(1);
+  auto time = Recorder::Clock::now();
+  for (int i = 0; i < 10; ++i) {
+    poll(recorder, time, 0);
+    time += Recorder::SAMPLE_INTERVAL;
+  }
+  std::ostringstream expected;
+  recorder.dump(expected, "test");
+
+  // The samples are moved out, and the recorder starts over
+  auto snapshot = std::make_shared<Recorder::Snapshot>(recorder.take("test"));
+  BOOST_CHECK(!recorder.isFrozen());
+  std::ostringstream empty;
+  recorder.dump(empty, "test");
+  BOOST_CHECK_EQUAL(countLines(empty.str()), 1);
+
+  // The writer finishes the pending writes before it is destroyed
+  std::ostringstream written;
+  {
+    FlightRecorderWriter writer;
+    writer.post([&] { snapshot->dump(written); });
+  }
+  BOOST_CHECK_EQUAL(written.str(), expected.str());
+}
+
+} // Anonymous namespace
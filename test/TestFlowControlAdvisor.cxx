@@ -0,0 +1,122 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestFlowControlAdvisor.cxx
+/// \brief Test of the FlowControlModel and FlowControlAdvisor classes
+
+#define BOOST_TEST_MODULE RORC_TestFlowControlAdvisor
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "FlowControlAdvisor.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+FlowControlModel::Configuration getConfiguration()
+{
+  FlowControlModel::Configuration configuration;
+  configuration.links = 4;
+  configuration.seconds = 0.2;
+  return configuration;
+}
+
+uint64_t getTotal(const FlowControlCounts& counts)
+{
+  return counts.accepted + counts.rejected + counts.forced + counts.dropped;
+}
+
+BOOST_AUTO_TEST_CASE(ModelAmpleSupply)
+{
+  FlowControlModel model(getConfiguration());
+  auto without = model.run({ false, 1000 }, 10000);
+  auto with = model.run({ true, 1200 }, 10000);
+
+  // Every packet makes it, and the runs see the same triggers
+  BOOST_CHECK_GT(without.accepted, 0);
+  BOOST_CHECK_EQUAL(without.accepted, getTotal(without));
+  BOOST_CHECK_EQUAL(with.accepted, getTotal(with));
+  BOOST_CHECK_EQUAL(with.accepted, without.accepted);
+
+  // A window smaller than the triggers forces the packets beyond it
+  auto small = model.run({ true, 600 }, 10000);
+  BOOST_CHECK_GT(small.forced, 0);
+  BOOST_CHECK_EQUAL(small.dropped, 0);
+  BOOST_CHECK_EQUAL(getTotal(small), getTotal(without));
+}
+
+BOOST_AUTO_TEST_CASE(ModelStarved)
+{
+  FlowControlModel model(getConfiguration());
+  // About half of the data rate
+  auto without = model.run({ false, 1200 }, 300);
+  auto with = model.run({ true, 1200 }, 300);
+
+  BOOST_CHECK_GT(without.dropped, 0);
+  BOOST_CHECK_EQUAL(without.rejected, 0);
+  BOOST_CHECK_GT(with.rejected, 0);
+  // Only the forced first packets of rejected triggers can be dropped
+  BOOST_CHECK_LT(with.dropped, without.dropped / 2);
+  BOOST_CHECK_EQUAL(getTotal(with), getTotal(without));
+}
+
+FlowControlAdvisor::Measurement makeMeasurement(bool allowRejection, uint32_t window, double supplyRate,
+                                                uint64_t accepted, uint64_t dropped)
+{
+  FlowControlAdvisor::Measurement measurement;
+  measurement.setting = { allowRejection, window };
+  measurement.supplyRate = supplyRate;
+  measurement.seconds = 1;
+  measurement.counts.accepted = accepted;
+  measurement.counts.dropped = dropped;
+  return measurement;
+}
+
+BOOST_AUTO_TEST_CASE(Recommend)
+{
+  FlowControlAdvisor advisor;
+  BOOST_CHECK(!advisor.recommend());
+
+  advisor.add(makeMeasurement(false, 1000, 1000, 900, 100));
+  advisor.add(makeMeasurement(true, 500, 1000, 700, 0));
+  advisor.add(makeMeasurement(true, 1000, 1000, 800, 0));
+  advisor.add(makeMeasurement(false, 1000, 2000, 1000, 0));
+  advisor.add(makeMeasurement(true, 1000, 2000, 990, 0));
+
+  // The highest rate, where nothing drops
+  auto best = advisor.recommend();
+  BOOST_REQUIRE(best);
+  BOOST_CHECK_EQUAL(best->supplyRate, 2000);
+  BOOST_CHECK_EQUAL(best->setting.allowRejection, false);
+
+  // Within the budget, the setting that drops is passed over, unless its drops are acceptable
+  best = advisor.recommend(1500);
+  BOOST_REQUIRE(best);
+  BOOST_CHECK_EQUAL(best->supplyRate, 1000);
+  BOOST_CHECK_EQUAL(best->setting.allowRejection, true);
+  BOOST_CHECK_EQUAL(best->setting.triggerWindowSize, 1000);
+  best = advisor.recommend(1500, 100);
+  BOOST_REQUIRE(best);
+  BOOST_CHECK_EQUAL(best->setting.allowRejection, false);
+
+  BOOST_CHECK(!advisor.recommend(500));
+
+  // If all drop, the one dropping the least
+  FlowControlAdvisor dropping;
+  dropping.add(makeMeasurement(false, 1000, 1000, 900, 100));
+  dropping.add(makeMeasurement(true, 1000, 1000, 800, 10));
+  best = dropping.recommend();
+  BOOST_REQUIRE(best);
+  BOOST_CHECK_EQUAL(best->setting.allowRejection, true);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,167 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestHugepageRegistry.cxx
+/// \brief Test of the HugepageRegistry class
+
+#define BOOST_TEST_MODULE RORC_TestHugepageRegistry
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <fstream>
+#include <vector>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "Utilities/HugepageRegistry.h"
+
+using namespace ::AliceO2::roc;
+using Utilities::HugepageRegistry;
+namespace bfs = boost::filesystem;
+
+namespace
+{
+
+constexpr size_t PAGE_SIZE_2MIB = 2 * 1024 * 1024;
+
+/// A registry file and a sysfs tree with a 2 MiB hugepage pool of 10 pages, split over two NUMA nodes
+struct Fixture {
+  Fixture() : directory(bfs::temp_directory_path() / bfs::unique_path("AliceO2_HugepageRegistry_Test_%%%%%%%%"))
+  {
+    setPool("kernel/mm/hugepages/hugepages-2048kB", 10, 8, 1);
+    setPool("devices/system/node/node0/hugepages/hugepages-2048kB", 5, 3, 0);
+    setPool("devices/system/node/node1/hugepages/hugepages-2048kB", 5, 5, 0);
+  }
+
+  ~Fixture()
+  {
+    bfs::remove_all(directory);
+  }
+
+  void setPool(const std::string& pool, size_t total, size_t free, size_t reserved)
+  {
+    auto path = directory / "sys" / pool;
+    bfs::create_directories(path);
+    std::ofstream((path / "nr_hugepages").string()) << total << '\n';
+    std::ofstream((path / "free_hugepages").string()) << free << '\n';
+    std::ofstream((path / "resv_hugepages").string()) << reserved << '\n';
+  }
+
+  HugepageRegistry getRegistry()
+  {
+    return HugepageRegistry((directory / "registry").string(), (directory / "sys").string());
+  }
+
+  bfs::path directory;
+};
+
+BOOST_FIXTURE_TEST_CASE(Availability, Fixture)
+{
+  auto registry = getRegistry();
+  auto system = registry.getAvailability(PAGE_SIZE_2MIB);
+  BOOST_CHECK_EQUAL(system.total, 10);
+  BOOST_CHECK_EQUAL(system.free, 7); // The kernel reserved one of the free pages
+  BOOST_CHECK_EQUAL(system.available, 7);
+
+  auto node = registry.getAvailability(PAGE_SIZE_2MIB, 0);
+  BOOST_CHECK_EQUAL(node.total, 5);
+  BOOST_CHECK_EQUAL(node.available, 3);
+
+  // A page size without a pool
+  BOOST_CHECK_EQUAL(registry.getAvailability(1024 * 1024 * 1024).available, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(Admission, Fixture)
+{
+  auto registry = getRegistry();
+  {
+    auto reservation = registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "first");
+    BOOST_CHECK_EQUAL(reservation->getPages(), 4);
+    BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).pending, 4);
+    BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).available, 3);
+    BOOST_CHECK_EQUAL(registry.getEntries().size(), 1);
+
+    BOOST_CHECK_THROW(registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "second"), HugepageCapacityException);
+    // The capacity error is a mapping error, so the 1 GiB to 2 MiB fallback of tryMapFile() catches it
+    BOOST_CHECK_THROW(registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "second"), MemoryMapException);
+    auto second = registry.reserve(3 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "second");
+    BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).available, 0);
+  }
+  // Released on destruction
+  BOOST_CHECK(registry.getEntries().empty());
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).available, 7);
+}
+
+BOOST_FIXTURE_TEST_CASE(Mapped, Fixture)
+{
+  auto registry = getRegistry();
+  auto reservation = registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "buffer");
+  reservation->setMapped();
+  // The kernel accounts for the pages of a mapped buffer, so the registry does not count them again
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).pending, 0);
+  BOOST_CHECK_EQUAL(registry.getEntries().size(), 1);
+  BOOST_CHECK(registry.getEntries().at(0).mapped);
+}
+
+BOOST_FIXTURE_TEST_CASE(NumaNode, Fixture)
+{
+  auto registry = getRegistry();
+  BOOST_CHECK_THROW(registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, 0, "node0"), HugepageCapacityException);
+  auto node1 = registry.reserve(4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, 1, "node1");
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB, 0).available, 3);
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB, 1).available, 1);
+  // A reservation without a node counts against every node
+  auto any = registry.reserve(1 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "any");
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB, 0).available, 2);
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB, 1).available, 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(DeadProcess, Fixture)
+{
+  // An entry of this PID with another start time is from a dead process whose PID was recycled
+  std::ofstream((directory / "registry").string()) << "1 " << getpid() << " 1 " << PAGE_SIZE_2MIB << " -1 7 0 dead\n";
+  auto registry = getRegistry();
+  BOOST_CHECK(registry.getEntries().empty());
+  BOOST_CHECK_EQUAL(registry.getAvailability(PAGE_SIZE_2MIB).available, 7);
+}
+
+BOOST_FIXTURE_TEST_CASE(AllocatedPages, Fixture)
+{
+  // A buffer file left behind with one of its four pages touched
+  auto path = (directory / "buffer").string();
+  {
+    std::ofstream file(path, std::ios::binary);
+    std::vector<char> page(PAGE_SIZE_2MIB, 1);
+    file.write(page.data(), page.size());
+  }
+  bfs::resize_file(path, 4 * PAGE_SIZE_2MIB);
+
+  // Reused for a buffer of the same size, so only its three missing pages still have to be reserved
+  BOOST_CHECK_EQUAL(HugepageRegistry::getAllocatedPages(path, 4 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB), 1);
+  // Not reused for a buffer of another size
+  BOOST_CHECK_EQUAL(HugepageRegistry::getAllocatedPages(path, 8 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB), 0);
+  BOOST_CHECK_EQUAL(HugepageRegistry::getAllocatedPages((directory / "missing").string(), 4 * PAGE_SIZE_2MIB,
+                                                        PAGE_SIZE_2MIB),
+                    0);
+}
+
+BOOST_FIXTURE_TEST_CASE(RegistryError, Fixture)
+{
+  // A registry that can not be opened fails like a buffer that can not be mapped, so the caller can fall back
+  HugepageRegistry registry((directory / "missing" / "registry").string(), (directory / "sys").string());
+  BOOST_CHECK_THROW(registry.reserve(1 * PAGE_SIZE_2MIB, PAGE_SIZE_2MIB, -1, "first"), MemoryMapException);
+
+  // Group-writable only, whatever the umask
+  getRegistry().getEntries();
+  auto permissions = bfs::status(directory / "registry").permissions();
+  BOOST_CHECK_EQUAL(permissions & bfs::all_all, bfs::owner_read | bfs::owner_write | bfs::group_read | bfs::group_write);
+}
+
+} // Anonymous namespace
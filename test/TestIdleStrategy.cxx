@@ -0,0 +1,76 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestIdleStrategy.cxx
+/// \brief Test of the IdleStrategy class
+
+#define BOOST_TEST_MODULE RORC_TestIdleStrategy
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <boost/test/unit_test.hpp>
+#include "Utilities/IdleStrategy.h"
+
+using namespace ::AliceO2::roc;
+using Utilities::IdleStrategy;
+
+namespace
+{
+
+BOOST_AUTO_TEST_CASE(Strings)
+{
+  for (auto policy : { IdleStrategy::Policy::BusySpin, IdleStrategy::Policy::Pause, IdleStrategy::Policy::Yield,
+                       IdleStrategy::Policy::Backoff, IdleStrategy::Policy::Sleep }) {
+    BOOST_CHECK_EQUAL(IdleStrategy::fromString(IdleStrategy::toString(policy)), policy);
+  }
+  BOOST_CHECK_THROW(IdleStrategy::fromString("nap"), ParameterException);
+}
+
+/// Time taken by the given amount of empty polls
+std::chrono::microseconds timeEmptyPolls(IdleStrategy& idle, int polls)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < polls; ++i) {
+    idle.idle(false);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+BOOST_AUTO_TEST_CASE(Backoff)
+{
+  IdleStrategy idle(IdleStrategy::Policy::Backoff, std::chrono::milliseconds(1));
+
+  // The first empty polls only spin, pause and yield
+  auto spinPolls = IdleStrategy::BACKOFF_SPINS + IdleStrategy::BACKOFF_PAUSES;
+  BOOST_CHECK(timeEmptyPolls(idle, spinPolls) < std::chrono::milliseconds(1));
+
+  // Then it sleeps, doubling up to the maximum
+  idle.idle(false);
+  BOOST_CHECK(timeEmptyPolls(idle, IdleStrategy::BACKOFF_YIELDS + 20) >= std::chrono::milliseconds(10));
+
+  // Progress restarts from spinning
+  idle.idle(true);
+  BOOST_CHECK(timeEmptyPolls(idle, spinPolls) < std::chrono::milliseconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(Sleep)
+{
+  IdleStrategy idle(IdleStrategy::Policy::Sleep, std::chrono::microseconds(500));
+  BOOST_CHECK(timeEmptyPolls(idle, 4) >= std::chrono::milliseconds(2));
+
+  // Polls that found work never sleep
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; ++i) {
+    idle.idle(true);
+  }
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(2));
+}
+
+} // Anonymous namespace
@@ -0,0 +1,91 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestLinkLiveness.cxx
+/// \brief Test of the LinkLiveness class
+
+#define BOOST_TEST_MODULE RORC_TestLinkLiveness
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "LinkLiveness.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr size_t CAPACITY = 128;
+
+BOOST_AUTO_TEST_CASE(IdleLink)
+{
+  LinkLiveness liveness(2, 1s);
+  auto now = LinkLiveness::Clock::now();
+  liveness.reset(now);
+
+  // Link 0 completes superpages, link 1 holds some but never completes them
+  for (int i = 0; i < 15; ++i) {
+    now += 100ms;
+    liveness.complete(0, now);
+    liveness.update(0, true, false, 10, now);
+    liveness.update(1, true, false, 10, now);
+  }
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Alive);
+  BOOST_CHECK_EQUAL(liveness.getState(1), LinkState::Idle);
+  BOOST_CHECK_EQUAL(liveness.getAllowedDepth(0, CAPACITY), CAPACITY);
+  BOOST_CHECK_EQUAL(liveness.getAllowedDepth(1, CAPACITY), LinkLiveness::IDLE_QUEUE_DEPTH);
+
+  // The front-end resumes
+  BOOST_CHECK_EQUAL(liveness.complete(1, now), LinkState::Idle);
+  BOOST_CHECK_EQUAL(liveness.getState(1), LinkState::Alive);
+  BOOST_CHECK_EQUAL(liveness.getStatistics(1).idleTransitions, 1);
+  BOOST_CHECK_EQUAL(liveness.getStatistics(1).recoveries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyLinkStaysAlive)
+{
+  LinkLiveness liveness(1, 1s);
+  auto now = LinkLiveness::Clock::now();
+  liveness.reset(now);
+
+  // Without superpages, a link can not be late
+  now += 10s;
+  liveness.update(0, true, false, 0, now);
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Alive);
+
+  // It has a full timeout for the first superpage it gets
+  now += 500ms;
+  liveness.update(0, true, false, 1, now);
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Alive);
+}
+
+BOOST_AUTO_TEST_CASE(DeadLink)
+{
+  LinkLiveness liveness(1, 1s);
+  auto now = LinkLiveness::Clock::now();
+  liveness.reset(now);
+
+  BOOST_CHECK_EQUAL(liveness.update(0, false, false, 5, now), LinkState::Alive);
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Dead);
+  BOOST_CHECK_EQUAL(liveness.getAllowedDepth(0, CAPACITY), 0);
+
+  // Back up: probed with a single superpage until it completes one
+  now += 100ms;
+  liveness.update(0, true, true, 5, now);
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Idle);
+  BOOST_CHECK_EQUAL(liveness.getStatistics(0).flaps, 1);
+  liveness.complete(0, now);
+  BOOST_CHECK_EQUAL(liveness.getState(0), LinkState::Alive);
+  BOOST_CHECK_EQUAL(liveness.getStatistics(0).deadTransitions, 1);
+  BOOST_CHECK_EQUAL(liveness.getStatistics(0).recoveries, 1);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,103 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestOrbitOrderedQueue.cxx
+/// \brief Test of the OrbitOrderedQueue class
+
+#define BOOST_TEST_MODULE RORC_TestOrbitOrderedQueue
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "OrbitOrderedQueue.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+using Queue = OrbitOrderedQueue<int>;
+constexpr auto TIMEOUT = std::chrono::milliseconds(100);
+
+BOOST_AUTO_TEST_CASE(MergeInOrder)
+{
+  Queue queue(2, 10, TIMEOUT);
+  auto now = Queue::Clock::now();
+  queue.reset(now);
+
+  queue.push(0, 20, 20, now);
+  queue.push(0, 30, 30, now);
+  int item = 0;
+  BOOST_CHECK(!queue.pop(item, now)); // Link 1 may still deliver an older orbit
+
+  queue.push(1, 10, 10, now);
+  queue.push(1, 25, 25, now);
+  for (int expected : { 10, 20, 25 }) {
+    BOOST_REQUIRE(queue.pop(item, now));
+    BOOST_CHECK_EQUAL(item, expected);
+  }
+  BOOST_CHECK(!queue.pop(item, now)); // Link 1 is empty again
+  BOOST_CHECK(queue.pop(item, now, true));
+  BOOST_CHECK_EQUAL(item, 30);
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK_EQUAL(queue.getOutOfOrderCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SilentLink)
+{
+  Queue queue(2, 10, TIMEOUT);
+  auto now = Queue::Clock::now();
+  queue.reset(now);
+
+  queue.push(0, 1, 1, now);
+  int item = 0;
+  BOOST_CHECK(!queue.pop(item, now + TIMEOUT / 2));
+  BOOST_CHECK(queue.pop(item, now + TIMEOUT));
+  BOOST_CHECK_EQUAL(item, 1);
+
+  // The silent link delivers late: it is released, but counted as out of order
+  queue.push(0, 3, 3, now + TIMEOUT);
+  queue.push(1, 0, 0, now + TIMEOUT);
+  BOOST_REQUIRE(queue.pop(item, now + TIMEOUT));
+  BOOST_CHECK_EQUAL(item, 0);
+  BOOST_CHECK_EQUAL(queue.getOutOfOrderCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Window)
+{
+  Queue queue(2, 3, TIMEOUT);
+  auto now = Queue::Clock::now();
+  queue.reset(now);
+
+  queue.push(0, 5, 5, now);
+  queue.push(0, 6, 6, now);
+  int item = 0;
+  BOOST_CHECK(!queue.pop(item, now));
+  queue.push(0, 7, 7, now);
+  BOOST_REQUIRE(queue.pop(item, now)); // The window is full, so the oldest is released
+  BOOST_CHECK_EQUAL(item, 5);
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(OrbitWrap)
+{
+  BOOST_CHECK(Queue::isBefore(0xFfffFffe, 0x1));
+  BOOST_CHECK(!Queue::isBefore(0x1, 0xFfffFffe));
+
+  Queue queue(2, 10, TIMEOUT);
+  auto now = Queue::Clock::now();
+  queue.reset(now);
+  queue.push(0, 0x2, 1, now);
+  queue.push(1, 0xFfffFfff, 2, now);
+  int item = 0;
+  BOOST_REQUIRE(queue.pop(item, now));
+  BOOST_CHECK_EQUAL(item, 2);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,102 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPartitionDmaBufferProvider.cxx
+/// \brief Test of the PartitionDmaBufferProvider class
+
+#define BOOST_TEST_MODULE RORC_TestPartitionDmaBufferProvider
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "DmaBufferProvider/PartitionDmaBufferProvider.h"
+#include "FakeBufferProvider.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+constexpr size_t MiB = 1024 * 1024;
+constexpr uintptr_t USER_BASE = FakeBufferProvider::USER_BASE;
+
+BOOST_AUTO_TEST_CASE(Partition)
+{
+  auto shared = std::make_shared<FakeBufferProvider>(std::vector<uintptr_t>{ 0x10000000, 0x40000000, 0x20000000, 0x30000000 });
+  PartitionDmaBufferProvider first(shared, 0, 4 * MiB);
+  PartitionDmaBufferProvider second(shared, 4 * MiB, 4 * MiB);
+
+  BOOST_CHECK_EQUAL(first.getAddress(), USER_BASE);
+  BOOST_CHECK_EQUAL(second.getAddress(), USER_BASE + 4 * MiB);
+  BOOST_CHECK_EQUAL(second.getSize(), 4 * MiB);
+
+  // Each partition has the entries of its own part of the buffer
+  BOOST_REQUIRE_EQUAL(second.getScatterGatherListSize(), 2);
+  BOOST_CHECK_EQUAL(second.getScatterGatherEntryAddress(0), USER_BASE + 4 * MiB);
+  BOOST_CHECK_EQUAL(second.getScatterGatherEntryBusAddress(0), 0x20000000);
+  BOOST_CHECK_EQUAL(second.getScatterGatherEntryBusAddress(1), 0x30000000);
+
+  // Offsets are relative to the partition
+  BOOST_CHECK_EQUAL(first.getBusOffsetAddress(2 * MiB + 0x100), 0x40000100);
+  BOOST_CHECK_EQUAL(second.getBusOffsetAddress(0x100), 0x20000100);
+  BOOST_CHECK_THROW(second.getBusOffsetAddress(4 * MiB), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(PartitionOutOfRange)
+{
+  auto shared = std::make_shared<FakeBufferProvider>(std::vector<uintptr_t>{ 0x10000000, 0x20000000 });
+  BOOST_CHECK_THROW(PartitionDmaBufferProvider(shared, 2 * MiB, 4 * MiB), ParameterException);
+  BOOST_CHECK_THROW(PartitionDmaBufferProvider(shared, 0, 0), ParameterException);
+}
+
+BOOST_AUTO_TEST_CASE(MakeShared)
+{
+  int created = 0;
+  auto create = [&] {
+    created++;
+    return std::make_unique<FakeBufferProvider>(std::vector<uintptr_t>{ 0x10000000, 0x20000000 });
+  };
+
+  {
+    auto first = PartitionDmaBufferProvider::makeShared("card_buffer", create, 0, 2 * MiB);
+    auto second = PartitionDmaBufferProvider::makeShared("card_buffer", create, 2 * MiB, 2 * MiB);
+    BOOST_CHECK_EQUAL(&first->getSharedBuffer(), &second->getSharedBuffer());
+    BOOST_CHECK_EQUAL(created, 1);
+    auto other = PartitionDmaBufferProvider::makeShared("other_buffer", create, 0, 2 * MiB);
+    BOOST_CHECK_EQUAL(created, 2);
+  }
+
+  // Released with its last partition, so it is registered again
+  PartitionDmaBufferProvider::makeShared("card_buffer", create, 0, 4 * MiB);
+  BOOST_CHECK_EQUAL(created, 3);
+}
+
+BOOST_AUTO_TEST_CASE(MakeSharedOverlap)
+{
+  auto create = [] {
+    return std::make_unique<FakeBufferProvider>(std::vector<uintptr_t>{ 0x10000000, 0x20000000, 0x30000000, 0x40000000 });
+  };
+
+  auto first = PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 2 * MiB, 4 * MiB);
+  BOOST_CHECK_THROW(PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 2 * MiB, 2 * MiB), ParameterException);
+  BOOST_CHECK_THROW(PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 0, 4 * MiB), ParameterException);
+  BOOST_CHECK_THROW(PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 4 * MiB, 4 * MiB), ParameterException);
+
+  // Adjacent partitions and other buffers do not overlap
+  auto before = PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 0, 2 * MiB);
+  auto after = PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 6 * MiB, 2 * MiB);
+  auto other = PartitionDmaBufferProvider::makeShared("other_overlap_buffer", create, 2 * MiB, 4 * MiB);
+
+  // The range of a closed partition is free again
+  first.reset();
+  BOOST_CHECK_NO_THROW(PartitionDmaBufferProvider::makeShared("overlap_buffer", create, 4 * MiB, 2 * MiB));
+}
+
+} // Anonymous namespace
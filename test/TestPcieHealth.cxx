@@ -0,0 +1,47 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPcieHealth.cxx
+/// \brief Test of the PCIe health functions
+
+#define BOOST_TEST_MODULE RORC_TestPcieHealth
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "Utilities/PcieHealth.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+// Bus 0xff, device 0x1f, function 7 is as unlikely as any address to be present
+const PciAddress MISSING_ADDRESS(0xff, 0x1f, 7);
+
+BOOST_AUTO_TEST_CASE(AllOnes)
+{
+  BOOST_CHECK(Utilities::isAllOnes(0xffffffff));
+  BOOST_CHECK(!Utilities::isAllOnes(0xfffffffe));
+  BOOST_CHECK(!Utilities::isAllOnes(0));
+}
+
+BOOST_AUTO_TEST_CASE(MissingDevice)
+{
+  BOOST_CHECK(!Utilities::isDeviceResponding(MISSING_ADDRESS));
+  BOOST_CHECK(!Utilities::getAerCounters(MISSING_ADDRESS));
+}
+
+BOOST_AUTO_TEST_CASE(ThrowDeviceLost)
+{
+  BOOST_CHECK_THROW(Utilities::throwDeviceLost(MISSING_ADDRESS, "testing"), DeviceLostException);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,94 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestPerfCounters.cxx
+/// \brief Test of the PerfCounters class
+
+#define BOOST_TEST_MODULE RORC_TestPerfCounters
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Utilities/PerfCounters.h"
+
+using namespace ::AliceO2::roc;
+using Utilities::PerfCounters;
+using Utilities::PerfEvent;
+using Utilities::PerfRegion;
+
+namespace
+{
+
+PerfCounters::Counts makeCounts(uint64_t cycles, uint64_t enabled, uint64_t running)
+{
+  PerfCounters::Counts counts;
+  counts.values[PerfEvent::Cycles] = cycles;
+  counts.timeEnabled = enabled;
+  counts.timeRunning = running;
+  return counts;
+}
+
+BOOST_AUTO_TEST_CASE(Delta)
+{
+  auto delta = makeCounts(1500, 2000, 2000) - makeCounts(500, 1000, 1000);
+  BOOST_CHECK_EQUAL(delta[PerfEvent::Cycles], 1000);
+  BOOST_CHECK_EQUAL(delta.timeEnabled, 1000);
+  BOOST_CHECK_EQUAL(delta[PerfEvent::Instructions], 0);
+}
+
+BOOST_AUTO_TEST_CASE(DeltaMultiplexed)
+{
+  // The counters were on the CPU for a quarter of the time, so the count is scaled up
+  auto delta = makeCounts(1500, 2000, 1250) - makeCounts(500, 1000, 1000);
+  BOOST_CHECK_EQUAL(delta[PerfEvent::Cycles], 4000);
+}
+
+BOOST_AUTO_TEST_CASE(Accumulate)
+{
+  PerfCounters::Counts total;
+  total += makeCounts(10, 100, 100);
+  total += makeCounts(20, 200, 100);
+  BOOST_CHECK_EQUAL(total[PerfEvent::Cycles], 30);
+  BOOST_CHECK_EQUAL(total.timeEnabled, 300);
+  BOOST_CHECK_EQUAL(total.timeRunning, 200);
+}
+
+BOOST_AUTO_TEST_CASE(RegionWithoutCounters)
+{
+  PerfRegion region;
+  region.begin();
+  region.end();
+  BOOST_CHECK_EQUAL(region.getCalls(), 0);
+  BOOST_CHECK_EQUAL(region.getTotal()[PerfEvent::Cycles], 0);
+}
+
+BOOST_AUTO_TEST_CASE(Counters)
+{
+  // Counters are often unavailable in containers and virtual machines, which must not be an error
+  PerfCounters counters;
+  if (!counters.isAvailable()) {
+    BOOST_CHECK(!counters.getError().empty());
+    BOOST_CHECK_EQUAL(counters.read()[PerfEvent::Cycles], 0);
+    return;
+  }
+
+  PerfRegion region(&counters);
+  region.begin();
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < 1000000; ++i) {
+    sum = sum + i;
+  }
+  region.end();
+  BOOST_CHECK_EQUAL(region.getCalls(), 1);
+  if (counters.isAvailable(PerfEvent::Instructions)) {
+    BOOST_CHECK_GT(region.getTotal()[PerfEvent::Instructions], 1000000);
+  }
+}
+
+} // Anonymous namespace
@@ -0,0 +1,86 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestRateWeightedDistribution.cxx
+/// \brief Test of the RateWeightedDistribution class
+
+#define BOOST_TEST_MODULE RORC_TestRateWeightedDistribution
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <array>
+#include <boost/test/unit_test.hpp>
+#include "RateWeightedDistribution.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr size_t CAPACITY = 128;
+
+/// Fills the queues of the links by picking until all are at their limit or the budget is spent
+template <size_t LINKS>
+std::array<size_t, LINKS> distribute(const RateWeightedDistribution& distribution, size_t budget)
+{
+  std::array<size_t, LINKS> depths{};
+  for (size_t i = 0; i < budget; ++i) {
+    auto link = distribution.pick([&](size_t l) { return depths[l]; }, [](size_t) { return CAPACITY; });
+    if (link == RateWeightedDistribution::NO_LINK) {
+      break;
+    }
+    depths[link]++;
+  }
+  return depths;
+}
+
+BOOST_AUTO_TEST_CASE(EvenWithoutRates)
+{
+  RateWeightedDistribution distribution(4, 2);
+  distribution.reset(RateWeightedDistribution::Clock::now());
+  auto depths = distribute<4>(distribution, 40);
+  for (auto depth : depths) {
+    BOOST_CHECK_EQUAL(depth, 10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WeightedByRate)
+{
+  RateWeightedDistribution distribution(3, 2);
+  auto now = RateWeightedDistribution::Clock::now();
+  distribution.reset(now);
+
+  // Link 0 completes three times as much as link 1, link 2 is quiet
+  for (int window = 0; window < 10; ++window) {
+    for (int i = 0; i < 30; ++i) {
+      distribution.countArrival(0);
+    }
+    for (int i = 0; i < 10; ++i) {
+      distribution.countArrival(1);
+    }
+    now += RateWeightedDistribution::UPDATE_INTERVAL;
+    distribution.update(now);
+  }
+  BOOST_CHECK_CLOSE(distribution.getShare(0), 0.75, 0.01);
+  BOOST_CHECK_CLOSE(distribution.getRate(1), 100.0, 0.01);
+
+  auto depths = distribute<3>(distribution, 82);
+  BOOST_CHECK_EQUAL(depths[2], 2); // Floor
+  BOOST_CHECK_EQUAL(depths[0], 60);
+  BOOST_CHECK_EQUAL(depths[1], 20);
+
+  // With the busy links full, the quiet link takes the rest
+  depths = distribute<3>(distribution, 3 * CAPACITY + 1);
+  BOOST_CHECK_EQUAL(depths[0], CAPACITY);
+  BOOST_CHECK_EQUAL(depths[1], CAPACITY);
+  BOOST_CHECK_EQUAL(depths[2], CAPACITY);
+}
+
+} // Anonymous namespace
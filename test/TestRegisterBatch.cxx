@@ -0,0 +1,209 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestRegisterBatch.cxx
+/// \brief Test of the RegisterBatch class
+
+#define BOOST_TEST_MODULE RORC_TestRegisterBatch
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "CommandLineUtilities/RegisterBatch.h"
+#include "Utilities/Util.h"
+
+using namespace ::AliceO2::roc;
+using namespace ::AliceO2::roc::CommandLineUtilities;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+/// Registers in memory
+class Registers : public RegisterReadWriteInterface
+{
+ public:
+  virtual uint32_t readRegister(int index) override
+  {
+    return values[index];
+  }
+
+  virtual void writeRegister(int index, uint32_t value) override
+  {
+    values[index] = value;
+  }
+
+  virtual void modifyRegister(int index, int position, int width, uint32_t value) override
+  {
+    Utilities::setBits(values[index], position, width, value);
+  }
+
+  std::map<int, uint32_t> values;
+};
+
+/// Opens Registers, and remembers them by card ID and channel
+struct Cards {
+  RegisterBatch::BarOpener getOpener()
+  {
+    return [this](const std::string& cardId, int channel) {
+      opened++;
+      auto& registers = bars[cardId + ':' + std::to_string(channel)];
+      registers = std::make_shared<Registers>();
+      return registers;
+    };
+  }
+
+  std::map<std::string, std::shared_ptr<Registers>> bars;
+  int opened = 0;
+};
+
+std::vector<std::string> getLines(const std::string& string)
+{
+  std::istringstream stream(string);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(stream, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+BOOST_AUTO_TEST_CASE(Operations)
+{
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  Cards cards;
+  RegisterBatch batch(cards.getOpener());
+  batch.selectCard("#0");
+
+  std::istringstream script(
+    "# Set up\n"
+    "write 0x10 0x12345678\n"
+    "modify 10 0 8 255 # Low byte\n"
+    "\n"
+    "read 10\n"
+    "sleep 250\n"
+    "card 42:0.0 1\n"
+    "write 4 7\n"
+    "card #0 # Back to the first\n"
+    "read 4\n"
+    "wait 10 28 4 1\n");
+  std::ostringstream output;
+  BOOST_CHECK_EQUAL(batch.run(script, output), 0);
+
+  auto lines = getLines(output.str());
+  BOOST_REQUIRE_EQUAL(lines.size(), 10);
+  BOOST_CHECK_EQUAL(lines[0], "line,operation,address,value,status,message");
+  BOOST_CHECK_EQUAL(lines[1], "2,write,0x10,0x12345678,ok,");
+  BOOST_CHECK_EQUAL(lines[2], "3,modify,0x10,0x000000ff,ok,");
+  BOOST_CHECK_EQUAL(lines[3], "5,read,0x10,0x123456ff,ok,");
+  BOOST_CHECK_EQUAL(lines[4], "6,sleep,,250,ok,");
+  BOOST_CHECK_EQUAL(lines[5], "7,card,,42:0.0:1,ok,");
+  BOOST_CHECK_EQUAL(lines[7], "9,card,,#0:0,ok,");
+  // The write went to the other card
+  BOOST_CHECK_EQUAL(lines[8], "10,read,0x4,0x00000000,ok,");
+  BOOST_CHECK_EQUAL(lines[9], "11,wait,0x10,0x123456ff,ok,");
+
+  // Each BAR is opened once, and kept open
+  BOOST_CHECK_EQUAL(cards.opened, 2);
+  BOOST_CHECK_EQUAL(cards.bars["42:0.0:1"]->values[1], 7);
+  BOOST_CHECK(timeSource.getSlept() == 250us);
+}
+
+BOOST_AUTO_TEST_CASE(Wait)
+{
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  Cards cards;
+  RegisterBatch batch(cards.getOpener());
+  batch.selectCard("#0");
+  cards.bars["#0:0"]->values[2] = 0x80000000;
+
+  std::ostringstream output;
+  BOOST_CHECK(batch.execute("wait 8 31 1 1", 1, output));
+  BOOST_CHECK(!batch.execute("wait 8 0 1 1 5", 2, output));
+  BOOST_CHECK_EQUAL(getLines(output.str())[1], "2,wait,0x8,0x80000000,timeout,");
+  BOOST_CHECK(timeSource.getElapsed() > 5ms);
+  BOOST_CHECK(timeSource.getElapsed() < 6ms);
+}
+
+BOOST_AUTO_TEST_CASE(Errors)
+{
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  Cards cards;
+
+  std::ostringstream output;
+  {
+    RegisterBatch batch(cards.getOpener());
+    BOOST_CHECK(!batch.execute("read 0", 1, output));
+    BOOST_CHECK_EQUAL(getLines(output.str())[0], "1,read,0x0,,error,No card selected");
+  }
+
+  RegisterBatch batch(cards.getOpener());
+  batch.selectCard("#0");
+  for (auto line : { "read 2", "read", "write 0 x", "write 0 -1", "modify 0 30 4 1", "modify 0x0 4294967295 1 0",
+                     "frobnicate 0" }) {
+    BOOST_CHECK(!batch.execute(line, 1, output));
+  }
+
+  // The script stops at the first failure, unless told to keep going
+  std::istringstream script("read 0\nread 3\nread 4\n");
+  output.str("");
+  BOOST_CHECK_EQUAL(batch.run(script, output), 1);
+  BOOST_CHECK_EQUAL(getLines(output.str()).size(), 3);
+
+  RegisterBatch keepGoing(cards.getOpener(), true);
+  keepGoing.selectCard("#0");
+  std::istringstream again("read 0\nread 3\nread 4\nread 5\n");
+  output.str("");
+  BOOST_CHECK_EQUAL(keepGoing.run(again, output), 2);
+  BOOST_CHECK_EQUAL(getLines(output.str()).size(), 5);
+}
+
+/// Counts the flushes of a stream
+class FlushCounter : public std::stringbuf
+{
+ public:
+  int flushes = 0;
+
+ protected:
+  virtual int sync() override
+  {
+    flushes++;
+    return std::stringbuf::sync();
+  }
+};
+
+BOOST_AUTO_TEST_CASE(LineBuffered)
+{
+  Cards cards;
+  std::istringstream script("card #0\n# comment\nread 0\nwrite 0 1\n");
+
+  FlushCounter counter;
+  std::ostream output(&counter);
+  RegisterBatch batch(cards.getOpener(), false, true);
+  BOOST_CHECK_EQUAL(batch.run(script, output), 0);
+  // The header and every operation, so a driving process is never left waiting for a result
+  BOOST_CHECK_EQUAL(counter.flushes, 4);
+
+  FlushCounter unbuffered;
+  std::ostream unbufferedOutput(&unbuffered);
+  std::istringstream again("card #0\nread 0\n");
+  BOOST_CHECK_EQUAL(RegisterBatch(cards.getOpener()).run(again, unbufferedOutput), 0);
+  BOOST_CHECK_EQUAL(unbuffered.flushes, 0);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,254 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestRegisterProgram.cxx
+/// \brief Test of the RegisterProgram class
+
+#define BOOST_TEST_MODULE RORC_TestRegisterProgram
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/Exception.h"
+#include "ReadoutCard/TimeSource.h"
+#include "RegisterProgram.h"
+#include "Utilities/Util.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+/// Registers in memory, reporting their writes to a recorder like the PdaBar does
+class Registers : public RegisterReadWriteInterface
+{
+ public:
+  virtual uint32_t readRegister(int index) override
+  {
+    reads++;
+    return values[index];
+  }
+
+  virtual void writeRegister(int index, uint32_t value) override
+  {
+    values[index] = value;
+    writes.emplace_back(index, value);
+    if (recorder) {
+      recorder->recordWrite(index, value);
+    }
+  }
+
+  virtual void modifyRegister(int index, int position, int width, uint32_t value) override
+  {
+    uint32_t regValue = readRegister(index);
+    Utilities::setBits(regValue, position, width, value);
+    values[index] = regValue;
+    writes.emplace_back(index, regValue);
+    if (recorder) {
+      recorder->recordModify(index, position, width, regValue);
+    }
+  }
+
+  std::map<int, uint32_t> values;
+  std::vector<std::pair<int, uint32_t>> writes;
+  uint64_t reads = 0;
+  RegisterProgramRecorder* recorder = nullptr;
+};
+
+/// A small configuration: fields set one by one, a pulse, a command written twice, a sleep and a polled ready bit
+void configure(Registers& registers)
+{
+  registers.modifyRegister(1, 0, 2, 0x3);
+  registers.modifyRegister(1, 8, 4, 0xa);
+  registers.modifyRegister(1, 16, 1, 0x1);
+  registers.modifyRegister(2, 4, 1, 0x1); // Pulse
+  registers.modifyRegister(2, 4, 1, 0x0);
+  registers.writeRegister(3, 0x2); // Command
+  registers.writeRegister(3, 0x2);
+  TimeSource::get().sleepFor(2ms);
+  TimeSource::get().sleepFor(3ms);
+  {
+    RegisterProgramRecorder::PollScope poll(registers.recorder, 4, 1u << 31, 1u << 31, 1ms);
+    while (!Utilities::getBit(registers.readRegister(4), 31)) {
+      TimeSource::get().sleepFor(100us);
+    }
+  }
+}
+
+RegisterProgram compile(Registers& registers)
+{
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scopedVirtual(timeSource);
+  RegisterProgram program("fw", "key");
+  RegisterProgramRecorder recorder(program);
+  ScopedThreadTimeSource scopedRecorder(recorder);
+  registers.recorder = &recorder;
+  configure(registers);
+  registers.recorder = nullptr;
+  BOOST_CHECK_EQUAL(recorder.getWrites(), 7);
+  return program;
+}
+
+BOOST_AUTO_TEST_CASE(Coalescing)
+{
+  Registers registers;
+  registers.values[1] = 0xf0000000;
+  registers.values[4] = 0x80000000;
+  auto program = compile(registers);
+  auto& operations = program.getOperations();
+
+  // The three fields of register 1 in one write, both halves of the pulse, both commands, one wait and the poll
+  BOOST_REQUIRE_EQUAL(operations.size(), 7);
+  BOOST_CHECK_EQUAL(operations[0].type, RegisterProgram::Operation::Write);
+  BOOST_CHECK_EQUAL(operations[0].index, 1);
+  BOOST_CHECK_EQUAL(operations[0].value, 0xf0010a03);
+  BOOST_CHECK_EQUAL(operations[0].mask, 0x00010f03);
+  BOOST_CHECK_EQUAL(operations[1].value, 0x10);
+  BOOST_CHECK_EQUAL(operations[2].value, 0x0);
+  BOOST_CHECK_EQUAL(operations[3].index, 3);
+  BOOST_CHECK_EQUAL(operations[4].index, 3);
+  BOOST_CHECK_EQUAL(operations[5].type, RegisterProgram::Operation::Wait);
+  BOOST_CHECK(operations[5].duration == 5ms);
+  BOOST_CHECK_EQUAL(operations[6].type, RegisterProgram::Operation::Poll);
+  BOOST_CHECK_EQUAL(operations[6].index, 4);
+  BOOST_CHECK_EQUAL(operations[6].mask, 0x80000000);
+  BOOST_CHECK_EQUAL(operations[6].value, 0x80000000);
+}
+
+BOOST_AUTO_TEST_CASE(Replay)
+{
+  Registers recorded;
+  recorded.values[1] = 0xf0000000;
+  recorded.values[4] = 0x80000000;
+  auto program = compile(recorded);
+
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  Registers replayed;
+  replayed.values[4] = 0x80000000;
+  BOOST_CHECK(program.replay(replayed));
+  BOOST_CHECK(timeSource.getSlept() == 5ms);
+  // The same end state, with the poll as the only read
+  BOOST_CHECK(replayed.values == recorded.values);
+  BOOST_CHECK_EQUAL(replayed.reads, 1);
+  BOOST_CHECK_EQUAL(replayed.writes.size(), 5);
+
+  // A condition that never comes true times out, and the replay stops there
+  replayed.values[4] = 0;
+  BOOST_CHECK(!program.replay(replayed));
+  BOOST_CHECK(timeSource.getElapsed() > 10ms + 1ms);
+}
+
+BOOST_AUTO_TEST_CASE(LiveSection)
+{
+  // A scan whose writes depend on what it reads
+  auto scan = [](Registers& registers) {
+    uint32_t step = 0;
+    while (registers.readRegister(5) < 3) {
+      registers.writeRegister(5, registers.values[5] + 1);
+      TimeSource::get().sleepFor(1ms);
+      step++;
+    }
+    return step;
+  };
+
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  RegisterProgram program("fw", "key");
+  Registers recorded;
+  {
+    RegisterProgramRecorder recorder(program);
+    ScopedThreadTimeSource scopedRecorder(recorder);
+    recorded.recorder = &recorder;
+    recorded.writeRegister(1, 1);
+    {
+      RegisterProgramRecorder::LiveScope live(&recorder, 7);
+      BOOST_CHECK_EQUAL(scan(recorded), 3);
+    }
+    recorded.writeRegister(2, 2);
+    recorded.recorder = nullptr;
+    BOOST_CHECK_EQUAL(recorder.getWrites(), 2);
+  }
+
+  auto& operations = program.getOperations();
+  BOOST_REQUIRE_EQUAL(operations.size(), 3);
+  BOOST_CHECK_EQUAL(operations[1].type, RegisterProgram::Operation::Live);
+  BOOST_CHECK_EQUAL(operations[1].index, 7);
+
+  // The replay runs the scan on what it reads now
+  Registers replayed;
+  replayed.values[5] = 1;
+  uint32_t steps = 0;
+  BOOST_CHECK(program.replay(replayed, [&](uint32_t section) {
+    BOOST_CHECK_EQUAL(section, 7);
+    steps = scan(replayed);
+  }));
+  BOOST_CHECK_EQUAL(steps, 2);
+  BOOST_CHECK_EQUAL(replayed.values[2], 2);
+  BOOST_CHECK_THROW(program.replay(replayed), Exception);
+
+  std::stringstream stream;
+  program.save(stream);
+  BOOST_CHECK_EQUAL(RegisterProgram::load(stream).getOperations()[1].type, RegisterProgram::Operation::Live);
+}
+
+BOOST_AUTO_TEST_CASE(OtherThread)
+{
+  // The sleeps of other threads, e.g. waiting for a lock, are not the configuration's
+  VirtualTimeSource timeSource;
+  ScopedTimeSource scoped(timeSource);
+  RegisterProgram program("fw", "key");
+  RegisterProgramRecorder recorder(program);
+  ScopedThreadTimeSource scopedRecorder(recorder);
+  std::thread other([] { TimeSource::get().sleepFor(1s); });
+  other.join();
+  TimeSource::get().sleepFor(1ms);
+  BOOST_REQUIRE_EQUAL(program.getOperations().size(), 1);
+  BOOST_CHECK(program.getOperations()[0].duration == 1ms);
+}
+
+BOOST_AUTO_TEST_CASE(SaveLoad)
+{
+  Registers registers;
+  registers.values[4] = 0x80000000;
+  auto program = compile(registers);
+
+  std::stringstream stream;
+  program.save(stream);
+  auto loaded = RegisterProgram::load(stream);
+  BOOST_CHECK(loaded.matches("fw", "key"));
+  BOOST_CHECK(!loaded.matches("fw2", "key"));
+  BOOST_CHECK(!loaded.matches("fw", "key2"));
+  BOOST_REQUIRE_EQUAL(loaded.getOperations().size(), program.getOperations().size());
+  for (size_t i = 0; i < loaded.getOperations().size(); ++i) {
+    auto& a = loaded.getOperations()[i];
+    auto& b = program.getOperations()[i];
+    BOOST_CHECK_EQUAL(a.type, b.type);
+    BOOST_CHECK_EQUAL(a.index, b.index);
+    BOOST_CHECK_EQUAL(a.value, b.value);
+    BOOST_CHECK_EQUAL(a.mask, b.mask);
+    BOOST_CHECK(a.duration == b.duration);
+  }
+
+  // Programs of another version are not replayed
+  std::stringstream other("# roc-register-program 999\nfirmware fw\nparameters key\nX 1\n");
+  BOOST_CHECK(!RegisterProgram::load(other).matches("fw", "key"));
+
+  std::stringstream malformed("# roc-register-program 2\nfirmware fw\nparameters key\nW 1 2\n");
+  BOOST_CHECK_THROW(RegisterProgram::load(malformed), ParseException);
+}
+
+} // Anonymous namespace
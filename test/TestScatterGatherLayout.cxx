@@ -0,0 +1,79 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestScatterGatherLayout.cxx
+/// \brief Test of the ScatterGatherLayout class
+
+#define BOOST_TEST_MODULE RORC_TestScatterGatherLayout
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include "DmaBufferProvider/ScatterGatherLayout.h"
+#include "FakeBufferProvider.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+constexpr size_t MiB = 1024 * 1024;
+
+BOOST_AUTO_TEST_CASE(MergeContiguousEntries)
+{
+  // Two 2 MiB hugepages that happen to be contiguous on the bus, then a separate one
+  FakeBufferProvider provider({ { 2 * MiB, 0x10000000 }, { 2 * MiB, 0x10200000 }, { 2 * MiB, 0x40000000 } });
+  ScatterGatherLayout layout(provider);
+
+  BOOST_REQUIRE_EQUAL(layout.getSegments().size(), 2);
+  BOOST_CHECK_EQUAL(layout.getSegments()[0].size, 4 * MiB);
+  BOOST_CHECK_EQUAL(layout.getSegments()[1].offset, 4 * MiB);
+  BOOST_CHECK_EQUAL(layout.getLargestSegmentSize(), 4 * MiB);
+
+  BOOST_CHECK(layout.isContiguous(1 * MiB, 3 * MiB));
+  BOOST_CHECK(!layout.isContiguous(3 * MiB, 2 * MiB));
+  BOOST_CHECK(layout.isContiguous(4 * MiB, 2 * MiB));
+  BOOST_CHECK(!layout.isContiguous(5 * MiB, 2 * MiB));
+}
+
+BOOST_AUTO_TEST_CASE(Plan)
+{
+  FakeBufferProvider provider({ { 2 * MiB, 0x10000000 }, { 2 * MiB, 0x10200000 }, { 2 * MiB, 0x40000000 } });
+  ScatterGatherLayout layout(provider);
+
+  // 3 MiB superpages: one fits in the 4 MiB segment, none in the 2 MiB one, and the second back-to-back one straddles
+  auto plan = layout.plan(3 * MiB);
+  BOOST_REQUIRE_EQUAL(plan.offsets.size(), 1);
+  BOOST_CHECK_EQUAL(plan.offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(plan.straddling.size(), 1);
+  BOOST_CHECK_EQUAL(plan.straddling[0], 3 * MiB);
+  BOOST_CHECK_EQUAL(plan.usableSize, 3 * MiB);
+  BOOST_CHECK_EQUAL(plan.lostSize, 3 * MiB);
+
+  // 1 MiB superpages fill the whole buffer
+  plan = layout.plan(1 * MiB);
+  BOOST_CHECK_EQUAL(plan.offsets.size(), 6);
+  BOOST_CHECK(plan.straddling.empty());
+  BOOST_CHECK_EQUAL(plan.lostSize, 0);
+}
+
+BOOST_AUTO_TEST_CASE(PlanAlignment)
+{
+  // A segment starting at an unaligned offset
+  FakeBufferProvider provider({ { 96 * 1024, 0x10000000 }, { 4 * MiB, 0x40000000 } });
+  ScatterGatherLayout layout(provider);
+
+  auto plan = layout.plan(1 * MiB, 1 * MiB);
+  BOOST_REQUIRE_EQUAL(plan.offsets.size(), 3);
+  BOOST_CHECK_EQUAL(plan.offsets[0], 1 * MiB);
+  BOOST_CHECK(!plan.straddling.empty());
+}
+
+} // Anonymous namespace
@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestSuperpageTracker.cxx
+/// \brief Test of the SuperpageTracker class
+
+#define BOOST_TEST_MODULE RORC_TestSuperpageTracker
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <sstream>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include "SuperpageTracker.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::literals;
+
+namespace
+{
+
+using Tracker = SuperpageTracker<4>;
+using Stage = Tracker::Stage;
+
+BOOST_AUTO_TEST_CASE(Lifecycle)
+{
+  Tracker tracker;
+  auto time = Tracker::Clock::now();
+  tracker.reset(time);
+
+  tracker.push(0x1000, 2, time);
+  tracker.complete(0x1000, time + 10us);
+  tracker.pop(0x1000, time + 30us);
+  tracker.push(0x1000, 1, time + 100us);
+
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Transfer, 2).count, 1);
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Transfer, 2).maxUs, 10);
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Ready, 2).maxUs, 20);
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Held, 2).maxUs, 70);
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Transfer, 1).count, 0);
+
+  // Events out of sequence or for unknown superpages are ignored
+  tracker.pop(0x1000, time + 110us);
+  tracker.complete(0x2000, time + 110us);
+  BOOST_CHECK_EQUAL(tracker.getHistogram(Stage::Ready, 1).count, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Histogram)
+{
+  Tracker::Histogram histogram;
+  for (int i = 0; i < 99; ++i) {
+    histogram.add(5);
+  }
+  histogram.add(1000);
+  BOOST_CHECK_EQUAL(histogram.count, 100);
+  BOOST_CHECK_EQUAL(histogram.getQuantile(0.5), 7);
+  BOOST_CHECK_EQUAL(histogram.getQuantile(0.99), 1000);
+  BOOST_CHECK_CLOSE(histogram.getMean(), 14.95, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(Overdue)
+{
+  Tracker tracker;
+  auto time = Tracker::Clock::now();
+  tracker.reset(time);
+
+  tracker.push(0x0, 0, time);
+  tracker.push(0x1000, 0, time);
+  tracker.complete(0x0, time);
+  tracker.pop(0x0, time);
+
+  BOOST_CHECK(tracker.checkOverdue(time + 500ms, 1s).empty());
+  auto overdue = tracker.checkOverdue(time + 1s, 1s);
+  BOOST_REQUIRE_EQUAL(overdue.size(), 2);
+
+  // Reported once per stage
+  BOOST_CHECK(tracker.checkOverdue(time + 2s, 1s).empty());
+  tracker.complete(0x1000, time + 2s);
+  BOOST_CHECK(tracker.checkOverdue(time + 3s, 1s).size() == 1);
+  BOOST_CHECK_EQUAL(tracker.getOverdueTotal(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(Export)
+{
+  Tracker tracker;
+  auto time = Tracker::Clock::now();
+  tracker.reset(time);
+  tracker.push(0x2000, 3, time);
+  tracker.complete(0x2000, time + 5us);
+
+  std::ostringstream trace;
+  tracker.writeTrace(trace, time + 10us);
+  auto string = trace.str();
+  BOOST_CHECK_NE(string.find("\"traceEvents\""), std::string::npos);
+  BOOST_CHECK_NE(string.find("\"name\":\"transfer\",\"cat\":\"superpage\",\"ph\":\"X\",\"pid\":0,\"tid\":3,\"ts\":0,\"dur\":5"),
+                 std::string::npos);
+  BOOST_CHECK_NE(string.find("\"ts\":5,\"dur\":5,\"args\":{\"offset\":8192,\"open\":true}"), std::string::npos);
+
+  std::ostringstream report;
+  tracker.writeReport(report);
+  BOOST_CHECK_NE(report.str().find("transfer"), std::string::npos);
+}
+
+} // Anonymous namespace
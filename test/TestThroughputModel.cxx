@@ -0,0 +1,87 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestThroughputModel.cxx
+/// \brief Test of the ThroughputModel class
+
+#define BOOST_TEST_MODULE RORC_TestThroughputModel
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <cmath>
+#include <boost/test/unit_test.hpp>
+#include "ThroughputModel.h"
+
+using namespace ::AliceO2::roc;
+
+namespace
+{
+
+BOOST_AUTO_TEST_CASE(LinkLimited)
+{
+  ThroughputModel::Configuration configuration;
+  configuration.links = 2;
+  configuration.datapathMode = DatapathMode::Continuous;
+  ThroughputModel model(configuration);
+
+  // Two links of 40.079 MHz * 16 bytes, the RDH is added by the card
+  double expected = 2 * 40.079e6 * 16 * 8192.0 / (8192 - 64);
+  BOOST_CHECK_CLOSE(model.getLinkCeiling(), expected, 1e-6);
+  BOOST_CHECK_EQUAL(model.getLimit().layer, "link");
+  BOOST_CHECK_CLOSE(model.getWrittenFraction(), 1.0, 1e-6);
+  BOOST_CHECK_CLOSE(model.getPayloadFraction(), (8192.0 - 64) / 8192 * 80 / 128, 1e-6);
+
+  configuration.gbtMode = GbtMode::Wb;
+  BOOST_CHECK_CLOSE(ThroughputModel(configuration).getPayloadFraction(), (8192.0 - 64) / 8192 * 112 / 128, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(PcieLimited)
+{
+  ThroughputModel::Configuration configuration;
+  configuration.links = 24;
+  ThroughputModel model(configuration);
+
+  // Gen3 x8 with 128b/130b encoding and 256 byte TLPs
+  double expected = 8e9 * 8 * 128 / 130 / 8 * 256 / (256 + 24);
+  BOOST_CHECK_CLOSE(model.getPcieCeiling(), expected, 1e-6);
+  BOOST_CHECK_EQUAL(model.getLimit().layer, "PCIe");
+
+  // Internal data generator: no link layer
+  configuration.links = 0;
+  BOOST_CHECK(std::isinf(ThroughputModel(configuration).getLinkCeiling()));
+}
+
+BOOST_AUTO_TEST_CASE(SmallPackets)
+{
+  ThroughputModel::Configuration configuration;
+  configuration.packetSize = 1024;
+  ThroughputModel model(configuration);
+
+  // Every 1 KiB packet takes a whole DMA page, of which only the RDH and the packet are written
+  BOOST_CHECK_CLOSE(model.getWrittenFraction(), (1024.0 + 64) / 8192, 1e-6);
+  BOOST_CHECK_CLOSE(model.getLinkCeiling(), 40.079e6 * 16 * 8192 / 1024, 1e-6);
+
+  // A packet spanning two pages
+  configuration.packetSize = 8192;
+  BOOST_CHECK_CLOSE(ThroughputModel(configuration).getWrittenFraction(), (8192.0 + 128) / (2 * 8192), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(SuperpageTail)
+{
+  ThroughputModel::Configuration configuration;
+  configuration.superpageSize = 8192 * 3 + 4096;
+  ThroughputModel::Configuration aligned = configuration;
+  aligned.superpageSize = 8192 * 3;
+
+  // The tail of the superpage is never filled, but is read out
+  BOOST_CHECK_CLOSE(ThroughputModel(configuration).getPcieCeiling(),
+                    ThroughputModel(aligned).getPcieCeiling() * (3.5 / 3), 1e-6);
+}
+
+} // Anonymous namespace
@@ -0,0 +1,109 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file TestTimeSource.cxx
+/// \brief Test of the TimeSource classes
+
+#define BOOST_TEST_MODULE RORC_TestTimeSource
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include "ReadoutCard/InterprocessLock.h"
+#include "ReadoutCard/TimeSource.h"
+
+using namespace ::AliceO2::roc;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+BOOST_AUTO_TEST_CASE(Default)
+{
+  BOOST_CHECK(dynamic_cast<SteadyTimeSource*>(&TimeSource::get()) != nullptr);
+  auto before = std::chrono::steady_clock::now();
+  auto now = TimeSource::get().now();
+  BOOST_CHECK(now >= before);
+  BOOST_CHECK(now <= std::chrono::steady_clock::now());
+}
+
+BOOST_AUTO_TEST_CASE(Virtual)
+{
+  VirtualTimeSource timeSource(1us);
+  auto start = timeSource.now();
+  timeSource.sleepFor(2s);
+  timeSource.advance(3s);
+  // The read itself takes a step
+  BOOST_CHECK(timeSource.now() - start == 5s + 1us);
+  BOOST_CHECK(timeSource.getSlept() == 2s);
+  BOOST_CHECK(timeSource.getElapsed() == 5s + 2us);
+
+  // A negative sleep does not go back in time
+  timeSource.sleepFor(-1s);
+  BOOST_CHECK(timeSource.getSlept() == 2s);
+}
+
+BOOST_AUTO_TEST_CASE(Scoped)
+{
+  VirtualTimeSource outer;
+  VirtualTimeSource inner;
+  {
+    ScopedTimeSource scopedOuter(outer);
+    BOOST_CHECK(&TimeSource::get() == &outer);
+    {
+      ScopedTimeSource scopedInner(inner);
+      BOOST_CHECK(&TimeSource::get() == &inner);
+      TimeSource::get().sleepFor(1s);
+    }
+    BOOST_CHECK(&TimeSource::get() == &outer);
+  }
+  BOOST_CHECK(dynamic_cast<SteadyTimeSource*>(&TimeSource::get()) != nullptr);
+  BOOST_CHECK(inner.getSlept() == 1s);
+  BOOST_CHECK(outer.getSlept() == 0s);
+}
+
+BOOST_AUTO_TEST_CASE(ScopedThread)
+{
+  VirtualTimeSource process;
+  VirtualTimeSource thread;
+  ScopedTimeSource scopedProcess(process);
+  {
+    ScopedThreadTimeSource scopedThread(thread);
+    BOOST_CHECK(&TimeSource::get() == &thread);
+    // Other threads keep the time source of the process
+    std::thread other([] { TimeSource::get().sleepFor(2s); });
+    other.join();
+    TimeSource::get().sleepFor(1s);
+  }
+  BOOST_CHECK(&TimeSource::get() == &process);
+  BOOST_CHECK(thread.getSlept() == 1s);
+  BOOST_CHECK(process.getSlept() == 2s);
+}
+
+/// The lock waits 5 seconds for a holder to release it, which takes no real time with the virtual time
+BOOST_AUTO_TEST_CASE(LockTimeout)
+{
+  const std::string name = "Alice_O2_RoC_TEST_TimeSource_" + std::to_string(getpid()) + "_lock";
+  Interprocess::Lock holder(name);
+
+  VirtualTimeSource timeSource(1ms);
+  ScopedTimeSource scoped(timeSource);
+  auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_THROW(Interprocess::Lock(name, true), std::runtime_error);
+  BOOST_CHECK(timeSource.getElapsed() > std::chrono::seconds(LOCK_TIMEOUT));
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < 2s);
+}
+
+} // Anonymous namespace